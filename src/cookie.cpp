@@ -24,8 +24,7 @@
 #include "httpserver/cookie.hpp"
 
 #include <cstdint>
-#include <cstdio>
-#include <ctime>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
@@ -33,6 +32,8 @@
 #include <utility>
 #include <vector>
 
+#include "httpserver/detail/http_date.hpp"
+
 namespace httpserver {
 
 namespace {
@@ -114,47 +115,6 @@ void validate_attr_param(std::string_view setter, std::string_view v) {
     }
 }
 
-// IMF-fixdate formatter (RFC 7231 §7.1.1.1):
-//     "Sun, 06 Nov 1994 08:49:37 GMT"
-// Locale-independent: hand-rolls the day/month spellings rather than
-// going through strftime, whose abbreviations are locale-sensitive.
-std::string format_imf_fixdate(std::int64_t epoch_seconds) {
-    static constexpr const char* kDayNames[7] = {
-        "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
-    };
-    static constexpr const char* kMonthNames[12] = {
-        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-    };
-
-    const std::time_t t = static_cast<std::time_t>(epoch_seconds);
-    std::tm tm{};
-#if defined(_WIN32)
-    gmtime_s(&tm, &t);
-#else
-    gmtime_r(&t, &tm);
-#endif
-
-    // tm_wday: 0..6 (Sunday=0); tm_mon: 0..11; tm_year: years since 1900
-    const int wday  = (tm.tm_wday >= 0 && tm.tm_wday < 7) ? tm.tm_wday : 0;
-    const int mon   = (tm.tm_mon  >= 0 && tm.tm_mon  < 12) ? tm.tm_mon : 0;
-    const int year  = tm.tm_year + 1900;
-    const int mday  = tm.tm_mday;
-    const int hour  = tm.tm_hour;
-    const int minute = tm.tm_min;
-    const int sec   = tm.tm_sec;
-
-    char buf[40];
-    std::snprintf(buf, sizeof(buf),
-                  "%s, %02d %s %04d %02d:%02d:%02d GMT",
-                  kDayNames[wday],
-                  mday,
-                  kMonthNames[mon],
-                  year,
-                  hour, minute, sec);
-    return std::string(buf);
-}
-
 // Trim ASCII whitespace from both ends.
 std::string_view trim_ws(std::string_view sv) noexcept {
     while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t')) {
@@ -225,21 +185,25 @@ parse_cookie_token(std::string_view tok) {
 void cookie::do_set_name(std::string v) {
     validate_name(v);
     name_ = std::move(v);
+    rendered_.reset();
 }
 
 void cookie::do_set_value(std::string v) {
     validate_value(v);
     value_ = std::move(v);
+    rendered_.reset();
 }
 
 void cookie::do_set_domain(std::string v) {
     validate_attr_param("cookie::with_domain", v);
     domain_ = std::move(v);
+    rendered_.reset();
 }
 
 void cookie::do_set_path(std::string v) {
     validate_attr_param("cookie::with_path", v);
     path_ = std::move(v);
+    rendered_.reset();
 }
 
 // ----------------------------------------------------------------------
@@ -283,46 +247,56 @@ cookie&& cookie::with_path(std::string v) && {
 
 cookie& cookie::with_expires(std::int64_t epoch_seconds) & noexcept {
     expires_ = epoch_seconds;
+    rendered_.reset();
     return *this;
 }
 cookie&& cookie::with_expires(std::int64_t epoch_seconds) && noexcept {
     expires_ = epoch_seconds;
+    rendered_.reset();
     return std::move(*this);
 }
 
 cookie& cookie::with_max_age(std::int64_t seconds) & noexcept {
     max_age_ = seconds;
+    rendered_.reset();
     return *this;
 }
 cookie&& cookie::with_max_age(std::int64_t seconds) && noexcept {
     max_age_ = seconds;
+    rendered_.reset();
     return std::move(*this);
 }
 
 cookie& cookie::with_secure(bool v) & noexcept {
     secure_ = v;
+    rendered_.reset();
     return *this;
 }
 cookie&& cookie::with_secure(bool v) && noexcept {
     secure_ = v;
+    rendered_.reset();
     return std::move(*this);
 }
 
 cookie& cookie::with_http_only(bool v) & noexcept {
     http_only_ = v;
+    rendered_.reset();
     return *this;
 }
 cookie&& cookie::with_http_only(bool v) && noexcept {
     http_only_ = v;
+    rendered_.reset();
     return std::move(*this);
 }
 
 cookie& cookie::with_same_site(same_site_mode v) & noexcept {
     same_site_ = v;
+    rendered_.reset();
     return *this;
 }
 cookie&& cookie::with_same_site(same_site_mode v) && noexcept {
     same_site_ = v;
+    rendered_.reset();
     return std::move(*this);
 }
 
@@ -337,6 +311,22 @@ cookie&& cookie::with_same_site(same_site_mode v) && noexcept {
 // SameSite=None without Secure).
 // ----------------------------------------------------------------------
 std::string cookie::to_set_cookie_header() const {
+    if (rendered_ != nullptr) {
+        return *rendered_;
+    }
+    // Reserve enough for a typical cookie. The exact growth is
+    // irrelevant; one reserve avoids most reallocations.
+    std::string out;
+    out.reserve(name_.size() + value_.size() + 96);
+    append_set_cookie_header(out);
+    return out;
+}
+
+void cookie::append_set_cookie_header(std::string& out) const {
+    if (rendered_ != nullptr) {
+        out.append(*rendered_);
+        return;
+    }
     if (name_.empty()) {
         throw std::invalid_argument(
             "cookie::to_set_cookie_header: name is empty -- a cookie "
@@ -353,11 +343,6 @@ std::string cookie::to_set_cookie_header() const {
     validate_name(name_, "cookie::to_set_cookie_header");
     validate_value(value_, "cookie::to_set_cookie_header");
 
-    // Reserve enough for a typical cookie. The exact growth is
-    // irrelevant; one reserve avoids most reallocations.
-    std::string out;
-    out.reserve(name_.size() + value_.size() + 96);
-
     out.append(name_);
     out.push_back('=');
     out.append(value_);
@@ -366,13 +351,23 @@ std::string cookie::to_set_cookie_header() const {
     append_target_attributes(out);
     append_flag_attributes(out);
     out.append(same_site_attribute_text(same_site_));
-    return out;
+}
+
+cookie& cookie::freeze() & {
+    if (rendered_ == nullptr) {
+        rendered_ = std::make_shared<const std::string>(to_set_cookie_header());
+    }
+    return *this;
+}
+cookie&& cookie::freeze() && {
+    freeze();
+    return std::move(*this);
 }
 
 void cookie::append_time_attributes(std::string& out) const {
     if (expires_.has_value()) {
         out.append("; Expires=");
-        out.append(format_imf_fixdate(*expires_));
+        out.append(detail::format_imf_fixdate(*expires_));
     }
     if (max_age_.has_value()) {
         out.append("; Max-Age=");
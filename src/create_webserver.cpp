@@ -34,8 +34,10 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "httpserver/create_webserver.hpp"
+#include "httpserver/detail/http_field_validation.hpp"
 
 namespace httpserver {
 
@@ -89,4 +91,16 @@ create_webserver& create_webserver::bind_address(const std::string& ip) {
     throw std::invalid_argument("bind_address: invalid IP address: " + ip);
 }
 
+create_webserver& create_webserver::default_headers(http::header_map headers) {
+    for (const auto& [name, value] : headers) {
+        if (name.empty() || detail::has_forbidden_field_char(name)
+                || detail::has_forbidden_field_char(value)) {
+            throw std::invalid_argument(
+                "default_headers: empty header name, or CR, LF or NUL in a name or value");
+        }
+    }
+    _config.default_headers = std::move(headers);
+    return *this;
+}
+
 }  // namespace httpserver
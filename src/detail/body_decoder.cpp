@@ -0,0 +1,161 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/body_decoder.hpp"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <strings.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string_view>
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+}  // namespace
+
+#ifdef HAVE_ZLIB
+
+struct body_decoder::state {
+    z_stream zs{};
+    std::array<char, window_bytes> window{};
+};
+
+body_decoder::coding body_decoder::create(const char* content_encoding,
+        std::size_t max_decoded_bytes, std::unique_ptr<body_decoder>* out) {
+    const std::string_view name =
+        trim(content_encoding == nullptr ? std::string_view{} : content_encoding);
+    if (name.empty() || iequals(name, "identity")) return coding::identity;
+    const bool gzip = iequals(name, "gzip") || iequals(name, "x-gzip");
+    if (!gzip && !iequals(name, "deflate")) return coding::unsupported;
+
+    auto st = std::make_unique<state>();
+    // 16 + MAX_WBITS selects the gzip wrapper; plain MAX_WBITS the zlib one.
+    if (inflateInit2(&st->zs, gzip ? 16 + MAX_WBITS : MAX_WBITS) != Z_OK) {
+        return coding::unsupported;
+    }
+    out->reset(new body_decoder(std::move(st), gzip, max_decoded_bytes));
+    return coding::supported;
+}
+
+body_decoder::~body_decoder() {
+    inflateEnd(&state_->zs);
+}
+
+int body_decoder::inflate_step() {
+    z_stream& zs = state_->zs;
+    // A finished gzip member followed by more input is the next member.
+    if (finished_ && zs.avail_in > 0) {
+        if (!multi_member_) return Z_DATA_ERROR;
+        inflateReset(&zs);
+        finished_ = false;
+    }
+    zs.next_out = reinterpret_cast<Bytef*>(state_->window.data());
+    zs.avail_out = static_cast<uInt>(window_bytes);
+    const int rc = inflate(&zs, Z_NO_FLUSH);
+    if (rc == Z_STREAM_END) finished_ = true;
+    return rc;
+}
+
+body_decoder::status body_decoder::flush(sink out, void* cls) {
+    const std::size_t produced = window_bytes - state_->zs.avail_out;
+    if (produced == 0) return status::ok;
+    if (produced > max_decoded_bytes_ - decoded_bytes_) return status::too_large;
+    decoded_bytes_ += produced;
+    return out(cls, state_->window.data(), produced) ? status::ok : status::stopped;
+}
+
+body_decoder::status body_decoder::feed(const char* data, std::size_t size,
+                                        sink out, void* cls) {
+    if (failed_ != status::ok) return failed_;
+    z_stream& zs = state_->zs;
+    constexpr std::size_t max_slice = std::numeric_limits<uInt>::max();
+    while (size > 0) {
+        const std::size_t slice = std::min(size, max_slice);
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zs.avail_in = static_cast<uInt>(slice);
+        // A full window means zlib may hold more output for the same input.
+        bool window_full = false;
+        while (zs.avail_in > 0 || window_full) {
+            const int rc = inflate_step();
+            if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                return failed_ = status::corrupt;
+            }
+            window_full = (zs.avail_out == 0);
+            const status s = flush(out, cls);
+            if (s != status::ok) return failed_ = s;
+            if (rc == Z_BUF_ERROR) break;  // no progress possible
+        }
+        data += slice;
+        size -= slice;
+    }
+    return status::ok;
+}
+
+#else  // !HAVE_ZLIB
+
+struct body_decoder::state {};
+
+body_decoder::coding body_decoder::create(const char* content_encoding,
+        std::size_t, std::unique_ptr<body_decoder>*) {
+    const std::string_view name =
+        trim(content_encoding == nullptr ? std::string_view{} : content_encoding);
+    if (name.empty() || iequals(name, "identity")) return coding::identity;
+    return coding::unsupported;
+}
+
+body_decoder::~body_decoder() = default;
+
+int body_decoder::inflate_step() { return -1; }
+
+body_decoder::status body_decoder::flush(sink, void*) { return status::corrupt; }
+
+body_decoder::status body_decoder::feed(const char*, std::size_t, sink, void*) {
+    return status::corrupt;
+}
+
+#endif  // HAVE_ZLIB
+
+body_decoder::body_decoder(std::unique_ptr<state> st, bool multi_member,
+                           std::size_t max_decoded_bytes) noexcept
+    : state_(std::move(st)), multi_member_(multi_member),
+      max_decoded_bytes_(max_decoded_bytes) {}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -231,7 +231,9 @@ int daemon_lifecycle::compose_runtime_flags() const {
     int flags = 0;
     if (parent->config.debug) flags |= MHD_USE_DEBUG;
     if (parent->config.pedantic) flags |= MHD_USE_PEDANTIC_CHECKS;
-    if (parent->config.deferred_enabled) flags |= MHD_USE_SUSPEND_RESUME;
+    if (parent->config.deferred_enabled || parent->config.async_upload_max_in_flight != 0) {
+        flags |= MHD_USE_SUSPEND_RESUME;
+    }
     if (parent->config.no_listen_socket) flags |= MHD_USE_NO_LISTEN_SOCKET;
     if (parent->config.no_thread_safety) flags |= MHD_USE_NO_THREAD_SAFETY;
     if (parent->config.turbo) flags |= MHD_USE_TURBO;
@@ -24,16 +24,22 @@
 
 #include "httpserver/detail/error_pages.hpp"
 
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include "httpserver/constants.hpp"
 #include "httpserver/create_webserver.hpp"
 #include "httpserver/http_request.hpp"
+#include "httpserver/http_resource.hpp"
 #include "httpserver/http_response.hpp"
 #include "httpserver/http_utils.hpp"
 #include "httpserver/detail/dispatch_util.hpp"
 #include "httpserver/detail/connection_context.hpp"
+#include "httpserver/detail/method_utils.hpp"
 
 namespace httpserver {
 
@@ -41,20 +47,72 @@ using httpserver::http::http_utils;
 
 namespace detail {
 
+namespace {
+
+http_response fixed_page(std::string_view body, int status) {
+    return http_response::string(std::string{body}).with_status(status);
+}
+
+// Freeze a default page. A failure leaves it to be built per call.
+std::optional<frozen_response> prebuild(http_response page) noexcept {
+    try {
+        return std::move(page).freeze();
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+}  // namespace
+
+error_pages::error_pages(const webserver_config& config) : config_(config) {
+    if (config_.not_found_handler == nullptr) {
+        not_found_ = prebuild(fixed_page(constants::NOT_FOUND_ERROR, http_utils::http_not_found));
+    }
+    if (config_.internal_error_handler == nullptr && !config_.expose_exception_messages) {
+        internal_error_ = prebuild(fixed_page(constants::INTERNAL_SERVER_ERROR,
+                                              http_utils::http_internal_server_error));
+    }
+    double_fault_ = prebuild(
+        http_response::empty().with_status(http_utils::http_internal_server_error));
+}
+
 http_response error_pages::not_found_page(connection_context* conn) const {
     if (config_.not_found_handler != nullptr) {
         return config_.not_found_handler(*conn->request);
     }
-    return http_response::string(std::string{constants::NOT_FOUND_ERROR})
-        .with_status(http_utils::http_not_found);
+    if (not_found_) return *not_found_;
+    return fixed_page(constants::NOT_FOUND_ERROR, http_utils::http_not_found);
 }
 
-http_response error_pages::method_not_allowed_page(connection_context* conn) const {
-    if (config_.method_not_allowed_handler != nullptr) {
-        return config_.method_not_allowed_handler(*conn->request);
+http_response error_pages::method_not_allowed_page(connection_context* conn,
+                                                   const http_resource& resource) const {
+    if (config_.method_not_allowed_handler == nullptr) {
+        return default_method_not_allowed(resource.get_allowed_methods());
+    }
+    http_response page = config_.method_not_allowed_handler(*conn->request);
+    const std::string& allow = resource.get_allow_header();
+    if (!allow.empty()) page.with_header(http_utils::http_header_allow, allow);
+    return page;
+}
+
+http_response error_pages::default_method_not_allowed(method_set allowed) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(method_not_allowed_mutex_);
+        auto it = method_not_allowed_.find(allowed.bits);
+        if (it != method_not_allowed_.end()) return it->second;
+    }
+    http_response page = fixed_page(constants::METHOD_ERROR,
+                                    http_utils::http_method_not_allowed);
+    const std::string allow = format_allow_header(allowed);
+    if (!allow.empty()) page.with_header(http_utils::http_header_allow, allow);
+    std::optional<frozen_response> frozen = prebuild(std::move(page));
+    if (!frozen) {
+        page = fixed_page(constants::METHOD_ERROR, http_utils::http_method_not_allowed);
+        if (!allow.empty()) page.with_header(http_utils::http_header_allow, allow);
+        return page;
     }
-    return http_response::string(std::string{constants::METHOD_ERROR})
-        .with_status(http_utils::http_method_not_allowed);
+    std::unique_lock<std::shared_mutex> lock(method_not_allowed_mutex_);
+    return method_not_allowed_.try_emplace(allowed.bits, std::move(*frozen)).first->second;
 }
 
 http_response error_pages::internal_error_page(connection_context* conn,
@@ -65,6 +123,7 @@ http_response error_pages::internal_error_page(connection_context* conn,
     // site after get_raw_response_with_fallback fires. The body is
     // intentionally empty and the message is intentionally ignored.
     if (force_our) {
+        if (double_fault_) return *double_fault_;
         return http_response::empty()
             .with_status(http_utils::http_internal_server_error);
     }
@@ -84,9 +143,8 @@ http_response error_pages::internal_error_page(connection_context* conn,
     if (config_.expose_exception_messages) {
         return http_response::string(std::string{msg}).with_status(status);
     }
-    return http_response::string(
-            std::string{constants::INTERNAL_SERVER_ERROR})
-        .with_status(status);
+    if (internal_error_) return *internal_error_;
+    return fixed_page(constants::INTERNAL_SERVER_ERROR, status);
 }
 
 http_response error_pages::run_internal_error_handler_safely(
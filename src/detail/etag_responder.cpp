@@ -0,0 +1,245 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/etag_responder.hpp"
+
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "httpserver/create_webserver.hpp"
+#include "httpserver/http_request.hpp"
+#include "httpserver/http_response.hpp"
+#include "httpserver/http_utils.hpp"
+#include "httpserver/detail/range_responder.hpp"
+#include "httpserver/detail/response_body.hpp"
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+// XXH64 (seed 0), fed incrementally so an iovec body hashes segment by
+// segment to the same value as its concatenation. Four independent
+// lanes over 32-byte stripes keep it at memory speed without SIMD or a
+// dependency; any byte changing changes the ETag with overwhelming
+// probability, which is all a validator needs -- it is not a MAC.
+class xxh64 {
+ public:
+    void update(const unsigned char* p, std::size_t n) noexcept {
+        total_ += n;
+        if (buffered_ + n < sizeof(buf_)) {
+            std::memcpy(buf_ + buffered_, p, n);
+            buffered_ += n;
+            return;
+        }
+        if (buffered_ != 0) {
+            const std::size_t fill = sizeof(buf_) - buffered_;
+            std::memcpy(buf_ + buffered_, p, fill);
+            stripe(buf_);
+            p += fill;
+            n -= fill;
+            buffered_ = 0;
+        }
+        for (; n >= sizeof(buf_); p += sizeof(buf_), n -= sizeof(buf_)) stripe(p);
+        std::memcpy(buf_, p, n);
+        buffered_ = n;
+    }
+
+    std::uint64_t digest() const noexcept {
+        std::uint64_t h = total_ >= sizeof(buf_) ? converge() : kP5;
+        h += total_;
+        const unsigned char* p = buf_;
+        std::size_t n = buffered_;
+        for (; n >= 8; p += 8, n -= 8) {
+            h ^= round(0, read64(p));
+            h = std::rotl(h, 27) * kP1 + kP4;
+        }
+        if (n >= 4) {
+            h ^= read32(p) * kP1;
+            h = std::rotl(h, 23) * kP2 + kP3;
+            p += 4;
+            n -= 4;
+        }
+        for (; n > 0; ++p, --n) {
+            h ^= *p * kP5;
+            h = std::rotl(h, 11) * kP1;
+        }
+        h ^= h >> 33;
+        h *= kP2;
+        h ^= h >> 29;
+        h *= kP3;
+        h ^= h >> 32;
+        return h;
+    }
+
+ private:
+    static constexpr std::uint64_t kP1 = 0x9E3779B185EBCA87ULL;
+    static constexpr std::uint64_t kP2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr std::uint64_t kP3 = 0x165667B19E3779F9ULL;
+    static constexpr std::uint64_t kP4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr std::uint64_t kP5 = 0x27D4EB2F165667C5ULL;
+
+    static std::uint64_t read64(const unsigned char* p) noexcept {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) v = __builtin_bswap64(v);
+        return v;
+    }
+
+    static std::uint64_t read32(const unsigned char* p) noexcept {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) v = __builtin_bswap32(v);
+        return v;
+    }
+
+    static std::uint64_t round(std::uint64_t acc, std::uint64_t lane) noexcept {
+        return std::rotl(acc + lane * kP2, 31) * kP1;
+    }
+
+    static std::uint64_t merge(std::uint64_t h, std::uint64_t lane) noexcept {
+        return (h ^ round(0, lane)) * kP1 + kP4;
+    }
+
+    void stripe(const unsigned char* p) noexcept {
+        for (int i = 0; i < 4; ++i) v_[i] = round(v_[i], read64(p + 8 * i));
+    }
+
+    std::uint64_t converge() const noexcept {
+        std::uint64_t h = std::rotl(v_[0], 1) + std::rotl(v_[1], 7)
+                        + std::rotl(v_[2], 12) + std::rotl(v_[3], 18);
+        for (const std::uint64_t lane : v_) h = merge(h, lane);
+        return h;
+    }
+
+    std::uint64_t v_[4] = {kP1 + kP2, kP2, 0, 0 - kP1};
+    unsigned char buf_[32];
+    std::size_t buffered_ = 0;
+    std::uint64_t total_ = 0;
+};
+
+void hash_bytes(xxh64* h, const void* data, std::size_t size) noexcept {
+    if (size != 0) h->update(static_cast<const unsigned char*>(data), size);
+}
+
+bool hashed_kind(body_kind kind) {
+    return kind == body_kind::string || kind == body_kind::iovec
+        || kind == body_kind::shared;
+}
+
+// Same methods as range_responder: a 304 answers GET and HEAD only.
+bool get_or_head(std::string_view method) {
+    return method == http::http_utils::http_method_get
+        || method == http::http_utils::http_method_head;
+}
+
+// The fields a 304 repeats from the 200 it stands for (RFC 9110 §15.4.5).
+constexpr std::string_view kNotModifiedFields[] = {
+    "Cache-Control", "ETag", "Expires", "Vary",
+};
+
+}  // namespace
+
+std::optional<std::string> etag_responder::body_etag(const http_response& resp) {
+    xxh64 h;
+    switch (resp.kind()) {
+        case body_kind::string: {
+            const std::string& s = static_cast<const string_response_body*>(resp.body_)->get_data();
+            hash_bytes(&h, s.data(), s.size());
+            break;
+        }
+        case body_kind::shared: {
+            const auto* b = static_cast<const shared_response_body*>(resp.body_);
+            hash_bytes(&h, b->data(), b->size());
+            break;
+        }
+        case body_kind::iovec:
+            for (const iovec_entry& e : static_cast<const iovec_response_body*>(resp.body_)->entries()) {
+                hash_bytes(&h, e.base, e.len);
+            }
+            break;
+        default:
+            return std::nullopt;
+    }
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "\"%016" PRIx64 "\"", h.digest());
+    return std::string(buf);
+}
+
+void etag_responder::apply(const http_request& req, http_response& resp) const noexcept {
+    if (!config_.generate_etags || !get_or_head(req.get_method())) return;
+    if (resp.kind() == body_kind::frozen) {
+        answer_frozen(req, resp);
+        return;
+    }
+    if (resp.get_status() != http::http_utils::http_ok || !hashed_kind(resp.kind())) return;
+    try {
+        // A handler-set ETag is kept and still answers If-None-Match.
+        std::string etag(resp.get_header("ETag"));
+        if (etag.empty()) {
+            etag = *body_etag(resp);
+            resp.with_header("ETag", etag);
+        }
+        const std::string_view inm = req.get_header("If-None-Match");
+        if (!inm.empty() && range_responder::etag_listed(inm, etag)) {
+            range_responder::respond_empty(resp, http::http_utils::http_not_modified);
+        }
+    } catch (...) {
+        // Out of memory while adding the header: the response still goes
+        // out, as the handler built it.
+    }
+}
+
+// A response_cache entry was frozen with its ETag (and encoding) by the
+// miss that stored it; a hit only needs its If-None-Match answered. The
+// 304 loses the frozen headers with the body, so the validator fields are
+// carried over.
+void etag_responder::answer_frozen(const http_request& req, http_response& resp) noexcept {
+    try {
+        const http_response& source =
+            static_cast<const frozen_response_body*>(resp.body_)->state().source;
+        const std::string_view etag = source.get_header("ETag");
+        const std::string_view inm = req.get_header("If-None-Match");
+        if (source.get_status() != http::http_utils::http_ok || etag.empty() || inm.empty()
+                || !range_responder::etag_listed(inm, etag)) {
+            return;
+        }
+        http_response not_modified = http_response::empty();
+        not_modified.with_status(http::http_utils::http_not_modified);
+        for (const std::string_view name : kNotModifiedFields) {
+            const std::string_view value = source.get_header(name);
+            if (!value.empty()) not_modified.with_header(std::string(name), std::string(value));
+        }
+        resp = std::move(not_modified);
+    } catch (...) {
+        // Out of memory while copying the fields: the cached 200 goes out.
+    }
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -0,0 +1,95 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/file_descriptor_cache.hpp"
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "httpserver/detail/response_body.hpp"
+
+namespace httpserver {
+namespace detail {
+
+file_descriptor_cache::~file_descriptor_cache() {
+    for (const entry& e : list_) ::close(e.fd);
+}
+
+int file_descriptor_cache::open(const std::string& path, std::size_t* size) noexcept {
+    if (max_entries_ == 0) return file_response_body::open_regular(path, size);
+    const int cached = dup_cached(path, size);
+    if (cached != -1) return cached;
+    const int fd = file_response_body::open_regular(path, size);
+    if (fd != -1) insert(path, fd, *size);
+    return fd;
+}
+
+std::size_t file_descriptor_cache::entries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return list_.size();
+}
+
+int file_descriptor_cache::dup_cached(const std::string& path, std::size_t* size) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(path);
+    if (it == map_.end()) return -1;
+    if (clock::now() >= it->second->expires) {
+        erase(it);
+        return -1;
+    }
+    // dup() under the lock: an eviction on another thread cannot close
+    // the entry's fd between the lookup and the dup.
+    const int fd = ::dup(it->second->fd);
+    if (fd == -1) return -1;
+    list_.splice(list_.begin(), list_, it->second);
+    *size = it->second->size;
+    return fd;
+}
+
+void file_descriptor_cache::insert(const std::string& path, int fd, std::size_t size) noexcept {
+    const int kept = ::dup(fd);
+    if (kept == -1) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Two threads that missed on the same path both insert; the later
+    // open wins.
+    auto it = map_.find(path);
+    if (it != map_.end()) erase(it);
+    while (list_.size() >= max_entries_) erase(map_.find(list_.back().path));
+    try {
+        list_.push_front(entry{path, kept, size, clock::now() + ttl_});
+        map_.emplace(list_.front().path, list_.begin());
+    } catch (...) {
+        // Out of memory building the entry: this open goes uncached.
+        if (!list_.empty() && list_.front().fd == kept) list_.pop_front();
+        ::close(kept);
+    }
+}
+
+void file_descriptor_cache::erase(map_t::iterator it) noexcept {
+    ::close(it->second->fd);
+    list_.erase(it->second);
+    map_.erase(it);
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -0,0 +1,405 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/form_parser.hpp"
+
+#include <microhttpd.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "httpserver/http_utils.hpp"
+
+namespace httpserver {
+
+using httpserver::http::http_utils;
+
+namespace detail {
+
+namespace {
+
+// RFC 2046 §5.1.1: a boundary is 1..70 characters.
+constexpr std::size_t max_boundary_length = 70;
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size()
+        && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool istarts_with(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size()
+        && strncasecmp(s.data(), prefix.data(), prefix.size()) == 0;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Value of parameter @p name in a `type; a=b; name="v"` header value,
+// quotes stripped (no backslash-unescaping, matching MHD's post processor).
+std::optional<std::string_view> header_param(std::string_view header,
+                                             std::string_view name) {
+    std::size_t semi = header.find(';');
+    while (semi != std::string_view::npos) {
+        std::string_view rest = header.substr(semi + 1);
+        const std::size_t eq = rest.find('=');
+        if (eq == std::string_view::npos) break;
+        const std::string_view param = trim(rest.substr(0, eq));
+        rest = trim(rest.substr(eq + 1));
+        std::string_view value;
+        if (!rest.empty() && rest.front() == '"') {
+            const std::size_t close = rest.find('"', 1);
+            value = rest.substr(1, close == std::string_view::npos
+                                       ? std::string_view::npos : close - 1);
+            header = (close == std::string_view::npos) ? std::string_view{}
+                                                       : rest.substr(close + 1);
+        } else {
+            const std::size_t next = rest.find(';');
+            value = trim(rest.substr(0, next));
+            header = (next == std::string_view::npos) ? std::string_view{}
+                                                      : rest.substr(next);
+        }
+        if (iequals(param, name)) return value;
+        semi = header.find(';');
+    }
+    return std::nullopt;
+}
+
+// Offset of the longest suffix of @p buf that is a proper prefix of
+// @p delim (buf.size() when there is none).
+std::size_t partial_match_start(std::string_view buf, std::string_view delim) {
+    for (std::size_t i = 0; i < buf.size(); ++i) {
+        const std::size_t n = buf.size() - i;
+        if (n < delim.size() && buf.compare(i, n, delim.substr(0, n)) == 0) return i;
+    }
+    return buf.size();
+}
+
+// Bytes of @p next up to and including the blank line that closes a part
+// header block, given the @p held header bytes from earlier chunks; npos
+// when the block is still open.
+std::size_t header_block_end(std::string_view held, std::string_view next) {
+    // A blank line straight after the delimiter line: no part headers.
+    if (held.size() < 2 && next.size() >= 2 - held.size()
+            && std::string(held).append(next.substr(0, 2 - held.size())) == "\r\n") {
+        return 2 - held.size();
+    }
+    // The blank line may straddle the previous chunk and this one.
+    if (!held.empty()) {
+        const std::size_t keep = std::min<std::size_t>(held.size(), 3);
+        std::string seam(held.substr(held.size() - keep));
+        seam.append(next.substr(0, 3));
+        const std::size_t at = seam.find("\r\n\r\n");
+        if (at != std::string::npos) return at + 4 - keep;
+    }
+    const std::size_t at = next.find("\r\n\r\n");
+    return (at == std::string_view::npos) ? at : at + 4;
+}
+
+}  // namespace
+
+std::unique_ptr<form_parser> form_parser::create(const char* content_type,
+                                                 field_iterator it, void* cls) {
+    if (content_type == nullptr) return nullptr;
+    const std::string_view type(content_type);
+    if (istarts_with(type, http_utils::http_post_encoding_form_urlencoded)) {
+        return std::unique_ptr<form_parser>(
+            new form_parser(encoding::urlencoded, {}, it, cls));
+    }
+    if (!istarts_with(type, http_utils::http_post_encoding_multipart_formdata)) {
+        return nullptr;
+    }
+    const auto boundary = header_param(type, "boundary");
+    if (!boundary || boundary->empty() || boundary->size() > max_boundary_length) {
+        return nullptr;
+    }
+    return std::unique_ptr<form_parser>(
+        new form_parser(encoding::multipart, *boundary, it, cls));
+}
+
+form_parser::form_parser(encoding enc, std::string_view boundary,
+                         field_iterator it, void* cls)
+    : it_(it), cls_(cls), encoding_(enc),
+      state_(enc == encoding::urlencoded ? state::url_key : state::preamble) {
+    if (encoding_ == encoding::multipart) {
+        delimiter_.reserve(4 + boundary.size());
+        delimiter_.append("\r\n--").append(boundary);
+        carry_.assign("\r\n");
+    }
+}
+
+bool form_parser::feed(const char* data, std::size_t size) {
+    // Every sub-parser consumes at least one byte or sets failed_, so the
+    // loop always terminates.
+    while (!failed_ && size > 0) {
+        const std::size_t used = (encoding_ == encoding::urlencoded)
+            ? feed_urlencoded(data, size)
+            : feed_multipart(data, size);
+        data += used;
+        size -= used;
+    }
+    return !failed_;
+}
+
+bool form_parser::finish() {
+    if (failed_) return false;
+    if (encoding_ == encoding::urlencoded && !key_.empty()) {
+        end_field();
+        key_.clear();
+        state_ = state::url_key;
+    }
+    return !failed_;
+}
+
+bool form_parser::emit(const char* data, std::size_t size) {
+    if (key_.empty()) return true;
+    emitted_ = true;
+    const MHD_Result r = it_(cls_, MHD_POSTDATA_KIND, key_.c_str(),
+        has_filename_ ? filename_.c_str() : nullptr,
+        has_content_type_ ? content_type_.c_str() : nullptr,
+        has_transfer_encoding_ ? transfer_encoding_.c_str() : nullptr,
+        data, off_, size);
+    off_ += size;
+    if (r != MHD_YES) failed_ = true;
+    return !failed_;
+}
+
+bool form_parser::emit_urlencoded_value(const char* data, std::size_t size) {
+    // '+' means ' ' in a form value (MHD_unescape_plus); only a value that
+    // actually contains one pays for the rewrite copy.
+    if (std::memchr(data, '+', size) == nullptr) return emit(data, size);
+    scratch_.assign(data, size);
+    std::replace(scratch_.begin(), scratch_.end(), '+', ' ');
+    return emit(scratch_.data(), scratch_.size());
+}
+
+bool form_parser::end_field() {
+    const bool ok = emitted_ ? !failed_ : emit("", 0);
+    off_ = 0;
+    emitted_ = false;
+    return ok;
+}
+
+std::size_t form_parser::feed_urlencoded(const char* data, std::size_t size) {
+    return (state_ == state::url_value) ? feed_url_value(data, size)
+                                        : feed_url_key(data, size);
+}
+
+std::size_t form_parser::feed_url_key(const char* data, std::size_t size) {
+    std::size_t i = 0;
+    while (i < size && data[i] != '=' && data[i] != '&') ++i;
+    if (key_.size() + i > max_buffered_bytes) {
+        failed_ = true;
+        return size;
+    }
+    const std::size_t key_start = key_.size();
+    key_.append(data, i);
+    std::replace(key_.begin() + static_cast<std::ptrdiff_t>(key_start), key_.end(), '+', ' ');
+    if (i == size) return size;
+    if (data[i] == '=') {
+        off_ = 0;
+        emitted_ = false;
+        state_ = state::url_value;
+    } else {
+        // "key&": a bare key registers with an empty value.
+        end_field();
+        key_.clear();
+    }
+    return i + 1;
+}
+
+std::size_t form_parser::feed_url_value(const char* data, std::size_t size) {
+    const char* amp = static_cast<const char*>(std::memchr(data, '&', size));
+    const std::size_t len = (amp == nullptr) ? size : static_cast<std::size_t>(amp - data);
+    if (len > 0 && !emit_urlencoded_value(data, len)) return size;
+    if (amp == nullptr) return size;
+    end_field();
+    key_.clear();
+    state_ = state::url_key;
+    return len + 1;
+}
+
+std::size_t form_parser::feed_multipart(const char* data, std::size_t size) {
+    switch (state_) {
+        case state::preamble:
+        case state::part_body:
+            return scan_for_delimiter(data, size);
+        case state::after_delimiter:
+            return consume_after_delimiter(data, size);
+        case state::part_headers:
+            return consume_part_headers(data, size);
+        default:
+            // epilogue (and the unreachable urlencoded states): discard.
+            return size;
+    }
+}
+
+bool form_parser::deliver(const char* data, std::size_t size) {
+    // Preamble bytes are discarded; only a part body reaches the iterator.
+    return state_ != state::part_body || size == 0 || emit(data, size);
+}
+
+void form_parser::on_delimiter() {
+    if (state_ == state::part_body) end_field();
+    carry_.clear();
+    state_ = state::after_delimiter;
+}
+
+std::size_t form_parser::resolve_carry(const char* data, std::size_t size) {
+    // carry_ holds a proper prefix of the delimiter from the previous
+    // chunk, so either the delimiter completes within the next
+    // delimiter_.size() bytes or the held bytes are plain data.
+    const std::size_t held = carry_.size();
+    const std::size_t take = std::min(size, delimiter_.size());
+    carry_.append(data, take);
+    const std::size_t at = carry_.find(delimiter_);
+    if (at != std::string::npos) {
+        if (deliver(carry_.data(), at)) on_delimiter();
+        return at + delimiter_.size() - held;
+    }
+    if (take == size) {
+        // The whole chunk fit: keep only the suffix that could still open
+        // a delimiter and pass the rest on.
+        const std::size_t keep_from = partial_match_start(carry_, delimiter_);
+        if (deliver(carry_.data(), keep_from)) carry_.erase(0, keep_from);
+        return size;
+    }
+    deliver(carry_.data(), held);
+    carry_.clear();
+    return std::string::npos;
+}
+
+std::size_t form_parser::scan_for_delimiter(const char* data, std::size_t size) {
+    if (!carry_.empty()) {
+        const std::size_t used = resolve_carry(data, size);
+        if (used != std::string::npos || failed_) return failed_ ? size : used;
+    }
+
+    // memchr to each CR, then compare the full delimiter. A trailing
+    // partial match is held back in carry_ for the next chunk; everything
+    // before it is handed out as a view into @p data.
+    const std::string_view delim(delimiter_);
+    const char* end = data + size;
+    const char* cur = data;
+    while (const char* cr = static_cast<const char*>(
+               std::memchr(cur, '\r', static_cast<std::size_t>(end - cur)))) {
+        const std::size_t avail = static_cast<std::size_t>(end - cr);
+        const std::size_t n = std::min(avail, delim.size());
+        if (std::memcmp(cr, delim.data(), n) != 0) {
+            cur = cr + 1;
+            continue;
+        }
+        if (!deliver(data, static_cast<std::size_t>(cr - data))) return size;
+        if (n < delim.size()) {
+            carry_.assign(cr, avail);
+            return size;
+        }
+        on_delimiter();
+        return static_cast<std::size_t>(cr - data) + delim.size();
+    }
+    deliver(data, size);
+    return size;
+}
+
+std::size_t form_parser::consume_after_delimiter(const char* data, std::size_t size) {
+    // After "--boundary": "--" closes the body, CRLF opens the next part.
+    // Transport padding (RFC 2046 LWSP) before the CRLF is skipped.
+    for (std::size_t i = 0; i < size; ++i) {
+        const char c = data[i];
+        if (!carry_.empty()) {
+            const char want = (carry_[0] == '-') ? '-' : '\n';
+            if (c != want) {
+                failed_ = true;
+                return size;
+            }
+            state_ = (want == '-') ? state::epilogue : state::part_headers;
+            carry_.clear();
+            return i + 1;
+        }
+        if (c == '-' || c == '\r') {
+            carry_.assign(1, c);
+        } else if (c != ' ' && c != '\t') {
+            failed_ = true;
+            return size;
+        }
+    }
+    return size;
+}
+
+std::size_t form_parser::consume_part_headers(const char* data, std::size_t size) {
+    const std::size_t held = carry_.size();
+    const std::size_t used = header_block_end(carry_, std::string_view(data, size));
+    const std::size_t take = (used == std::string_view::npos) ? size : used;
+    if (held + take > max_buffered_bytes) {
+        failed_ = true;
+        return size;
+    }
+    carry_.append(data, take);
+    if (used == std::string_view::npos) return size;
+
+    parse_part_headers(carry_);
+    carry_.clear();
+    off_ = 0;
+    emitted_ = false;
+    state_ = state::part_body;
+    return used;
+}
+
+void form_parser::parse_part_headers(std::string_view block) {
+    key_.clear();
+    filename_.clear();
+    content_type_.clear();
+    transfer_encoding_.clear();
+    has_filename_ = has_content_type_ = has_transfer_encoding_ = false;
+
+    while (!block.empty()) {
+        const std::size_t eol = block.find("\r\n");
+        const std::string_view line = block.substr(0, eol);
+        block = (eol == std::string_view::npos) ? std::string_view{}
+                                                : block.substr(eol + 2);
+        const std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        const std::string_view name = trim(line.substr(0, colon));
+        const std::string_view value = trim(line.substr(colon + 1));
+        if (iequals(name, "Content-Disposition")) {
+            if (auto n = header_param(value, "name")) key_.assign(*n);
+            if (auto f = header_param(value, "filename")) {
+                filename_.assign(*f);
+                has_filename_ = true;
+            }
+        } else if (iequals(name, http_utils::http_header_content_type)) {
+            content_type_.assign(value);
+            has_content_type_ = true;
+        } else if (iequals(name, "Content-Transfer-Encoding")) {
+            transfer_encoding_.assign(value);
+            has_transfer_encoding_ = true;
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -0,0 +1,127 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/http_date.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+constexpr const char* kDayNames[7] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+};
+constexpr const char* kMonthNames[12] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+// The IMF-fixdate layout: '0' is any digit, 'a' any letter position
+// (checked separately), everything else literal.
+constexpr std::string_view kFixdateShape = "aaa, 00 aaa 0000 00:00:00 GMT";
+
+bool has_fixdate_shape(std::string_view s) {
+    if (s.size() != kFixdateShape.size()) return false;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const char want = kFixdateShape[i];
+        if (want == '0' ? (s[i] < '0' || s[i] > '9') : (want != 'a' && s[i] != want)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// @p n decimal digits of @p s starting at @p at (already shape-checked).
+int digits(std::string_view s, std::size_t at, std::size_t n) {
+    int v = 0;
+    for (std::size_t i = at; i < at + n; ++i) v = v * 10 + (s[i] - '0');
+    return v;
+}
+
+int month_index(std::string_view name) {
+    for (int m = 0; m < 12; ++m) {
+        if (name == kMonthNames[m]) return m;
+    }
+    return -1;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (month 1-12);
+// H. Hinnant's days_from_civil, which needs no timegm().
+std::int64_t days_from_civil(std::int64_t y, int m, int d) {
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const std::int64_t yoe = y - era * 400;
+    const std::int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+}  // namespace
+
+std::string format_imf_fixdate(std::int64_t epoch_seconds) {
+    const std::time_t t = static_cast<std::time_t>(epoch_seconds);
+    std::tm tm{};
+#if defined(_WIN32)
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+
+    // tm_wday: 0..6 (Sunday=0); tm_mon: 0..11; tm_year: years since 1900
+    const int wday  = (tm.tm_wday >= 0 && tm.tm_wday < 7) ? tm.tm_wday : 0;
+    const int mon   = (tm.tm_mon  >= 0 && tm.tm_mon  < 12) ? tm.tm_mon : 0;
+    const int year  = tm.tm_year + 1900;
+
+    char buf[40];
+    std::snprintf(buf, sizeof(buf),
+                  "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                  kDayNames[wday],
+                  tm.tm_mday,
+                  kMonthNames[mon],
+                  year,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return std::string(buf);
+}
+
+// "Sun, 06 Nov 1994 08:49:37 GMT": fixed width, so every field is read
+// at its offset. The day name is not checked against the date.
+std::optional<std::int64_t> parse_imf_fixdate(std::string_view date) noexcept {
+    if (!has_fixdate_shape(date)) return std::nullopt;
+    const int day = digits(date, 5, 2);
+    const int month = month_index(date.substr(8, 3));
+    const int hour = digits(date, 17, 2);
+    const int minute = digits(date, 20, 2);
+    const int second = digits(date, 23, 2);
+    if (month < 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return std::nullopt;
+    }
+    return days_from_civil(digits(date, 12, 4), month + 1, day) * 86400
+        + hour * 3600 + minute * 60 + second;
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -332,6 +332,10 @@ void http_request_impl::set_args(const std::map<std::string, std::string>& args,
 }
 
 void http_request_impl::grow_last_arg(const std::string& key, const std::string& value) {
+    grow_last_arg(std::string_view(key), std::string_view(value));
+}
+
+void http_request_impl::grow_last_arg(std::string_view key, std::string_view value) {
     // Invalidation rule: see args_view_cache_built_ in http_request_impl.hpp.
     args_view_cache_built_ = false;
     auto& vec = find_or_insert_arg(unescaped_args, key);
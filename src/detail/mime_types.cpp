@@ -0,0 +1,109 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/mime_types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+using namespace std::string_view_literals;
+
+struct mime_entry {
+    std::string_view extension;
+    http::static_text type;
+};
+
+// Sorted by extension (lower case) for the binary search below; the
+// static_assert keeps additions in order.
+constexpr std::array kMimeTypes = {
+    mime_entry{"7z"sv, "application/x-7z-compressed"sv},
+    mime_entry{"avif"sv, "image/avif"sv},
+    mime_entry{"bmp"sv, "image/bmp"sv},
+    mime_entry{"css"sv, "text/css"sv},
+    mime_entry{"csv"sv, "text/csv"sv},
+    mime_entry{"gif"sv, "image/gif"sv},
+    mime_entry{"gz"sv, "application/gzip"sv},
+    mime_entry{"htm"sv, "text/html"sv},
+    mime_entry{"html"sv, "text/html"sv},
+    mime_entry{"ico"sv, "image/x-icon"sv},
+    mime_entry{"jpeg"sv, "image/jpeg"sv},
+    mime_entry{"jpg"sv, "image/jpeg"sv},
+    mime_entry{"js"sv, "application/javascript"sv},
+    mime_entry{"json"sv, "application/json"sv},
+    mime_entry{"map"sv, "application/json"sv},
+    mime_entry{"md"sv, "text/markdown"sv},
+    mime_entry{"mjs"sv, "application/javascript"sv},
+    mime_entry{"mp3"sv, "audio/mpeg"sv},
+    mime_entry{"mp4"sv, "video/mp4"sv},
+    mime_entry{"ogg"sv, "audio/ogg"sv},
+    mime_entry{"otf"sv, "font/otf"sv},
+    mime_entry{"pdf"sv, "application/pdf"sv},
+    mime_entry{"png"sv, "image/png"sv},
+    mime_entry{"svg"sv, "image/svg+xml"sv},
+    mime_entry{"tar"sv, "application/x-tar"sv},
+    mime_entry{"ttf"sv, "font/ttf"sv},
+    mime_entry{"txt"sv, "text/plain"sv},
+    mime_entry{"wasm"sv, "application/wasm"sv},
+    mime_entry{"wav"sv, "audio/wav"sv},
+    mime_entry{"webm"sv, "video/webm"sv},
+    mime_entry{"webmanifest"sv, "application/manifest+json"sv},
+    mime_entry{"webp"sv, "image/webp"sv},
+    mime_entry{"woff"sv, "font/woff"sv},
+    mime_entry{"woff2"sv, "font/woff2"sv},
+    mime_entry{"xml"sv, "application/xml"sv},
+    mime_entry{"zip"sv, "application/zip"sv},
+};
+
+static_assert(std::is_sorted(kMimeTypes.begin(), kMimeTypes.end(),
+                             [](const mime_entry& a, const mime_entry& b) {
+                                 return a.extension < b.extension;
+                             }),
+              "kMimeTypes must stay sorted by extension");
+
+// Longer than any extension in the table.
+constexpr std::size_t kMaxExtension = 16;
+
+}  // namespace
+
+http::static_text mime_type_for(std::string_view path) noexcept {
+    const std::size_t dot = path.find_last_of("./");
+    if (dot == std::string_view::npos || path[dot] != '.') return "application/octet-stream"sv;
+    const std::string_view ext = path.substr(dot + 1);
+    if (ext.empty() || ext.size() > kMaxExtension) return "application/octet-stream"sv;
+    char lower[kMaxExtension];
+    std::transform(ext.begin(), ext.end(), lower, [](char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    });
+    const std::string_view key(lower, ext.size());
+    const auto it = std::lower_bound(kMimeTypes.begin(), kMimeTypes.end(), key,
+        [](const mime_entry& e, std::string_view k) { return e.extension < k; });
+    if (it == kMimeTypes.end() || it->extension != key) return "application/octet-stream"sv;
+    return it->type;
+}
+
+}  // namespace detail
+}  // namespace httpserver
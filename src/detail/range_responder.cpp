@@ -0,0 +1,323 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/range_responder.hpp"
+
+#include <microhttpd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "httpserver/create_webserver.hpp"
+#include "httpserver/http_request.hpp"
+#include "httpserver/http_response.hpp"
+#include "httpserver/http_utils.hpp"
+#include "httpserver/detail/http_date.hpp"
+#include "httpserver/detail/response_body.hpp"
+
+namespace httpserver {
+namespace detail {
+
+using namespace std::string_view_literals;
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// A whole decimal number; nullopt when empty, not all digits, or too big.
+std::optional<std::uint64_t> to_u64(std::string_view s) {
+    std::uint64_t v = 0;
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (s.empty() || ec != std::errc{} || end != s.data() + s.size()) return std::nullopt;
+    return v;
+}
+
+// One byte-range-spec ("a-b", "a-" or "-n") against a @p size byte file.
+// False when malformed; otherwise *sat says whether it selects anything,
+// and *out what.
+bool parse_spec(std::string_view spec, std::uint64_t size,
+                range_responder::byte_range* out, bool* sat) {
+    const std::size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) return false;
+    const std::string_view a = trim(spec.substr(0, dash));
+    const std::string_view b = trim(spec.substr(dash + 1));
+    if (a.empty()) {
+        const auto n = to_u64(b);
+        if (!n) return false;
+        *sat = *n > 0 && size > 0;
+        *out = {size - std::min(*n, size), size - 1};
+        return true;
+    }
+    const auto first = to_u64(a);
+    const auto last = b.empty() ? std::optional<std::uint64_t>(UINT64_MAX) : to_u64(b);
+    if (!first || !last || *last < *first) return false;
+    *sat = *first < size;
+    *out = {*first, std::min(*last, size - 1)};
+    return true;
+}
+
+// Whether a conditional request's validators say the client's copy is
+// current (RFC 9110 §13.2.2: If-None-Match wins over If-Modified-Since).
+bool not_modified(const http_request& req, std::string_view etag, std::int64_t modified) {
+    const std::string_view inm = req.get_header("If-None-Match");
+    if (!inm.empty()) return range_responder::etag_listed(inm, etag);
+    const auto since = parse_imf_fixdate(req.get_header("If-Modified-Since"));
+    return since && modified <= *since;
+}
+
+// If-Range (RFC 9110 §13.1.5): the range applies only if the validator
+// still matches, strongly -- a weak or absent ETag never does.
+bool if_range_holds(std::string_view if_range, std::string_view etag, std::int64_t modified) {
+    if (if_range.empty()) return true;
+    if (if_range.front() == '"') return if_range == etag;
+    if (if_range.substr(0, 2) == "W/") return false;
+    const auto date = parse_imf_fixdate(if_range);
+    return date && *date == modified;
+}
+
+// Ranges and preconditions are defined for GET; HEAD gets the same
+// headers (and 304s) without a body.
+bool get_or_head(std::string_view method) {
+    return method == http::http_utils::http_method_get
+        || method == http::http_utils::http_method_head;
+}
+
+std::string content_range(const range_responder::byte_range& r, std::uint64_t size) {
+    char buf[80];
+    std::snprintf(buf, sizeof(buf), "bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64,
+                  r.first, r.last, size);
+    return buf;
+}
+
+// Validators for the file behind @p fd, unless the handler set its own;
+// fstat() only runs when one is missing. Returns the Last-Modified time in
+// seconds, or nullopt (nothing added) when fstat() fails.
+std::optional<std::int64_t> add_validators(http_response& resp, int fd) {
+    const bool has_etag = !resp.get_header("ETag").empty();
+    const auto set = parse_imf_fixdate(resp.get_header("Last-Modified"));
+    struct stat sb{};
+    if ((!has_etag || !set) && ::fstat(fd, &sb) != 0) return std::nullopt;
+    resp.with_header("Accept-Ranges"sv, "bytes"sv);
+    if (!has_etag) {
+        resp.with_header("ETag", range_responder::file_etag(
+            file_mtime_ns(sb), static_cast<std::uint64_t>(sb.st_size)));
+    }
+    if (set) return *set;
+    resp.with_header("Last-Modified", format_imf_fixdate(sb.st_mtime));
+    return sb.st_mtime;
+}
+
+// The multipart/byteranges body: part headers interleaved with ranges of
+// the file, read with pread() from the original body's fd.
+struct byteranges_stream {
+    struct part {
+        std::string head;
+        std::uint64_t offset = 0;
+        std::uint64_t length = 0;
+    };
+
+    static ssize_t copy(std::string_view text, std::uint64_t pos, char* buf, std::size_t max) {
+        const std::size_t n = std::min<std::size_t>(max, text.size() - pos);
+        text.copy(buf, n, pos);
+        return static_cast<ssize_t>(n);
+    }
+
+    ssize_t read_at(std::uint64_t offset, std::size_t n, char* buf) const {
+        ssize_t got;
+        do {
+            got = ::pread(fd, buf, n, static_cast<off_t>(offset));
+        } while (got < 0 && errno == EINTR);
+        // A file that shrank under us cannot produce the promised bytes.
+        return got > 0 ? got : MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+
+    ssize_t produce(std::uint64_t pos, char* buf, std::size_t max) const {
+        for (const part& p : parts) {
+            if (pos < p.head.size()) return copy(p.head, pos, buf, max);
+            pos -= p.head.size();
+            if (pos < p.length) {
+                return read_at(p.offset + pos, std::min<std::uint64_t>(max, p.length - pos), buf);
+            }
+            pos -= p.length;
+        }
+        if (pos < tail.size()) return copy(tail, pos, buf, max);
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    http_response source;   // keeps the fd open
+    int fd = -1;
+    std::vector<part> parts;
+    std::string tail;
+};
+
+// nginx-style boundary: a process-wide counter, which cannot collide
+// with itself and is vanishingly unlikely to occur in a file.
+std::string next_boundary() {
+    static std::atomic<std::uint64_t> counter{0};
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%020" PRIu64, counter.fetch_add(1) + 1);
+    return buf;
+}
+
+}  // namespace
+
+std::optional<std::vector<range_responder::byte_range>> range_responder::parse_range(
+        std::string_view value, std::uint64_t size) {
+    value = trim(value);
+    if (value.size() < 6 || value.substr(0, 6) != "bytes=") return std::nullopt;
+    value.remove_prefix(6);
+    std::vector<byte_range> ranges;
+    std::uint64_t total = 0;
+    std::size_t specs = 0;
+    while (!value.empty()) {
+        const std::size_t comma = value.find(',');
+        const std::string_view spec = trim(value.substr(0, comma));
+        value.remove_prefix(comma == std::string_view::npos ? value.size() : comma + 1);
+        if (spec.empty()) continue;
+        byte_range r;
+        bool sat = false;
+        if (++specs > max_ranges || !parse_spec(spec, size, &r, &sat)) return std::nullopt;
+        if (!sat) continue;
+        total += r.last - r.first + 1;
+        ranges.push_back(r);
+    }
+    if (specs == 0 || total > size) return std::nullopt;
+    return ranges;
+}
+
+void range_responder::apply(const http_request& req, http_response& resp) const noexcept {
+    if (!config_.file_range_requests || resp.kind() != body_kind::file
+            || resp.get_status() != http::http_utils::http_ok) {
+        return;
+    }
+    const std::string_view method = req.get_method();
+    if (!get_or_head(method)) return;
+    const int fd = static_cast<file_response_body*>(resp.body_)->ensure_open();
+    if (fd == -1) return;
+    try {
+        const auto modified = add_validators(resp, fd);
+        if (!modified) return;
+        if (not_modified(req, resp.get_header("ETag"), *modified)) {
+            respond_empty(resp, http::http_utils::http_not_modified);
+        } else if (method == http::http_utils::http_method_get) {
+            serve_range(req, resp, *modified);
+        }
+    } catch (...) {
+        // Out of memory while adding headers or building the multipart
+        // body: the response still goes out, as the handler built it.
+    }
+}
+
+std::string range_responder::file_etag(std::int64_t mtime_ns, std::uint64_t size) {
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "\"%" PRIx64 "-%" PRIx64 "\"",
+                  static_cast<std::uint64_t>(mtime_ns), size);
+    return buf;
+}
+
+// If-None-Match: "*" or a list of entity-tags, compared weakly (the
+// opaque quoted part only, so W/ on either side does not matter).
+bool range_responder::etag_listed(std::string_view list, std::string_view etag) {
+    if (trim(list) == "*") return true;
+    const std::size_t q = etag.find('"');
+    if (q == std::string_view::npos) return false;
+    const std::string_view mine = etag.substr(q);
+    for (std::size_t open = list.find('"'); open != std::string_view::npos;
+            open = list.find('"', open)) {
+        const std::size_t close = list.find('"', open + 1);
+        if (close == std::string_view::npos) return false;
+        if (list.substr(open, close - open + 1) == mine) return true;
+        open = close + 1;
+    }
+    return false;
+}
+
+void range_responder::respond_empty(http_response& resp, int status) {
+    http_response donor = http_response::empty();
+    resp.replace_body(donor);
+    resp.with_status(status);
+}
+
+void range_responder::serve_range(const http_request& req, http_response& resp,
+                                  std::int64_t modified) {
+    const std::string_view range = req.get_header("Range");
+    if (range.empty()
+            || !if_range_holds(req.get_header("If-Range"), resp.get_header("ETag"), modified)) {
+        return;
+    }
+    auto* body = static_cast<file_response_body*>(resp.body_);
+    const std::uint64_t size = body->size();
+    const auto ranges = parse_range(range, size);
+    if (!ranges) return;
+    if (ranges->empty()) {
+        respond_empty(resp, http::http_utils::http_requested_range_not_satisfiable);
+        resp.with_header("Content-Range", "bytes */" + std::to_string(size));
+        return;
+    }
+    if (ranges->size() == 1) {
+        const byte_range& r = ranges->front();
+        body->select_range(r.first, static_cast<std::size_t>(r.last - r.first + 1));
+        resp.with_header("Content-Range", content_range(r, size));
+    } else {
+        serve_multipart(*ranges, size, resp);
+    }
+    resp.with_status(http::http_utils::http_partial_content);
+}
+
+void range_responder::serve_multipart(const std::vector<byte_range>& ranges,
+                                      std::uint64_t size, http_response& resp) {
+    auto st = std::make_shared<byteranges_stream>();
+    const std::string boundary = next_boundary();
+    const std::string type(resp.get_header("Content-Type"));
+    for (const byte_range& r : ranges) {
+        std::string head = "\r\n--" + boundary + "\r\n";
+        if (!type.empty()) head += "Content-Type: " + type + "\r\n";
+        head += "Content-Range: " + content_range(r, size) + "\r\n\r\n";
+        st->parts.push_back({std::move(head), r.first, r.last - r.first + 1});
+    }
+    st->tail = "\r\n--" + boundary + "--\r\n";
+    http_response donor = http_response::deferred(
+        [st](std::uint64_t pos, char* buf, std::size_t max) { return st->produce(pos, buf, max); });
+    st->source.replace_body(resp);
+    st->fd = static_cast<file_response_body*>(st->source.body_)->fd();
+    resp.replace_body(donor);
+    resp.with_header("Content-Type", "multipart/byteranges; boundary=" + boundary);
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -45,22 +45,20 @@
 #include "httpserver/http_request.hpp"
 #include "httpserver/http_resource.hpp"
 #include "httpserver/http_response.hpp"
-#include "httpserver/http_utils.hpp"
 #include "httpserver/detail/dispatch_util.hpp"
 #include "httpserver/detail/error_pages.hpp"
 #include "httpserver/detail/hook_dispatcher.hpp"
 #include "httpserver/detail/connection_context.hpp"
 #include "httpserver/detail/resource_hook_table.hpp"
+#include "httpserver/detail/response_cache.hpp"
 #include "httpserver/detail/response_materializer.hpp"
 #include "httpserver/detail/route_table.hpp"
+#include "httpserver/detail/single_flight.hpp"
 #ifdef HAVE_WEBSOCKET
 #include "httpserver/detail/websocket_upgrader.hpp"
 #endif  // HAVE_WEBSOCKET
 
 namespace httpserver {
-
-using httpserver::http::http_utils;
-
 namespace detail {
 
 bool request_dispatcher::resolve_resource_for_request(detail::connection_context* conn,
@@ -103,6 +101,20 @@ bool request_dispatcher::resolve_resource_for_request(detail::connection_context
     return true;
 }
 
+std::shared_ptr<http_resource> request_dispatcher::upload_target(
+        detail::connection_context* conn) {
+    route_table::lookup_result result =
+        routes_.lookup_v2(conn->method_enum, conn->standardized_url);
+    if (!result.found || result.entry.handler == nullptr
+            || !result.entry.handler->is_allowed(conn->method_enum)) {
+        return nullptr;
+    }
+    for (const auto& [name, value] : result.captured_params) {
+        conn->request->set_arg(name, value);
+    }
+    return result.entry.handler;
+}
+
 namespace {
 
 // Shared body of the two dispatch_resource_handler catch arms. Either
@@ -159,35 +171,17 @@ void handle_dispatch_exception(hook_dispatcher& hooks, error_pages& errors,
 
 }  // namespace
 
-void request_dispatcher::dispatch_resource_handler(detail::connection_context* conn,
+void request_dispatcher::invoke_handler(detail::connection_context* conn,
         const std::shared_ptr<http_resource>& hrm) {
     try {
-        if (conn->pp != nullptr) {
-            MHD_destroy_post_processor(conn->pp);
-            conn->pp = nullptr;
-        }
-        // before_handler fires from finalize_answer, so auth and
-        // method-not-allowed alias hooks run as part of the unified
-        // before_handler chain before this is called; the is_allowed check
-        // below is the default (no-hook) 405 fallback.
-        if (hrm->is_allowed(conn->method_enum)) {
-            // Pointer-to-member dispatch returns http_response by value; the
-            // prvalue is moved into the per-connection optional anchor.
-            conn->response.emplace(((*hrm).*(conn->callback))(*conn->request));
-            if (conn->response->get_status() == -1) {
-                // Handler returned the default-sentinel response. Route
-                // through the safe internal-error path.
-                conn->response.emplace(errors_.run_internal_error_handler_safely(
-                    conn, "handler returned null response"));
-            }
-            return;
-        }
-        // Method not allowed: emit the Allow header from the resource's
-        // lazily-cached value.
-        conn->response.emplace(errors_.method_not_allowed_page(conn));
-        const std::string& header_value = hrm->get_allow_header();
-        if (!header_value.empty()) {
-            conn->response->with_header(http_utils::http_header_allow, header_value);
+        // Pointer-to-member dispatch returns http_response by value; the
+        // prvalue is moved into the per-connection optional anchor.
+        conn->response.emplace(((*hrm).*(conn->callback))(*conn->request));
+        if (conn->response->get_status() == -1) {
+            // Handler returned the default-sentinel response. Route
+            // through the safe internal-error path.
+            conn->response.emplace(errors_.run_internal_error_handler_safely(
+                conn, "handler returned null response"));
         }
     } catch (const std::exception& e) {
         // Handler threw std::exception -> handler_exception chain (with the
@@ -208,6 +202,61 @@ void request_dispatcher::dispatch_resource_handler(detail::connection_context* c
     }
 }
 
+std::string request_dispatcher::flight_key(detail::connection_context* conn,
+        const std::shared_ptr<http_resource>& hrm) {
+    if (!flights_.enabled()) return {};
+    try {
+        return hrm->single_flight_key(*conn->request);
+    } catch (...) {
+        // A broken key function only costs the coalescing.
+        log_dispatch_error(config_, "dispatch: single_flight_key threw");
+        return {};
+    }
+}
+
+void request_dispatcher::follow(detail::connection_context* conn,
+        const std::shared_ptr<http_resource>& hrm) {
+    if (auto shared = single_flight::take(&conn->flight)) {
+        conn->response.emplace(*shared);
+    } else {
+        invoke_handler(conn, hrm);
+    }
+}
+
+bool request_dispatcher::dispatch_resource_handler(MHD_Connection* connection,
+        detail::connection_context* conn, const std::shared_ptr<http_resource>& hrm) {
+    if (conn->pp != nullptr) {
+        MHD_destroy_post_processor(conn->pp);
+        conn->pp = nullptr;
+    }
+    // before_handler fires from finalize_answer, so auth and
+    // method-not-allowed alias hooks run as part of the unified
+    // before_handler chain before this is called; the is_allowed check
+    // below is the default (no-hook) 405 fallback.
+    if (!hrm->is_allowed(conn->method_enum)) {
+        // Method not allowed: the page carries the resource's Allow header.
+        conn->response.emplace(errors_.method_not_allowed_page(conn, *hrm));
+        return false;
+    }
+    const std::string key = flight_key(conn, hrm);
+    if (key.empty()) {
+        invoke_handler(conn, hrm);
+        return false;
+    }
+    switch (flights_.join(hrm, key, connection, &conn->flight)) {
+        case single_flight::role::parked:
+            return true;
+        case single_flight::role::follow:
+            follow(conn, hrm);
+            return false;
+        case single_flight::role::lead:
+            break;
+    }
+    invoke_handler(conn, hrm);
+    flights_.land(&conn->flight, conn->response ? &*conn->response : nullptr);
+    return false;
+}
+
 namespace {
 
 void fire_route_resolved_gated(hook_dispatcher& hooks,
@@ -243,6 +292,46 @@ std::optional<MHD_Result> request_dispatcher::try_ws_upgrade(
 #endif  // HAVE_WEBSOCKET
 }
 
+std::optional<MHD_Result> request_dispatcher::try_cache_hit(
+        MHD_Connection* connection, detail::connection_context* conn,
+        http_resource* resource, std::string* key) {
+    if (!cache_.enabled() || !conn->request) return std::nullopt;
+    *key = cache_.key(*conn->request, conn->method_enum, conn->standardized_url);
+    if (key->empty()) return std::nullopt;
+    auto hit = cache_.find(*key, conn->standardized_url);
+    if (!hit) return std::nullopt;
+    // Queued as is: the route was resolved and the before_handler chain
+    // (auth included) let the request through; the handler and the
+    // after_handler hooks do not run. The entry already carries its ETag
+    // and encoding; etag_responder still answers If-None-Match for it.
+    conn->response.emplace(*hit);
+    return materializer_.materialize_and_queue_response(connection, conn, resource);
+}
+
+void request_dispatcher::store_in_cache(detail::connection_context* conn,
+                                        std::string key) {
+    if (key.empty() || !conn->response) return;
+    cache_.store(std::move(key), conn->standardized_url, *conn->response);
+}
+
+void request_dispatcher::note_resolved_resource(detail::connection_context* conn,
+        const std::shared_ptr<http_resource>& hrm) {
+    // Snapshot whether this resource carries a per-route hook table so
+    // fire_request_completed_gated (fires after this shared_ptr is gone)
+    // can gate its weak_ptr lock() on the common zero-per-route-hook path.
+    conn->route_has_hook_table_ = (hrm->hook_table_raw_() != nullptr);
+
+    // Only stamp the weak_ptr when a later out-of-scope consumer can use
+    // it (the MHD completion callback), i.e. iff this resource has a
+    // per-route hook table OR a server-wide request_completed hook is
+    // registered. Gating this drops 2 control-block atomics per matched
+    // request on the common zero-hook path.
+    if (conn->route_has_hook_table_ ||
+            hooks_.has_hooks_for(hook_phase::request_completed)) {
+        conn->resource_weak_ = hrm;
+    }
+}
+
 MHD_Result request_dispatcher::finalize_answer(MHD_Connection* connection,
         detail::connection_context* conn) {
     if (auto ws_result = try_ws_upgrade(connection, conn)) {
@@ -264,22 +353,7 @@ MHD_Result request_dispatcher::finalize_answer(MHD_Connection* connection,
     std::shared_ptr<http_resource> hrm;
     bool found = resolve_resource_for_request(conn, hrm);
 
-    if (found) {
-        // Snapshot whether this resource carries a per-route hook table so
-        // fire_request_completed_gated (fires after this shared_ptr is gone)
-        // can gate its weak_ptr lock() on the common zero-per-route-hook path.
-        conn->route_has_hook_table_ = (hrm->hook_table_raw_() != nullptr);
-
-        // Only stamp the weak_ptr when a later out-of-scope consumer can use
-        // it (the MHD completion callback), i.e. iff this resource has a
-        // per-route hook table OR a server-wide request_completed hook is
-        // registered. Gating this drops 2 control-block atomics per matched
-        // request on the common zero-hook path.
-        if (conn->route_has_hook_table_ ||
-                hooks_.has_hooks_for(hook_phase::request_completed)) {
-            conn->resource_weak_ = hrm;
-        }
-    }
+    if (found) note_resolved_resource(conn, hrm);
 
     fire_route_resolved_gated(hooks_, conn, found, hrm);
 
@@ -292,8 +366,18 @@ MHD_Result request_dispatcher::finalize_answer(MHD_Connection* connection,
                                                              hrm.get());
     }
 
+    // Only after the before_handler chain: a route guarded by auth_handler
+    // (API key, cookie, ...) must not hand its cached body to a client
+    // that chain would reject.
+    std::string cache_key;
+    if (auto cached = try_cache_hit(connection, conn, hrm.get(), &cache_key)) {
+        return *cached;
+    }
+
     if (found) {
-        dispatch_resource_handler(conn, hrm);
+        // A parked single_flight follower returns without a response;
+        // resume_follower queues it once the leader landed.
+        if (dispatch_resource_handler(connection, conn, hrm)) return MHD_YES;
     } else if (!conn->response) {
         conn->response.emplace(errors_.not_found_page(conn));
     }
@@ -303,8 +387,22 @@ MHD_Result request_dispatcher::finalize_answer(MHD_Connection* connection,
     // materialiser tolerate a null resource.
     hooks_.fire_after_handler_gated(conn, hrm.get());
 
-    return materializer_.materialize_and_queue_response(connection, conn,
-                                                        hrm.get());
+    // Stored after the ETag and compression stages: the frozen entry is
+    // queued as is, on this miss and on every hit.
+    materializer_.prepare_response(connection, conn);
+    store_in_cache(conn, std::move(cache_key));
+
+    return materializer_.queue_prepared_response(connection, conn, hrm.get());
+}
+
+MHD_Result request_dispatcher::resume_follower(MHD_Connection* connection,
+        detail::connection_context* conn) {
+    // Route resolution and before_handler ran before the request parked;
+    // the flight holds the resource alive.
+    const std::shared_ptr<http_resource> hrm = conn->flight.joined->resource;
+    follow(conn, hrm);
+    hooks_.fire_after_handler_gated(conn, hrm.get());
+    return materializer_.materialize_and_queue_response(connection, conn, hrm.get());
 }
 
 }  // namespace detail
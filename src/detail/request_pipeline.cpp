@@ -40,6 +40,7 @@
 #include <iostream>
 #include <optional>
 #include <span>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -50,9 +51,14 @@
 #include "httpserver/http_request.hpp"
 #include "httpserver/http_response.hpp"
 #include "httpserver/http_utils.hpp"
+#include "httpserver/detail/body_decoder.hpp"
 #include "httpserver/detail/hook_dispatcher.hpp"
 #include "httpserver/detail/connection_context.hpp"
+#include "httpserver/detail/form_parser.hpp"
 #include "httpserver/detail/request_dispatcher.hpp"
+#include "httpserver/detail/upload_budget.hpp"
+#include "httpserver/detail/upload_pipeline.hpp"
+#include "httpserver/detail/upload_writer.hpp"
 #include "httpserver/detail/webserver_impl.hpp"
 
 namespace httpserver {
@@ -91,20 +97,85 @@ bool fire_and_maybe_short_circuit_body_chunk(hook_dispatcher& hooks,
         MHD_destroy_post_processor(conn->pp);
         conn->pp = nullptr;
     }
+    conn->form.reset();
     return true;
 }
 
-// Feed @p upload_data through MHD's post processor (when one is attached)
-// and close any open upload-target stream.
+// Feed @p upload_data through MHD's post processor or the native
+// form_parser (whichever is attached) and close any open upload-target
+// stream.
 void run_post_processor_if_attached(connection_context* conn, const char* upload_data,
                                     size_t upload_data_size) {
-    if (conn->pp == nullptr) return;
-    MHD_post_process(conn->pp, upload_data, upload_data_size);
+    if (conn->form != nullptr) {
+        conn->form->feed(upload_data, upload_data_size);
+    } else if (conn->pp != nullptr) {
+        MHD_post_process(conn->pp, upload_data, upload_data_size);
+    } else {
+        return;
+    }
     if (conn->upload_ostrm != nullptr && conn->upload_ostrm->is_open()) {
         conn->upload_ostrm->close();
     }
 }
 
+// Map a body_decoder failure to the response that ends the request: 400
+// for a malformed (or, at end-of-body, truncated) stream, 413 once the
+// decoded size passes content_size_limit. ok / stopped need nothing: a
+// stopping sink already short-circuited the request itself.
+void reject_undecodable_body(connection_context* conn, body_decoder::status s) {
+    if (s == body_decoder::status::corrupt) {
+        conn->short_circuit(http_response::string(std::string{"Bad Request"})
+            .with_status(http_utils::http_bad_request));
+    } else if (s == body_decoder::status::too_large) {
+        conn->short_circuit(http_response::string(std::string{"Payload Too Large"})
+            .with_status(http_utils::http_request_entity_too_large));
+    }
+}
+
+// decode_request_body: attach a decoder for the request's Content-Encoding.
+// Returns false, with the request short-circuited to 415 (advertising the
+// codings we accept), when the coding cannot be decoded.
+bool attach_body_decoder(MHD_Connection* connection, connection_context* conn,
+                         size_t content_size_limit) {
+    const char* coding = MHD_lookup_connection_value(connection,
+        MHD_HEADER_KIND, http_utils::http_header_content_encoding);
+    if (body_decoder::create(coding, content_size_limit, &conn->decoder)
+            != body_decoder::coding::unsupported) {
+        return true;
+    }
+    conn->short_circuit(http_response::string(std::string{"Unsupported Media Type"})
+        .with_header(http_utils::http_header_accept_encoding, "gzip, deflate")
+        .with_status(http_utils::http_unsupported_media_type));
+    return false;
+}
+
+// Create the post-processor (or native form_parser) for form/multipart
+// bodies; other content types get neither.
+void attach_form_parser(MHD_Connection* connection, connection_context* conn,
+                        bool native) {
+    const char *encoding = MHD_lookup_connection_value(connection,
+        MHD_HEADER_KIND, http_utils::http_header_content_type);
+    if (native) {
+        // Same post_iterator trampoline as MHD's post processor, so the
+        // form-arg / upload paths downstream are shared.
+        conn->form = form_parser::create(encoding, &webserver_impl::post_iterator, conn);
+        return;
+    }
+    if (nullptr != encoding &&
+            ((0 == strncasecmp(http_utils::http_post_encoding_form_urlencoded, encoding, strlen(http_utils::http_post_encoding_form_urlencoded))) ||
+             (0 == strncasecmp(http_utils::http_post_encoding_multipart_formdata, encoding, strlen(http_utils::http_post_encoding_multipart_formdata))))) {
+        const size_t post_memory_limit(32 * 1024);  // Same as #MHD_POOL_SIZE_DEFAULT
+        conn->pp = MHD_create_post_processor(connection, post_memory_limit, &webserver_impl::post_iterator, conn);
+    }
+}
+
+// async_upload_writes backpressure. The chunk has been consumed either way;
+// if the writer is over budget the connection is parked until it catches up.
+void throttle_async_upload(upload_writer& writer, MHD_Connection* connection,
+                           connection_context* conn) {
+    if (conn->upload_async != nullptr) writer.throttle(*conn->upload_async, connection);
+}
+
 }  // namespace
 
 MHD_Result request_pipeline::requests_answer_first_step(
@@ -141,17 +212,18 @@ MHD_Result request_pipeline::requests_answer_first_step(
     }
 
     conn->request->set_content_size_limit(config_.content_size_limit);
-    const char *encoding = MHD_lookup_connection_value(connection,
-        MHD_HEADER_KIND, http_utils::http_header_content_type);
-
-    if (config_.post_process_enabled &&
-        (nullptr != encoding &&
-            ((0 == strncasecmp(http_utils::http_post_encoding_form_urlencoded, encoding, strlen(http_utils::http_post_encoding_form_urlencoded))) ||
-             (0 == strncasecmp(http_utils::http_post_encoding_multipart_formdata, encoding, strlen(http_utils::http_post_encoding_multipart_formdata)))))) {
-        const size_t post_memory_limit(32 * 1024);  // Same as #MHD_POOL_SIZE_DEFAULT
-        conn->pp = MHD_create_post_processor(connection, post_memory_limit, &webserver_impl::post_iterator, conn);
-    } else {
-        conn->pp = nullptr;
+    conn->budget = upload_budget::charge(&budget_);
+    if (config_.decode_request_body
+            && !attach_body_decoder(connection, conn, config_.content_size_limit)) {
+        return MHD_YES;
+    }
+    conn->pp = nullptr;
+    if (config_.post_process_enabled) {
+        attach_form_parser(connection, conn, config_.native_form_parser);
+        // Streamed file parts need their resource before the body arrives.
+        if (config_.file_upload_target == FILE_UPLOAD_STREAM) {
+            conn->upload_target = dispatcher_.upload_target(conn);
+        }
     }
     return MHD_YES;
 }
@@ -176,13 +248,28 @@ MHD_Result request_pipeline::requests_answer_second_step(
         return MHD_YES;
     }
 
+    // With decode_request_body on, the decoder drives consume_body_bytes
+    // once per decoded window instead of once per wire chunk.
+    if (conn->decoder != nullptr) {
+        decode_body_chunk(conn, upload_data, *upload_data_size);
+    } else if (!consume_body_bytes(conn, upload_data, *upload_data_size)) {
+        *upload_data_size = 0;
+        return MHD_YES;
+    }
+    throttle_async_upload(writer_, connection, conn);
+
+    *upload_data_size = 0;
+    return MHD_YES;
+}
+
+bool request_pipeline::consume_body_bytes(connection_context* conn,
+        const char* upload_data, size_t upload_data_size) {
     // body_chunk hook fires per chunk BEFORE the bytes are appended to
     // conn->request / fed to MHD_post_process.
     if (hooks_.has_hooks_for(::httpserver::hook_phase::body_chunk)) {
         if (fire_and_maybe_short_circuit_body_chunk(
-                hooks_, conn, upload_data, *upload_data_size)) {
-            *upload_data_size = 0;
-            return MHD_YES;
+                hooks_, conn, upload_data, upload_data_size)) {
+            return false;
         }
     }
 
@@ -193,29 +280,73 @@ MHD_Result request_pipeline::requests_answer_second_step(
     if (debug_dump_request_body_opted_in()) {
         std::cout << "Writing content: ";
         std::cout.write(upload_data,
-                        static_cast<std::streamsize>(*upload_data_size));
+                        static_cast<std::streamsize>(upload_data_size));
         std::cout << std::endl;
     }
-    // The post iterator is only created for multipart/form-data and
-    // application/x-www-form-urlencoded; all other content (conn->pp == nullptr)
-    // must be put to the content even if put_processed_data_to_content is false.
-    if (conn->pp == nullptr || config_.put_processed_data_to_content) {
-        conn->request->grow_content(upload_data, *upload_data_size);
-    }
-    run_post_processor_if_attached(conn, upload_data, *upload_data_size);
+    if (!buffer_content_chunk(conn, upload_data, upload_data_size)) return false;
+    run_post_processor_if_attached(conn, upload_data, upload_data_size);
+    return true;
+}
 
-    *upload_data_size = 0;
-    return MHD_YES;
+void request_pipeline::decode_body_chunk(connection_context* conn,
+        const char* upload_data, size_t upload_data_size) {
+    struct sink_ctx {
+        request_pipeline* self;
+        connection_context* conn;
+    } ctx{this, conn};
+    auto sink = [](void* cls, const char* data, size_t size) {
+        auto* c = static_cast<sink_ctx*>(cls);
+        return c->self->consume_body_bytes(c->conn, data, size);
+    };
+    reject_undecodable_body(conn, conn->decoder->feed(upload_data, upload_data_size, sink, &ctx));
+}
+
+// The post iterator is only created for multipart/form-data and
+// application/x-www-form-urlencoded; all other content (no pp / form) must
+// be put to the content even if put_processed_data_to_content is false.
+bool request_pipeline::buffer_content_chunk(connection_context* conn,
+        const char* upload_data, size_t upload_data_size) {
+    if ((conn->pp != nullptr || conn->form != nullptr)
+            && !config_.put_processed_data_to_content) {
+        return true;
+    }
+    // Once content_size_limit is reached grow_content stores nothing more.
+    const size_t stored = conn->request->content_too_large() ? 0 : upload_data_size;
+    if (!conn->budget.reserve(upload_budget::kind::memory, stored)) {
+        conn->short_circuit(upload_budget::rejection_response(upload_budget::kind::memory));
+        return false;
+    }
+    conn->request->grow_content(upload_data, upload_data_size);
+    return true;
 }
 
 MHD_Result request_pipeline::complete_request(MHD_Connection* connection,
         struct detail::connection_context* conn, const char* version,
         const char* method) {
+    // A resumed single_flight follower: everything below already ran
+    // before it parked.
+    if (conn->flight.connection != nullptr) return dispatcher_.resume_follower(connection, conn);
+    // Handlers must see complete upload files: hold the request until every
+    // queued async write landed. If this suspends, MHD calls back with the
+    // same zero-size end-of-body signal once the writer resumes us.
+    if (conn->upload_async != nullptr) {
+        if (writer_.wait_for_flush(*conn->upload_async, connection)) return MHD_YES;
+        if (conn->upload_async->failed) return MHD_NO;
+    }
+    // A compressed body that ended mid-stream is truncated.
+    if (conn->decoder != nullptr && !conn->skip_handler && !conn->decoder->finished()) {
+        reject_undecodable_body(conn, body_decoder::status::corrupt);
+    }
     // conn->ws is pre-populated in answer_to_connection (hoisted there for
     // early-path request_completed coverage); no need to set it again here.
     conn->request->set_path(conn->standardized_url);
     conn->request->set_method(method);
     conn->request->set_version(version);
+    // Flush a trailing urlencoded key that never saw a value byte. MHD's
+    // post processor only does this from MHD_destroy_post_processor, i.e.
+    // after the handler ran.
+    if (conn->form != nullptr) conn->form->finish();
+    if (conn->upload_target != nullptr) upload_pipeline::end_streamed_part(conn);
 
     return dispatcher_.finalize_answer(connection, conn);
 }
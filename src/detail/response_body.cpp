@@ -29,15 +29,35 @@
 #include <sys/uio.h>        // POSIX struct iovec — used for layout-pin asserts
 #endif
 
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
+#include "httpserver/detail/file_descriptor_cache.hpp"
+#include "httpserver/detail/http_field_validation.hpp"
+#include "httpserver/detail/stream_channel.hpp"
+
 namespace httpserver {
 
+bool deferred_trailers::add(std::string_view name, std::string_view value) {
+    if (fields_ == nullptr || name.empty() || detail::has_forbidden_field_char(name)
+            || detail::has_forbidden_field_char(value)) {
+        return false;
+    }
+    try {
+        fields_->insert_or_assign(name, value);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
 namespace detail {
 
 // ---------------------------------------------------------------------------
@@ -104,26 +124,49 @@ MHD_Response* string_response_body::materialize() {
 }
 
 // ---------------------------------------------------------------------------
-// file_response_body — opens the file and fstat's it at construction so size() is
-// accurate immediately.  materialize() uses fstat's st_size; it never calls
-// lseek(), so the fd's read position remains at 0 when handed to
+// shared_response_body
+// ---------------------------------------------------------------------------
+namespace {
+void release_shared_owner(void* cls) {
+    delete static_cast<std::shared_ptr<const void>*>(cls);
+}
+}  // namespace
+
+MHD_Response* shared_response_body::materialize() {
+    if (owner_ == nullptr) {
+        return MHD_create_response_from_buffer_static(size_, data_);
+    }
+    auto* keep_alive = new std::shared_ptr<const void>(owner_);
+    MHD_Response* r = MHD_create_response_from_buffer_with_free_callback_cls(
+        size_, data_, &release_shared_owner, keep_alive);
+    if (r == nullptr) delete keep_alive;
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// file_response_body — opens the file and fstat's it up front (at
+// construction, or in ensure_open() for a deferred body) so size() is
+// accurate before materialize().  materialize() uses fstat's st_size; it
+// never calls lseek(), so the fd's read position remains at 0 when handed to
 // MHD_create_response_from_fd (CWE-367).
 // ---------------------------------------------------------------------------
-file_response_body::file_response_body(std::string path) noexcept
-    : path_(std::move(path)) {
+file_response_body::file_response_body(std::string path, bool precompressed) noexcept
+    : path_(std::move(path)), precompressed_(precompressed) {
+    fd_ = open_regular(path_, &size_);
+}
+
+file_response_body::file_response_body(std::string path, bool precompressed,
+                                       deferred_open_t) noexcept
+    : path_(std::move(path)), open_pending_(true), precompressed_(precompressed) {
+}
+
+int file_response_body::open_regular(const std::string& path, std::size_t* size) noexcept {
 #ifndef _WIN32
-    fd_ = ::open(path_.c_str(), O_RDONLY | O_NOFOLLOW);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW);
 #else
-    fd_ = ::open(path_.c_str(), O_RDONLY);
+    const int fd = ::open(path.c_str(), O_RDONLY);
 #endif
-    if (fd_ == -1) return;
-
-    struct stat sb;
-    if (::fstat(fd_, &sb) != 0 || !S_ISREG(sb.st_mode)) {
-        ::close(fd_);
-        fd_ = -1;
-        return;
-    }
+    if (fd == -1) return -1;
 
     // Use fstat's st_size directly — no lseek, no TOCTOU, no fd-position
     // side-effect.
@@ -133,14 +176,22 @@ file_response_body::file_response_body(std::string path) noexcept
     // the cast. Reject oversized files so MHD_create_response_from_fd always
     // receives the correct size.  On 64-bit targets the comparison is a
     // compile-time no-op and the branch is dead.
-    if (sb.st_size < 0 ||
+    struct stat sb;
+    if (::fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode) || sb.st_size < 0 ||
         static_cast<uint64_t>(sb.st_size) >
             static_cast<uint64_t>(std::numeric_limits<std::size_t>::max())) {
-        ::close(fd_);
-        fd_ = -1;
-        return;
+        ::close(fd);
+        return -1;
     }
-    size_ = static_cast<std::size_t>(sb.st_size);
+    *size = static_cast<std::size_t>(sb.st_size);
+    return fd;
+}
+
+int file_response_body::ensure_open(file_descriptor_cache* cache) noexcept {
+    if (!open_pending_) return fd_;
+    open_pending_ = false;
+    fd_ = cache != nullptr ? cache->open(path_, &size_) : open_regular(path_, &size_);
+    return fd_;
 }
 
 file_response_body::~file_response_body() {
@@ -159,15 +210,20 @@ file_response_body::~file_response_body() {
 file_response_body::file_response_body(file_response_body&& o) noexcept
     : path_(std::move(o.path_)),
       size_(o.size_),
+      offset_(o.offset_),
       fd_(std::exchange(o.fd_, -1)),
-      materialized_(std::exchange(o.materialized_, true)) {
+      materialized_(std::exchange(o.materialized_, true)),
+      open_pending_(std::exchange(o.open_pending_, false)),
+      precompressed_(o.precompressed_) {
 }
 
 MHD_Response* file_response_body::materialize() {
-    if (fd_ == -1) return nullptr;
+    if (ensure_open() == -1) return nullptr;
 
     if (size_) {
-        MHD_Response* r = MHD_create_response_from_fd(size_, fd_);
+        MHD_Response* r = offset_ == 0
+            ? MHD_create_response_from_fd(size_, fd_)
+            : MHD_create_response_from_fd_at_offset64(size_, fd_, offset_);
         if (r != nullptr) {
             materialized_ = true;  // MHD now owns fd_
         }
@@ -193,11 +249,18 @@ MHD_Response* iovec_response_body::materialize() {
                 std::numeric_limits<unsigned int>::max())) {
         return nullptr;
     }
-    return MHD_create_response_from_iovec(
-        reinterpret_cast<const MHD_IoVec*>(entries_.data()),
-        static_cast<unsigned int>(entries_.size()),
-        nullptr,
-        nullptr);
+    const auto* iov = reinterpret_cast<const MHD_IoVec*>(entries_.data());
+    const auto count = static_cast<unsigned int>(entries_.size());
+    if (owners_ == nullptr) {
+        return MHD_create_response_from_iovec(iov, count, nullptr, nullptr);
+    }
+    // MHD copies the vector itself; the buffers stay owned until it drops
+    // the response (same keep-alive as shared_response_body).
+    auto* keep_alive = new std::shared_ptr<const void>(owners_);
+    MHD_Response* r = MHD_create_response_from_iovec(iov, count, &release_shared_owner,
+                                                     keep_alive);
+    if (r == nullptr) delete keep_alive;
+    return r;
 }
 
 // ---------------------------------------------------------------------------
@@ -216,17 +279,51 @@ pipe_response_body::~pipe_response_body() {
 // already-materialized so its destructor skips close.
 pipe_response_body::pipe_response_body(pipe_response_body&& o) noexcept
     : fd_(std::exchange(o.fd_, -1)),
+      block_size_(o.block_size_),
       materialized_(std::exchange(o.materialized_, true)) {
 }
 
+namespace {
+
+ssize_t read_fd(int fd, char* buf, std::size_t max) noexcept {
+    for (;;) {
+        const ssize_t n = ::read(fd, buf, max);
+        if (n > 0) return n;
+        if (n == 0) return MHD_CONTENT_READER_END_OF_STREAM;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+}
+
+// The fd rides in cls, so the MHD_Response does not depend on the body
+// outliving it.
+ssize_t read_pipe_block(void* cls, std::uint64_t, char* buf, std::size_t max) {
+    return read_fd(static_cast<int>(reinterpret_cast<std::intptr_t>(cls)), buf, max);
+}
+
+void close_pipe(void* cls) {
+    ::close(static_cast<int>(reinterpret_cast<std::intptr_t>(cls)));
+}
+
+}  // namespace
+
 MHD_Response* pipe_response_body::materialize() {
-    MHD_Response* r = MHD_create_response_from_pipe(fd_);
+    MHD_Response* r = block_size_ == 0
+        ? MHD_create_response_from_pipe(fd_)
+        : MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, block_size_, &read_pipe_block,
+                                            reinterpret_cast<void*>(static_cast<std::intptr_t>(fd_)),
+                                            &close_pipe);
     if (r != nullptr) {
         materialized_ = true;  // MHD now owns fd_
     }
     return r;
 }
 
+ssize_t pipe_response_body::read_some(char* buf, std::size_t max) noexcept {
+    return read_fd(fd_, buf, max);
+}
+
 // ---------------------------------------------------------------------------
 // deferred_response_body — trampoline + materialize.
 // ---------------------------------------------------------------------------
@@ -243,12 +340,79 @@ ssize_t deferred_response_body::trampoline(void* cls, std::uint64_t pos,
     return self->producer_(pos, buf, max);
 }
 
+ssize_t deferred_response_body::trailer_trampoline(void* cls, std::uint64_t pos,
+                                                  char* buf, std::size_t max) {
+    auto* binding = static_cast<trailer_binding*>(cls);
+    if (!binding->self->producer_) return MHD_CONTENT_READER_END_WITH_ERROR;
+    const ssize_t n = binding->self->producer_(pos, buf, max, binding->trailers);
+    if (n == MHD_CONTENT_READER_END_OF_STREAM) {
+        // The body is complete and MHD has not yet written the terminating
+        // chunk, which it follows with the response's footers: only now is
+        // the buffer attached. Views are NUL-terminated; MHD copies them.
+        for (const auto& [name, value] : binding->fields) {
+            MHD_add_response_footer(binding->response, name.data(), value.data());
+        }
+        binding->trailers.fields_ = nullptr;
+    }
+    return n;
+}
+
 MHD_Response* deferred_response_body::materialize() {
-    // Block size 1024 mirrors v1 deferred_response::get_raw_response_helper.
     // Free-callback is nullptr because *this owns producer_ and outlives the
     // MHD_Response (http_response's lifetime enforces this).
-    return MHD_create_response_from_callback(
-        MHD_SIZE_UNKNOWN, 1024, &deferred_response_body::trampoline, this, nullptr);
+    if (!producer_.takes_trailers()) {
+        return MHD_create_response_from_callback(
+            MHD_SIZE_UNKNOWN, block_size_, &deferred_response_body::trampoline, this, nullptr);
+    }
+    // Trailers collect in the binding while the response streams and
+    // reach it at end of stream (trailer_trampoline).
+    auto binding = std::unique_ptr<trailer_binding>(
+        new trailer_binding{this, nullptr, {}, deferred_trailers(nullptr)});
+    MHD_Response* response = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN, block_size_, &deferred_response_body::trailer_trampoline,
+        binding.get(), [](void* cls) { delete static_cast<trailer_binding*>(cls); });
+    if (response == nullptr) return nullptr;
+    binding->response = response;
+    binding->trailers.fields_ = &binding->fields;
+    binding.release();
+    return response;
+}
+
+// ---------------------------------------------------------------------------
+// stream_response_body
+// ---------------------------------------------------------------------------
+namespace {
+void release_stream_channel(void* cls) {
+    auto* channel = static_cast<std::shared_ptr<stream_channel>*>(cls);
+    (*channel)->detach();
+    delete channel;
+}
+}  // namespace
+
+stream_response_body::~stream_response_body() {
+    if (!materialized_ && channel_ != nullptr) channel_->detach();
+}
+
+ssize_t stream_response_body::trampoline(void* cls, std::uint64_t,
+                                         char* buf, std::size_t max) {
+    stream_channel& channel = **static_cast<std::shared_ptr<stream_channel>*>(cls);
+    const ssize_t n = channel.read(buf, max);
+    // Parked: the next write resumes the connection and MHD calls again.
+    if (n != 0 || channel.park()) return n;
+    return channel.read(buf, max);
+}
+
+MHD_Response* stream_response_body::materialize() {
+    auto* ref = new std::shared_ptr<stream_channel>(channel_);
+    MHD_Response* r = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN, 4096, &stream_response_body::trampoline, ref,
+        &release_stream_channel);
+    if (r == nullptr) {
+        delete ref;
+        return nullptr;
+    }
+    materialized_ = true;  // the free callback detaches from here on
+    return r;
 }
 
 // ---------------------------------------------------------------------------
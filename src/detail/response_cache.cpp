@@ -0,0 +1,246 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/response_cache.hpp"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "httpserver/http_method.hpp"
+#include "httpserver/http_request.hpp"
+#include "httpserver/http_response.hpp"
+#include "httpserver/detail/response_body.hpp"
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// Splits a comma list into trimmed, non-empty elements.
+std::vector<std::string_view> elements(std::string_view list) {
+    std::vector<std::string_view> out;
+    while (!list.empty()) {
+        const std::size_t comma = list.find(',');
+        const std::string_view item = trim(list.substr(0, comma));
+        if (!item.empty()) out.push_back(item);
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+    }
+    return out;
+}
+
+// Delta-seconds of a directive argument, quoted or not; nullopt when it
+// is not a number.
+std::optional<std::chrono::seconds> delta_seconds(std::string_view v) {
+    if (v.size() >= 2 && v.front() == '"' && v.back() == '"') v = v.substr(1, v.size() - 2);
+    if (v.empty()) return std::nullopt;
+    std::int64_t n = 0;
+    for (char c : v) {
+        if (c < '0' || c > '9') return std::nullopt;
+        // Clamp absurd values instead of overflowing (RFC 9111 §1.2.2).
+        n = std::min<std::int64_t>(n * 10 + (c - '0'), std::int64_t{1} << 31);
+    }
+    return std::chrono::seconds(n);
+}
+
+bool forbids_storing(std::string_view directive) {
+    return iequals(directive, "no-store") || iequals(directive, "no-cache")
+        || iequals(directive, "private");
+}
+
+// Statuses a cache may store without the response saying so explicitly
+// (RFC 9110 §15.1); anything else is passed through.
+bool cacheable_status(int status) {
+    switch (status) {
+        case 200: case 203: case 204: case 300: case 301: case 308:
+        case 404: case 405: case 410: case 414: case 501:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+response_cache::response_cache(std::size_t capacity, std::vector<std::string> vary,
+                               key_function key_fn)
+    : capacity_(capacity), shard_capacity_(capacity / kShards),
+      vary_(std::move(vary)), key_fn_(std::move(key_fn)) {}
+
+std::optional<std::chrono::seconds> response_cache::lifetime(std::string_view cache_control) {
+    std::optional<std::chrono::seconds> max_age;
+    std::optional<std::chrono::seconds> s_maxage;
+    for (std::string_view d : elements(cache_control)) {
+        const std::size_t eq = d.find('=');
+        const std::string_view name = trim(d.substr(0, eq));
+        const std::string_view arg = eq == std::string_view::npos ? std::string_view{}
+                                                                  : trim(d.substr(eq + 1));
+        if (forbids_storing(name)) return std::nullopt;
+        if (iequals(name, "s-maxage")) {
+            s_maxage = delta_seconds(arg);
+        } else if (iequals(name, "max-age")) {
+            max_age = delta_seconds(arg);
+        }
+    }
+    std::optional<std::chrono::seconds> ttl = s_maxage ? s_maxage : max_age;
+    if (!ttl || ttl->count() == 0) return std::nullopt;
+    return ttl;
+}
+
+std::string response_cache::key(const http_request& req, http_method method,
+                                std::string_view path) const {
+    if (!enabled() || (method != http_method::get && method != http_method::head)) return {};
+    if (!req.get_header("Authorization").empty()) return {};
+    std::string k(to_string(method));
+    k.append(" ").append(path).append(req.get_querystring());
+    for (const std::string& name : vary_) {
+        k.append("\n").append(req.get_header(name));
+    }
+    if (key_fn_) k.append("\n").append(key_fn_(req));
+    return k;
+}
+
+response_cache::shard& response_cache::shard_for(std::string_view path) noexcept {
+    return shards_[std::hash<std::string_view>{}(path) % kShards];
+}
+
+std::optional<frozen_response> response_cache::find(const std::string& key,
+                                                    std::string_view path) {
+    shard& s = shard_for(path);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it == s.map.end()) return std::nullopt;
+    if (it->second->expires <= clock::now()) {
+        erase(s, it->second);
+        return std::nullopt;
+    }
+    s.list.splice(s.list.begin(), s.list, it->second);
+    return it->second->response;
+}
+
+bool response_cache::storable(const http_response& resp) const {
+    if (!cacheable_status(resp.get_status()) || !resp.get_cookies_parsed().empty()
+            || !resp.get_header("Set-Cookie").empty()) {
+        return false;
+    }
+    if (resp.kind() != body_kind::string && resp.kind() != body_kind::shared
+            && resp.kind() != body_kind::empty) {
+        return false;
+    }
+    // Variants are only told apart by the configured headers.
+    for (std::string_view name : elements(resp.get_header("Vary"))) {
+        if (std::none_of(vary_.begin(), vary_.end(),
+                         [name](const std::string& v) { return iequals(v, name); })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void response_cache::store(std::string key, std::string_view path, http_response& resp) {
+    const std::optional<std::chrono::seconds> ttl = lifetime(resp.get_header("Cache-Control"));
+    if (!ttl || !storable(resp)) return;
+    std::size_t charge = key.size() + path.size() + (resp.body_ ? resp.body_->size() : 0);
+    for (const auto& [name, value] : resp.get_headers()) charge += name.size() + value.size();
+    if (charge > shard_capacity_) return;
+
+    // A failed freeze (out of memory) leaves resp empty, which the
+    // materializer answers with its internal-error fallback.
+    std::optional<frozen_response> frozen;
+    try {
+        frozen.emplace(std::move(resp).freeze());
+    } catch (...) {
+        return;
+    }
+    resp = *frozen;
+
+    shard& s = shard_for(path);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it != s.map.end()) erase(s, it->second);
+    while (s.used + charge > shard_capacity_) erase(s, std::prev(s.list.end()));
+    s.list.push_front(entry{std::move(key), std::string(path), std::move(*frozen),
+                            clock::now() + *ttl, charge});
+    s.map.emplace(s.list.front().key, s.list.begin());
+    s.used += charge;
+}
+
+std::size_t response_cache::purge(std::string_view path) {
+    shard& s = shard_for(path);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::size_t n = 0;
+    for (auto it = s.list.begin(); it != s.list.end();) {
+        auto next = std::next(it);
+        if (it->path == path) {
+            erase(s, it);
+            ++n;
+        }
+        it = next;
+    }
+    return n;
+}
+
+void response_cache::clear() {
+    for (shard& s : shards_) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.map.clear();
+        s.list.clear();
+        s.used = 0;
+    }
+}
+
+std::size_t response_cache::used() const {
+    std::size_t n = 0;
+    for (const shard& s : shards_) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        n += s.used;
+    }
+    return n;
+}
+
+void response_cache::erase(shard& s, list_t::iterator it) {
+    s.used -= it->charge;
+    s.map.erase(it->key);
+    s.list.erase(it);
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -0,0 +1,483 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/response_compressor.hpp"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <microhttpd.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "httpserver/create_webserver.hpp"
+#include "httpserver/http_request.hpp"
+#include "httpserver/http_response.hpp"
+#include "httpserver/detail/http_date.hpp"
+#include "httpserver/detail/response_body.hpp"
+#include "httpserver/detail/stream_channel.hpp"
+
+namespace httpserver {
+namespace detail {
+
+using namespace std::string_view_literals;
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// Calls @p fn with each trimmed, non-empty element of a comma list.
+template <typename Fn>
+void for_each_element(std::string_view list, Fn&& fn) {
+    while (!list.empty()) {
+        const std::size_t comma = list.find(',');
+        const std::string_view item = trim(list.substr(0, comma));
+        if (!item.empty()) fn(item);
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+    }
+}
+
+bool has_element(std::string_view list, std::string_view token) {
+    bool found = false;
+    for_each_element(list, [&](std::string_view item) {
+        found = found || iequals(trim(item.substr(0, item.find(';'))), token);
+    });
+    return found;
+}
+
+// The digits after "0." / "1." of a qvalue, in thousandths.
+int thousandths(std::string_view digits) {
+    int w = 0;
+    for (int scale = 100; scale > 0 && !digits.empty(); scale /= 10) {
+        if (digits.front() < '0' || digits.front() > '9') break;
+        w += (digits.front() - '0') * scale;
+        digits.remove_prefix(1);
+    }
+    return w;
+}
+
+// Parses the weight of one Accept-Encoding element, in thousandths.
+// No q parameter means 1; a malformed one is treated as q=0.
+int weight(std::string_view params) {
+    const std::size_t q = params.find("q=");
+    if (q == std::string_view::npos) return 1000;
+    const std::string_view v = trim(params.substr(q + 2));
+    if (v.empty() || (v.front() != '0' && v.front() != '1')) return 0;
+    int w = (v.front() - '0') * 1000;
+    if (v.size() > 1 && v[1] == '.') w += thousandths(v.substr(2));
+    return w > 1000 ? 1000 : w;
+}
+
+// Accept-Encoding weights of the codings negotiate() knows; -1 = unlisted.
+struct coding_weights {
+    int br = -1, gzip = -1, deflate = -1, any = -1;
+
+    void record(std::string_view item) {
+        const std::size_t semi = item.find(';');
+        const std::string_view name = trim(item.substr(0, semi));
+        const int w = semi == std::string_view::npos ? 1000 : weight(item.substr(semi + 1));
+        if (iequals(name, "gzip") || iequals(name, "x-gzip")) gzip = w;
+        else if (iequals(name, "deflate")) deflate = w;
+        else if (iequals(name, "br")) br = w;
+        else if (name == "*") any = w;
+    }
+};
+
+// Statuses that carry no body, or whose body is a byte range of the
+// unencoded representation, are left alone.
+bool compressible_status(int status) {
+    return status >= 200 && status != 204 && status != 206 && status != 304;
+}
+
+bool compressible_kind(body_kind k) {
+    return k == body_kind::string || k == body_kind::iovec
+        || k == body_kind::deferred || k == body_kind::pipe || k == body_kind::stream;
+}
+
+void add_vary(http_response& resp) {
+    const std::string_view vary = resp.get_header("Vary");
+    if (vary.empty()) {
+        resp.with_header("Vary"sv, "Accept-Encoding"sv);
+    } else if (!has_element(vary, "*") && !has_element(vary, "Accept-Encoding")) {
+        resp.with_header("Vary", std::string(vary) + ", Accept-Encoding");
+    }
+}
+
+// The encoded bytes are a different representation, so a strong
+// validator no longer identifies them (RFC 9110 §8.8.1).
+void mark_encoded(http_response& resp, response_compressor::coding c) {
+    if (c == response_compressor::coding::gzip) {
+        resp.with_header("Content-Encoding"sv, "gzip"sv);
+    } else if (c == response_compressor::coding::br) {
+        resp.with_header("Content-Encoding"sv, "br"sv);
+    } else {
+        resp.with_header("Content-Encoding"sv, "deflate"sv);
+    }
+    const std::string_view etag = resp.get_header("ETag");
+    if (!etag.empty() && etag.front() == '"') {
+        resp.with_header("ETag", "W/" + std::string(etag));
+    }
+}
+
+// The sibling a precompressed file keeps its @p c encoding in.
+std::string_view sidecar_suffix(response_compressor::coding c) {
+    if (c == response_compressor::coding::br) return ".br";
+    if (c == response_compressor::coding::gzip) return ".gz";
+    return {};
+}
+
+}  // namespace
+
+response_compressor::response_compressor(const webserver_config& config) noexcept
+    : config_(config), files_(config.compressed_file_cache_size) {}
+
+response_compressor::coding response_compressor::negotiate(
+        std::string_view accept_encoding, bool allow_br) noexcept {
+    coding_weights w;
+    for_each_element(accept_encoding, [&w](std::string_view item) { w.record(item); });
+    // An explicitly listed coding takes its own weight; otherwise "*".
+    const int br = !allow_br ? 0 : (w.br < 0 ? w.any : w.br);
+    const int gzip = w.gzip < 0 ? w.any : w.gzip;
+    const int deflate = w.deflate < 0 ? w.any : w.deflate;
+    if (br > 0 && br >= gzip && br >= deflate) return coding::br;
+    if (gzip > 0 && gzip >= deflate) return coding::gzip;
+    if (deflate > 0) return coding::deflate;
+    return coding::identity;
+}
+
+bool response_compressor::compressible_type(std::string_view content_type) const noexcept {
+    const std::string_view type = trim(content_type.substr(0, content_type.find(';')));
+    if (type.empty()) return false;
+    for (const std::string& pattern : config_.compression_types) {
+        const std::string_view p = pattern;
+        if (p.size() >= 2 && p.substr(p.size() - 2) == "/*") {
+            if (type.size() > p.size() - 1
+                    && iequals(type.substr(0, p.size() - 1), p.substr(0, p.size() - 1))) {
+                return true;
+            }
+        } else if (iequals(type, p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void response_compressor::apply(const http_request& req, http_response& resp) noexcept {
+    if (!compressible_status(resp.get_status()) || !resp.get_header("Content-Encoding").empty()) {
+        return;
+    }
+    try {
+        if (resp.kind() == body_kind::file) {
+            apply_file(req, resp);
+            return;
+        }
+        if (!config_.compress_responses || !compressible_kind(resp.kind())
+                || has_element(resp.get_header("Cache-Control"), "no-transform")
+                || !compressible_type(resp.get_header("Content-Type"))) {
+            return;
+        }
+        add_vary(resp);
+        const coding c = negotiate(req.get_header("Accept-Encoding"));
+        if (c == coding::identity) return;
+        const bool streamed = resp.kind() == body_kind::deferred || resp.kind() == body_kind::pipe
+            || resp.kind() == body_kind::stream;
+        if (streamed ? encode_stream(resp, c) : encode_buffer(resp, c)) {
+            mark_encoded(resp, c);
+        }
+    } catch (...) {
+        // Out of memory while encoding or adding headers: the response
+        // still goes out, unencoded.
+    }
+}
+
+void response_compressor::apply_file(const http_request& req, http_response& resp) {
+    auto* body = static_cast<file_response_body*>(resp.body_);
+    // A missing file keeps failing at materialize(); never mask it.
+    if (body->ensure_open() == -1) return;
+    const bool cacheable = config_.compress_responses && files_.capacity() > 0
+        && !has_element(resp.get_header("Cache-Control"), "no-transform")
+        && compressible_type(resp.get_header("Content-Type"));
+    if (!body->precompressed() && !cacheable) return;
+    add_vary(resp);
+    const std::string_view accept_encoding = req.get_header("Accept-Encoding");
+    if (body->precompressed() && serve_sidecar(resp, accept_encoding)) return;
+    const coding c = cacheable ? negotiate(accept_encoding) : coding::identity;
+    if (c != coding::identity && serve_cached(resp, c)) mark_encoded(resp, c);
+}
+
+bool response_compressor::serve_sidecar(http_response& resp, std::string_view accept_encoding) {
+    const std::string& path = static_cast<const file_response_body*>(resp.body_)->path();
+    // br is tried first when preferred; gzip is the fallback when no
+    // ".br" exists.
+    coding tried = coding::identity;
+    for (const coding c : {negotiate(accept_encoding, true), negotiate(accept_encoding)}) {
+        const std::string_view suffix = sidecar_suffix(c);
+        if (suffix.empty() || c == tried) continue;
+        tried = c;
+        http_response donor = http_response::file(std::string(path).append(suffix));
+        if (static_cast<file_response_body*>(donor.body_)->ensure_open() == -1) continue;
+        resp.replace_body(donor);
+        mark_encoded(resp, c);
+        return true;
+    }
+    return false;
+}
+
+#ifdef HAVE_ZLIB
+
+namespace {
+
+int window_bits(response_compressor::coding c) {
+    // 16 + MAX_WBITS selects the gzip wrapper; plain MAX_WBITS the zlib one.
+    return c == response_compressor::coding::gzip ? 16 + MAX_WBITS : MAX_WBITS;
+}
+
+// Deflates @p parts into @p out in one pass. False when zlib fails or the
+// result is no smaller than the input.
+bool deflate_parts(const std::vector<std::string_view>& parts, std::size_t total,
+                   response_compressor::coding c, int level, std::string* out) {
+    z_stream zs{};
+    if (deflateInit2(&zs, level, Z_DEFLATED, window_bits(c), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    out->resize(deflateBound(&zs, static_cast<uLong>(total)));
+    zs.next_out = reinterpret_cast<Bytef*>(out->data());
+    zs.avail_out = static_cast<uInt>(out->size());
+    int rc = Z_OK;
+    for (std::size_t i = 0; i < parts.size() && rc == Z_OK; ++i) {
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(parts[i].data()));
+        zs.avail_in = static_cast<uInt>(parts[i].size());
+        rc = deflate(&zs, i + 1 == parts.size() ? Z_FINISH : Z_NO_FLUSH);
+    }
+    const bool ok = rc == Z_STREAM_END && zs.total_out < total;
+    out->resize(zs.total_out);
+    deflateEnd(&zs);
+    return ok;
+}
+
+// Whole-file read with pread(), so the fd's offset (which MHD relies on
+// when it is served as is) never moves.
+bool read_file(int fd, std::size_t size, std::string* out) {
+    out->resize(size);
+    std::size_t got = 0;
+    while (got < size) {
+        const ssize_t n = ::pread(fd, out->data() + got, size - got, static_cast<off_t>(got));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        got += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Shared by the producer of a streamed encoding: the original body, kept
+// alive in `source`, and the deflate state between MHD callbacks.
+struct encoding_stream {
+    explicit encoding_stream(http_response src) noexcept : source(std::move(src)) {}
+    ~encoding_stream() { deflateEnd(&zs); }
+    encoding_stream(const encoding_stream&) = delete;
+    encoding_stream& operator=(const encoding_stream&) = delete;
+
+    ssize_t read_source() {
+        switch (kind) {
+            case body_kind::pipe:
+                return static_cast<pipe_response_body*>(body)->read_some(in.data(), in.size());
+            case body_kind::stream:
+                return static_cast<stream_response_body*>(body)->channel().read(in.data(), in.size());
+            default:
+                return deferred_response_body::trampoline(static_cast<deferred_response_body*>(body),
+                                                          source_pos, in.data(), in.size());
+        }
+    }
+
+    ssize_t pull() {
+        const ssize_t n = read_source();
+        if (n > 0) {
+            zs.next_in = reinterpret_cast<Bytef*>(in.data());
+            zs.avail_in = static_cast<uInt>(n);
+            source_pos += static_cast<std::uint64_t>(n);
+            pending = true;
+        } else if (n == MHD_CONTENT_READER_END_OF_STREAM) {
+            eof = true;
+        }
+        return n;
+    }
+
+    // Picks the flush mode for the next deflate call, pulling more input
+    // when the last chunk is used up. -1 means return @p result as is.
+    int next_flush(ssize_t* result) {
+        if (zs.avail_in > 0 || eof) return eof ? Z_FINISH : Z_NO_FLUSH;
+        const ssize_t n = pull();
+        if (n > 0 || eof) return eof ? Z_FINISH : Z_NO_FLUSH;
+        if (n < 0) {
+            *result = MHD_CONTENT_READER_END_WITH_ERROR;
+            return -1;
+        }
+        // The source has nothing ready: push out what it gave so far.
+        *result = 0;
+        return pending ? Z_SYNC_FLUSH : -1;
+    }
+
+    // One deflate call. False once produce() should stop: output was
+    // written, the stream ended or was flushed, or @p result is final.
+    bool step(uInt room, ssize_t* result) {
+        const int flush = next_flush(result);
+        if (flush < 0) return false;
+        const int rc = deflate(&zs, flush);
+        if (rc == Z_STREAM_ERROR) {
+            *result = MHD_CONTENT_READER_END_WITH_ERROR;
+            return false;
+        }
+        if (rc == Z_STREAM_END) finished = true;
+        *result = static_cast<ssize_t>(room - zs.avail_out);
+        if (flush == Z_SYNC_FLUSH && zs.avail_out > 0) pending = false;
+        return !finished && flush != Z_SYNC_FLUSH && zs.avail_out == room;
+    }
+
+    ssize_t produce(char* buf, std::size_t max) {
+        if (finished) return MHD_CONTENT_READER_END_OF_STREAM;
+        zs.next_out = reinterpret_cast<Bytef*>(buf);
+        zs.avail_out = static_cast<uInt>(std::min<std::size_t>(max, std::numeric_limits<uInt>::max()));
+        const uInt room = zs.avail_out;
+        ssize_t result = 0;
+        while (step(room, &result)) {}
+        if (result == 0 && finished) return MHD_CONTENT_READER_END_OF_STREAM;
+        // Nothing to send and the writer has nothing queued: park the
+        // connection as the unencoded stream would.
+        if (result == 0 && kind == body_kind::stream) {
+            static_cast<stream_response_body*>(body)->channel().park();
+        }
+        return result;
+    }
+
+    http_response source;
+    response_body* body = nullptr;
+    body_kind kind = body_kind::deferred;
+    z_stream zs{};
+    std::array<char, 16 * 1024> in{};
+    std::uint64_t source_pos = 0;
+    bool pending = false;   // input deflated but not yet flushed out
+    bool eof = false;
+    bool finished = false;
+};
+
+}  // namespace
+
+bool response_compressor::encode_buffer(http_response& resp, coding c) const {
+    const std::size_t total = resp.body_->size();
+    if (total < config_.compression_min_size) return false;
+    std::vector<std::string_view> parts;
+    if (resp.kind() == body_kind::string) {
+        parts.emplace_back(static_cast<string_response_body*>(resp.body_)->get_data());
+    } else {
+        for (const iovec_entry& e : static_cast<iovec_response_body*>(resp.body_)->entries()) {
+            parts.emplace_back(static_cast<const char*>(e.base), e.len);
+        }
+    }
+    for (std::string_view p : parts) {
+        if (p.size() > std::numeric_limits<uInt>::max()) return false;
+    }
+    std::string encoded;
+    if (parts.empty() || !deflate_parts(parts, total, c, config_.compression_level, &encoded)) {
+        return false;
+    }
+    http_response donor = http_response::string(std::move(encoded));
+    resp.replace_body(donor);
+    return true;
+}
+
+bool response_compressor::encode_stream(http_response& resp, coding c) const {
+    auto st = std::make_shared<encoding_stream>(http_response{});
+    if (deflateInit2(&st->zs, config_.compression_level, Z_DEFLATED, window_bits(c), 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    http_response donor = http_response::deferred(
+        [st](std::uint64_t, char* buf, std::size_t max) { return st->produce(buf, max); });
+    // The original body moves into the stream state, where its address
+    // stays fixed for the producer.
+    st->source.replace_body(resp);
+    st->body = st->source.body_;
+    st->kind = st->source.kind_;
+    resp.replace_body(donor);
+    return true;
+}
+
+bool response_compressor::serve_cached(http_response& resp, coding c) {
+    const auto* body = static_cast<const file_response_body*>(resp.body_);
+    const std::size_t size = body->size();
+    if (size == 0 || size < config_.compression_min_size || size > files_.capacity()
+            || size > std::numeric_limits<uInt>::max()) {
+        return false;
+    }
+    struct stat sb;
+    if (::fstat(body->fd(), &sb) != 0) return false;
+    const compressed_file_cache::stamp stamp{file_mtime_ns(sb), size};
+    const auto key = static_cast<std::uint8_t>(c);
+    std::shared_ptr<const std::string> encoded;
+    if (!files_.find(body->path(), key, stamp, &encoded)) {
+        std::string raw;
+        if (!read_file(body->fd(), size, &raw)) return false;
+        auto out = std::make_shared<std::string>();
+        // A null entry remembers that the file does not shrink.
+        if (deflate_parts({raw}, size, c, config_.compression_level, out.get())) {
+            encoded = std::move(out);
+        }
+        files_.insert(body->path(), key, stamp, encoded);
+    }
+    if (encoded == nullptr) return false;
+    http_response donor = http_response::shared(std::move(encoded));
+    resp.replace_body(donor);
+    return true;
+}
+
+#else  // !HAVE_ZLIB
+
+// compress_responses(true) is rejected by the webserver constructor on
+// builds without zlib, so these are never reached.
+bool response_compressor::encode_buffer(http_response&, coding) const { return false; }
+bool response_compressor::encode_stream(http_response&, coding) const { return false; }
+bool response_compressor::serve_cached(http_response&, coding) { return false; }
+
+#endif  // HAVE_ZLIB
+
+}  // namespace detail
+}  // namespace httpserver
@@ -29,11 +29,15 @@
 
 #include <microhttpd.h>
 
+#include <atomic>
+#include <cstdint>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "httpserver/cookie.hpp"
 #include "httpserver/create_webserver.hpp"
 #include "httpserver/http_response.hpp"
 #include "httpserver/http_utils.hpp"
@@ -42,10 +46,38 @@
 #include "httpserver/detail/error_pages.hpp"
 #include "httpserver/detail/hook_dispatcher.hpp"
 #include "httpserver/detail/connection_context.hpp"
+#include "httpserver/detail/stream_channel.hpp"
 
 namespace httpserver {
 namespace detail {
 
+namespace {
+
+// Identifies a response_materializer -- one per webserver -- for
+// frozen_response_state::defaults_owner. Never reused within the process,
+// unlike the address of a destroyed webserver's config; 0 means unowned.
+std::uint64_t next_server_id() noexcept {
+    static std::atomic<std::uint64_t> last{0};
+    return last.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}  // namespace
+
+response_materializer::response_materializer(error_pages& errors,
+                                             hook_dispatcher& hook_dispatch,
+                                             const std::string& digest_opaque,
+                                             const webserver_config& config) noexcept
+    : errors_(errors), hook_dispatch_(hook_dispatch),
+      digest_opaque_(digest_opaque), config_(config),
+      server_id_(next_server_id()),
+      files_(config.file_descriptor_cache_entries, config.file_descriptor_cache_ttl),
+      ranges_(config), etags_(config), compressor_(config),
+      // Same condition under which daemon_lifecycle sets
+      // MHD_USE_SUSPEND_RESUME; THREAD_PER_CONNECTION cannot suspend.
+      streams_can_suspend_(
+          (config.deferred_enabled || config.async_upload_max_in_flight != 0)
+          && config.start_method != http::http_utils::THREAD_PER_CONNECTION) {}
+
 // materialize_response: ask the body to produce a fresh MHD_Response with
 // no headers/footers/cookies attached. webserver_impl / response_materializer
 // are friends of http_response so body_ is reachable directly.
@@ -56,23 +88,116 @@ MHD_Response* response_materializer::materialize_response(http_response* resp) {
     return resp->body_->materialize();
 }
 
+namespace {
+
+// One Set-Cookie header per cookie, each rendered (or, for a frozen
+// cookie, copied) into a per-thread scratch buffer -- MHD copies the
+// value -- whose capacity amortises across responses, instead of a
+// fresh std::string per cookie.
+void add_set_cookie_headers(MHD_Response* response, const std::vector<cookie>& cookies) {
+    thread_local std::string scratch;
+    for (const auto& c : cookies) {
+        scratch.clear();
+        c.append_set_cookie_header(scratch);
+        MHD_add_response_header(response, "Set-Cookie", scratch.c_str());
+    }
+}
+
+// A frozen response that gained headers after conversion is materialized
+// afresh; it carries the frozen source's headers and footers (minus any it
+// overrides) and cookies, ahead of its own.
+void decorate_frozen_source(MHD_Response* response, const http_response& src,
+                            const http_response& resp) {
+    for (const auto& [k, v] : src.get_headers()) {
+        if (resp.get_headers().count(k) == 0) {
+            MHD_add_response_header(response, k.data(), v.data());
+        }
+    }
+    for (const auto& [k, v] : src.get_footers()) {
+        if (resp.get_footers().count(k) == 0) {
+            MHD_add_response_footer(response, k.data(), v.data());
+        }
+    }
+    add_set_cookie_headers(response, src.get_cookies_parsed());
+}
+
+}  // namespace
+
+MHD_Response* response_materializer::shared_frozen_response(const http_response& resp) const {
+    if (resp.kind() != body_kind::frozen) return nullptr;
+    if (!resp.get_headers().empty() || !resp.get_footers().empty()
+            || !resp.get_cookies_parsed().empty()) {
+        return nullptr;
+    }
+    const frozen_response_state& state =
+        static_cast<const frozen_response_body*>(resp.body_)->state();
+    if (config_.default_headers.empty()) return state.mhd;
+    return shared_frozen_with_defaults(state);
+}
+
+MHD_Response* response_materializer::shared_frozen_with_defaults(
+        const frozen_response_state& state) const noexcept {
+    if (MHD_Response* built = state.with_defaults.load(std::memory_order_acquire)) {
+        return state.defaults_owner.load(std::memory_order_relaxed) == server_id_
+            ? built : nullptr;
+    }
+    // The first webserver to claim the state builds it; a request racing
+    // the build takes the per-request path once.
+    std::uint64_t unowned = 0;
+    if (!state.defaults_owner.compare_exchange_strong(unowned, server_id_)) return nullptr;
+    MHD_Response* built = nullptr;
+    try {
+        built = state.body->materialize();
+        if (built != nullptr) {
+            decorate_mhd_response(built, state.source);
+            add_default_headers(built, state.source);
+        }
+    } catch (...) {
+        if (built != nullptr) MHD_destroy_response(built);
+        built = nullptr;
+    }
+    if (built == nullptr) {
+        // Give the claim back, so a later request (from any webserver)
+        // can build it instead of every one taking the per-request path.
+        state.defaults_owner.store(0, std::memory_order_relaxed);
+        return nullptr;
+    }
+    state.with_defaults.store(built, std::memory_order_release);
+    return built;
+}
+
+void response_materializer::add_default_headers(MHD_Response* response,
+                                                const http_response& resp) const {
+    const http_response* source = resp.kind() == body_kind::frozen
+        ? &static_cast<const frozen_response_body*>(resp.body_)->state().source
+        : nullptr;
+    for (const auto& [name, value] : config_.default_headers) {
+        if (resp.get_headers().contains(name)
+                || (source != nullptr && source->get_headers().contains(name))) {
+            continue;
+        }
+        MHD_add_response_header(response, name.c_str(), value.c_str());
+    }
+}
+
 // decorate_mhd_response: walk the response's header/footer/cookie maps and
-// attach each to the materialized MHD_Response.
+// attach each to the materialized MHD_Response. header_fields views are
+// always NUL-terminated, so they go to MHD without a copy.
 void response_materializer::decorate_mhd_response(MHD_Response* response,
                                                   const http_response& resp) {
+    if (resp.kind() == body_kind::frozen) {
+        decorate_frozen_source(response,
+            static_cast<const frozen_response_body*>(resp.body_)->state().source, resp);
+    }
     for (const auto& [k, v] : resp.get_headers()) {
-        MHD_add_response_header(response, k.c_str(), v.c_str());
+        MHD_add_response_header(response, k.data(), v.data());
     }
     for (const auto& [k, v] : resp.get_footers()) {
-        MHD_add_response_footer(response, k.c_str(), v.c_str());
+        MHD_add_response_footer(response, k.data(), v.data());
     }
     // Render from the structured cookie list (not the legacy cookies_ map)
-    // via cookie::to_set_cookie_header() so attributes propagate to the wire
-    // per RFC 6265 §4.1.
-    for (const auto& c : resp.get_cookies_parsed()) {
-        const std::string cookie_hdr = c.to_set_cookie_header();
-        MHD_add_response_header(response, "Set-Cookie", cookie_hdr.c_str());
-    }
+    // so attributes propagate to the wire per RFC 6265 §4.1.
+    add_set_cookie_headers(response, resp.get_cookies_parsed());
 }
 
 struct MHD_Response* response_materializer::get_raw_response_with_fallback(
@@ -203,10 +328,55 @@ int response_materializer::queue_response_dispatching_kind(
         connection, conn->response->get_status(), raw_response));
 }
 
+void response_materializer::open_through_cache(http_response& resp) noexcept {
+    if (files_.max_entries() == 0 || resp.kind() != body_kind::file) return;
+    static_cast<file_response_body*>(resp.body_)->ensure_open(&files_);
+}
+
+void response_materializer::attach_stream(MHD_Connection* connection,
+                                          http_response& resp) noexcept {
+    if (resp.kind() != body_kind::stream) return;
+    static_cast<stream_response_body*>(resp.body_)->channel().attach(
+        connection, streams_can_suspend_, &streams_);
+}
+
 MHD_Result response_materializer::materialize_and_queue_response(
         MHD_Connection* connection,
         detail::connection_context* conn,
         http_resource* resource) {
+    prepare_response(connection, conn);
+    return queue_prepared_response(connection, conn, resource);
+}
+
+void response_materializer::prepare_response(MHD_Connection* connection,
+                                             detail::connection_context* conn) {
+    if (conn->response) {
+        open_through_cache(*conn->response);
+        attach_stream(connection, *conn->response);
+    }
+    if (conn->response && conn->request) {
+        // Ranges and ETags first: a 206 / 304 / 416 is never compressed,
+        // and an ETag is hashed from the bytes the handler returned.
+        ranges_.apply(*conn->request, *conn->response);
+        etags_.apply(*conn->request, *conn->response);
+        compressor_.apply(*conn->request, *conn->response);
+    }
+}
+
+MHD_Result response_materializer::queue_prepared_response(
+        MHD_Connection* connection,
+        detail::connection_context* conn,
+        http_resource* resource) {
+    // A frozen response was materialized and decorated by freeze(). MHD
+    // takes its own reference when queuing, and the frozen state keeps
+    // ours, so there is nothing to destroy afterwards.
+    if (conn->response) {
+        if (MHD_Response* shared = shared_frozen_response(*conn->response)) {
+            int to_ret = queue_response_dispatching_kind(connection, conn, shared);
+            hook_dispatch_.fire_response_sent_gated(conn, resource);
+            return (MHD_Result) to_ret;
+        }
+    }
     struct MHD_Response* raw_response = get_raw_response_with_fallback(conn);
     if (raw_response == nullptr) {
         // Belt-and-suspenders: even get_raw_response_with_fallback's own
@@ -229,6 +399,7 @@ MHD_Result response_materializer::materialize_and_queue_response(
         }
     }
     decorate_mhd_response(raw_response, *conn->response);
+    add_default_headers(raw_response, *conn->response);
     int to_ret = queue_response_dispatching_kind(connection, conn, raw_response);
     // Fire response_sent AFTER MHD_queue_response (status/bytes reflect what
     // was queued) and BEFORE MHD_destroy_response (ctx.response backed by live
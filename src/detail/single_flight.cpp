@@ -0,0 +1,131 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/single_flight.hpp"
+
+#include <microhttpd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "httpserver/http_response.hpp"
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+// Keys are per resource: the leader holds the resource alive while its
+// flight is in the air, so its address cannot be reused meanwhile.
+std::string flight_key(const http_resource* resource, const std::string& key) {
+    std::string k = std::to_string(reinterpret_cast<std::uintptr_t>(resource));
+    k.append("\n").append(key);
+    return k;
+}
+
+// Freeze @p resp in place and keep a copy in @p f. A body kind freeze()
+// rejects is left alone; a failed materialization leaves resp empty,
+// which the materializer answers with its internal-error fallback.
+void share(single_flight::flight& f, http_response& resp) {
+    try {
+        f.result.emplace(std::move(resp).freeze());
+    } catch (...) {
+        return;
+    }
+    resp = *f.result;
+}
+
+}  // namespace
+
+void single_flight::ticket::leave() noexcept {
+    if (joined == nullptr || connection == nullptr) return;
+    std::lock_guard<std::mutex> lock(joined->mutex);
+    auto& parked = joined->parked;
+    parked.erase(std::remove(parked.begin(), parked.end(), connection), parked.end());
+    connection = nullptr;
+}
+
+single_flight::role single_flight::join(const std::shared_ptr<http_resource>& resource,
+                                        const std::string& key,
+                                        MHD_Connection* connection, ticket* t) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = flights_.try_emplace(flight_key(resource.get(), key));
+        if (inserted) {
+            it->second = std::make_shared<flight>();
+            it->second->resource = resource;
+            t->joined = it->second;
+            t->key = it->first;
+            return role::lead;
+        }
+        t->joined = it->second;
+    }
+    flight& f = *t->joined;
+    std::unique_lock<std::mutex> lock(f.mutex);
+    // The leader may have landed between the two locks.
+    if (f.landed) return role::follow;
+    if (mode_ == mode::block) {
+        ++f.blocked;
+        f.cv.wait(lock, [&f] { return f.landed; });
+        return role::follow;
+    }
+    // Suspend under f.mutex: land() resumes under the same lock, so the
+    // resume can never overtake the suspend.
+    f.parked.push_back(connection);
+    t->connection = connection;
+    MHD_suspend_connection(connection);
+    return role::parked;
+}
+
+void single_flight::land(ticket* t, http_response* resp) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flights_.erase(t->key);
+    }
+    std::shared_ptr<flight> f = std::move(t->joined);
+    *t = ticket{};
+    std::lock_guard<std::mutex> lock(f->mutex);
+    f->landed = true;
+    if (resp != nullptr && (!f->parked.empty() || f->blocked > 0)) share(*f, *resp);
+    for (MHD_Connection* c : f->parked) MHD_resume_connection(c);
+    f->parked.clear();
+    f->cv.notify_all();
+}
+
+std::optional<frozen_response> single_flight::take(ticket* t) {
+    std::shared_ptr<flight> f = std::move(t->joined);
+    *t = ticket{};
+    std::lock_guard<std::mutex> lock(f->mutex);
+    return f->result;
+}
+
+std::size_t single_flight::in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flights_.size();
+}
+
+}  // namespace detail
+}  // namespace httpserver
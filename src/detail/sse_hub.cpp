@@ -0,0 +1,143 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/sse_hub.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "httpserver/detail/stream_channel.hpp"
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+void append_field(std::string* out, std::string_view name, std::string_view value) {
+    if (value.find_first_of(std::string_view("\r\n\0", 3)) != std::string_view::npos) {
+        throw std::invalid_argument("sse_channel: event and id must not contain CR, LF or NUL");
+    }
+    out->append(name).append(": ").append(value).push_back('\n');
+}
+
+}  // namespace
+
+sse_hub::sse_hub(std::size_t replay_events, std::chrono::milliseconds keep_alive)
+    : replay_events_(replay_events), keep_alive_(keep_alive) {
+    if (keep_alive_.count() > 0) timer_ = std::thread([this] { keep_alive_loop(); });
+}
+
+sse_hub::~sse_hub() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (timer_.joinable()) timer_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& channel : subscribers_) channel->finish();
+}
+
+std::string sse_hub::encode(std::string_view data, std::string_view event,
+                            std::string_view id) {
+    std::string out;
+    out.reserve(data.size() + event.size() + id.size() + 24);
+    if (!event.empty()) append_field(&out, "event", event);
+    if (!id.empty()) append_field(&out, "id", id);
+    // One data line per line of @p data; CRLF, CR and LF all end a line.
+    for (std::size_t start = 0;;) {
+        std::size_t end = data.find_first_of("\r\n", start);
+        out.append("data: ").append(data.substr(start, end - start)).push_back('\n');
+        if (end == std::string_view::npos) break;
+        if (data[end] == '\r' && end + 1 < data.size() && data[end + 1] == '\n') ++end;
+        start = end + 1;
+    }
+    out.push_back('\n');
+    return out;
+}
+
+void sse_hub::subscribe(std::shared_ptr<stream_channel> channel,
+                        std::string_view last_event_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!last_event_id.empty()) {
+        auto it = std::find_if(replay_.rbegin(), replay_.rend(),
+                               [&](const replay_entry& e) { return e.id == last_event_id; });
+        // it.base() is the entry after the match (end() when none matched).
+        for (auto next = it.base(); it != replay_.rend() && next != replay_.end(); ++next) {
+            if (!channel->push(next->frame)) {
+                channel->abort();
+                return;
+            }
+        }
+    }
+    subscribers_.push_back(std::move(channel));
+}
+
+void sse_hub::publish(std::shared_ptr<const std::string> frame, std::string id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (replay_events_ > 0) {
+        if (replay_.size() == replay_events_) replay_.pop_front();
+        replay_.push_back({std::move(id), frame});
+    }
+    published_ = true;
+    broadcast_locked(frame);
+}
+
+std::size_t sse_hub::subscribers() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    prune_locked();
+    return subscribers_.size();
+}
+
+void sse_hub::broadcast_locked(const std::shared_ptr<const std::string>& frame) {
+    std::erase_if(subscribers_, [&frame](const std::shared_ptr<stream_channel>& channel) {
+        if (channel->push(frame)) return false;
+        // Closed already, or too slow: its client reconnects and resumes
+        // from Last-Event-ID.
+        channel->abort();
+        return true;
+    });
+}
+
+void sse_hub::prune_locked() {
+    std::erase_if(subscribers_, [](const std::shared_ptr<stream_channel>& channel) {
+        return channel->closed();
+    });
+}
+
+void sse_hub::keep_alive_loop() {
+    const auto comment = std::make_shared<const std::string>(":\n\n");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, keep_alive_, [this] { return stopping_; })) {
+        if (!published_) broadcast_locked(comment);
+        published_ = false;
+    }
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -0,0 +1,130 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/static_directory_index.hpp"
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "httpserver/detail/http_date.hpp"
+#include "httpserver/detail/mime_types.hpp"
+#include "httpserver/detail/range_responder.hpp"
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+bool is_regular(const std::string& path, struct stat* sb) {
+    return ::lstat(path.c_str(), sb) == 0 && S_ISREG(sb->st_mode);
+}
+
+}  // namespace
+
+static_directory_index::static_directory_index(std::string root,
+                                               std::vector<std::string> index_files,
+                                               std::size_t max_entries,
+                                               clock::duration ttl)
+    : root_(root.ends_with('/') ? root.substr(0, root.size() - 1) : std::move(root)),
+      index_files_(std::move(index_files)),
+      max_entries_(max_entries),
+      ttl_(ttl) {
+}
+
+std::shared_ptr<const static_file_info> static_directory_index::lookup(const std::string& rel) {
+    if (auto hit = find(rel)) return hit;
+    auto info = load(rel);
+    if (info && max_entries_ > 0) insert(rel, info);
+    return info;
+}
+
+std::size_t static_directory_index::entries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return list_.size();
+}
+
+std::shared_ptr<const static_file_info> static_directory_index::load(const std::string& rel) const {
+    std::string path = root_ + rel;
+    struct stat sb;
+    if (::lstat(path.c_str(), &sb) != 0) return nullptr;
+    if (S_ISDIR(sb.st_mode)) {
+        if (!path.ends_with('/')) path.push_back('/');
+        const std::size_t dir_size = path.size();
+        bool found = false;
+        for (const std::string& name : index_files_) {
+            path.resize(dir_size);
+            path += name;
+            if ((found = is_regular(path, &sb))) break;
+        }
+        if (!found) return nullptr;
+    } else if (!S_ISREG(sb.st_mode)) {
+        return nullptr;
+    }
+    const auto etag = range_responder::file_etag(file_mtime_ns(sb),
+                                                 static_cast<std::uint64_t>(sb.st_size));
+    const auto content_type = mime_type_for(path);
+    return std::make_shared<const static_file_info>(static_file_info{
+        std::move(path), content_type, etag, format_imf_fixdate(sb.st_mtime)});
+}
+
+std::shared_ptr<const static_file_info> static_directory_index::find(const std::string& rel) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(rel);
+    if (it == map_.end()) return nullptr;
+    if (clock::now() >= it->second->expires) {
+        list_.erase(it->second);
+        map_.erase(it);
+        return nullptr;
+    }
+    list_.splice(list_.begin(), list_, it->second);
+    return it->second->info;
+}
+
+void static_directory_index::insert(const std::string& rel,
+                                    std::shared_ptr<const static_file_info> info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Two threads that missed on the same path both insert; the later
+    // lstat wins.
+    if (auto it = map_.find(rel); it != map_.end()) {
+        list_.erase(it->second);
+        map_.erase(it);
+    }
+    while (list_.size() >= max_entries_) {
+        map_.erase(list_.back().rel);
+        list_.pop_back();
+    }
+    list_.push_front(entry{rel, std::move(info), clock::now() + ttl_});
+    try {
+        map_.emplace(list_.front().rel, list_.begin());
+    } catch (...) {
+        list_.pop_front();
+        throw;
+    }
+}
+
+}  // namespace detail
+}  // namespace httpserver
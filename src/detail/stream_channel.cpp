@@ -0,0 +1,215 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/stream_channel.hpp"
+
+#include <microhttpd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace httpserver {
+namespace detail {
+
+stream_channel::stream_channel(std::size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) {
+        throw std::invalid_argument("stream_writer: buffer size must be > 0");
+    }
+    ring_ = std::make_unique<char[]>(capacity_);
+}
+
+stream_channel::~stream_channel() = default;
+
+std::size_t stream_channel::try_write(std::string_view data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_ || aborted_ || detached_) return 0;
+    const std::size_t n = std::min(data.size(), capacity_ - size_);
+    if (n == 0) return 0;
+    // At most two copies: up to the end of the ring, then from its start.
+    const std::size_t tail = (head_ + size_) % capacity_;
+    const std::size_t first = std::min(n, capacity_ - tail);
+    std::memcpy(ring_.get() + tail, data.data(), first);
+    std::memcpy(ring_.get(), data.data() + first, n - first);
+    size_ += n;
+    wake_locked();
+    return n;
+}
+
+bool stream_channel::write(std::string_view data) {
+    while (!data.empty()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return size_ < capacity_ || finished_ || aborted_ || detached_;
+            });
+        }
+        const std::size_t n = try_write(data);
+        if (n == 0) return false;
+        data.remove_prefix(n);
+    }
+    return true;
+}
+
+bool stream_channel::push(std::shared_ptr<const std::string> frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_ || aborted_ || detached_) return false;
+    if (!frames_.empty() && frame->size() > capacity_ - std::min(capacity_, frame_bytes_)) {
+        return false;
+    }
+    frame_bytes_ += frame->size();
+    frames_.push_back(std::move(frame));
+    wake_locked();
+    return true;
+}
+
+void stream_channel::finish() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) return;
+    finished_ = true;
+    wake_locked();
+}
+
+bool stream_channel::closed() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aborted_ || detached_;
+}
+
+ssize_t stream_channel::read(char* buf, std::size_t max) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (aborted_) return MHD_CONTENT_READER_END_WITH_ERROR;
+    if (!frames_.empty()) return static_cast<ssize_t>(read_frames_locked(buf, max));
+    if (size_ == 0) return finished_ ? MHD_CONTENT_READER_END_OF_STREAM : 0;
+    const std::size_t n = std::min(max, size_);
+    const std::size_t first = std::min(n, capacity_ - head_);
+    std::memcpy(buf, ring_.get() + head_, first);
+    std::memcpy(buf + first, ring_.get(), n - first);
+    head_ = (head_ + n) % capacity_;
+    size_ -= n;
+    // Room again for a writer blocked in write().
+    cv_.notify_all();
+    return static_cast<ssize_t>(n);
+}
+
+std::size_t stream_channel::read_frames_locked(char* buf, std::size_t max) noexcept {
+    std::size_t n = 0;
+    while (n < max && !frames_.empty()) {
+        const std::string& front = *frames_.front();
+        const std::size_t take = std::min(max - n, front.size() - frame_offset_);
+        std::memcpy(buf + n, front.data() + frame_offset_, take);
+        n += take;
+        frame_offset_ += take;
+        if (frame_offset_ == front.size()) {
+            frames_.pop_front();
+            frame_offset_ = 0;
+        }
+    }
+    frame_bytes_ -= n;
+    return n;
+}
+
+bool stream_channel::park() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (readable_locked()) return false;
+    if (can_suspend_ && connection_ != nullptr) {
+        suspended_ = true;
+        MHD_suspend_connection(connection_);
+        return true;
+    }
+    cv_.wait(lock, [this] { return readable_locked(); });
+    return false;
+}
+
+void stream_channel::attach(MHD_Connection* connection, bool can_suspend,
+                            stream_registry* registry) noexcept {
+    bool tracked = true;
+    try {
+        if (registry != nullptr) tracked = registry->add(this);
+    } catch (...) {
+        tracked = false;
+    }
+    // Untracked, a parked connection could hold up webserver::stop():
+    // fail the response instead.
+    if (!tracked) registry = nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborted_ = aborted_ || !tracked;
+    connection_ = connection;
+    can_suspend_ = can_suspend;
+    registry_ = registry;
+}
+
+void stream_channel::detach() noexcept {
+    stream_registry* registry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        detached_ = true;
+        suspended_ = false;
+        connection_ = nullptr;
+        registry = std::exchange(registry_, nullptr);
+        cv_.notify_all();
+    }
+    if (registry != nullptr) registry->remove(this);
+}
+
+void stream_channel::abort() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborted_ = true;
+    wake_locked();
+}
+
+void stream_channel::wake_locked() noexcept {
+    if (suspended_) {
+        suspended_ = false;
+        MHD_resume_connection(connection_);
+    }
+    cv_.notify_all();
+}
+
+bool stream_registry::add(stream_channel* channel) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return false;
+    channels_.insert(channel);
+    return true;
+}
+
+void stream_registry::remove(stream_channel* channel) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    channels_.erase(channel);
+}
+
+void stream_registry::close() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    for (stream_channel* channel : channels_) channel->abort();
+}
+
+void stream_registry::reopen() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+}
+
+}  // namespace detail
+}  // namespace httpserver
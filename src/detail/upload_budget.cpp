@@ -0,0 +1,46 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/upload_budget.hpp"
+
+#include <string>
+
+#include "httpserver/http_response.hpp"
+#include "httpserver/http_utils.hpp"
+
+namespace httpserver {
+
+using httpserver::http::http_utils;
+
+namespace detail {
+
+http_response upload_budget::rejection_response(kind k) {
+    if (k == kind::disk) {
+        return http_response::string(std::string{"Insufficient Storage"})
+            .with_header(http_utils::http_header_retry_after, "1")
+            .with_status(http_utils::http_insufficient_storage);
+    }
+    return http_response::string(std::string{"Service Unavailable"})
+        .with_header(http_utils::http_header_retry_after, "1")
+        .with_status(http_utils::http_service_unavailable);
+}
+
+}  // namespace detail
+}  // namespace httpserver
@@ -27,19 +27,27 @@
 
 #include "httpserver/detail/upload_pipeline.hpp"
 
+#include <fcntl.h>
 #include <microhttpd.h>
 #include <unistd.h>
 
 #include <cstring>
+#include <exception>
 #include <fstream>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 
 #include "httpserver/create_webserver.hpp"
 #include "httpserver/file_info.hpp"
 #include "httpserver/http_request.hpp"
+#include "httpserver/http_resource.hpp"
+#include "httpserver/http_response.hpp"
 #include "httpserver/http_utils.hpp"
 #include "httpserver/detail/connection_context.hpp"
+#include "httpserver/detail/upload_budget.hpp"
+#include "httpserver/detail/upload_writer.hpp"
 
 namespace httpserver {
 
@@ -47,6 +55,45 @@ using httpserver::http::http_utils;
 
 namespace detail {
 
+namespace {
+
+// Charge @p size bytes of @p k to the request's upload budget. On failure
+// the request is short-circuited to 503 / 507 and the caller returns
+// MHD_NO so the form parser stops delivering fields.
+bool charge_or_reject(connection_context* conn, upload_budget::kind k, size_t size) {
+    if (conn->budget.reserve(k, size)) return true;
+    conn->short_circuit(upload_budget::rejection_response(k));
+    return false;
+}
+
+// Hand @p chunk to the request's upload target. A refusal -- false or an
+// exception, which must not escape the C post-iterator callback -- ends
+// the request with 500 before the handler runs.
+bool deliver_upload_chunk(connection_context* conn, const upload_chunk& chunk) {
+    bool accepted = false;
+    try {
+        accepted = conn->upload_target->on_upload_chunk(*conn->request, chunk);
+    } catch (const std::exception&) {
+        accepted = false;
+    }
+    if (accepted) return true;
+    conn->short_circuit(http_response::string(std::string{"Internal Server Error"})
+        .with_status(http_utils::http_internal_server_error));
+    return false;
+}
+
+// FILE_UPLOAD_STREAM: true when a chunk begins a part other than the open
+// one -- the field or file name changed, or the parser restarted at offset
+// 0 for a same-named part.
+bool starts_new_part(const connection_context* conn, const char* key,
+                     const char* filename, uint64_t off) {
+    if (conn->upload_filename.empty()) return false;
+    return conn->upload_key != key || conn->upload_filename != filename
+        || (off == 0 && conn->upload_offset != 0);
+}
+
+}  // namespace
+
 MHD_Result upload_pipeline::handle_post_form_arg(detail::connection_context* conn,
         const char* key, const char* data, size_t size, uint64_t off) {
     // MHD may invoke the post iterator with a null key on a continuation
@@ -59,12 +106,15 @@ MHD_Result upload_pipeline::handle_post_form_arg(detail::connection_context* con
     if (key == nullptr) {
         return MHD_YES;
     }
+    if (!charge_or_reject(conn, upload_budget::kind::memory, size)) return MHD_NO;
     // A non-zero @p off means MHD is feeding a continuation chunk of a
-    // previously-started value, so append rather than replace.
+    // previously-started value, so append rather than replace. The
+    // (ptr, size) overloads copy straight into the arena-backed argument
+    // storage, with no std::string temporary in between.
     if (off > 0) {
-        conn->request->grow_last_arg(key, std::string(data, size));
+        conn->request->grow_last_arg(key, data, size);
     } else {
-        conn->request->set_arg(key, std::string(data, size));
+        conn->request->set_arg(key, data, size);
     }
     return MHD_YES;
 }
@@ -113,6 +163,28 @@ void upload_pipeline::manage_upload_stream(detail::connection_context* conn,
     }
 }
 
+MHD_Result upload_pipeline::queue_file_chunk(detail::connection_context* conn,
+        const char* filename, const char* key, const http::file_info& file,
+        const char* data, size_t size) const {
+    // Same rotation rule as manage_upload_stream. The previous file_handle
+    // stays alive in its queued jobs, so switching files never waits for
+    // the writer. No O_APPEND: pwrite() places each chunk by offset.
+    auto& s = conn->upload_async;
+    if (s == nullptr) s = std::make_shared<upload_writer::stream>();
+    if (s->file == nullptr || s->key != key || s->filename != filename) {
+        const int fd = ::open(file.get_file_system_file_name().c_str(),
+                              O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+        if (fd < 0) return MHD_NO;
+        s->file = std::make_shared<upload_writer::file_handle>(fd);
+        s->key = key;
+        s->filename = filename;
+    }
+    if (size > 0 && !writer_.enqueue(s, file.get_file_size(), data, size)) {
+        return MHD_NO;
+    }
+    return MHD_YES;
+}
+
 MHD_Result upload_pipeline::process_file_upload(detail::connection_context* conn,
         const char* key, const char* filename, const char* content_type,
         const char* transfer_encoding, const char* data, size_t size) const {
@@ -123,20 +195,66 @@ MHD_Result upload_pipeline::process_file_upload(detail::connection_context* conn
             return MHD_NO;
         }
     }
-    manage_upload_stream(conn, filename, key, file);
-    if (size > 0) {
-        conn->upload_ostrm->write(data, size);
-        if (!conn->upload_ostrm->good()) return MHD_NO;
+    if (!charge_or_reject(conn, upload_budget::kind::disk, size)) return MHD_NO;
+    if (writer_.enabled()) {
+        MHD_Result r = queue_file_chunk(conn, filename, key, file, data, size);
+        if (r != MHD_YES) return r;
+    } else {
+        manage_upload_stream(conn, filename, key, file);
+        if (size > 0) {
+            conn->upload_ostrm->write(data, size);
+            if (!conn->upload_ostrm->good()) return MHD_NO;
+        }
     }
     file.grow_file_size(size);
     return MHD_YES;
 }
 
+bool upload_pipeline::end_streamed_part(detail::connection_context* conn) {
+    if (conn->upload_filename.empty() || conn->skip_handler) return true;
+    const upload_chunk last{conn->upload_key, conn->upload_filename,
+        conn->upload_content_type, {}, conn->upload_offset, /*is_last=*/true};
+    const bool ok = deliver_upload_chunk(conn, last);
+    conn->upload_key.clear();
+    conn->upload_filename.clear();
+    conn->upload_content_type.clear();
+    conn->upload_offset = 0;
+    return ok;
+}
+
+MHD_Result upload_pipeline::stream_file_chunk(detail::connection_context* conn,
+        const char* key, const char* filename, const char* content_type,
+        const char* data, size_t size, uint64_t off) {
+    // No route (or a disallowed method): finalize_answer answers 404 /
+    // 405, so the bytes have nowhere to go.
+    if (conn->upload_target == nullptr) return MHD_YES;
+    if (starts_new_part(conn, key, filename, off) && !end_streamed_part(conn)) {
+        return MHD_NO;
+    }
+    if (conn->upload_filename.empty()) {
+        conn->upload_key = key;
+        conn->upload_filename = filename;
+        conn->upload_content_type = content_type != nullptr ? content_type : "";
+    }
+    if (size == 0) return MHD_YES;
+    const upload_chunk chunk{conn->upload_key, conn->upload_filename,
+        conn->upload_content_type,
+        std::as_bytes(std::span<const char>(data, size)),
+        conn->upload_offset, /*is_last=*/false};
+    conn->upload_offset += size;
+    return deliver_upload_chunk(conn, chunk) ? MHD_YES : MHD_NO;
+}
+
 MHD_Result upload_pipeline::iterate_file(detail::connection_context* conn,
         const char* key, const char* filename, const char* content_type,
-        const char* transfer_encoding, const char* data, size_t size) {
+        const char* transfer_encoding, const char* data, size_t size,
+        uint64_t off) {
+    if (config_.file_upload_target == FILE_UPLOAD_STREAM && *filename != '\0') {
+        return stream_file_chunk(conn, key, filename, content_type, data, size, off);
+    }
     try {
         if (config_.file_upload_target != FILE_UPLOAD_DISK_ONLY) {
+            if (!charge_or_reject(conn, upload_budget::kind::memory, size)) return MHD_NO;
             conn->request->set_arg_flat(key,
                 std::string(conn->request->get_arg(key)) + std::string(data, size));
         }
@@ -0,0 +1,144 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/detail/upload_writer.hpp"
+
+#include <microhttpd.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace httpserver {
+namespace detail {
+
+namespace {
+
+// pwrite() the whole buffer, retrying short writes and EINTR.
+bool write_fully(int fd, const char* data, std::size_t size, std::uint64_t offset) {
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+upload_writer::file_handle::~file_handle() {
+    if (fd >= 0) ::close(fd);
+}
+
+upload_writer::upload_writer(std::size_t max_in_flight_bytes, bool can_suspend)
+    : max_in_flight_(max_in_flight_bytes), can_suspend_(can_suspend) {
+    if (enabled()) thread_ = std::thread(&upload_writer::run, this);
+}
+
+upload_writer::~upload_writer() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    // run() drains the queue before returning, so no accepted write is lost.
+    thread_.join();
+}
+
+bool upload_writer::enqueue(const std::shared_ptr<stream>& s, std::uint64_t offset,
+                            const char* data, std::size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (s->failed) return false;
+        ++s->pending;
+    }
+    in_flight_.fetch_add(size, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(job{s, s->file, offset, std::string(data, size)});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+template <typename Pred>
+bool upload_writer::park(stream& s, MHD_Connection* connection, Pred done) {
+    std::unique_lock<std::mutex> lock(s.mutex);
+    if (done()) return false;
+    if (!can_suspend_) {
+        s.cv.wait(lock, done);
+        return false;
+    }
+    // Suspend under s.mutex: complete() resumes under the same lock, so the
+    // resume can never overtake the suspend.
+    s.suspended = connection;
+    MHD_suspend_connection(connection);
+    return true;
+}
+
+bool upload_writer::throttle(stream& s, MHD_Connection* connection) {
+    return park(s, connection, [this, &s] {
+        return s.pending == 0 || in_flight_bytes() <= max_in_flight_;
+    });
+}
+
+bool upload_writer::wait_for_flush(stream& s, MHD_Connection* connection) {
+    return park(s, connection, [&s] { return s.pending == 0; });
+}
+
+void upload_writer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        job j = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        const bool ok = write_fully(j.file->fd, j.bytes.data(), j.bytes.size(), j.offset);
+        complete(j, ok);
+        lock.lock();
+    }
+}
+
+void upload_writer::complete(const job& j, bool ok) {
+    in_flight_.fetch_sub(j.bytes.size(), std::memory_order_relaxed);
+    stream& s = *j.owner;
+    std::lock_guard<std::mutex> lock(s.mutex);
+    --s.pending;
+    if (!ok) s.failed = true;
+    const bool ready = s.pending == 0 || in_flight_bytes() <= max_in_flight_;
+    if (ready && s.suspended != nullptr) {
+        MHD_resume_connection(s.suspended);
+        s.suspended = nullptr;
+    }
+    s.cv.notify_all();
+}
+
+}  // namespace detail
+}  // namespace httpserver
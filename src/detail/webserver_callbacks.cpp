@@ -574,7 +574,7 @@ MHD_Result webserver_impl::post_iterator(void *cls, enum MHD_ValueKind kind,
         return upload_pipeline::handle_post_form_arg(conn, key, data, size, off);
     }
     return conn->ws->impl_->upload_.iterate_file(
-        conn, key, filename, content_type, transfer_encoding, data, size);
+        conn, key, filename, content_type, transfer_encoding, data, size, off);
 }
 
 }  // namespace detail
@@ -589,8 +589,6 @@ MHD_Result webserver_impl::post_iterator(void *cls, enum MHD_ValueKind kind,
 
 namespace detail {
 
-namespace {
-
 // NOTE: the caller (should_skip_auth) must receive an already-unescaped
 // path (i.e., no %XX sequences remain). libhttpserver's base_unescaper()
 // (called in answer_to_connection) runs before should_skip_auth, so this
@@ -653,8 +651,6 @@ std::string normalize_path(std::string_view path) {
     return out;
 }
 
-}  // namespace
-
 // Pre-normalize each auth_skip_paths entry once at
 // webserver construction time.  Entries ending in "/*" keep their
 // wildcard suffix; the prefix before the wildcard is normalized.
@@ -87,6 +87,20 @@ void for_each_requested_method(method_set methods, Fn&& fn) {
     }
 }
 
+// Followers park with MHD_suspend_connection when the daemon allows it
+// (the condition daemon_lifecycle sets MHD_USE_SUSPEND_RESUME under) and
+// block their own thread under THREAD_PER_CONNECTION; anywhere else a
+// blocked follower would stall its worker's other connections.
+detail::single_flight::mode single_flight_mode(const webserver_config& config) {
+    if (config.start_method == http::http_utils::THREAD_PER_CONNECTION) {
+        return detail::single_flight::mode::block;
+    }
+    if (config.deferred_enabled || config.async_upload_max_in_flight != 0) {
+        return detail::single_flight::mode::park;
+    }
+    return detail::single_flight::mode::off;
+}
+
 }  // namespace
 
 namespace detail {
@@ -135,13 +149,19 @@ webserver_impl::webserver_impl(webserver* parent, MHD_socket bind_socket_val)
 #endif  // HAVE_WEBSOCKET
       errors_(parent->config), hooks_dispatch_(hooks_, parent->config),
       response_mat_(errors_, hooks_dispatch_, digest_opaque_, parent->config),
-      upload_(parent->config),
-      dispatcher_(routes_, hooks_dispatch_, errors_, response_mat_,
+      budget_(parent->config.upload_memory_budget, parent->config.upload_disk_budget),
+      response_cache_(parent->config.response_cache_size, parent->config.response_cache_vary,
+                      parent->config.response_cache_key),
+      upload_writer_(parent->config.async_upload_max_in_flight,
+                     parent->config.start_method != http::http_utils::THREAD_PER_CONNECTION),
+      flights_(single_flight_mode(parent->config)),
+      upload_(parent->config, upload_writer_),
+      dispatcher_(routes_, hooks_dispatch_, errors_, response_mat_, response_cache_, flights_,
 #ifdef HAVE_WEBSOCKET
                   ws_upgrader_,
 #endif  // HAVE_WEBSOCKET
                   parent->config),
-      pipeline_(hooks_dispatch_, dispatcher_, parent->config) {
+      pipeline_(hooks_dispatch_, dispatcher_, upload_writer_, budget_, parent->config) {
     // Guard against null parent: the dispatch helpers (not_found_page,
     // method_not_allowed_page, internal_error_page, etc.) read the const
     // config bag on `parent` and will dereference this pointer on every
@@ -385,6 +385,10 @@ void http_request::grow_last_arg(const std::string& key, const std::string& valu
     impl_->grow_last_arg(key, value);
 }
 
+void http_request::grow_last_arg(const char* key, const char* value, size_t size) {
+    impl_->grow_last_arg(key, std::string_view(value, size));
+}
+
 void http_request::set_file_cleanup_callback(file_cleanup_callback_ptr callback) {
     impl_->file_cleanup_callback_ = callback;
 }
@@ -116,6 +116,12 @@ void http_response::adopt_body_from(http_response& other) noexcept {
     other.kind_ = body_kind::empty;
 }
 
+void http_response::replace_body(http_response& donor) noexcept {
+    destroy_body();
+    kind_ = donor.kind_;
+    adopt_body_from(donor);
+}
+
 // -----------------------------------------------------------------------
 // Destructor.
 //
@@ -130,8 +136,8 @@ http_response::~http_response() {
 // -----------------------------------------------------------------------
 // Move constructor.
 //
-// noexcept because every member's move is noexcept (header_map is a
-// std::map, std::map move is noexcept; std::byte[64] is trivially
+// noexcept because every member's move is noexcept (the header_fields
+// stores and the header_map cookie mirror move noexcept; std::byte[64] is trivially
 // movable; per-subclass body move ctors are noexcept by static_assert in
 // detail/response_body.hpp).
 // -----------------------------------------------------------------------
@@ -191,12 +197,12 @@ namespace {
 void validate_http_field(std::string_view setter_name,
                          std::string_view key,
                          std::string_view value) {
-    if (key.find_first_of(detail::kForbiddenFieldChars) != std::string_view::npos) {
+    if (detail::has_forbidden_field_char(key)) {
         throw std::invalid_argument(
             std::string(setter_name) +
             ": key contains forbidden control character (CR, LF, or NUL)");
     }
-    if (value.find_first_of(detail::kForbiddenFieldChars) != std::string_view::npos) {
+    if (detail::has_forbidden_field_char(value)) {
         throw std::invalid_argument(
             std::string(setter_name) +
             ": value contains forbidden control character (CR, LF, or NUL)");
@@ -204,14 +210,19 @@ void validate_http_field(std::string_view setter_name,
 }
 }  // namespace
 
-void http_response::do_set_header(std::string key, std::string value) {
+void http_response::do_set_header(std::string_view key, std::string_view value) {
     validate_http_field("with_header", key, value);
-    headers_.insert_or_assign(std::move(key), std::move(value));
+    headers_.insert_or_assign(key, value);
 }
 
-void http_response::do_set_footer(std::string key, std::string value) {
+void http_response::do_set_header(http::static_text key, std::string_view value) {
+    validate_http_field("with_header", {}, value);
+    headers_.insert_or_assign(key, value);
+}
+
+void http_response::do_set_footer(std::string_view key, std::string_view value) {
     validate_http_field("with_footer", key, value);
-    footers_.insert_or_assign(std::move(key), std::move(value));
+    footers_.insert_or_assign(key, value);
 }
 
 void http_response::do_set_cookie(std::string key, std::string value) {
@@ -287,25 +298,50 @@ void http_response::do_set_status(int code) {
 
 http_response& http_response::with_header(std::string key,
                                           std::string value) & {
-    do_set_header(std::move(key), std::move(value));
+    do_set_header(key, value);
     return *this;
 }
 
 http_response&& http_response::with_header(std::string key,
                                            std::string value) && {
-    do_set_header(std::move(key), std::move(value));
+    do_set_header(key, value);
+    return std::move(*this);
+}
+
+http_response& http_response::with_header(http::static_text key,
+                                          std::string value) & {
+    do_set_header(key, value);
+    return *this;
+}
+
+http_response&& http_response::with_header(http::static_text key,
+                                           std::string value) && {
+    do_set_header(key, value);
+    return std::move(*this);
+}
+
+// Both halves were validated when the static_text was constant-evaluated.
+http_response& http_response::with_header(http::static_text key,
+                                          http::static_text value) & {
+    headers_.insert_or_assign(key, value);
+    return *this;
+}
+
+http_response&& http_response::with_header(http::static_text key,
+                                           http::static_text value) && {
+    headers_.insert_or_assign(key, value);
     return std::move(*this);
 }
 
 http_response& http_response::with_footer(std::string key,
                                           std::string value) & {
-    do_set_footer(std::move(key), std::move(value));
+    do_set_footer(key, value);
     return *this;
 }
 
 http_response&& http_response::with_footer(std::string key,
                                            std::string value) && {
-    do_set_footer(std::move(key), std::move(value));
+    do_set_footer(key, value);
     return std::move(*this);
 }
 
@@ -355,8 +391,9 @@ http_response&& http_response::with_status(int code) && {
 // http_response.hpp.
 // -----------------------------------------------------------------------
 namespace {
-inline std::string_view header_map_find_view(const http::header_map& m,
-                                             std::string_view key) {
+// Map is http::header_map (the cookie mirror) or a header_fields store.
+template <typename Map>
+std::string_view header_map_find_view(const Map& m, std::string_view key) {
     auto it = m.find(key);
     if (it == m.end()) return {};
     return it->second;
@@ -398,12 +435,25 @@ std::string_view http_response::get_cookie(std::string_view key) const {
     return header_map_find_view(cookies_, key);
 }
 
+namespace {
+// Same layout as http::dump_header_map, for the header_fields stores.
+template <typename Fields>
+void dump_fields(std::ostream& os, const char* prefix, const Fields& fields) {
+    if (fields.empty()) return;
+    os << "    " << prefix << " [";
+    for (const auto& [name, value] : fields) {
+        os << name << ":\"" << value << "\" ";
+    }
+    os << "]" << std::endl;
+}
+}  // namespace
+
 std::ostream &operator<< (std::ostream& os, const http_response& r) {
     os << "Response [response_code:" << r.status_code_ << "]" << std::endl;
 
     r.ensure_cookie_mirror_();
-    http::dump_header_map(os, "Headers", r.headers_);
-    http::dump_header_map(os, "Footers", r.footers_);
+    dump_fields(os, "Headers", r.headers_);
+    dump_fields(os, "Footers", r.footers_);
     http::dump_header_map(os, "Cookies", r.cookies_);
 
     return os;
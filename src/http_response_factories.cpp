@@ -39,9 +39,11 @@
 
 #include "httpserver/detail/response_body.hpp"   // complete type for body_->~response_body()
 #include "httpserver/detail/http_field_validation.hpp"
+#include "httpserver/detail/response_materializer.hpp"
 #include "httpserver/feature_unavailable.hpp"
 #include "httpserver/http_utils.hpp"
 #include "httpserver/iovec_entry.hpp"
+#include "httpserver/stream_writer.hpp"
 
 namespace httpserver {
 
@@ -114,21 +116,44 @@ http_response http_response::string(std::string response_body,
                                     std::string content_type) {
     http_response r;
     r.status_code_ = http::http_utils::http_ok;          // 200
-    r.with_header(http::http_utils::http_header_content_type,
-                  std::move(content_type));
+    r.do_set_header(library_header(http::http_utils::http_header_content_type),
+                    content_type);
     r.emplace_body<detail::string_response_body>(body_kind::string,
                                         std::move(response_body));
     return r;
 }
 
-http_response http_response::file(std::string path) {
+http_response http_response::shared(std::shared_ptr<const std::string> body,
+                                    std::string content_type) {
+    if (body == nullptr) {
+        throw std::invalid_argument("http_response::shared: null body");
+    }
+    const std::string& bytes = *body;
+    return shared(std::as_bytes(std::span<const char>(bytes.data(), bytes.size())),
+                  std::move(body), std::move(content_type));
+}
+
+http_response http_response::shared(std::span<const std::byte> data,
+                                    std::shared_ptr<const void> owner,
+                                    std::string content_type) {
+    http_response r;
+    r.status_code_ = http::http_utils::http_ok;          // 200
+    r.do_set_header(library_header(http::http_utils::http_header_content_type),
+                    content_type);
+    r.emplace_body<detail::shared_response_body>(body_kind::shared,
+        data.data(), data.size(), std::move(owner));
+    return r;
+}
+
+http_response http_response::file(std::string path, file_options options) {
     http_response r;
     r.status_code_ = http::http_utils::http_ok;
     // Match v1 file_response default Content-Type. Callers can override
     // with .with_header("Content-Type", "...") in the chain.
-    r.with_header(http::http_utils::http_header_content_type,
-                  http::http_utils::application_octet_stream);
-    r.emplace_body<detail::file_response_body>(body_kind::file, std::move(path));
+    r.do_set_header(library_header(http::http_utils::http_header_content_type),
+                    http::http_utils::application_octet_stream);
+    r.emplace_body<detail::file_response_body>(body_kind::file, std::move(path),
+        options.precompressed, detail::file_response_body::deferred_open_t{});
     return r;
 }
 
@@ -143,19 +168,48 @@ http_response http_response::iovec(std::span<const iovec_entry> entries) {
     return r;
 }
 
-http_response http_response::pipe(int fd) {
+http_response http_response::iovec(std::vector<iovec_segment> segments) {
+    std::vector<iovec_entry> v;
+    v.reserve(segments.size());
+    // One refcounted list for all owners, so materialize() hands MHD a
+    // single reference however many segments there are.
+    auto owners = std::make_shared<std::vector<std::shared_ptr<const void>>>();
+    for (iovec_segment& s : segments) {
+        v.push_back(iovec_entry{s.base, s.len});
+        if (s.owner != nullptr) owners->push_back(std::move(s.owner));
+    }
+    std::shared_ptr<const void> keep;
+    if (!owners->empty()) keep = std::move(owners);
     http_response r;
     r.status_code_ = http::http_utils::http_ok;
-    r.emplace_body<detail::pipe_response_body>(body_kind::pipe, fd);
+    r.emplace_body<detail::iovec_response_body>(body_kind::iovec, std::move(v),
+                                                std::move(keep));
     return r;
 }
 
-http_response http_response::deferred(
-        std::function<ssize_t(std::uint64_t, char*, std::size_t)> producer) {
+http_response http_response::pipe(int fd, pipe_options options) {
+    http_response r;
+    r.status_code_ = http::http_utils::http_ok;
+    r.emplace_body<detail::pipe_response_body>(body_kind::pipe, fd, options.block_size);
+    return r;
+}
+
+http_response http_response::deferred(deferred_producer producer,
+                                      std::size_t block_size) {
+    if (block_size == 0) {
+        throw std::invalid_argument("http_response::deferred: block_size must be > 0");
+    }
     http_response r;
     r.status_code_ = http::http_utils::http_ok;
     r.emplace_body<detail::deferred_response_body>(body_kind::deferred,
-                                          std::move(producer));
+                                          std::move(producer), block_size);
+    return r;
+}
+
+http_response http_response::stream(const stream_writer& writer) {
+    http_response r;
+    r.status_code_ = http::http_utils::http_ok;
+    r.emplace_body<detail::stream_response_body>(body_kind::stream, writer.channel_);
     return r;
 }
 
@@ -217,8 +271,8 @@ http_response http_response::unauthorized(std::string_view scheme,
         challenge.append(escaped_realm);
     }
     challenge.push_back('"');
-    r.with_header(http::http_utils::http_header_www_authenticate,
-                  challenge);
+    r.do_set_header(library_header(http::http_utils::http_header_www_authenticate),
+                    challenge);
     // The body slot literally holds a string_response_body (possibly empty), so
     // kind() reports body_kind::string. Switching to body_kind::empty
     // for the empty-body case would fork the construction path and
@@ -300,4 +354,41 @@ http_response http_response::unauthorized(digest_challenge challenge) {
 }
 #endif  // HAVE_DAUTH
 
+// -----------------------------------------------------------------------
+// freeze() / frozen_response. The MHD_Response is built and decorated
+// here, once, by the same helpers the dispatch path uses per request.
+// -----------------------------------------------------------------------
+frozen_response http_response::freeze() && {
+    if (body_ == nullptr || (kind_ != body_kind::string && kind_ != body_kind::shared
+            && kind_ != body_kind::empty && kind_ != body_kind::iovec)) {
+        throw std::invalid_argument(
+            "http_response::freeze: only string, shared, empty and iovec "
+            "responses can be frozen");
+    }
+    auto state = std::make_shared<detail::frozen_response_state>(std::move(*this));
+    // Taken after the move: an inline body was relocated into state->source.
+    state->body = state->source.body_;
+    state->mhd = state->body->materialize();
+    if (state->mhd == nullptr) {
+        throw std::runtime_error("http_response::freeze: materialization failed");
+    }
+    detail::response_materializer::decorate_mhd_response(state->mhd, state->source);
+    return frozen_response(std::move(state));
+}
+
+frozen_response::operator http_response() const {
+    http_response r;
+    r.status_code_ = state_->source.status_code_;
+    r.emplace_body<detail::frozen_response_body>(body_kind::frozen, state_);
+    return r;
+}
+
+int frozen_response::get_status() const noexcept {
+    return state_->source.get_status();
+}
+
+const http_response& frozen_response::source() const noexcept {
+    return state_->source;
+}
+
 }  // namespace httpserver
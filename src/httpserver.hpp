@@ -30,7 +30,9 @@
 #include "httpserver/body_kind.hpp"
 #include "httpserver/constants.hpp"
 #include "httpserver/cookie.hpp"
+#include "httpserver/deferred_producer.hpp"
 #include "httpserver/feature_unavailable.hpp"
+#include "httpserver/header_fields.hpp"
 #include "httpserver/hook_action.hpp"
 #include "httpserver/hook_context.hpp"
 #include "httpserver/hook_handle.hpp"
@@ -44,6 +46,9 @@
 #include "httpserver/ip_representation.hpp"
 #include "httpserver/iovec_entry.hpp"
 #include "httpserver/file_info.hpp"
+#include "httpserver/static_directory_resource.hpp"
+#include "httpserver/stream_writer.hpp"
+#include "httpserver/sse_channel.hpp"
 #include "httpserver/webserver.hpp"
 // Included unconditionally. websocket_handler.hpp is safe to
 // include in both HAVE_WEBSOCKET-on and HAVE_WEBSOCKET-off builds; the
@@ -46,10 +46,15 @@ namespace httpserver {
 enum class body_kind : std::uint8_t {
     empty,
     string,    // NOLINT(build/include_what_you_use) - enumerator, not std::string
+    // Borrowed bytes kept alive by a shared owner (http_response::shared);
+    // never copied.
+    shared,
     file,
     iovec,
     pipe,
     deferred,
+    // Pushed through a stream_writer (http_response::stream).
+    stream,
     // RFC-7616 Digest auth challenge body. The body is a body-only
     // MHD_Response (the "access denied" payload); the WWW-Authenticate header
     // with nonce/opaque/qop/algorithm parameters is attached by the dispatch
@@ -58,6 +63,10 @@ enum class body_kind : std::uint8_t {
     // branch onto the auth-required queueing API without naming any backend
     // type from http_response.hpp.
     digest_challenge,
+    // A response converted from a frozen_response: the MHD_Response was
+    // built and decorated once by http_response::freeze() and is queued
+    // as-is on every request that returns it.
+    frozen,
 };
 
 }  // namespace httpserver
@@ -48,6 +48,7 @@
 //   v2.1 (next release): legacy string-blob path is removed.
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -171,6 +172,23 @@ class cookie final {
     /// no name is not a valid Set-Cookie.
     [[nodiscard]] std::string to_set_cookie_header() const;
 
+    /// Append the same rendering to @p out, so a caller can reuse one
+    /// buffer across cookies. Throws like to_set_cookie_header(); @p out
+    /// may then hold a partial rendering.
+    void append_set_cookie_header(std::string& out) const;
+
+    /// Pre-render the `Set-Cookie` value once, for a cookie whose
+    /// attributes do not change between responses. Copies share the
+    /// rendering, so setting a frozen cookie on every response costs no
+    /// serialization. Any later setter call drops it. Throws like
+    /// to_set_cookie_header().
+    cookie& freeze() &;
+    cookie&& freeze() &&;
+
+    /// Whether freeze() has rendered this cookie (and no setter has run
+    /// since).
+    [[nodiscard]] bool is_frozen() const noexcept { return rendered_ != nullptr; }
+
     /// Parse an RFC 6265 §5.4 `Cookie:` request-header value into a
     /// flat list of (name, value) cookies. Request cookies carry no
     /// attributes per the spec, so domain/path/etc. on the returned
@@ -196,6 +214,8 @@ class cookie final {
     bool secure_ = false;
     bool http_only_ = false;
     same_site_mode same_site_ = same_site_mode::unset;
+    // freeze()'s rendering; null when not frozen.
+    std::shared_ptr<const std::string> rendered_;
 
     void do_set_name(std::string v);
     void do_set_value(std::string v);
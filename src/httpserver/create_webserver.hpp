@@ -26,6 +26,7 @@
 #define SRC_HTTPSERVER_CREATE_WEBSERVER_HPP_
 
 #include <stdlib.h>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <functional>
@@ -89,6 +90,12 @@ namespace http { class file_info; }
 
 typedef std::function<bool(const std::string&, const std::string&, const http::file_info&)> file_cleanup_callback_ptr;
 
+/**
+ * Callback signature for @ref create_webserver::response_cache_key: its
+ * result is added to the key a cacheable request is looked up under.
+ */
+typedef std::function<std::string(const http_request&)> response_cache_key_t;
+
 /**
  * Centralised authentication callback signature.
  *
@@ -178,9 +185,40 @@ struct webserver_config {
     bool ip_access_control_enabled = true;
     bool post_process_enabled = true;
     bool put_processed_data_to_content = true;
+    bool native_form_parser = false;
+    bool decode_request_body = false;
+    // Response compression (create_webserver::compress_responses); the
+    // level, size floor and MIME filter only apply while it is on.
+    bool compress_responses = false;
+    int compression_level = 6;
+    size_t compression_min_size = 256;
+    std::vector<std::string> compression_types = {
+        "text/*", "application/json", "application/javascript",
+        "application/xml", "image/svg+xml"};
+    // Bytes of compressed file bodies to keep (create_webserver::
+    // compressed_file_cache); 0 = file bodies are never compressed.
+    size_t compressed_file_cache_size = 0;
+    bool file_range_requests = true;
+    bool generate_etags = false;
+    // Open files kept by create_webserver::file_descriptor_cache; 0 = every
+    // file response opens its path.
+    size_t file_descriptor_cache_entries = 0;
+    std::chrono::milliseconds file_descriptor_cache_ttl{1000};
+    // Bytes of responses kept by create_webserver::response_cache; 0 = off.
+    size_t response_cache_size = 0;
+    std::vector<std::string> response_cache_vary;
+    response_cache_key_t response_cache_key = nullptr;
+    // create_webserver::default_headers; added to every response at
+    // materialization, never copied into the response itself.
+    http::header_map default_headers;
     file_upload_target_T file_upload_target = FILE_UPLOAD_MEMORY_ONLY;
     std::string file_upload_dir = "/tmp";
     bool generate_random_filename_on_upload = false;
+    // 0 = write upload chunks synchronously on the MHD worker thread.
+    size_t async_upload_max_in_flight = 0;
+    // 0 = unlimited (usage is still tracked for get_upload_usage()).
+    size_t upload_memory_budget = 0;
+    size_t upload_disk_budget = 0;
     bool deferred_enabled = false;
     bool single_resource = false;
     bool tcp_nodelay = false;
@@ -434,8 +472,196 @@ class create_webserver {
      create_webserver& ip_access_control(bool enable = true) { _config.ip_access_control_enabled = enable; return *this; }
      create_webserver& post_process(bool enable = true) { _config.post_process_enabled = enable; return *this; }
      create_webserver& put_processed_data_to_content(bool enable = true) { _config.put_processed_data_to_content = enable; return *this; }
+     /**
+      * Parse form bodies with libhttpserver's streaming form parser instead
+      * of libmicrohttpd's MHD_PostProcessor. Field bytes reach the argument
+      * map / upload file straight from the connection's receive buffer,
+      * skipping the post processor's intermediate copy. Only consulted when
+      * @ref post_process is enabled. Default `false`.
+      */
+     create_webserver& native_form_parser(bool enable = true) { _config.native_form_parser = enable; return *this; }
+     /**
+      * Decode request bodies sent with `Content-Encoding: gzip` (or
+      * `x-gzip`) or `deflate` before any body stage sees them: body_chunk
+      * hooks, get_content() and form parsing all observe decoded bytes.
+      * Decoding is streamed chunk by chunk, and content_size_limit
+      * applies to the decoded size: a body that inflates past it is
+      * rejected with 413. Malformed or truncated streams get 400; any
+      * other coding gets 415. The Content-Encoding header itself is left
+      * on the request.
+      *
+      * Requires a libhttpserver built with zlib; otherwise constructing
+      * the webserver throws feature_unavailable. Default `false`.
+      */
+     create_webserver& decode_request_body(bool enable = true) { _config.decode_request_body = enable; return *this; }
+     /**
+      * Compress response bodies for clients whose `Accept-Encoding` allows
+      * it (gzip preferred, then deflate). Runs after after_handler hooks,
+      * just before the response is queued. String and iovec bodies are
+      * compressed in one pass; deferred and pipe bodies are compressed as
+      * they stream, flushing whenever the producer has nothing ready.
+      *
+      * Responses whose Content-Type is listed in @ref compression_types
+      * are considered, except 1xx, 204, 206 and 304; each of them gains
+      * `Vary: Accept-Encoding`, compressed or not. Bodies that
+      * already carry a Content-Encoding, responses marked
+      * `Cache-Control: no-transform`, and string / iovec bodies smaller
+      * than @ref compression_min_size are sent unchanged. File bodies are
+      * only compressed through @ref compressed_file_cache; shared and
+      * frozen bodies never are. A strong ETag becomes weak on a
+      * compressed response.
+      *
+      * Requires a libhttpserver built with zlib; otherwise constructing
+      * the webserver throws feature_unavailable. Default `false`.
+      */
+     create_webserver& compress_responses(bool enable = true) { _config.compress_responses = enable; return *this; }
+     /// zlib compression level for @ref compress_responses, 1 (fastest)
+     /// to 9 (smallest). Default 6.
+     create_webserver& compression_level(int v) {
+         if (v < 1 || v > 9) throw_invalid("compression_level", v, "[1, 9]");
+         _config.compression_level = v; return *this;
+     }
+     /// Smallest string / iovec body, in bytes, that @ref compress_responses
+     /// compresses. Default 256.
+     create_webserver& compression_min_size(size_t bytes) { _config.compression_min_size = bytes; return *this; }
+     /// Content types @ref compress_responses may compress, compared
+     /// case-insensitively against the response's Content-Type without
+     /// parameters. An entry ending in `/*` matches every subtype.
+     /// Default: `text/*`, `application/json`, `application/javascript`,
+     /// `application/xml`, `image/svg+xml`.
+     create_webserver& compression_types(std::vector<std::string> types) { _config.compression_types = std::move(types); return *this; }
+     /// Let @ref compress_responses compress file bodies, keeping up to
+     /// @p max_bytes of compressed copies in memory. An entry is keyed by
+     /// path and coding and rebuilt when the file's mtime or size changes;
+     /// hits are served from memory without copying. Files larger than
+     /// @p max_bytes are sent uncompressed. Default 0 (files are never
+     /// compressed, keeping their zero-copy path).
+     create_webserver& compressed_file_cache(size_t max_bytes) { _config.compressed_file_cache_size = max_bytes; return *this; }
+     /**
+      * Answer conditional and range requests for file responses
+      * (http_response::file) to GET and HEAD.
+      *
+      * A 200 file response gains `Accept-Ranges: bytes` and, unless the
+      * handler set them, an `ETag` and `Last-Modified` taken from the
+      * file's mtime and size. `If-None-Match` / `If-Modified-Since` that
+      * match get 304; a satisfiable `Range` (when `If-Range`, if present,
+      * still matches) gets 206 -- one range is sent straight from the
+      * file at an offset, several as `multipart/byteranges` -- and an
+      * unsatisfiable one 416. Nothing is read from the file except to
+      * fill a multipart body. Default `true`.
+      */
+     create_webserver& file_range_requests(bool enable = true) { _config.file_range_requests = enable; return *this; }
+     /**
+      * Give 200 string, iovec and shared responses to GET and HEAD a
+      * strong `ETag` hashed from their bytes (XXH64, a fast
+      * non-cryptographic hash), and answer a matching `If-None-Match`
+      * with an empty 304 -- a client polling an unchanged payload gets
+      * headers only.
+      *
+      * A handler-set `ETag` is kept and compared instead. The hash costs
+      * one pass over the body per response; file responses are covered by
+      * @ref file_range_requests, and deferred, pipe and stream bodies are
+      * never buffered to hash. With @ref compress_responses on, a
+      * compressed reply carries the ETag weakened (`W/`). A frozen
+      * response, such as a @ref response_cache hit, is not hashed again:
+      * its stored `ETag` answers `If-None-Match`. Default `false`.
+      */
+     create_webserver& generate_etags(bool enable = true) { _config.generate_etags = enable; return *this; }
+     /**
+      * Keep up to @p max_entries files opened for http_response::file
+      * responses, keyed by path, so a hot file costs one `dup()` instead
+      * of an `open()` and `fstat()` per response.
+      *
+      * An entry is reused for @p ttl after it was opened and then reopened
+      * from the path: a file replaced within that window is served from
+      * its old contents until the entry expires. Each response gets its
+      * own descriptor, so eviction never affects one in flight; the cache
+      * holds one descriptor per entry against the process's open-file
+      * limit. Default 0 (off).
+      */
+     create_webserver& file_descriptor_cache(size_t max_entries,
+                                             std::chrono::milliseconds ttl = std::chrono::milliseconds(1000)) {
+         if (ttl.count() < 0) throw_invalid("file_descriptor_cache ttl", ttl.count(), "[0, inf)");
+         _config.file_descriptor_cache_entries = max_entries;
+         _config.file_descriptor_cache_ttl = ttl;
+         return *this;
+     }
+     /**
+      * Keep up to @p max_bytes of handler responses in memory and answer
+      * matching requests from them without running the handler or the
+      * after_handler hooks. Route resolution and the route_resolved and
+      * before_handler hooks -- @ref auth_handler included -- still run
+      * first, so a request they reject never gets a cached response.
+      *
+      * GET and HEAD requests without an Authorization header are looked
+      * up by method, path and query string, the @ref response_cache_vary
+      * headers and the @ref response_cache_key result. A response is
+      * stored, as sent after the after_handler hooks, when its
+      * `Cache-Control` carries `s-maxage` or `max-age` (for that many
+      * seconds) and none of `no-store`, `no-cache` or `private`, it sets
+      * no cookie, its `Vary` lists only configured headers and its body
+      * is a string, shared or empty one. A response is stored after the
+      * @ref generate_etags and @ref compress_responses stages, then
+      * frozen, so hits queue the same built response with its ETag and
+      * encoding; a hit matching If-None-Match gets a 304. Compression adds
+      * `Vary: Accept-Encoding`, so with @ref compress_responses on, a
+      * compressible response is cached only when `Accept-Encoding` is one
+      * of the @ref response_cache_vary headers (one entry per encoding
+      * request header). webserver::purge_cached_responses() drops
+      * entries. The budget is split evenly over 16 shards, and a response
+      * larger than one shard's share is not stored. Default 0 (off).
+      */
+     create_webserver& response_cache(size_t max_bytes) { _config.response_cache_size = max_bytes; return *this; }
+     /// Request headers whose values tell cached variants apart (for
+     /// example `Accept-Language`). A response whose `Vary` names any
+     /// other header is not cached. Default: none.
+     create_webserver& response_cache_vary(std::vector<std::string> headers) { _config.response_cache_vary = std::move(headers); return *this; }
+     /// Add the result of @p key to the response cache key of every
+     /// cacheable request, e.g. a tenant derived from the Host header. It
+     /// runs on the request's connection thread after the before_handler
+     /// hooks.
+     create_webserver& response_cache_key(response_cache_key_t key) { _config.response_cache_key = std::move(key); return *this; }
+     /**
+      * Headers sent on every response, e.g. `Server`,
+      * `Strict-Transport-Security` or `X-Content-Type-Options`. They are
+      * kept here, once, and added straight onto each libmicrohttpd
+      * response when it is built, so handlers neither set nor copy them;
+      * they never show up in http_response::get_headers(). A header the
+      * response sets itself (case-insensitive name match) wins over the
+      * default of that name. Frozen responses carry them too: a second
+      * libmicrohttpd response with the defaults is built on first use and
+      * then shared. Throws std::invalid_argument for an empty name or a
+      * name or value containing CR, LF or NUL. Default: none.
+      */
+     create_webserver& default_headers(http::header_map headers);
 
      create_webserver& file_upload_target(const file_upload_target_T& v) { _config.file_upload_target = v; return *this; }
+     /**
+      * Write uploaded files from a dedicated writer thread instead of the
+      * MHD worker that received the bytes.
+      *
+      * Each chunk is copied into a queue drained by one background thread
+      * with `pwrite()`. When more than @p max_in_flight_bytes are queued,
+      * the uploading connection is suspended until the writer catches up;
+      * the handler only runs once all of the request's writes have landed.
+      * Pass 0 (the default) to keep synchronous writes.
+      */
+     create_webserver& async_upload_writes(size_t max_in_flight_bytes) { _config.async_upload_max_in_flight = max_in_flight_bytes; return *this; }
+     /**
+      * Cap the request-body bytes that all in-progress requests together
+      * may buffer in memory (raw content plus form and in-memory upload
+      * args). A body chunk that would exceed the cap fails its request
+      * with 503 Service Unavailable; the bytes are returned when each
+      * request completes. Pass 0 (the default) for no cap.
+      */
+     create_webserver& upload_memory_budget(size_t bytes) { _config.upload_memory_budget = bytes; return *this; }
+     /**
+      * Cap the bytes that all in-progress uploads together may write
+      * under file_upload_dir. An upload chunk that would exceed the cap
+      * fails its request with 507 Insufficient Storage. Pass 0 (the
+      * default) for no cap.
+      */
+     create_webserver& upload_disk_budget(size_t bytes) { _config.upload_disk_budget = bytes; return *this; }
      /**
       * Set the directory where uploaded files are written to disk.
       *
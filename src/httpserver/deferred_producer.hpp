@@ -0,0 +1,241 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#if !defined (_HTTPSERVER_HPP_INSIDE_) && !defined (HTTPSERVER_COMPILATION)
+#error "Only <httpserver.hpp> or <httpserverpp> can be included directly."
+#endif
+
+#ifndef SRC_HTTPSERVER_DEFERRED_PRODUCER_HPP_
+#define SRC_HTTPSERVER_DEFERRED_PRODUCER_HPP_
+
+#include <sys/types.h>          // ssize_t
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "httpserver/header_fields.hpp"
+
+namespace httpserver {
+
+namespace detail {
+class deferred_response_body;
+}  // namespace detail
+
+/**
+ * Trailer fields of a chunked deferred response, handed to a producer
+ * taking a fourth `deferred_trailers&` argument. Fields added before the
+ * producer returns MHD_CONTENT_READER_END_OF_STREAM are sent after the
+ * last chunk, so values only known once the body is generated -- a
+ * running checksum, a record count -- need no second pass. They are
+ * buffered here and attached to the libmicrohttpd response only when the
+ * producer ends the stream, never while it is being sent; re-adding a
+ * name replaces its value. They are dropped when the reply is not chunked
+ * (HTTP/1.0, HEAD).
+**/
+class deferred_trailers {
+ public:
+     deferred_trailers(const deferred_trailers&) = delete;
+     deferred_trailers& operator=(const deferred_trailers&) = delete;
+
+     // Add trailer @p name. Returns false, adding nothing, when @p name is
+     // empty, either argument contains CR, LF or NUL, the producer is not
+     // running under libmicrohttpd, the stream has ended, or out of memory.
+     bool add(std::string_view name, std::string_view value);
+
+ private:
+     explicit deferred_trailers(http::footer_fields* fields) noexcept
+         : fields_(fields) {}
+
+     // The buffer in deferred_response_body's trailer binding; nullptr when
+     // there is none or the stream has ended.
+     http::footer_fields* fields_;
+
+     friend class deferred_producer;
+     friend class detail::deferred_response_body;
+};
+
+/**
+ * The producer behind http_response::deferred(): any callable
+ * `ssize_t(std::uint64_t pos, char* buf, std::size_t max)`, kept with its
+ * own type. A callable of up to inline_size bytes that is nothrow-movable
+ * lives inside the producer -- and so inside the response's inline
+ * storage -- and is called directly, without std::function's indirection
+ * or allocation; anything larger is moved to the heap once.
+ *
+ * A callable that also accepts a trailing `deferred_trailers&` is called
+ * with one and may add trailer fields while it streams.
+ *
+ * Move-only. A moved-from producer is empty, as is one built from an
+ * empty std::function or a null function pointer.
+**/
+class deferred_producer {
+     // Declared first: the converting constructor's constraint uses it.
+     template <typename D>
+     static constexpr bool takes_trailers_v = std::is_invocable_r_v<
+         ssize_t, D&, std::uint64_t, char*, std::size_t, deferred_trailers&>;
+
+ public:
+     // Largest callable stored without allocating.
+     static constexpr std::size_t inline_size = 40;
+     // MHD block size http_response::deferred() uses unless told otherwise;
+     // the size v1's deferred_response asked for.
+     static constexpr std::size_t default_block_size = 1024;
+
+     deferred_producer() noexcept = default;
+
+     template <typename F, typename D = std::decay_t<F>,
+               typename = std::enable_if_t<
+                   !std::is_same_v<D, deferred_producer> &&
+                   (std::is_invocable_r_v<ssize_t, D&, std::uint64_t, char*, std::size_t> ||
+                    takes_trailers_v<D>)>>
+     deferred_producer(F&& f) {  // NOLINT(runtime/explicit)
+         if constexpr (std::is_pointer_v<D> || is_std_function<D>::value) {
+             if (!f) return;
+         }
+         if constexpr (fits_inline<D>) {
+             ::new (static_cast<void*>(storage_)) D(std::forward<F>(f));
+             ops_ = &inline_model<D>::table;
+         } else {
+             ::new (static_cast<void*>(storage_)) D*(new D(std::forward<F>(f)));
+             ops_ = &heap_model<D>::table;
+         }
+     }
+
+     deferred_producer(deferred_producer&& o) noexcept : ops_(o.ops_) {
+         if (ops_ != nullptr) ops_->relocate(o.storage_, storage_);
+         o.ops_ = nullptr;
+     }
+
+     deferred_producer& operator=(deferred_producer&& o) noexcept {
+         if (this != &o) {
+             reset();
+             ops_ = o.ops_;
+             if (ops_ != nullptr) ops_->relocate(o.storage_, storage_);
+             o.ops_ = nullptr;
+         }
+         return *this;
+     }
+
+     deferred_producer(const deferred_producer&) = delete;
+     deferred_producer& operator=(const deferred_producer&) = delete;
+
+     ~deferred_producer() { reset(); }
+
+     explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+     // True when the callable is stored inside the producer.
+     [[nodiscard]] bool stored_inline() const noexcept {
+         return ops_ != nullptr && !ops_->on_heap;
+     }
+
+     // True when the callable takes a deferred_trailers&.
+     [[nodiscard]] bool takes_trailers() const noexcept {
+         return ops_ != nullptr && ops_->with_trailers;
+     }
+
+     // Precondition: not empty. A trailer-taking callable gets trailers
+     // that add nothing.
+     ssize_t operator()(std::uint64_t pos, char* buf, std::size_t max) {
+         deferred_trailers none(nullptr);
+         return ops_->invoke(storage_, pos, buf, max, none);
+     }
+
+     // Precondition: not empty. @p trailers is ignored by a callable that
+     // does not take it.
+     ssize_t operator()(std::uint64_t pos, char* buf, std::size_t max,
+                        deferred_trailers& trailers) {
+         return ops_->invoke(storage_, pos, buf, max, trailers);
+     }
+
+ private:
+     struct ops_table {
+         ssize_t (*invoke)(void*, std::uint64_t, char*, std::size_t, deferred_trailers&);
+         // Move-constructs into the second argument and destroys the first.
+         void (*relocate)(void*, void*) noexcept;
+         void (*destroy)(void*) noexcept;
+         bool on_heap;
+         bool with_trailers;
+     };
+
+     template <typename D>
+     static ssize_t call(D& d, std::uint64_t pos, char* buf, std::size_t max,
+                         deferred_trailers& trailers) {
+         if constexpr (takes_trailers_v<D>) {
+             return d(pos, buf, max, trailers);
+         } else {
+             return d(pos, buf, max);
+         }
+     }
+
+     template <typename D>
+     static constexpr bool fits_inline = sizeof(D) <= inline_size &&
+         alignof(D) <= alignof(void*) && std::is_nothrow_move_constructible_v<D>;
+
+     template <typename D>
+     struct is_std_function : std::false_type {};
+     template <typename R, typename... A>
+     struct is_std_function<std::function<R(A...)>> : std::true_type {};
+
+     template <typename D>
+     struct inline_model {
+         static D* self(void* s) noexcept { return std::launder(static_cast<D*>(s)); }
+         static ssize_t invoke(void* s, std::uint64_t pos, char* buf, std::size_t max,
+                               deferred_trailers& trailers) {
+             return call(*self(s), pos, buf, max, trailers);
+         }
+         static void relocate(void* from, void* to) noexcept {
+             ::new (to) D(std::move(*self(from)));
+             self(from)->~D();
+         }
+         static void destroy(void* s) noexcept { self(s)->~D(); }
+         static constexpr ops_table table{&invoke, &relocate, &destroy, false,
+                                         takes_trailers_v<D>};
+     };
+
+     template <typename D>
+     struct heap_model {
+         static D* self(void* s) noexcept { return *std::launder(static_cast<D**>(s)); }
+         static ssize_t invoke(void* s, std::uint64_t pos, char* buf, std::size_t max,
+                               deferred_trailers& trailers) {
+             return call(*self(s), pos, buf, max, trailers);
+         }
+         static void relocate(void* from, void* to) noexcept { ::new (to) D*(self(from)); }
+         static void destroy(void* s) noexcept { delete self(s); }
+         static constexpr ops_table table{&invoke, &relocate, &destroy, true,
+                                         takes_trailers_v<D>};
+     };
+
+     void reset() noexcept {
+         if (ops_ != nullptr) ops_->destroy(storage_);
+         ops_ = nullptr;
+     }
+
+     const ops_table* ops_ = nullptr;
+     alignas(void*) unsigned char storage_[inline_size];
+};
+
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DEFERRED_PRODUCER_HPP_
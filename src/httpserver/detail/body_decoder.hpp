@@ -0,0 +1,115 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// body_decoder -- streaming Content-Encoding decoder for request bodies
+// (create_webserver::decode_request_body). request_pipeline feeds it each
+// upload_data chunk MHD delivers; it inflates into a fixed-size window and
+// hands every filled window to a sink, which runs the ordinary body stages
+// (body_chunk hooks, grow_content, the form parser). Memory per request is
+// the zlib state plus one window, whatever the compression ratio.
+//
+// The decoded size is capped by the request's content_size_limit: once
+// the cap would be exceeded the decoder stops inflating and reports
+// too_large, so a small compressed body cannot expand without bound.
+//
+// Supported codings: gzip (and its x-gzip alias, including concatenated
+// gzip members) and deflate (the zlib format, RFC 9110 §8.4.1.2).
+// Requires zlib (HAVE_ZLIB); without it create() never yields a decoder
+// and the webserver constructor rejects decode_request_body(true).
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "body_decoder.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_BODY_DECODER_HPP_
+#define SRC_HTTPSERVER_DETAIL_BODY_DECODER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace httpserver {
+namespace detail {
+
+class body_decoder {
+ public:
+    enum class status : std::uint8_t {
+        ok,           // all input consumed
+        stopped,      // the sink returned false
+        corrupt,      // not a valid stream for the declared coding
+        too_large     // decoded size would exceed the limit
+    };
+
+    // Receives decoded bytes; return false to stop decoding.
+    using sink = bool (*)(void* cls, const char* data, std::size_t size);
+
+    // Decoded bytes handed to the sink per call.
+    static constexpr std::size_t window_bytes = 16 * 1024;
+
+    // Outcome of create(): the coding was absent / "identity" (decoder
+    // stays null), supported (decoder set), or one this build cannot
+    // decode (respond 415).
+    enum class coding : std::uint8_t { identity, supported, unsupported };
+
+    // Build a decoder for the raw Content-Encoding header value
+    // @p content_encoding, capping decoded output at @p max_decoded_bytes.
+    static coding create(const char* content_encoding,
+                         std::size_t max_decoded_bytes,
+                         std::unique_ptr<body_decoder>* out);
+
+    body_decoder(const body_decoder&) = delete;
+    body_decoder& operator=(const body_decoder&) = delete;
+    body_decoder(body_decoder&&) = delete;
+    body_decoder& operator=(body_decoder&&) = delete;
+    ~body_decoder();
+
+    // Decode @p size bytes of the encoded body, forwarding output to
+    // @p out. After any status other than ok, later calls return the same
+    // status without decoding.
+    status feed(const char* data, std::size_t size, sink out, void* cls);
+
+    // True once the encoded stream ended cleanly. Checked at end-of-body:
+    // a body that stops mid-stream is truncated.
+    bool finished() const noexcept { return finished_; }
+
+ private:
+    struct state;
+
+    body_decoder(std::unique_ptr<state> st, bool multi_member,
+                 std::size_t max_decoded_bytes) noexcept;
+
+    // Inflate one step of input into window_; returns the zlib result.
+    int inflate_step();
+    // Hand the filled part of window_ to the sink and reset it.
+    status flush(sink out, void* cls);
+
+    std::unique_ptr<state> state_;
+    const bool multi_member_;
+    const std::size_t max_decoded_bytes_;
+    std::size_t decoded_bytes_ = 0;
+    bool finished_ = false;
+    status failed_ = status::ok;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_BODY_DECODER_HPP_
@@ -0,0 +1,148 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// Byte-bounded LRU of compressed file bodies
+// (create_webserver::compressed_file_cache), consulted by
+// response_compressor for file responses.
+//
+// An entry is keyed by (path, coding) and remembers the mtime and size of
+// the file it was built from; a lookup with a different stamp is a miss
+// and the next insert replaces the stale bytes, so at most one version of
+// each (path, coding) is held. Entries are shared_ptrs: a response serving
+// one keeps it alive after eviction. Same locking shape as route_cache:
+// every touch, hits included, splices the LRU list under one std::mutex.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "compressed_file_cache.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_COMPRESSED_FILE_CACHE_HPP_
+#define SRC_HTTPSERVER_DETAIL_COMPRESSED_FILE_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace httpserver {
+namespace detail {
+
+class compressed_file_cache {
+ public:
+    // Identifies the file contents an entry was built from.
+    struct stamp {
+        std::int64_t mtime_ns = 0;
+        std::uint64_t size = 0;
+
+        friend bool operator==(const stamp&, const stamp&) = default;
+    };
+
+    // @p capacity is the budget, in bytes, for compressed bodies plus
+    // their paths. 0 disables the cache: find() misses, insert() drops.
+    explicit compressed_file_cache(std::size_t capacity) noexcept
+        : capacity_(capacity) {}
+
+    compressed_file_cache(const compressed_file_cache&) = delete;
+    compressed_file_cache& operator=(const compressed_file_cache&) = delete;
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    // True on a hit for @p path / @p coding built from @p s, with the
+    // cached bytes in @p out. A null @p out on a hit records that the
+    // file does not shrink under this coding. Promotes the hit.
+    bool find(const std::string& path, std::uint8_t coding, stamp s,
+              std::shared_ptr<const std::string>* out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(key{path, coding});
+        if (it == map_.end() || !(it->second->s == s)) return false;
+        list_.splice(list_.begin(), list_, it->second);
+        *out = it->second->data;
+        return true;
+    }
+
+    // Inserts (or replaces) the bytes for @p path / @p coding, evicting
+    // least recently used entries until the budget holds. An entry that
+    // alone exceeds the budget is not stored.
+    void insert(std::string path, std::uint8_t coding, stamp s,
+                std::shared_ptr<const std::string> data) {
+        const std::size_t charge = path.size() + (data ? data->size() : 0);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(key{path, coding});
+        if (it != map_.end()) erase(it);
+        if (charge > capacity_) return;
+        while (used_ + charge > capacity_) erase(map_.find(list_.back().k));
+        list_.push_front(entry{key{std::move(path), coding}, s, std::move(data), charge});
+        map_.emplace(list_.front().k, list_.begin());
+        used_ += charge;
+    }
+
+    // Bytes currently charged against the budget.
+    std::size_t used() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return used_;
+    }
+
+ private:
+    struct key {
+        std::string path;
+        std::uint8_t coding = 0;
+
+        friend bool operator==(const key&, const key&) = default;
+    };
+
+    struct key_hash {
+        std::size_t operator()(const key& k) const noexcept {
+            return std::hash<std::string>{}(k.path) ^ (k.coding * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    struct entry {
+        key k;
+        stamp s;
+        std::shared_ptr<const std::string> data;
+        std::size_t charge = 0;
+    };
+
+    using list_t = std::list<entry>;
+    using map_t = std::unordered_map<key, list_t::iterator, key_hash>;
+
+    void erase(map_t::iterator it) {
+        used_ -= it->second->charge;
+        list_.erase(it->second);
+        map_.erase(it);
+    }
+
+    mutable std::mutex mutex_;
+    const std::size_t capacity_;
+    std::size_t used_ = 0;
+    list_t list_;
+    map_t map_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_COMPRESSED_FILE_CACHE_HPP_
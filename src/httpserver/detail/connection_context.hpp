@@ -35,10 +35,16 @@
 #include <memory>
 #include <optional>
 #include <fstream>
+#include <utility>
 
 #include "httpserver/http_method.hpp"
 #include "httpserver/http_request.hpp"
 #include "httpserver/http_response.hpp"
+#include "httpserver/detail/body_decoder.hpp"
+#include "httpserver/detail/form_parser.hpp"
+#include "httpserver/detail/single_flight.hpp"
+#include "httpserver/detail/upload_budget.hpp"
+#include "httpserver/detail/upload_writer.hpp"
 
 namespace httpserver {
 
@@ -74,6 +80,13 @@ namespace detail {
 //      request_completed hook, then deletes this object.
 struct connection_context {
     struct MHD_PostProcessor *pp = nullptr;
+    // Set instead of pp when create_webserver::native_form_parser is on;
+    // at most one of the two is non-null for a request.
+    std::unique_ptr<form_parser> form;
+    // Set when create_webserver::decode_request_body is on and the body
+    // carries a supported Content-Encoding; every later body stage sees
+    // decoded bytes.
+    std::unique_ptr<body_decoder> decoder;
     std::string complete_uri;
     std::string standardized_url;
     webserver* ws = nullptr;
@@ -138,6 +151,28 @@ struct connection_context {
     std::string upload_key;
     std::string upload_filename;
     std::unique_ptr<std::ofstream> upload_ostrm;
+    // Replaces upload_ostrm when create_webserver::async_upload_writes is
+    // on: the destination file plus the queued-write bookkeeping shared
+    // with the upload_writer thread.
+    std::shared_ptr<upload_writer::stream> upload_async;
+    // FILE_UPLOAD_STREAM: the resource resolved when the body started,
+    // which receives file parts through on_upload_chunk (null when no
+    // route matched). upload_key / upload_filename name the open part;
+    // these two track its content type and the bytes delivered so far.
+    std::shared_ptr<http_resource> upload_target;
+    std::string upload_content_type;
+    std::uint64_t upload_offset = 0;
+
+    // Body bytes this request holds against the webserver's upload_budget
+    // (armed in requests_answer_first_step). Released when this object
+    // is destroyed at request completion.
+    upload_budget::charge budget;
+
+    // This request's part in a single_flight (http_resource::
+    // single_flight_key): set while it leads a flight or is parked on
+    // one. A resumed follower re-enters through complete_request, which
+    // hands it straight to request_dispatcher::resume_follower.
+    single_flight::ticket flight;
 
     // Captured once on the first invocation of
     // webserver_impl::answer_to_connection for this request (i.e., when
@@ -176,6 +211,13 @@ struct connection_context {
 
     connection_context() = default;
 
+    // Stage @p r and skip routing / auth / the handler, the same way a
+    // pre-handler hook short-circuit does. Later body chunks are drained.
+    void short_circuit(http_response r) {
+        response.emplace(std::move(r));
+        skip_handler = true;
+    }
+
     connection_context(const connection_context& b) = delete;
     connection_context(connection_context&& b) = default;
 
@@ -186,6 +228,8 @@ struct connection_context {
         if (nullptr != pp) {
             MHD_destroy_post_processor(pp);
         }
+        if (upload_async != nullptr) upload_async->detach();
+        flight.leave();
     }
 };
 
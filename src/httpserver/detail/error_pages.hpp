@@ -21,8 +21,14 @@
 // error_pages -- behavior service (DR-014, §4.11) that synthesises the
 // 404 / 405 / 500 responses. A leaf in the dispatch DAG: it reads only
 // the const config bag (the user not_found / method_not_allowed /
-// internal_error handlers + expose_exception_messages) and conn->request;
-// it owns no state, takes no locks, and touches no other collaborator.
+// internal_error handlers + expose_exception_messages) and conn->request,
+// and touches no other collaborator.
+//
+// The default pages (no user handler) are frozen once, at construction,
+// and every request queues the same MHD_Response: the error path neither
+// allocates nor decorates. A default 405 carries the resource's Allow
+// header, so those are frozen lazily, one per allow mask (at most
+// 2^9), behind a shared_mutex.
 //
 // Internal header; only reachable when compiling libhttpserver.
 #if !defined(HTTPSERVER_COMPILATION)
@@ -32,12 +38,18 @@
 #ifndef SRC_HTTPSERVER_DETAIL_ERROR_PAGES_HPP_
 #define SRC_HTTPSERVER_DETAIL_ERROR_PAGES_HPP_
 
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
 #include <string_view>
+#include <unordered_map>
 
+#include "httpserver/http_method.hpp"
 #include "httpserver/http_response.hpp"
 
 namespace httpserver {
 
+class http_resource;
 struct webserver_config;
 
 namespace detail {
@@ -46,8 +58,7 @@ struct connection_context;
 
 class error_pages {
  public:
-    explicit error_pages(const webserver_config& config) noexcept
-        : config_(config) {}
+    explicit error_pages(const webserver_config& config);
 
     error_pages(const error_pages&) = delete;
     error_pages& operator=(const error_pages&) = delete;
@@ -60,9 +71,10 @@ class error_pages {
     http_response not_found_page(connection_context* conn) const;
 
     // 405 body: the user method_not_allowed_handler if set, else the
-    // fixed METHOD_ERROR string with http_method_not_allowed status. The
-    // caller supplies the Allow header separately.
-    http_response method_not_allowed_page(connection_context* conn) const;
+    // fixed METHOD_ERROR string with http_method_not_allowed status. Both
+    // carry @p resource's Allow header (none when it allows nothing).
+    http_response method_not_allowed_page(connection_context* conn,
+                                          const http_resource& resource) const;
 
     // 500 body. @p force_our=true returns the double-fault fallback: an
     // EMPTY-body 500 with @p msg ignored (used when the user handler
@@ -85,7 +97,17 @@ class error_pages {
                                                     std::string_view msg) const;
 
  private:
+    // The frozen default 405 for @p allowed, built on first use.
+    http_response default_method_not_allowed(method_set allowed) const;
+
     const webserver_config& config_;
+    // Unset when the page has a user handler, or freezing it failed (the
+    // page is then built per call, as before).
+    std::optional<frozen_response> not_found_;
+    std::optional<frozen_response> internal_error_;
+    std::optional<frozen_response> double_fault_;
+    mutable std::shared_mutex method_not_allowed_mutex_;
+    mutable std::unordered_map<std::uint32_t, frozen_response> method_not_allowed_;
 };
 
 }  // namespace detail
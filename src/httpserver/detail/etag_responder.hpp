@@ -0,0 +1,89 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// etag_responder -- the create_webserver::generate_etags stage.
+// response_materializer runs it on conn->response after range_responder
+// and before response_compressor. For a 200 string, iovec or shared
+// response to GET / HEAD it:
+//
+//   * adds a strong ETag hashed from the body bytes (XXH64, 16 hex
+//     digits), unless the handler set its own;
+//   * answers a matching If-None-Match with an empty 304, so a client
+//     polling an unchanged payload is not sent it again.
+//
+// A frozen response (a response_cache hit, stored after this stage ran)
+// is not hashed again: a matching If-None-Match against the ETag it was
+// frozen with becomes an empty 304.
+//
+// The ETag depends on the bytes only -- an iovec body hashes the same as
+// a string body with the same contents. A later compression pass weakens
+// it (W/), since the encoded bytes differ. A friend of http_response
+// (reads body_).
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "etag_responder.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_ETAG_RESPONDER_HPP_
+#define SRC_HTTPSERVER_DETAIL_ETAG_RESPONDER_HPP_
+
+#include <optional>
+#include <string>
+
+namespace httpserver {
+
+struct webserver_config;
+class http_request;
+class http_response;
+
+namespace detail {
+
+class etag_responder {
+ public:
+    explicit etag_responder(const webserver_config& config) noexcept
+        : config_(config) {}
+
+    etag_responder(const etag_responder&) = delete;
+    etag_responder& operator=(const etag_responder&) = delete;
+    etag_responder(etag_responder&&) = delete;
+    etag_responder& operator=(etag_responder&&) = delete;
+    ~etag_responder() = default;
+
+    // Add the ETag and answer If-None-Match for @p resp. Never throws: on
+    // any failure the response goes out as the handler built it.
+    void apply(const http_request& req, http_response& resp) const noexcept;
+
+    // The strong ETag this stage gives @p resp's body, quoted; nullopt for
+    // a body kind it does not hash (file, deferred, pipe, stream, frozen).
+    static std::optional<std::string> body_etag(const http_response& resp);
+
+ private:
+    // If-None-Match against a frozen response's own ETag (a
+    // response_cache hit): a matching one becomes an empty 304.
+    static void answer_frozen(const http_request& req, http_response& resp) noexcept;
+
+    const webserver_config& config_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_ETAG_RESPONDER_HPP_
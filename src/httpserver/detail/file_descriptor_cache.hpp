@@ -0,0 +1,112 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// Entry-bounded LRU of open file descriptors for file responses
+// (create_webserver::file_descriptor_cache), owned by
+// response_materializer.
+//
+// An entry holds one descriptor opened and fstat'd the way
+// file_response_body does (O_NOFOLLOW, regular files only) plus the size
+// that fstat reported. Every response gets its own dup() of it: MHD
+// closes the descriptor it is handed, and each dup has its own lifetime,
+// so evicting or expiring an entry never pulls a descriptor out from
+// under a response in flight. Since sendfile() and pread() take explicit
+// offsets, sharing the open file description between concurrent
+// responses is safe.
+//
+// Entries are revalidated by age only: for @c ttl after it was opened, an
+// entry is served without touching the path, so a file replaced (renamed
+// over) in that window is still served from the old inode, and one
+// truncated in place can end a response early. Same locking shape as
+// route_cache: every touch splices the LRU list under one std::mutex.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "file_descriptor_cache.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_FILE_DESCRIPTOR_CACHE_HPP_
+#define SRC_HTTPSERVER_DETAIL_FILE_DESCRIPTOR_CACHE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace httpserver {
+namespace detail {
+
+class file_descriptor_cache {
+ public:
+    using clock = std::chrono::steady_clock;
+
+    // @p max_entries 0 disables the cache: open() always opens the path
+    // and keeps nothing.
+    file_descriptor_cache(std::size_t max_entries, clock::duration ttl) noexcept
+        : max_entries_(max_entries), ttl_(ttl) {}
+    // Closes every cached descriptor; dups already handed out stay open.
+    ~file_descriptor_cache();
+
+    file_descriptor_cache(const file_descriptor_cache&) = delete;
+    file_descriptor_cache& operator=(const file_descriptor_cache&) = delete;
+
+    std::size_t max_entries() const noexcept { return max_entries_; }
+
+    // A descriptor for @p path that the caller owns, with the file's size
+    // in @p size; -1 (and @p size untouched) when the path cannot be
+    // opened as a regular file. A fresh entry costs one dup(); a missing
+    // or expired one reopens the path and replaces it.
+    int open(const std::string& path, std::size_t* size) noexcept;
+
+    // Entries currently held.
+    std::size_t entries() const;
+
+ private:
+    struct entry {
+        std::string path;
+        int fd = -1;
+        std::size_t size = 0;
+        clock::time_point expires;
+    };
+
+    using list_t = std::list<entry>;
+    using map_t = std::unordered_map<std::string, list_t::iterator>;
+
+    // The dup of a live entry for @p path, promoted; -1 on a miss, after
+    // dropping the entry if it expired.
+    int dup_cached(const std::string& path, std::size_t* size) noexcept;
+    // Cache @p fd (which the caller keeps) under @p path, evicting the
+    // least recently used entries past max_entries_.
+    void insert(const std::string& path, int fd, std::size_t size) noexcept;
+    void erase(map_t::iterator it) noexcept;
+
+    mutable std::mutex mutex_;
+    const std::size_t max_entries_;
+    const clock::duration ttl_;
+    list_t list_;
+    map_t map_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_FILE_DESCRIPTOR_CACHE_HPP_
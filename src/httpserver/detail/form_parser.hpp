@@ -0,0 +1,158 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// form_parser -- streaming application/x-www-form-urlencoded and
+// multipart/form-data body parser, the opt-in alternative to MHD's
+// MHD_PostProcessor (create_webserver::native_form_parser).
+//
+// MHD_PostProcessor copies every field byte into its own buffer before
+// invoking the post iterator. form_parser instead hands the iterator
+// pointers straight into the upload_data chunk MHD passed to
+// request_pipeline::requests_answer_second_step. The only bytes it copies
+// are the ones it must hold across two chunks: part header blocks,
+// urlencoded keys, the (at most delimiter-length) tail of a chunk that
+// might be the start of a boundary, and urlencoded values that contain a
+// '+' (rewritten to ' ' the way MHD_unescape_plus does).
+//
+// The iterator signature is MHD_PostDataIterator's, so the same
+// webserver_impl::post_iterator trampoline (and with it upload_pipeline)
+// consumes both parsers' output unchanged. '%XX' escapes are left raw on
+// both paths: libhttpserver installs a no-op MHD unescaper, so that is
+// what the MHD post processor delivers too.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "form_parser.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_FORM_PARSER_HPP_
+#define SRC_HTTPSERVER_DETAIL_FORM_PARSER_HPP_
+
+#include <microhttpd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if MHD_VERSION < 0x00097002
+typedef int MHD_Result;
+#endif
+
+namespace httpserver {
+namespace detail {
+
+class form_parser {
+ public:
+    // MHD_PostDataIterator-compatible callback (kind, key, filename,
+    // content_type, transfer_encoding, data, off, size).
+    using field_iterator = MHD_Result (*)(void*, MHD_ValueKind, const char*,
+                                          const char*, const char*, const char*,
+                                          const char*, uint64_t, size_t);
+
+    // Upper bound on bytes held in any one internal buffer (a multipart
+    // header block or an urlencoded key). Matches the 32 KiB memory budget
+    // request_pipeline hands MHD_create_post_processor.
+    static constexpr std::size_t max_buffered_bytes = 32 * 1024;
+
+    // Build a parser for @p content_type (the raw Content-Type header).
+    // Returns nullptr when the type is neither form encoding, or when a
+    // multipart type carries no usable boundary parameter -- the caller
+    // then treats the body as opaque content, as it does when
+    // MHD_create_post_processor returns nullptr.
+    static std::unique_ptr<form_parser> create(const char* content_type,
+                                               field_iterator it, void* cls);
+
+    form_parser(const form_parser&) = delete;
+    form_parser& operator=(const form_parser&) = delete;
+    form_parser(form_parser&&) = delete;
+    form_parser& operator=(form_parser&&) = delete;
+    ~form_parser() = default;
+
+    // Parse the next @p size bytes of the body. Returns false once the
+    // iterator has refused a field (returned MHD_NO) or the body is
+    // malformed; every later call is then a no-op returning false, the
+    // same contract as MHD_post_process.
+    bool feed(const char* data, std::size_t size);
+
+    // Signal end-of-body: flushes a trailing urlencoded key that had no
+    // value bytes yet. Returns false under the same conditions as feed().
+    bool finish();
+
+ private:
+    enum class encoding : std::uint8_t { urlencoded, multipart };
+    enum class state : std::uint8_t {
+        url_key, url_value,
+        preamble, after_delimiter, part_headers, part_body, epilogue
+    };
+
+    form_parser(encoding enc, std::string_view boundary, field_iterator it,
+                void* cls);
+
+    std::size_t feed_urlencoded(const char* data, std::size_t size);
+    std::size_t feed_url_key(const char* data, std::size_t size);
+    std::size_t feed_url_value(const char* data, std::size_t size);
+    std::size_t feed_multipart(const char* data, std::size_t size);
+    std::size_t scan_for_delimiter(const char* data, std::size_t size);
+    // Settle bytes held back by the previous chunk. Returns the bytes of
+    // @p data consumed, or npos when the chunk must be scanned from 0.
+    std::size_t resolve_carry(const char* data, std::size_t size);
+    bool deliver(const char* data, std::size_t size);
+    void on_delimiter();
+    std::size_t consume_after_delimiter(const char* data, std::size_t size);
+    std::size_t consume_part_headers(const char* data, std::size_t size);
+    void parse_part_headers(std::string_view block);
+
+    // Deliver @p size bytes of the current field (a no-op for unnamed
+    // multipart parts). The first call for a field carries off == 0.
+    bool emit(const char* data, std::size_t size);
+    bool emit_urlencoded_value(const char* data, std::size_t size);
+    // Close the current field; a field that never saw a byte is reported
+    // once with size 0 so empty values still reach the argument map.
+    bool end_field();
+
+    field_iterator it_;
+    void* cls_;
+    encoding encoding_;
+    state state_;
+    bool failed_ = false;
+
+    // "\r\n--" + boundary. The body's first delimiter has no leading CRLF;
+    // the constructor seeds carry_ with one so every delimiter scans alike.
+    std::string delimiter_;
+    std::string carry_;
+
+    std::string key_;
+    std::string filename_;
+    std::string content_type_;
+    std::string transfer_encoding_;
+    bool has_filename_ = false;
+    bool has_content_type_ = false;
+    bool has_transfer_encoding_ = false;
+    std::uint64_t off_ = 0;
+    bool emitted_ = false;
+    std::string scratch_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_FORM_PARSER_HPP_
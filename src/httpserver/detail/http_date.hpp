@@ -0,0 +1,68 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// HTTP-date (RFC 9110 §5.6.7) helpers shared by the Set-Cookie renderer
+// (Expires) and range_responder (Last-Modified, If-Modified-Since,
+// If-Range), plus the file mtime those validators and
+// compressed_file_cache stamps are built from. Pure free functions.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "http_date.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_HTTP_DATE_HPP_
+#define SRC_HTTPSERVER_DETAIL_HTTP_DATE_HPP_
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace httpserver {
+namespace detail {
+
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT". Locale-independent:
+// the day and month spellings are hand-rolled rather than going through
+// strftime.
+std::string format_imf_fixdate(std::int64_t epoch_seconds);
+
+// Seconds since the epoch for an IMF-fixdate; nullopt for anything else,
+// including the obsolete RFC 850 and asctime forms, which callers treat
+// as an absent header (RFC 9110 §13.1.3).
+std::optional<std::int64_t> parse_imf_fixdate(std::string_view date) noexcept;
+
+// st_mtime with its sub-second part, in nanoseconds since the epoch.
+inline std::int64_t file_mtime_ns(const struct stat& sb) noexcept {
+#if defined(__APPLE__)
+    return static_cast<std::int64_t>(sb.st_mtimespec.tv_sec) * 1000000000 + sb.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    return static_cast<std::int64_t>(sb.st_mtime) * 1000000000;
+#else
+    return static_cast<std::int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+}
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_HTTP_DATE_HPP_
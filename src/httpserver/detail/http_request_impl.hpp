@@ -326,6 +326,7 @@ class http_request_impl {
     void set_arg_flat(const std::string& key, const std::string& value, std::size_t content_size_limit);
     void set_args(const std::map<std::string, std::string>& args, std::size_t content_size_limit);
     void grow_last_arg(const std::string& key, const std::string& value);
+    void grow_last_arg(std::string_view key, std::string_view value);
 
 #ifdef HAVE_BAUTH
     void fetch_user_pass() const;
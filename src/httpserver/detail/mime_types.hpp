@@ -0,0 +1,49 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// Compiled file-extension -> Content-Type table used by
+// static_directory_resource. A sorted constexpr array searched by binary
+// search: no allocation, no file read at startup, and the results are
+// static_text, so a response borrows them instead of copying.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "mime_types.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_MIME_TYPES_HPP_
+#define SRC_HTTPSERVER_DETAIL_MIME_TYPES_HPP_
+
+#include <string_view>
+
+#include "httpserver/header_fields.hpp"
+
+namespace httpserver {
+namespace detail {
+
+// The Content-Type for @p path by its extension (after the last '.' of
+// the last segment, ASCII case-insensitive); application/octet-stream
+// when there is none or it is unknown.
+http::static_text mime_type_for(std::string_view path) noexcept;
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_MIME_TYPES_HPP_
@@ -28,23 +28,30 @@
 #define SRC_HTTPSERVER_DETAIL_PATH_NORMALIZE_HPP_
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace httpserver {
 namespace detail {
 
+// Resolve an (already unescaped) path into its canonical absolute form:
+// a leading '/', no empty or "." segments, and each ".." popping the
+// segment before it (never above the root). The dispatch path applies it
+// to every request URL, should_skip_auth re-applies it to its input, and
+// static_directory_resource uses it to map a URL onto its root. Defined
+// in src/detail/webserver_callbacks.cpp.
+std::string normalize_path(std::string_view path);
+
 // Pre-normalize an auth_skip_paths list so the per-request comparison
 // in webserver_impl::should_skip_auth runs against already-canonical
 // entries.  Each entry is fed through normalize_path — the helper that
-// normalizes the *request* path inside should_skip_auth.  Note that
-// normalize_path is declared in no header: it is a file-local
-// (unnamed-namespace) function in src/detail/webserver_request.cpp.
+// normalizes the *request* path inside should_skip_auth.
 // Entries ending in "/*" keep their trailing "/*" wildcard suffix;
 // the prefix before the wildcard is normalized.
 //
 // Pure function: no shared state, callable from the webserver
 // constructor body.  The definition lives in
-// src/detail/webserver_request.cpp alongside normalize_path so the
+// src/detail/webserver_callbacks.cpp alongside normalize_path so the
 // helper and its callers share a single canonicalisation rule.
 std::vector<std::string> normalize_auth_skip_paths(
         const std::vector<std::string>& raw);
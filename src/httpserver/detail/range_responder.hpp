@@ -0,0 +1,120 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// range_responder -- conditional and range requests for file responses
+// (create_webserver::file_range_requests). response_materializer runs it
+// on conn->response after after_handler hooks, before response_compressor.
+// For a 200 file response to GET / HEAD it:
+//
+//   * adds validators derived from fstat() -- ETag "<mtime>-<size>" and
+//     Last-Modified -- unless the handler set its own (with both set, as
+//     static_directory_resource does, there is no fstat()), and
+//     Accept-Ranges: bytes;
+//   * answers If-None-Match / If-Modified-Since with 304;
+//   * answers a satisfiable Range (subject to If-Range) with 206: one
+//     range narrows the file body to an fd offset, several become a
+//     multipart/byteranges body read with pread(); an unsatisfiable one
+//     gets 416.
+//
+// Only the 206 multipart path reads file contents. A friend of
+// http_response (swaps and narrows body_).
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "range_responder.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_RANGE_RESPONDER_HPP_
+#define SRC_HTTPSERVER_DETAIL_RANGE_RESPONDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace httpserver {
+
+struct webserver_config;
+class http_request;
+class http_response;
+
+namespace detail {
+
+class range_responder {
+ public:
+    // An inclusive byte range, as written in Range / Content-Range.
+    struct byte_range {
+        std::uint64_t first = 0;
+        std::uint64_t last = 0;
+    };
+
+    // More ranges than this, or ranges adding up to more than the file,
+    // and the Range header is ignored (RFC 9110 §14.2 lets a server
+    // refuse overlapping or abusive range sets).
+    static constexpr std::size_t max_ranges = 16;
+
+    explicit range_responder(const webserver_config& config) noexcept
+        : config_(config) {}
+
+    range_responder(const range_responder&) = delete;
+    range_responder& operator=(const range_responder&) = delete;
+    range_responder(range_responder&&) = delete;
+    range_responder& operator=(range_responder&&) = delete;
+    ~range_responder() = default;
+
+    // Apply validators, preconditions and Range to @p resp. Never throws:
+    // on any failure the response goes out as the handler built it.
+    void apply(const http_request& req, http_response& resp) const noexcept;
+
+    // The ranges a "bytes=" Range value selects in a @p size byte file,
+    // clipped to it. nullopt when the header is to be ignored (malformed,
+    // another unit, or over the limits above); empty when no range is
+    // satisfiable (416).
+    static std::optional<std::vector<byte_range>> parse_range(
+        std::string_view value, std::uint64_t size);
+
+    // The strong ETag this stage gives a file: "<mtime_ns>-<size>" in hex.
+    static std::string file_etag(std::int64_t mtime_ns, std::uint64_t size);
+
+    // Whether If-None-Match value @p list is "*" or names @p etag, compared
+    // weakly. Shared with etag_responder.
+    static bool etag_listed(std::string_view list, std::string_view etag);
+
+    // Swap resp's body for an empty one and set @p status (304, 416).
+    static void respond_empty(http_response& resp, int status);
+
+ private:
+    // Answer the request's Range, if any and If-Range allows it: 206
+    // (narrowed file or multipart), 416, or -- when parse_range() says to
+    // ignore it -- leave the 200 alone. @p modified: Last-Modified, seconds.
+    static void serve_range(const http_request& req, http_response& resp,
+                            std::int64_t modified);
+    static void serve_multipart(const std::vector<byte_range>& ranges,
+                                std::uint64_t size, http_response& resp);
+
+    const webserver_config& config_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_RANGE_RESPONDER_HPP_
@@ -27,8 +27,11 @@
 //
 // Holds references to the collaborators it drives: route_table (lookup),
 // hook_dispatcher (all firing + gating), error_pages (404/405/500),
-// response_materializer (queueing), websocket_upgrader (HAVE_WEBSOCKET),
-// and const webserver_config (log_dispatch_error). Owns no state.
+// response_materializer (queueing), response_cache (hits served after
+// route resolution and before_handler, handler responses stored after
+// after_handler and the ETag / compression stages),
+// single_flight (coalesced handler calls), websocket_upgrader (HAVE_WEBSOCKET), and const webserver_config
+// (log_dispatch_error). Owns no state.
 //
 // Internal header; only reachable when compiling libhttpserver.
 #if !defined(HTTPSERVER_COMPILATION)
@@ -42,6 +45,7 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 
 #if MHD_VERSION < 0x00097002
 typedef int MHD_Result;
@@ -59,18 +63,21 @@ class route_table;
 class hook_dispatcher;
 class error_pages;
 class response_materializer;
+class response_cache;
+class single_flight;
 class websocket_upgrader;
 
 class request_dispatcher {
  public:
     request_dispatcher(route_table& routes, hook_dispatcher& hooks,
                        error_pages& errors, response_materializer& materializer,
+                       response_cache& cache, single_flight& flights,
 #ifdef HAVE_WEBSOCKET
                        websocket_upgrader& ws_upgrader,
 #endif  // HAVE_WEBSOCKET
                        const webserver_config& config) noexcept
         : routes_(routes), hooks_(hooks), errors_(errors),
-          materializer_(materializer),
+          materializer_(materializer), cache_(cache), flights_(flights),
 #ifdef HAVE_WEBSOCKET
           ws_upgrader_(ws_upgrader),
 #endif  // HAVE_WEBSOCKET
@@ -83,10 +90,23 @@ class request_dispatcher {
     ~request_dispatcher() = default;
 
     // The finalize stage of the request (called by request_pipeline's
-    // complete_request). Resolves the route, runs the hook gates + handler,
-    // and queues the response. Returns the MHD queue result.
+    // complete_request). Serves a response_cache hit, or resolves the
+    // route, runs the hook gates + handler, and queues the response.
+    // Returns the MHD queue result.
     MHD_Result finalize_answer(MHD_Connection* connection, connection_context* conn);
 
+    // The finalize stage of a single_flight follower that was parked in
+    // dispatch_resource_handler and has been resumed: queue the leader's
+    // shared response (or run the handler when it was not shareable),
+    // after the after_handler hooks.
+    MHD_Result resume_follower(MHD_Connection* connection, connection_context* conn);
+
+    // FILE_UPLOAD_STREAM: look up, before the body is read, the resource
+    // that will serve @p conn and replay its captured URL parameters into
+    // the request. Null when no route matches or the resource does not
+    // allow the method (finalize_answer answers 404 / 405 as usual).
+    std::shared_ptr<http_resource> upload_target(connection_context* conn);
+
  private:
     // Websocket-upgrade probe. Forwards to ws_upgrader_ on HAVE_WEBSOCKET
     // builds; a no-op returning nullopt otherwise. Kept as a helper so the
@@ -95,6 +115,20 @@ class request_dispatcher {
     std::optional<MHD_Result> try_ws_upgrade(MHD_Connection* connection,
                                              connection_context* conn);
 
+    // Queue the fresh response_cache entry for @p conn, if there is one;
+    // called once route resolution and before_handler let the request
+    // through, with the resolved @p resource (null on a miss). Otherwise
+    // leave in @p key what the handler's response is stored under after
+    // after_handler (empty when the request is not cacheable) and return
+    // nullopt.
+    std::optional<MHD_Result> try_cache_hit(MHD_Connection* connection,
+                                            connection_context* conn,
+                                            http_resource* resource,
+                                            std::string* key);
+    // Offer conn->response to the cache under @p key (from try_cache_hit),
+    // once response_materializer::prepare_response has run on it.
+    void store_in_cache(connection_context* conn, std::string key);
+
     // Resolve the resource serving @p conn via routes_.lookup_v2 (cache ->
     // exact -> radix -> regex). Returns true and sets @p hrm on hit (also
     // replays captured params + populates the hook-ctx path template when a
@@ -102,17 +136,38 @@ class request_dispatcher {
     bool resolve_resource_for_request(connection_context* conn,
                                       std::shared_ptr<http_resource>& hrm);
 
-    // Invoke the resource handler bound to @p conn (pointer-to-member
-    // dispatch), populating conn->response. On is_allowed=false, queues a 405
-    // with an Allow header. On handler-throw, routes through the
-    // handler_exception chain / safe internal-error path.
-    void dispatch_resource_handler(connection_context* conn,
+    // Snapshot what the MHD completion callback needs to know about the
+    // resolved @p hrm (per-route hook table, weak_ptr).
+    void note_resolved_resource(connection_context* conn,
+                                const std::shared_ptr<http_resource>& hrm);
+
+    // Populate conn->response for the resolved @p hrm. On is_allowed=false,
+    // a 405 with an Allow header. Otherwise runs the handler, or, when
+    // hrm->single_flight_key() coalesces the request onto a running call,
+    // takes that call's response. Returns true iff the connection was
+    // parked instead (resume_follower finishes it).
+    bool dispatch_resource_handler(MHD_Connection* connection, connection_context* conn,
                                    const std::shared_ptr<http_resource>& hrm);
 
+    // Invoke the resource handler bound to @p conn (pointer-to-member
+    // dispatch), populating conn->response. On handler-throw, routes
+    // through the handler_exception chain / safe internal-error path.
+    void invoke_handler(connection_context* conn, const std::shared_ptr<http_resource>& hrm);
+
+    // hrm->single_flight_key() for @p conn; empty when coalescing is off
+    // or the key function threw.
+    std::string flight_key(connection_context* conn, const std::shared_ptr<http_resource>& hrm);
+
+    // Follower side of a landed flight: stage the leader's response, or
+    // run the handler when it was not shareable.
+    void follow(connection_context* conn, const std::shared_ptr<http_resource>& hrm);
+
     route_table& routes_;
     hook_dispatcher& hooks_;
     error_pages& errors_;
     response_materializer& materializer_;
+    response_cache& cache_;
+    single_flight& flights_;
 #ifdef HAVE_WEBSOCKET
     websocket_upgrader& ws_upgrader_;
 #endif  // HAVE_WEBSOCKET
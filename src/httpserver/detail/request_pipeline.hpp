@@ -29,7 +29,9 @@
 // forwards into first_step / second_step here.
 //
 // Holds const webserver_config& (body-read config), hook_dispatcher& (the
-// request_received / body_chunk gates), and request_dispatcher& (finalize).
+// request_received / body_chunk gates), request_dispatcher& (finalize),
+// upload_writer& (async upload backpressure / flush-before-handler), and
+// upload_budget& (arms each request's budget charge).
 // A friend of http_request (constructs it + writes its per-request fields).
 //
 // Internal header; only reachable when compiling libhttpserver.
@@ -57,12 +59,16 @@ namespace detail {
 struct connection_context;
 class hook_dispatcher;
 class request_dispatcher;
+class upload_budget;
+class upload_writer;
 
 class request_pipeline {
  public:
     request_pipeline(hook_dispatcher& hooks, request_dispatcher& dispatcher,
+                     upload_writer& writer, upload_budget& budget,
                      const webserver_config& config) noexcept
-        : hooks_(hooks), dispatcher_(dispatcher), config_(config) {}
+        : hooks_(hooks), dispatcher_(dispatcher), writer_(writer), budget_(budget),
+          config_(config) {}
 
     request_pipeline(const request_pipeline&) = delete;
     request_pipeline& operator=(const request_pipeline&) = delete;
@@ -72,7 +78,7 @@ class request_pipeline {
 
     // First MHD callback for a fresh request: construct the http_request,
     // fire request_received (short-circuits to skip_handler), and create the
-    // post-processor for form/multipart bodies.
+    // post-processor (or native form_parser) for form/multipart bodies.
     MHD_Result requests_answer_first_step(MHD_Connection* connection,
                                           connection_context* conn);
 
@@ -88,6 +94,23 @@ class request_pipeline {
                                            connection_context* conn);
 
  private:
+    // Append a body chunk to the request content when it is kept there.
+    // Returns false, with the request short-circuited to 503, when the
+    // chunk does not fit the upload memory budget.
+    // The per-chunk body stages: body_chunk hooks, the debug dump,
+    // buffer_content_chunk and the form parser. Returns false once the
+    // request was short-circuited.
+    bool consume_body_bytes(connection_context* conn, const char* upload_data,
+                            size_t upload_data_size);
+
+    // decode_request_body: inflate a wire chunk through conn->decoder,
+    // running consume_body_bytes on every decoded window.
+    void decode_body_chunk(connection_context* conn, const char* upload_data,
+                           size_t upload_data_size);
+
+    bool buffer_content_chunk(connection_context* conn, const char* upload_data,
+                              size_t upload_data_size);
+
     // Stamp the request path/method/version and hand off to the dispatcher's
     // finalize_answer. Called by second_step on the end-of-body signal.
     MHD_Result complete_request(MHD_Connection* connection, connection_context* conn,
@@ -95,6 +118,8 @@ class request_pipeline {
 
     hook_dispatcher& hooks_;
     request_dispatcher& dispatcher_;
+    upload_writer& writer_;
+    upload_budget& budget_;
     const webserver_config& config_;
 };
 
@@ -38,10 +38,10 @@
 #include <microhttpd.h>
 #include <sys/types.h>      // ssize_t
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <memory>           // unique_ptr for digest_challenge_response_body params
 #include <new>              // placement-new used by move_into() overrides
 #include <string>
@@ -50,6 +50,8 @@
 #include <vector>
 
 #include "httpserver/body_kind.hpp"
+#include "httpserver/deferred_producer.hpp"
+#include "httpserver/http_response.hpp"  // frozen_response_state::source
 #include "httpserver/http_utils.hpp"   // digest_algorithm enum
 #include "httpserver/iovec_entry.hpp"
 
@@ -57,6 +59,9 @@ namespace httpserver {
 
 namespace detail {
 
+class file_descriptor_cache;
+class stream_channel;
+
 // Polymorphic body that http_response stores in its small-buffer
 // optimisation slot. materialize() walks across the C++ /
 // libmicrohttpd boundary by returning a fresh MHD_Response* with NO
@@ -155,6 +160,37 @@ class string_response_body final : public response_body {
     std::string data_;
 };
 
+// ---------------------------------------------------------------------------
+// shared_response_body — bytes owned elsewhere (a cache entry, an mmap'd
+// file) and kept alive by a shared owner. materialize() hands MHD the bytes
+// in place together with a reference to the owner, which MHD drops through
+// the free callback when it destroys the MHD_Response; the bytes therefore
+// outlive every connection still sending them, even one queued from a
+// frozen response. A null owner means the bytes are static.
+// ---------------------------------------------------------------------------
+class shared_response_body final : public response_body {
+ public:
+    shared_response_body(const void* data, std::size_t size,
+                         std::shared_ptr<const void> owner) noexcept
+        : owner_(std::move(owner)), data_(data), size_(size) {}
+
+    shared_response_body(shared_response_body&&) noexcept = default;
+
+    body_kind kind() const noexcept override { return body_kind::shared; }
+    std::size_t size() const noexcept override { return size_; }
+    const void* data() const noexcept { return data_; }
+    MHD_Response* materialize() override;
+
+    void move_into(void* dst) noexcept override {
+        ::new (dst) shared_response_body(std::move(*this));
+    }
+
+ private:
+    std::shared_ptr<const void> owner_;
+    const void* data_;
+    std::size_t size_;
+};
+
 // ---------------------------------------------------------------------------
 // file_response_body — opens the file and runs fstat at construction so that:
 //   * size() is accurate immediately (no need to call materialize() first),
@@ -170,16 +206,29 @@ class string_response_body final : public response_body {
 //   are still followed. Callers supplying user-derived paths MUST canonicalize
 //   them (e.g. realpath()) before constructing file_response_body.
 //
+// Deferred open:
+//   http_response::file() constructs with deferred_open_t, so the handler
+//   thread does no I/O and response_materializer can take the fd from
+//   create_webserver::file_descriptor_cache. Until ensure_open() runs,
+//   fd() is -1 and size() is 0; every consumer (range_responder,
+//   response_compressor, materialize()) calls it first, opening the path
+//   directly when the materializer did not.
+//
 // Ownership / lifecycle:
-//   * If open or fstat fails at construction, fd_ == -1 and size_ == 0;
-//     materialize() will return nullptr.
+//   * If open or fstat fails, fd_ == -1 and size_ == 0; materialize() will
+//     return nullptr.
 //   * If materialize() succeeds, MHD owns the fd (MHD_destroy_response closes
 //     it). materialized_ is set to suppress ~file_response_body's close.
 //   * If materialize() is never called, ~file_response_body closes fd_.
 // ---------------------------------------------------------------------------
 class file_response_body final : public response_body {
  public:
-    explicit file_response_body(std::string path) noexcept;
+    // @p precompressed: http_response::file_options::precompressed, read
+    // by response_compressor when it picks a ".br" / ".gz" sibling.
+    explicit file_response_body(std::string path, bool precompressed = false) noexcept;
+    struct deferred_open_t {};
+    // Leaves the open to ensure_open().
+    file_response_body(std::string path, bool precompressed, deferred_open_t) noexcept;
     ~file_response_body() override;
 
     // Hand-written move: transfers fd_ ownership and marks the source as
@@ -196,11 +245,37 @@ class file_response_body final : public response_body {
         ::new (dst) file_response_body(std::move(*this));
     }
 
+    const std::string& path() const noexcept { return path_; }
+    // -1 when the file could not be opened (materialize() then fails) or
+    // the open is still deferred.
+    int fd() const noexcept { return fd_; }
+
+    // Runs a deferred open, through @p cache when given, and returns fd().
+    // A no-op after the first call and for eagerly opened bodies.
+    int ensure_open(file_descriptor_cache* cache = nullptr) noexcept;
+
+    // open(O_NOFOLLOW) + fstat of @p path: the fd, with the file's size in
+    // @p size, or -1 (@p size untouched) unless it is a regular file whose
+    // size fits std::size_t. Shared with file_descriptor_cache.
+    static int open_regular(const std::string& path, std::size_t* size) noexcept;
+    bool precompressed() const noexcept { return precompressed_; }
+
+    // Serve only @p length bytes from @p offset (range_responder's single
+    // range). The caller keeps offset + length within the file; size()
+    // then reports @p length.
+    void select_range(std::uint64_t offset, std::size_t length) noexcept {
+        offset_ = offset;
+        size_ = length;
+    }
+
  private:
     std::string path_;
     std::size_t size_ = 0;
+    std::uint64_t offset_ = 0;
     int fd_ = -1;
     bool materialized_ = false;
+    bool open_pending_ = false;
+    bool precompressed_ = false;
 };
 
 // ---------------------------------------------------------------------------
@@ -226,6 +301,10 @@ class file_response_body final : public response_body {
 //   connection. Do NOT free the underlying buffer data before the
 //   MHD_Response is destroyed.
 //
+//   The iovec_segment factory lifts this: owners_ holds the segments'
+//   owners, and materialize() hands MHD a reference to it, released by the
+//   free callback when the MHD_Response is destroyed.
+//
 // ALLOCATION NOTE:
 //   std::vector unconditionally heap-allocates its backing store, so every
 //   iovec_response_body construction performs one heap allocation. The SBO
@@ -238,8 +317,12 @@ class file_response_body final : public response_body {
 // ---------------------------------------------------------------------------
 class iovec_response_body final : public response_body {
  public:
-    explicit iovec_response_body(std::vector<iovec_entry> entries) noexcept
+    // @p owners (null for borrowed buffers) keeps every buffer alive; the
+    // materialized MHD_Response holds a reference on it until destroyed.
+    explicit iovec_response_body(std::vector<iovec_entry> entries,
+                                 std::shared_ptr<const void> owners = nullptr) noexcept
         : entries_(std::move(entries)),
+          owners_(std::move(owners)),
           total_size_(compute_total_size(entries_)) {}
 
     iovec_response_body(iovec_response_body&&) noexcept = default;
@@ -252,6 +335,10 @@ class iovec_response_body final : public response_body {
         ::new (dst) iovec_response_body(std::move(*this));
     }
 
+    [[nodiscard]] const std::vector<iovec_entry>& entries() const noexcept {
+        return entries_;
+    }
+
  private:
     static std::size_t compute_total_size(
             const std::vector<iovec_entry>& entries) noexcept {
@@ -261,6 +348,7 @@ class iovec_response_body final : public response_body {
     }
 
     std::vector<iovec_entry> entries_;
+    std::shared_ptr<const void> owners_;
     std::size_t total_size_;
 };
 
@@ -272,10 +360,15 @@ class iovec_response_body final : public response_body {
 //   * if materialize() is never called, ~pipe_response_body() must close the fd
 //     to avoid a leak (v1 didn't have to handle this because its
 //     pipe_response always reached the dispatch path)
+// A non-zero block_size_ (pipe_options) swaps MHD_create_response_from_pipe
+// for a callback response reading that many bytes per call; the fd then
+// travels as the callback's cls and the free callback closes it, so the
+// ownership contract above is unchanged.
 // ---------------------------------------------------------------------------
 class pipe_response_body final : public response_body {
  public:
-    explicit pipe_response_body(int fd) noexcept : fd_(fd) {}
+    explicit pipe_response_body(int fd, std::size_t block_size = 0) noexcept
+        : fd_(fd), block_size_(block_size) {}
     ~pipe_response_body() override;
 
     // Hand-written move: transfers fd_ and suppresses the source's close
@@ -290,18 +383,27 @@ class pipe_response_body final : public response_body {
         ::new (dst) pipe_response_body(std::move(*this));
     }
 
+    // Read from the pipe directly, for when the library streams the body
+    // itself instead of handing the fd to MHD (response compression).
+    // Returns the byte count, 0 when a non-blocking pipe has nothing
+    // ready, or MHD_CONTENT_READER_END_OF_STREAM / _END_WITH_ERROR.
+    ssize_t read_some(char* buf, std::size_t max) noexcept;
+
+    std::size_t block_size() const noexcept { return block_size_; }
+
  private:
     int fd_ = -1;
+    std::size_t block_size_ = 0;
     // suppresses ~pipe_response_body's close — MHD owns fd_ after a successful
     // materialize() (mirrors the analogous field in file_response_body).
     bool materialized_ = false;
 };
 
 // ---------------------------------------------------------------------------
-// deferred_response_body — type-erased producer callback. v1 stored a typed
-// callable inside deferred_response<T>; v2 type-erases through
-// std::function so the body fits the SBO budget without templating
-// http_response.
+// deferred_response_body — producer callback. v1 stored a typed callable
+// inside deferred_response<T>; v2 keeps it in a deferred_producer, which
+// stores small callables inline (so they share the http_response SBO)
+// and boxes larger ones, without templating http_response.
 //
 // The trampoline is the C-callable wrapper MHD invokes; it dispatches
 // to producer_. Exposed publicly (static method) so unit tests can
@@ -311,32 +413,24 @@ class pipe_response_body final : public response_body {
 //   trampoline() checks for null cls and empty producer_ before invoking
 //   the callable. MHD's callback mechanism does not catch C++ exceptions;
 //   a null-invoke would call std::terminate() in MHD's IO thread.
-//   If cls is null or producer_ is empty, trampoline returns
-//   MHD_CONTENT_READER_END_WITH_ERROR to signal an error to MHD.
+//   If cls is null or producer_ is empty (e.g. moved-from), trampoline
+//   returns MHD_CONTENT_READER_END_WITH_ERROR to signal an error to MHD.
 //
-// ALLOCATION NOTE:
-//   std::function internally uses small-buffer optimisation (SBO), but
-//   the SBO threshold is implementation-defined (typically 16-32 bytes on
-//   libstdc++ / libc++). Lambdas that capture more than one pointer (e.g.
-//   a user object reference plus a shared_ptr sentinel) will silently
-//   heap-allocate inside std::function. The static_assert on
-//   sizeof(deferred_response_body) only verifies that std::function's control
-//   block fits in the 64-byte SBO buffer, NOT that the callable itself
-//   is stored inline. Callers should minimise captures to stay within
-//   std::function's internal SSO threshold if zero-allocation is required.
+// block_size_ is handed to MHD_create_response_from_callback: the size of
+// the buffer MHD reads each block into, i.e. the largest `max` the
+// producer sees on the non-chunked path.
 // ---------------------------------------------------------------------------
 class deferred_response_body final : public response_body {
  public:
-    using producer_type =
-        std::function<ssize_t(std::uint64_t, char*, std::size_t)>;
-
-    explicit deferred_response_body(producer_type producer) noexcept
-        : producer_(std::move(producer)) {
+    explicit deferred_response_body(
+            deferred_producer producer,
+            std::size_t block_size = deferred_producer::default_block_size) noexcept
+        : producer_(std::move(producer)), block_size_(block_size) {
         // Precondition: caller must not pass a null/empty callable.
         // An empty producer_ would cause trampoline() to return
         // MHD_CONTENT_READER_END_WITH_ERROR on every MHD read callback,
         // which is unlikely to be the caller's intent.
-        assert(producer_ != nullptr &&
+        assert(producer_ &&
                "deferred_response_body: producer must not be empty");
     }
 
@@ -350,13 +444,71 @@ class deferred_response_body final : public response_body {
         ::new (dst) deferred_response_body(std::move(*this));
     }
 
+    std::size_t block_size() const noexcept { return block_size_; }
+
     // Public so unit tests can drive it directly; also passed by name
     // to MHD_create_response_from_callback in materialize().
     static ssize_t trampoline(void* cls, std::uint64_t pos,
                               char* buf, std::size_t max);
 
  private:
-    producer_type producer_;
+    // The callback argument for a producer taking deferred_trailers: the
+    // body, the MHD_Response built for it, and the trailers the producer
+    // adds, buffered in fields until it ends the stream. Heap-allocated,
+    // and freed by MHD, so the body itself still fits the response's
+    // inline storage.
+    struct trailer_binding {
+        deferred_response_body* self;
+        MHD_Response* response;
+        http::footer_fields fields;
+        deferred_trailers trailers;
+    };
+    static ssize_t trailer_trampoline(void* cls, std::uint64_t pos,
+                                      char* buf, std::size_t max);
+
+    deferred_producer producer_;
+    std::size_t block_size_;
+};
+
+// ---------------------------------------------------------------------------
+// stream_response_body — the consumer end of a stream_writer's channel.
+// materialize() hands MHD a heap reference to the channel, released (and
+// the channel detached, closing it for writers) by the free callback when
+// MHD destroys the response. A body dropped without being materialized --
+// e.g. replaced by response_compressor, which reads it through read_some()
+// and park() instead -- detaches in its destructor.
+//
+// response_materializer attaches the channel to its connection before any
+// of this runs, so an empty channel suspends the connection rather than
+// spinning the content reader.
+// ---------------------------------------------------------------------------
+class stream_response_body final : public response_body {
+ public:
+    explicit stream_response_body(std::shared_ptr<stream_channel> channel) noexcept
+        : channel_(std::move(channel)) {}
+    ~stream_response_body() override;
+
+    stream_response_body(stream_response_body&& o) noexcept
+        : channel_(std::move(o.channel_)),
+          materialized_(std::exchange(o.materialized_, true)) {}
+
+    body_kind kind() const noexcept override { return body_kind::stream; }
+    std::size_t size() const noexcept override { return 0; }  // size unknown
+    MHD_Response* materialize() override;
+
+    void move_into(void* dst) noexcept override {
+        ::new (dst) stream_response_body(std::move(*this));
+    }
+
+    stream_channel& channel() const noexcept { return *channel_; }
+
+    // MHD content reader over the channel: reads, parking the connection
+    // when nothing is queued.
+    static ssize_t trampoline(void* cls, std::uint64_t pos, char* buf, std::size_t max);
+
+ private:
+    std::shared_ptr<stream_channel> channel_;
+    bool materialized_ = false;
 };
 
 // ---------------------------------------------------------------------------
@@ -431,6 +583,69 @@ class digest_challenge_response_body final : public response_body {
     std::unique_ptr<params> params_;
 };
 
+// ---------------------------------------------------------------------------
+// frozen_response_state — built once by http_response::freeze(): the source
+// response (which owns the bytes the MHD_Response points at, and its
+// headers), its body, and the MHD_Response materialized and decorated from
+// it. Shared by every frozen_response copy and every in-flight response
+// converted from one. MHD holds its own reference per queued connection, so
+// dropping the last owner only releases ours.
+// ---------------------------------------------------------------------------
+struct frozen_response_state {
+    explicit frozen_response_state(http_response src) noexcept
+        : source(std::move(src)) {}
+    ~frozen_response_state() {
+        if (mhd != nullptr) MHD_destroy_response(mhd);
+        if (MHD_Response* d = with_defaults.load()) MHD_destroy_response(d);
+    }
+    frozen_response_state(const frozen_response_state&) = delete;
+    frozen_response_state& operator=(const frozen_response_state&) = delete;
+
+    http_response source;
+    // Set by freeze() before the state is shared; read-only afterwards.
+    response_body* body = nullptr;
+    MHD_Response* mhd = nullptr;
+    // mhd's decoration plus a webserver's create_webserver::default_headers,
+    // built by the first webserver with defaults to queue this response
+    // (defaults_owner, its response_materializer's id; 0 while unclaimed or
+    // after a failed build). Another webserver with defaults materializes
+    // the response per request instead.
+    mutable std::atomic<std::uint64_t> defaults_owner{0};
+    mutable std::atomic<MHD_Response*> with_defaults{nullptr};
+};
+
+// ---------------------------------------------------------------------------
+// frozen_response_body — the body of a response converted from a
+// frozen_response. The dispatch path queues state().mhd directly; only when
+// headers, footers or cookies were added after conversion does it call
+// materialize(), which builds a fresh MHD_Response from the source body
+// (string / shared / empty / iovec bodies materialize without mutating themselves,
+// so concurrent requests may share the source).
+// ---------------------------------------------------------------------------
+class frozen_response_body final : public response_body {
+ public:
+    explicit frozen_response_body(
+            std::shared_ptr<const frozen_response_state> state) noexcept
+        : state_(std::move(state)) {}
+
+    frozen_response_body(frozen_response_body&&) noexcept = default;
+
+    body_kind kind() const noexcept override { return body_kind::frozen; }
+    std::size_t size() const noexcept override { return state_->body->size(); }
+    MHD_Response* materialize() override { return state_->body->materialize(); }
+
+    void move_into(void* dst) noexcept override {
+        ::new (dst) frozen_response_body(std::move(*this));
+    }
+
+    [[nodiscard]] const frozen_response_state& state() const noexcept {
+        return *state_;
+    }
+
+ private:
+    std::shared_ptr<const frozen_response_state> state_;
+};
+
 // ---------------------------------------------------------------------------
 // SBO budget asserts. Every concrete body must fit in the 64-byte
 // buffer http_response carries. If any of these fires on a new
@@ -445,6 +660,10 @@ static_assert(sizeof(string_response_body) <= 64,
               "string_response_body must fit in http_response SBO (DR-005)");
 static_assert(alignof(string_response_body) <= 16,
               "string_response_body alignment must be <= alignas(16) SBO buffer (DR-005)");
+static_assert(sizeof(shared_response_body) <= 64,
+              "shared_response_body must fit in http_response SBO (DR-005)");
+static_assert(alignof(shared_response_body) <= 16,
+              "shared_response_body alignment must be <= alignas(16) SBO buffer (DR-005)");
 static_assert(sizeof(file_response_body) <= 64,
               "file_response_body must fit in http_response SBO (DR-005)");
 static_assert(alignof(file_response_body) <= 16,
@@ -461,10 +680,18 @@ static_assert(sizeof(deferred_response_body) <= 64,
               "deferred_response_body must fit in http_response SBO (DR-005)");
 static_assert(alignof(deferred_response_body) <= 16,
               "deferred_response_body alignment must be <= 16 (DR-005)");
+static_assert(sizeof(stream_response_body) <= 64,
+              "stream_response_body must fit in http_response SBO (DR-005)");
+static_assert(alignof(stream_response_body) <= 16,
+              "stream_response_body alignment must be <= 16 (DR-005)");
 static_assert(sizeof(digest_challenge_response_body) <= 64,
               "digest_challenge_response_body must fit in http_response SBO (DR-005)");
 static_assert(alignof(digest_challenge_response_body) <= 16,
               "digest_challenge_response_body alignment must be <= 16 (DR-005)");
+static_assert(sizeof(frozen_response_body) <= 64,
+              "frozen_response_body must fit in http_response SBO (DR-005)");
+static_assert(alignof(frozen_response_body) <= 16,
+              "frozen_response_body alignment must be <= 16 (DR-005)");
 
 // Per-subclass nothrow-move contract. http_response::move_into(...) is
 // noexcept, and that depends on every concrete body's move
@@ -476,6 +703,8 @@ static_assert(std::is_nothrow_move_constructible_v<empty_response_body>,
               "empty_response_body move ctor must be noexcept (TASK-009 / DR-005)");
 static_assert(std::is_nothrow_move_constructible_v<string_response_body>,
               "string_response_body move ctor must be noexcept (TASK-009 / DR-005)");
+static_assert(std::is_nothrow_move_constructible_v<shared_response_body>,
+              "shared_response_body move ctor must be noexcept (DR-005)");
 static_assert(std::is_nothrow_move_constructible_v<file_response_body>,
               "file_response_body move ctor must be noexcept (TASK-009 / DR-005)");
 static_assert(std::is_nothrow_move_constructible_v<iovec_response_body>,
@@ -484,8 +713,12 @@ static_assert(std::is_nothrow_move_constructible_v<pipe_response_body>,
               "pipe_response_body move ctor must be noexcept (TASK-009 / DR-005)");
 static_assert(std::is_nothrow_move_constructible_v<deferred_response_body>,
               "deferred_response_body move ctor must be noexcept (TASK-009 / DR-005)");
+static_assert(std::is_nothrow_move_constructible_v<stream_response_body>,
+              "stream_response_body move ctor must be noexcept (DR-005)");
 static_assert(std::is_nothrow_move_constructible_v<digest_challenge_response_body>,
               "digest_challenge_response_body move ctor must be noexcept (DR-005)");
+static_assert(std::is_nothrow_move_constructible_v<frozen_response_body>,
+              "frozen_response_body move ctor must be noexcept (DR-005)");
 
 }  // namespace detail
 
@@ -0,0 +1,150 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// Byte-bounded LRU of frozen responses (create_webserver::response_cache).
+// request_dispatcher looks a request up only after route resolution and
+// the before_handler chain (auth included) let it through, and before
+// dispatching to the handler; a hit never skips those gates.
+//
+// key() spells a GET or HEAD request as its method, path and query
+// string, the values of the configured vary headers and the result of the
+// user key function; other requests, and requests carrying
+// Authorization, get an empty key and bypass the cache. store() keeps a
+// handler's response only when its Cache-Control grants a lifetime
+// (s-maxage, else max-age) and forbids nothing (no-store, no-cache,
+// private), it sets no cookie, its Vary names configured headers only and
+// its body can be frozen (string, shared, empty). The response is frozen
+// in place, so the miss and every later hit queue the same MHD_Response.
+//
+// Entries are spread over kShards shards by path hash, each with its own
+// mutex, LRU list and an equal slice of the byte budget; every variant of
+// a path lives in one shard, so purge(path) locks only that one. Same
+// locking shape as compressed_file_cache within a shard. Expired entries
+// are dropped when a lookup meets them or the LRU evicts them.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "response_cache.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_RESPONSE_CACHE_HPP_
+#define SRC_HTTPSERVER_DETAIL_RESPONSE_CACHE_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "httpserver/http_method.hpp"
+#include "httpserver/http_response.hpp"
+
+namespace httpserver {
+
+class http_request;
+
+namespace detail {
+
+class response_cache {
+ public:
+    using clock = std::chrono::steady_clock;
+    using key_function = std::function<std::string(const http_request&)>;
+
+    static constexpr std::size_t kShards = 16;
+
+    // @p capacity is the budget, in bytes, for bodies, headers and keys;
+    // 0 disables the cache. @p vary lists the request headers that may
+    // tell cached variants apart; @p key_fn, when set, adds its result
+    // to every key.
+    response_cache(std::size_t capacity, std::vector<std::string> vary,
+                   key_function key_fn);
+
+    response_cache(const response_cache&) = delete;
+    response_cache& operator=(const response_cache&) = delete;
+
+    bool enabled() const noexcept { return capacity_ > 0; }
+
+    // The key @p req is cached under, or empty when it is not cacheable.
+    // @p path is the request's normalized path.
+    std::string key(const http_request& req, http_method method,
+                    std::string_view path) const;
+
+    // The response stored under @p key, if it is still fresh. Promotes
+    // the hit.
+    std::optional<frozen_response> find(const std::string& key,
+                                        std::string_view path);
+
+    // When @p resp may be stored, freezes it in place and inserts it
+    // under @p key, evicting least recently used entries of its shard
+    // until the shard's budget holds. Leaves @p resp alone otherwise.
+    void store(std::string key, std::string_view path, http_response& resp);
+
+    // Drops every entry stored for @p path (all methods and variants);
+    // returns how many there were.
+    std::size_t purge(std::string_view path);
+    void clear();
+
+    // Bytes currently charged against the budget.
+    std::size_t used() const;
+
+    // The lifetime Cache-Control value @p cache_control grants a shared
+    // cache; nullopt when it grants none or forbids storing.
+    static std::optional<std::chrono::seconds> lifetime(std::string_view cache_control);
+
+ private:
+    struct entry {
+        std::string key;
+        std::string path;
+        frozen_response response;
+        clock::time_point expires;
+        std::size_t charge = 0;
+    };
+
+    using list_t = std::list<entry>;
+
+    struct shard {
+        mutable std::mutex mutex;
+        std::size_t used = 0;
+        list_t list;
+        std::unordered_map<std::string_view, list_t::iterator> map;  // views into entry::key
+    };
+
+    shard& shard_for(std::string_view path) noexcept;
+    // Whether @p resp's own headers allow storing it under our key.
+    bool storable(const http_response& resp) const;
+    static void erase(shard& s, list_t::iterator it);
+
+    const std::size_t capacity_;
+    const std::size_t shard_capacity_;
+    const std::vector<std::string> vary_;
+    const key_function key_fn_;
+    std::array<shard, kShards> shards_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_RESPONSE_CACHE_HPP_
@@ -0,0 +1,121 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// response_compressor -- the create_webserver::compress_responses stage.
+// response_materializer runs it on conn->response after after_handler
+// hooks and before materialization. It negotiates Accept-Encoding, applies
+// the status / Content-Type / size filters, and swaps the handler's body
+// for an encoded one:
+//
+//   * string and iovec bodies are deflated in one pass into a string body;
+//     the original is kept if compression would not make it smaller.
+//   * deferred and pipe bodies become a deferred body whose producer pulls
+//     from the original and deflates as it goes. When the original has
+//     nothing ready (returns 0) the pending output is sync-flushed, so a
+//     slow producer's bytes still reach the client promptly.
+//   * file bodies are swapped for a ".br" / ".gz" sibling when the response
+//     opted in (file_options::precompressed); otherwise, with
+//     compressed_file_cache on, for a compressed copy held in memory and
+//     served as a shared body, so a hot file is compressed once per
+//     (mtime, size).
+//
+// Every response that passes the filters gains Vary: Accept-Encoding,
+// whether or not this client gets it compressed. A friend of http_response
+// (swaps body_).
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "response_compressor.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_RESPONSE_COMPRESSOR_HPP_
+#define SRC_HTTPSERVER_DETAIL_RESPONSE_COMPRESSOR_HPP_
+
+#include <cstdint>
+#include <string_view>
+
+#include "httpserver/detail/compressed_file_cache.hpp"
+
+namespace httpserver {
+
+struct webserver_config;
+class http_request;
+class http_response;
+
+namespace detail {
+
+class response_compressor {
+ public:
+    // Content codings this build can produce, plus br, which is only
+    // ever served from a precompressed ".br" file: zlib is the only
+    // compressor linked.
+    enum class coding : std::uint8_t { identity, gzip, deflate, br };
+
+    explicit response_compressor(const webserver_config& config) noexcept;
+
+    response_compressor(const response_compressor&) = delete;
+    response_compressor& operator=(const response_compressor&) = delete;
+    response_compressor(response_compressor&&) = delete;
+    response_compressor& operator=(response_compressor&&) = delete;
+    ~response_compressor() = default;
+
+    // Encode @p resp for @p req when it passes the filters. Never throws:
+    // on any failure the response goes out unencoded.
+    void apply(const http_request& req, http_response& resp) noexcept;
+
+    // The coding to use for an Accept-Encoding value (RFC 9110 §12.5.3):
+    // the highest q-value among gzip / x-gzip, deflate and "*" (and br
+    // with @p allow_br), br then gzip on a tie; identity when the header
+    // is absent or rules them all out.
+    static coding negotiate(std::string_view accept_encoding,
+                            bool allow_br = false) noexcept;
+
+    // True when @p content_type (parameters allowed) matches one of
+    // webserver_config::compression_types.
+    bool compressible_type(std::string_view content_type) const noexcept;
+
+ private:
+    // Replace resp's body with a one-pass encoding of its string / iovec
+    // bytes. False (body untouched) when it is below compression_min_size,
+    // would not shrink, or zlib fails.
+    bool encode_buffer(http_response& resp, coding c) const;
+    // Replace resp's deferred / pipe body with one that encodes it as it
+    // streams. False (body untouched) when zlib cannot be initialised.
+    bool encode_stream(http_response& resp, coding c) const;
+
+    // The file-body branch of apply().
+    void apply_file(const http_request& req, http_response& resp);
+    // Swap resp's file body for the ".br" / ".gz" sibling @p accept_encoding
+    // prefers. False (body untouched) when none applies or exists.
+    static bool serve_sidecar(http_response& resp, std::string_view accept_encoding);
+    // Swap resp's file body for its cached encoding, compressing and
+    // caching it on a miss. False (body untouched) when the file is outside
+    // the size bounds, unreadable, or does not shrink.
+    bool serve_cached(http_response& resp, coding c);
+
+    const webserver_config& config_;
+    // create_webserver::compressed_file_cache; capacity 0 when off.
+    compressed_file_cache files_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_RESPONSE_COMPRESSOR_HPP_
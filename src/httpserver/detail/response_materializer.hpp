@@ -36,8 +36,15 @@
 
 #include <microhttpd.h>
 
+#include <cstdint>
 #include <string>
 
+#include "httpserver/detail/file_descriptor_cache.hpp"
+#include "httpserver/detail/etag_responder.hpp"
+#include "httpserver/detail/range_responder.hpp"
+#include "httpserver/detail/response_compressor.hpp"
+#include "httpserver/detail/stream_channel.hpp"
+
 #if MHD_VERSION < 0x00097002
 typedef int MHD_Result;
 #endif
@@ -52,6 +59,7 @@ namespace detail {
 
 struct connection_context;
 class error_pages;
+struct frozen_response_state;
 class hook_dispatcher;
 
 class response_materializer {
@@ -59,9 +67,7 @@ class response_materializer {
     response_materializer(error_pages& errors,
                           hook_dispatcher& hook_dispatch,
                           const std::string& digest_opaque,
-                          const webserver_config& config) noexcept
-        : errors_(errors), hook_dispatch_(hook_dispatch),
-          digest_opaque_(digest_opaque), config_(config) {}
+                          const webserver_config& config) noexcept;
 
     response_materializer(const response_materializer&) = delete;
     response_materializer& operator=(const response_materializer&) = delete;
@@ -69,13 +75,37 @@ class response_materializer {
     response_materializer& operator=(response_materializer&&) = delete;
     ~response_materializer() = default;
 
-    // Final stage of the request: materialise conn->response, decorate, queue,
-    // fire response_sent, destroy the MHD handle. @p resource is the resolved
+    // Final stage of the request: open a file response's path (through
+    // file_descriptor_cache when on), bind a stream response to the
+    // connection, answer conditional / range requests
+    // for it, encode conn->response (compress_responses,
+    // precompressed file siblings), materialise, decorate, queue, fire
+    // response_sent, destroy the MHD handle. @p resource is the resolved
     // resource (nullptr when none) forwarded to the response_sent gate so it
     // reaches the per-route hook table without a weak_ptr lock().
     MHD_Result materialize_and_queue_response(MHD_Connection* connection,
                                               connection_context* conn,
                                               http_resource* resource);
+    // materialize_and_queue_response in two halves, so request_dispatcher
+    // can store the response in response_cache between them -- after its
+    // ETag and encoding, which a frozen response no longer takes.
+    // prepare_response opens / binds the body and runs the range, ETag
+    // and compression stages; queue_prepared_response does the rest.
+    void prepare_response(MHD_Connection* connection, connection_context* conn);
+    MHD_Result queue_prepared_response(MHD_Connection* connection,
+                                       connection_context* conn,
+                                       http_resource* resource);
+
+    // Ask the response's body to produce a fresh headerless MHD_Response.
+    static struct MHD_Response* materialize_response(http_response* resp);
+    // Attach the response's header/footer/cookie maps to a materialised
+    // MHD_Response. Also used once by http_response::freeze().
+    static void decorate_mhd_response(struct MHD_Response* response,
+                                      const http_response& resp);
+
+    // Streams (http_response::stream) bound to a live connection;
+    // webserver::stop() closes them around MHD_stop_daemon().
+    stream_registry& streams() noexcept { return streams_; }
 
  private:
     // Materialise conn->response into a raw MHD_Response, routing any
@@ -90,17 +120,45 @@ class response_materializer {
                                         connection_context* conn,
                                         MHD_Response* raw_response);
 
-    // Ask the response's body to produce a fresh headerless MHD_Response.
-    static struct MHD_Response* materialize_response(http_response* resp);
-    // Attach the response's header/footer/cookie maps to a materialised
-    // MHD_Response.
-    static void decorate_mhd_response(struct MHD_Response* response,
-                                      const http_response& resp);
+    // The MHD_Response prebuilt by freeze() -- or, with default_headers,
+    // its shared copy carrying them -- when @p resp is a frozen response
+    // nothing was added to since conversion; nullptr otherwise.
+    struct MHD_Response* shared_frozen_response(const http_response& resp) const;
+    // The frozen state's with_defaults response, built here on first use;
+    // nullptr when another webserver owns it or building it failed.
+    struct MHD_Response* shared_frozen_with_defaults(
+        const frozen_response_state& state) const noexcept;
+    // Add create_webserver::default_headers to a materialised response,
+    // skipping those @p resp (or its frozen source) sets itself.
+    void add_default_headers(struct MHD_Response* response,
+                             const http_response& resp) const;
+
+    // Run a file body's deferred open through files_ when the cache is on;
+    // otherwise the first consumer opens the path itself.
+    void open_through_cache(http_response& resp) noexcept;
+    // Bind a stream body's channel to @p connection so an empty channel
+    // suspends it, and track it in streams_.
+    void attach_stream(MHD_Connection* connection, http_response& resp) noexcept;
 
     error_pages& errors_;
     hook_dispatcher& hook_dispatch_;
     const std::string& digest_opaque_;
     const webserver_config& config_;
+    // This webserver's claim on a frozen response's with_defaults copy
+    // (frozen_response_state::defaults_owner); unique per process.
+    const std::uint64_t server_id_;
+    // create_webserver::file_descriptor_cache; max_entries 0 when off.
+    file_descriptor_cache files_;
+    // create_webserver::file_range_requests.
+    range_responder ranges_;
+    // create_webserver::generate_etags.
+    etag_responder etags_;
+    // compress_responses and file_options::precompressed; also holds the
+    // compressed_file_cache.
+    response_compressor compressor_;
+    stream_registry streams_;
+    // MHD_USE_SUSPEND_RESUME is set and the threading model can suspend.
+    const bool streams_can_suspend_;
 };
 
 }  // namespace detail
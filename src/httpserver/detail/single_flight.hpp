@@ -0,0 +1,134 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// single_flight -- request coalescing for resources that override
+// http_resource::single_flight_key. request_dispatcher joins every keyed
+// request to the flight for (resource, key): the first request leads and
+// runs the handler; the ones arriving while it runs follow. When the
+// leader lands, its response is frozen in place (only if anyone is
+// following) and every follower queues a copy of that frozen response
+// instead of calling the handler again. A response that cannot be frozen
+// (file, deferred, pipe, ...) is not shared; its followers then run the
+// handler themselves.
+//
+// Followers are parked with MHD_suspend_connection and resumed by land()
+// -- the upload_writer pattern, including suspending and resuming under
+// the same lock. Under THREAD_PER_CONNECTION, where MHD cannot suspend,
+// they wait on their own thread instead. Without MHD_USE_SUSPEND_RESUME
+// (create_webserver::deferred() off) a follower would stall every
+// connection its worker thread multiplexes, so coalescing is off.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "single_flight.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_SINGLE_FLIGHT_HPP_
+#define SRC_HTTPSERVER_DETAIL_SINGLE_FLIGHT_HPP_
+
+#include <microhttpd.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "httpserver/http_response.hpp"
+
+namespace httpserver {
+
+class http_resource;
+
+namespace detail {
+
+class single_flight {
+ public:
+    enum class mode { off, park, block };
+
+    // What join() made of the request.
+    enum class role {
+        lead,    // run the handler, then land()
+        parked,  // suspended; MHD calls back once the leader landed
+        follow   // the leader landed; take() its response
+    };
+
+    // One handler call and the requests waiting on it. `resource` is
+    // immutable; the rest is guarded by `mutex`.
+    struct flight {
+        std::shared_ptr<http_resource> resource;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<MHD_Connection*> parked;
+        std::size_t blocked = 0;
+        bool landed = false;
+        std::optional<frozen_response> result;
+    };
+
+    // A connection's part in a flight, held by connection_context.
+    struct ticket {
+        std::shared_ptr<flight> joined;
+        std::string key;                       // set for the leader
+        MHD_Connection* connection = nullptr;  // set while parked
+
+        // Called when the connection is torn down: land() must never
+        // resume a connection MHD has already released.
+        void leave() noexcept;
+    };
+
+    explicit single_flight(mode m) noexcept : mode_(m) {}
+
+    single_flight(const single_flight&) = delete;
+    single_flight& operator=(const single_flight&) = delete;
+
+    bool enabled() const noexcept { return mode_ != mode::off; }
+
+    // Join @p connection to the flight for @p resource and @p key,
+    // starting one when none is in the air. Followers park (or block)
+    // here; @p t records the membership.
+    role join(const std::shared_ptr<http_resource>& resource, const std::string& key,
+              MHD_Connection* connection, ticket* t);
+
+    // End the flight @p t leads with the leader's @p resp (null when
+    // there is none): freeze it in place for the followers, if there are
+    // any and it can be frozen, then release them. Clears @p t.
+    void land(ticket* t, http_response* resp);
+
+    // The leader's shared response for the follower holding @p t;
+    // nullopt when it was not shareable. Clears @p t.
+    static std::optional<frozen_response> take(ticket* t);
+
+    // Flights currently in the air.
+    std::size_t in_flight() const;
+
+ private:
+    const mode mode_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<flight>> flights_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_SINGLE_FLIGHT_HPP_
@@ -0,0 +1,104 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// Fan-out behind sse_channel: the subscribed stream_channels, the replay
+// ring of recent events and the keep-alive timer.
+//
+// publish() encodes an event once into a shared_ptr<const std::string> and
+// push()es that same buffer onto every subscriber, under one mutex, so a
+// subscriber replayed from the ring at subscribe() time sees no gap and no
+// duplicate before the live events. Subscribers whose queue is full are
+// aborted (their connection closes); closed ones are pruned as they are
+// met. The timer thread sleeps on a condition variable and only sends a
+// keep-alive comment when nothing was published for a whole period.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "sse_hub.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_SSE_HUB_HPP_
+#define SRC_HTTPSERVER_DETAIL_SSE_HUB_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace httpserver {
+namespace detail {
+
+class stream_channel;
+
+class sse_hub {
+ public:
+    sse_hub(std::size_t replay_events, std::chrono::milliseconds keep_alive);
+    // Stops the timer and finishes every subscriber.
+    ~sse_hub();
+
+    sse_hub(const sse_hub&) = delete;
+    sse_hub& operator=(const sse_hub&) = delete;
+
+    // The wire form of one event. Throws std::invalid_argument when
+    // @p event or @p id contains CR, LF or NUL.
+    static std::string encode(std::string_view data, std::string_view event,
+                              std::string_view id);
+
+    // Queues the events published after @p last_event_id (none when it is
+    // empty or no longer in the ring) and adds @p channel to the fan-out.
+    void subscribe(std::shared_ptr<stream_channel> channel,
+                   std::string_view last_event_id);
+    // Sends @p frame, an encode()d event, to every subscriber; a non-empty
+    // @p id makes it resumable.
+    void publish(std::shared_ptr<const std::string> frame, std::string id);
+    std::size_t subscribers();
+
+ private:
+    struct replay_entry {
+        std::string id;
+        std::shared_ptr<const std::string> frame;
+    };
+
+    // Pushes @p frame to every live subscriber. Requires mutex_.
+    void broadcast_locked(const std::shared_ptr<const std::string>& frame);
+    void prune_locked();
+    void keep_alive_loop();
+
+    const std::size_t replay_events_;
+    const std::chrono::milliseconds keep_alive_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<stream_channel>> subscribers_;
+    std::deque<replay_entry> replay_;
+    bool published_ = false;        // since the last keep-alive tick
+    bool stopping_ = false;
+    std::thread timer_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_SSE_HUB_HPP_
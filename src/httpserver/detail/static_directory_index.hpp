@@ -0,0 +1,111 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// Metadata index behind static_directory_resource: an entry-bounded LRU
+// from a normalized URL path under the resource's root to what a
+// response for it needs -- the file to serve (the directory's index file
+// for a directory), its Content-Type, ETag and Last-Modified -- built
+// lazily, one lstat() per miss.
+//
+// Entries are revalidated by age: for @c ttl after it was built an entry
+// is served without touching the filesystem. Paths that name no servable
+// file are not cached, so probing random URLs cannot evict the hot set.
+// Entries are shared_ptrs: a request holding one keeps it alive after
+// eviction. Same locking shape as route_cache.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "static_directory_index.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_STATIC_DIRECTORY_INDEX_HPP_
+#define SRC_HTTPSERVER_DETAIL_STATIC_DIRECTORY_INDEX_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "httpserver/header_fields.hpp"
+
+namespace httpserver {
+namespace detail {
+
+// What a response for one URL path serves.
+struct static_file_info {
+    std::string path;
+    http::static_text content_type;
+    std::string etag;
+    std::string last_modified;
+};
+
+class static_directory_index {
+ public:
+    using clock = std::chrono::steady_clock;
+
+    // @p root: an absolute directory path (no trailing '/' needed).
+    // @p max_entries 0 disables caching: every lookup runs lstat().
+    static_directory_index(std::string root, std::vector<std::string> index_files,
+                           std::size_t max_entries, clock::duration ttl);
+
+    static_directory_index(const static_directory_index&) = delete;
+    static_directory_index& operator=(const static_directory_index&) = delete;
+
+    // The file served for @p rel, a normalized path ("/" or "/a/b") below
+    // the root; nullptr unless it names a regular file, or a directory
+    // holding one of the index files. Symlinks (the last component) are
+    // not served. Promotes a hit.
+    std::shared_ptr<const static_file_info> lookup(const std::string& rel);
+
+    // Entries currently held.
+    std::size_t entries() const;
+
+ private:
+    struct entry {
+        std::string rel;
+        std::shared_ptr<const static_file_info> info;
+        clock::time_point expires;
+    };
+
+    using list_t = std::list<entry>;
+    using map_t = std::unordered_map<std::string, list_t::iterator>;
+
+    // lstat() @p rel (and, for a directory, its index files).
+    std::shared_ptr<const static_file_info> load(const std::string& rel) const;
+    std::shared_ptr<const static_file_info> find(const std::string& rel);
+    void insert(const std::string& rel, std::shared_ptr<const static_file_info> info);
+
+    const std::string root_;
+    const std::vector<std::string> index_files_;
+    const std::size_t max_entries_;
+    const clock::duration ttl_;
+    mutable std::mutex mutex_;
+    list_t list_;
+    map_t map_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_STATIC_DIRECTORY_INDEX_HPP_
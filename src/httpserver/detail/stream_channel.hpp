@@ -0,0 +1,169 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// stream_channel -- the bounded byte ring between a stream_writer (any
+// application thread) and the MHD content reader of the response built by
+// http_response::stream().
+//
+// The reader never blocks a worker: when the ring is empty it suspends the
+// connection (MHD_suspend_connection) and the next write(), finish() or
+// abort resumes it. Suspend and resume both happen under the channel's
+// mutex, so a resume can never overtake the suspend it answers (same rule
+// as upload_writer). Where MHD cannot suspend -- THREAD_PER_CONNECTION, or
+// a daemon started without create_webserver::deferred() -- the reader
+// waits on a condition variable on the connection's own thread instead.
+// A writer blocks in write() only while the ring is full.
+//
+// push() queues refcounted frames instead of copying into the ring, so one
+// encoded buffer can feed many channels (sse_channel). A channel is fed
+// either through write()/try_write() or through push(), not both.
+//
+// stream_registry tracks the channels bound to a live connection so
+// webserver::stop() can end them: MHD refuses to stop with connections
+// still suspended.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "stream_channel.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_STREAM_CHANNEL_HPP_
+#define SRC_HTTPSERVER_DETAIL_STREAM_CHANNEL_HPP_
+
+#include <microhttpd.h>
+#include <sys/types.h>      // ssize_t
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace httpserver {
+namespace detail {
+
+class stream_registry;
+
+class stream_channel {
+ public:
+    // @p capacity bytes of ring; must be > 0.
+    explicit stream_channel(std::size_t capacity);
+    ~stream_channel();
+
+    stream_channel(const stream_channel&) = delete;
+    stream_channel& operator=(const stream_channel&) = delete;
+
+    // --- writer side (any thread) ---
+
+    // Queues as much of @p data as fits; returns the bytes taken (0 when
+    // full, finished or closed).
+    std::size_t try_write(std::string_view data);
+    // Queues all of @p data, waiting while the ring is full. False once the
+    // channel is closed (part of @p data may have been queued) or finished.
+    bool write(std::string_view data);
+    // Queues @p frame by reference, without copying it. False when closed
+    // or finished, or when the frames already queued plus this one would
+    // exceed the capacity (a single frame is always accepted into an
+    // empty queue).
+    bool push(std::shared_ptr<const std::string> frame);
+    // No more data: the response ends once the ring drains.
+    void finish() noexcept;
+    // The response is gone (sent in full, client disconnected, server
+    // stopped); further writes are dropped.
+    bool closed() const noexcept;
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    // --- reader side (the connection's MHD thread) ---
+
+    // Copies up to @p max queued bytes into @p buf. 0 when nothing is
+    // queued yet; MHD_CONTENT_READER_END_OF_STREAM once finished and
+    // drained; MHD_CONTENT_READER_END_WITH_ERROR once aborted.
+    ssize_t read(char* buf, std::size_t max) noexcept;
+    // Called after read() returned 0. Suspends the connection until the
+    // next write and returns true; or, when suspending is not possible,
+    // waits for data and returns false. Also false when data arrived
+    // in between.
+    bool park() noexcept;
+
+    // --- lifecycle ---
+
+    // Binds the channel to the connection it is queued on and registers
+    // it with @p registry (nullptr: not tracked). Called once, by
+    // response_materializer, before the response is queued.
+    void attach(MHD_Connection* connection, bool can_suspend,
+                stream_registry* registry) noexcept;
+    // The response was destroyed: close for writers, leave the registry.
+    void detach() noexcept;
+    // Server shutdown: fail the response and resume a parked connection.
+    void abort() noexcept;
+
+ private:
+    // Resumes a parked connection and wakes waiters. Requires mutex_.
+    void wake_locked() noexcept;
+    bool readable_locked() const noexcept {
+        return size_ > 0 || !frames_.empty() || finished_ || aborted_;
+    }
+    std::size_t read_frames_locked(char* buf, std::size_t max) noexcept;
+
+    const std::size_t capacity_;
+    std::unique_ptr<char[]> ring_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::size_t head_ = 0;          // next byte to read
+    std::size_t size_ = 0;          // bytes queued
+    std::deque<std::shared_ptr<const std::string>> frames_;
+    std::size_t frame_offset_ = 0;  // bytes of frames_.front() already read
+    std::size_t frame_bytes_ = 0;   // unread bytes across frames_
+    MHD_Connection* connection_ = nullptr;
+    stream_registry* registry_ = nullptr;
+    bool can_suspend_ = false;
+    bool suspended_ = false;
+    bool finished_ = false;
+    bool aborted_ = false;
+    bool detached_ = false;
+};
+
+class stream_registry {
+ public:
+    stream_registry() = default;
+    stream_registry(const stream_registry&) = delete;
+    stream_registry& operator=(const stream_registry&) = delete;
+
+    // False while closed: the caller must not park the channel.
+    bool add(stream_channel* channel);
+    void remove(stream_channel* channel) noexcept;
+    // abort() every registered channel and refuse new ones until
+    // reopen(); brackets MHD_stop_daemon() in webserver::stop().
+    void close() noexcept;
+    void reopen() noexcept;
+
+ private:
+    std::mutex mutex_;
+    std::unordered_set<stream_channel*> channels_;
+    bool closed_ = false;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_STREAM_CHANNEL_HPP_
@@ -0,0 +1,154 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// upload_budget -- process-wide accounting of request-body bytes held by
+// in-progress requests (create_webserver::upload_memory_budget /
+// upload_disk_budget). Two counters:
+//
+//   memory  body bytes buffered in the request: grow_content() and the
+//           form / in-memory upload args, all of which live in the
+//           connection arena or its heap overflow blocks.
+//   disk    bytes written (or queued for writing) to upload files under
+//           file_upload_dir.
+//
+// Every request holds a charge (connection_context::budget) that records
+// what it reserved; the charge returns its bytes when the
+// connection_context is destroyed at request completion. A reservation
+// that would push a counter past its limit fails, and the caller rejects
+// the request with rejection_response() -- 503 for memory, 507 for disk.
+// A limit of 0 means unlimited; usage is still counted so it can be
+// reported through webserver::get_upload_usage().
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "upload_budget.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_UPLOAD_BUDGET_HPP_
+#define SRC_HTTPSERVER_DETAIL_UPLOAD_BUDGET_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "httpserver/http_response.hpp"
+
+namespace httpserver {
+namespace detail {
+
+class upload_budget {
+ public:
+    enum class kind : std::uint8_t { memory = 0, disk = 1 };
+
+    // Per-request tally. Move-only; releases everything it reserved when
+    // destroyed. A default-constructed charge (no budget) accepts every
+    // reservation, so code paths without an owning webserver still work.
+    class charge {
+     public:
+        charge() noexcept = default;
+        explicit charge(upload_budget* budget) noexcept : budget_(budget) {}
+        ~charge() { release(); }
+
+        charge(const charge&) = delete;
+        charge& operator=(const charge&) = delete;
+        charge(charge&& o) noexcept : budget_(o.budget_), held_(o.held_) {
+            o.budget_ = nullptr;
+        }
+        charge& operator=(charge&& o) noexcept {
+            if (this != &o) {
+                release();
+                budget_ = o.budget_;
+                held_ = o.held_;
+                o.budget_ = nullptr;
+            }
+            return *this;
+        }
+
+        // Reserve @p bytes of @p k. Returns false (reserving nothing) if
+        // that would exceed the limit.
+        bool reserve(kind k, std::size_t bytes) noexcept {
+            if (budget_ == nullptr || bytes == 0) return true;
+            if (!budget_->acquire(k, bytes)) return false;
+            held_[index(k)] += bytes;
+            return true;
+        }
+
+        void release() noexcept {
+            if (budget_ == nullptr) return;
+            budget_->give_back(kind::memory, held_[0]);
+            budget_->give_back(kind::disk, held_[1]);
+            held_ = {};
+        }
+
+     private:
+        upload_budget* budget_ = nullptr;
+        std::array<std::size_t, 2> held_{};
+    };
+
+    upload_budget(std::size_t memory_limit, std::size_t disk_limit) noexcept
+        : limit_{memory_limit, disk_limit} {}
+
+    upload_budget(const upload_budget&) = delete;
+    upload_budget& operator=(const upload_budget&) = delete;
+    upload_budget(upload_budget&&) = delete;
+    upload_budget& operator=(upload_budget&&) = delete;
+    ~upload_budget() = default;
+
+    std::size_t in_use(kind k) const noexcept {
+        return used_[index(k)].load(std::memory_order_relaxed);
+    }
+    std::size_t limit(kind k) const noexcept { return limit_[index(k)]; }
+
+    // 503 Service Unavailable (memory) or 507 Insufficient Storage (disk),
+    // with a Retry-After hint: the budget frees up as requests complete.
+    static http_response rejection_response(kind k);
+
+ private:
+    static constexpr std::size_t index(kind k) noexcept {
+        return static_cast<std::size_t>(k);
+    }
+
+    bool acquire(kind k, std::size_t bytes) noexcept {
+        auto& used = used_[index(k)];
+        const std::size_t limit = limit_[index(k)];
+        if (limit == 0) {
+            used.fetch_add(bytes, std::memory_order_relaxed);
+            return true;
+        }
+        std::size_t cur = used.load(std::memory_order_relaxed);
+        do {
+            if (bytes > limit || cur > limit - bytes) return false;
+        } while (!used.compare_exchange_weak(cur, cur + bytes, std::memory_order_relaxed));
+        return true;
+    }
+
+    void give_back(kind k, std::size_t bytes) noexcept {
+        if (bytes != 0) used_[index(k)].fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    const std::array<std::size_t, 2> limit_;
+    std::array<std::atomic<std::size_t>, 2> used_{};
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_UPLOAD_BUDGET_HPP_
@@ -21,9 +21,10 @@
 // upload_pipeline -- behavior service (DR-014, §4.11) owning multipart /
 // file-upload handling: the MHD post-iterator body (no-file form args and
 // file chunks), the on-disk destination selection, and the per-(key,
-// filename) output-stream lifecycle. Holds only const webserver_config&
+// filename) output-stream lifecycle. Holds const webserver_config&
 // (file_upload_target / file_upload_dir / generate_random_filename_on_upload)
-// and operates on conn->request / conn->upload_* fields.
+// plus the webserver's upload_writer, and operates on conn->request /
+// conn->upload_* fields.
 //
 // The webserver_impl::post_iterator static MHD trampoline forwards here:
 // the no-file branch calls the static handle_post_form_arg (safe without an
@@ -55,11 +56,12 @@ namespace http { class file_info; }
 namespace detail {
 
 struct connection_context;
+class upload_writer;
 
 class upload_pipeline {
  public:
-    explicit upload_pipeline(const webserver_config& config) noexcept
-        : config_(config) {}
+    upload_pipeline(const webserver_config& config, upload_writer& writer) noexcept
+        : config_(config), writer_(writer) {}
 
     upload_pipeline(const upload_pipeline&) = delete;
     upload_pipeline& operator=(const upload_pipeline&) = delete;
@@ -77,12 +79,18 @@ class upload_pipeline {
 
     // File-upload branch of the post iterator: mirror the value into the
     // request args (unless disk-only), then stream the chunk to disk (unless
-    // memory-only), per config_.file_upload_target. Contains the
-    // generateFilenameException guard.
+    // memory-only), per config_.file_upload_target. Under FILE_UPLOAD_STREAM
+    // a named file goes to the resource's on_upload_chunk instead. Contains
+    // the generateFilenameException guard.
     MHD_Result iterate_file(connection_context* conn, const char* key,
                             const char* filename, const char* content_type,
                             const char* transfer_encoding, const char* data,
-                            size_t size);
+                            size_t size, uint64_t off);
+
+    // FILE_UPLOAD_STREAM: deliver the final (is_last) call for the open
+    // part, if any. Called at end of body. Returns false, with the request
+    // short-circuited to 500, if the resource refused it.
+    static bool end_streamed_part(connection_context* conn);
 
  private:
     // First chunk for a (key, filename) pair: choose the on-disk destination
@@ -97,6 +105,13 @@ class upload_pipeline {
     static void manage_upload_stream(connection_context* conn, const char* filename,
                                      const char* key, http::file_info& file);
 
+    // async_upload_writes variant of the disk write: (re)open the
+    // destination for conn->upload_async when the (filename, key) pair
+    // changes, then queue the chunk on writer_ at the file's current size.
+    MHD_Result queue_file_chunk(connection_context* conn, const char* filename,
+                                const char* key, const http::file_info& file,
+                                const char* data, size_t size) const;
+
     // Stream one upload chunk to disk, setting up the file_info + stream on
     // the first chunk.
     MHD_Result process_file_upload(connection_context* conn, const char* key,
@@ -104,7 +119,16 @@ class upload_pipeline {
                                    const char* transfer_encoding,
                                    const char* data, size_t size) const;
 
+    // FILE_UPLOAD_STREAM variant of the file branch: close the previous
+    // part when a new one starts, then hand the chunk to the resource.
+    static MHD_Result stream_file_chunk(connection_context* conn, const char* key,
+                                        const char* filename,
+                                        const char* content_type,
+                                        const char* data, size_t size,
+                                        uint64_t off);
+
     const webserver_config& config_;
+    upload_writer& writer_;
 };
 
 }  // namespace detail
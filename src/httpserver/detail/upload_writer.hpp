@@ -0,0 +1,154 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+// upload_writer -- the opt-in asynchronous disk sink for file uploads
+// (create_webserver::async_upload_writes). upload_pipeline copies each
+// upload chunk into a queued job; one dedicated writer thread pwrite()s the
+// jobs in FIFO order, so a slow disk no longer stalls the MHD worker that
+// multiplexes every other connection.
+//
+// Backpressure: the writer tracks the bytes queued but not yet written.
+// When that total exceeds the configured budget, request_pipeline suspends
+// the connection that just queued (MHD_suspend_connection) and the writer
+// resumes it once the budget recovers or the connection's own writes have
+// all landed. Before the handler runs, complete_request waits the same way
+// for the connection's writes to finish, so handlers always see complete
+// files. Under THREAD_PER_CONNECTION (where MHD cannot suspend) both waits
+// block the connection's own thread instead.
+//
+// Internal header; only reachable when compiling libhttpserver.
+#if !defined(HTTPSERVER_COMPILATION)
+#error "upload_writer.hpp is internal; only reachable when compiling libhttpserver."
+#endif
+
+#ifndef SRC_HTTPSERVER_DETAIL_UPLOAD_WRITER_HPP_
+#define SRC_HTTPSERVER_DETAIL_UPLOAD_WRITER_HPP_
+
+#include <microhttpd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace httpserver {
+namespace detail {
+
+class upload_writer {
+ public:
+    // An open destination file. Shared by the connection and every queued
+    // job, so the descriptor is closed only after the last write landed.
+    struct file_handle {
+        explicit file_handle(int fd) noexcept : fd(fd) {}
+        ~file_handle();
+        file_handle(const file_handle&) = delete;
+        file_handle& operator=(const file_handle&) = delete;
+
+        const int fd;
+    };
+
+    // Per-connection write state, held by connection_context (and by its
+    // queued jobs). `file` / `key` / `filename` are touched only by the
+    // connection's MHD thread; the remaining fields are guarded by `mutex`.
+    struct stream {
+        std::shared_ptr<file_handle> file;
+        std::string key;
+        std::string filename;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        MHD_Connection* suspended = nullptr;
+        std::size_t pending = 0;
+        bool failed = false;
+
+        // Called when the connection is torn down: the writer must never
+        // resume a connection MHD has already released.
+        void detach() noexcept {
+            std::lock_guard<std::mutex> lock(mutex);
+            suspended = nullptr;
+        }
+    };
+
+    // @p max_in_flight_bytes == 0 disables the writer (no thread is
+    // started). @p can_suspend is false under THREAD_PER_CONNECTION.
+    upload_writer(std::size_t max_in_flight_bytes, bool can_suspend);
+    ~upload_writer();
+
+    upload_writer(const upload_writer&) = delete;
+    upload_writer& operator=(const upload_writer&) = delete;
+    upload_writer(upload_writer&&) = delete;
+    upload_writer& operator=(upload_writer&&) = delete;
+
+    bool enabled() const noexcept { return max_in_flight_ != 0; }
+
+    // Bytes queued but not yet written, across every connection.
+    std::size_t in_flight_bytes() const noexcept {
+        return in_flight_.load(std::memory_order_relaxed);
+    }
+
+    // Copy @p size bytes and queue them for pwrite() at @p offset of
+    // s->file. Returns false (queuing nothing) once an earlier write on
+    // this stream has failed.
+    bool enqueue(const std::shared_ptr<stream>& s, std::uint64_t offset,
+                 const char* data, std::size_t size);
+
+    // While the writer is over budget and @p s has writes queued, park
+    // @p connection. Returns true iff the connection was suspended (MHD
+    // re-invokes the access handler once the writer resumes it).
+    bool throttle(stream& s, MHD_Connection* connection);
+
+    // Park @p connection until every write queued on @p s has landed.
+    // Returns true iff the connection was suspended.
+    bool wait_for_flush(stream& s, MHD_Connection* connection);
+
+ private:
+    struct job {
+        std::shared_ptr<stream> owner;
+        std::shared_ptr<file_handle> file;
+        std::uint64_t offset;
+        std::string bytes;
+    };
+
+    void run();
+    void complete(const job& j, bool ok);
+    // Suspend (or, without suspend support, block) until @p done holds.
+    template <typename Pred>
+    bool park(stream& s, MHD_Connection* connection, Pred done);
+
+    const std::size_t max_in_flight_;
+    const bool can_suspend_;
+    std::atomic<std::size_t> in_flight_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<job> queue_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+}  // namespace detail
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_DETAIL_UPLOAD_WRITER_HPP_
@@ -79,9 +79,13 @@
 #include "httpserver/detail/ip_access_control.hpp"
 #include "httpserver/detail/request_dispatcher.hpp"
 #include "httpserver/detail/request_pipeline.hpp"
+#include "httpserver/detail/response_cache.hpp"
 #include "httpserver/detail/response_materializer.hpp"
 #include "httpserver/detail/route_table.hpp"
+#include "httpserver/detail/single_flight.hpp"
 #include "httpserver/detail/upload_pipeline.hpp"
+#include "httpserver/detail/upload_budget.hpp"
+#include "httpserver/detail/upload_writer.hpp"
 #include "httpserver/detail/websocket_upgrader.hpp"
 #include "httpserver/detail/ws_registry.hpp"
 
@@ -293,16 +297,35 @@ class webserver_impl {
     // materialize_and_queue_response method forwards here.
     response_materializer response_mat_;
 
+    // Process-wide request-body accounting (create_webserver::
+    // upload_memory_budget / upload_disk_budget); each connection_context
+    // holds a charge against it. Read by webserver::get_upload_usage().
+    upload_budget budget_;
+
+    // create_webserver::response_cache; consulted by dispatcher_ and
+    // purged through webserver::purge_cached_responses().
+    response_cache response_cache_;
+
+    // Background pwrite() sink for uploads (create_webserver::
+    // async_upload_writes); idle, with no thread, when that is unset.
+    // Declared before upload_ / pipeline_, which hold references to it.
+    upload_writer upload_writer_;
+
+    // Coalesced handler calls (http_resource::single_flight_key); driven
+    // by dispatcher_.
+    single_flight flights_;
+
     // Behavior service (DR-014 §4.11): multipart / file-upload handling.
-    // Holds only parent->config. The post_iterator MHD trampoline forwards
-    // here (impl_->upload_.iterate_file / upload_pipeline::handle_post_form_arg).
+    // Holds parent->config and upload_writer_. The post_iterator MHD
+    // trampoline forwards here (impl_->upload_.iterate_file /
+    // upload_pipeline::handle_post_form_arg).
     upload_pipeline upload_;
 
     // Behavior service (DR-014 §4.11): the routing + auth + handler-invocation
     // stage (finalize_answer / resolve_resource_for_request /
     // dispatch_resource_handler). Declared last: it references routes_,
-    // hooks_dispatch_, errors_, response_mat_, ws_upgrader_ (HAVE_WEBSOCKET)
-    // and parent->config, so it must be constructed after all of them.
+    // hooks_dispatch_, errors_, response_mat_, response_cache_, flights_,
+    // ws_upgrader_ (HAVE_WEBSOCKET) and parent->config, so it must be constructed after all of them.
     // complete_request hands off to dispatcher_.finalize_answer.
     request_dispatcher dispatcher_;
 
@@ -53,10 +53,12 @@ namespace httpserver {
  *   - @ref webserver::webserver — thrown at webserver construction time
  *     when consuming the builder: `use_ssl(true)` on a
  *     `HAVE_GNUTLS`-off build, `basic_auth(true)` on a
- *     `HAVE_BAUTH`-off build, or `digest_auth(true)` on a
- *     `HAVE_DAUTH`-off build. The `create_webserver` setters accept all
- *     values without throwing; feature-unavailability is validated
- *     lazily at `webserver` construction, not at the setter call.
+ *     `HAVE_BAUTH`-off build, `digest_auth(true)` on a
+ *     `HAVE_DAUTH`-off build, or `decode_request_body(true)` /
+ *     `compress_responses(true)` on a `HAVE_ZLIB`-off build. The
+ *     `create_webserver` setters accept all values without throwing;
+ *     feature-unavailability is validated lazily at `webserver`
+ *     construction, not at the setter call.
  *   - @ref http_response::unauthorized(digest_challenge) — thrown on a
  *     `HAVE_DAUTH`-off build. The declaration is unconditional;
  *     only the definition branches on `HAVE_DAUTH`.
@@ -0,0 +1,379 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#if !defined (_HTTPSERVER_HPP_INSIDE_) && !defined (HTTPSERVER_COMPILATION)
+#error "Only <httpserver.hpp> or <httpserverpp> can be included directly."
+#endif
+
+#ifndef SRC_HTTPSERVER_HEADER_FIELDS_HPP_
+#define SRC_HTTPSERVER_HEADER_FIELDS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "httpserver/http_utils.hpp"
+
+namespace httpserver {
+
+class http_response;
+
+namespace http {
+
+/**
+ * A header name or value with static storage duration, stored by
+ * http_response without copying. Only constructible in constant
+ * evaluation, from a NUL-terminated string_view free of CR, LF and NUL:
+ *
+ *     using namespace std::string_view_literals;
+ *     r.with_header("Cache-Control"sv, "no-store"sv);
+ *
+ * A string_view that is not a constant (or that views a buffer with
+ * automatic storage) fails to compile instead of dangling at run time.
+**/
+class static_text {
+ public:
+     consteval static_text(std::string_view s)  // NOLINT(runtime/explicit)
+         : view_(s) {
+         for (const char c : s) {
+             if (c == '\r' || c == '\n' || c == '\0') {
+                 throw std::invalid_argument(
+                     "static_text: forbidden control character (CR, LF, or NUL)");
+             }
+         }
+         // Materialization hands the bytes to libmicrohttpd as C strings.
+         if (s.data()[s.size()] != '\0') {
+             throw std::invalid_argument("static_text: not NUL-terminated");
+         }
+     }
+
+     [[nodiscard]] constexpr std::string_view view() const noexcept { return view_; }
+
+ private:
+     // Header names the library itself sets (http_utils::http_header_*)
+     // are static C strings that are only known at run time.
+     struct unchecked_t {};
+     constexpr static_text(std::string_view s, unchecked_t) noexcept : view_(s) {}
+
+     std::string_view view_;
+
+     friend class ::httpserver::http_response;
+};
+
+/**
+ * Case-insensitive, single-valued name -> value store backing
+ * http_response's headers and footers. The first Fields entries live
+ * inline in the object; past that, entries move to one vector. Copied
+ * text goes to a chain of heap chunks, the first ChunkBytes long, so a
+ * response's headers cost one allocation for their text however many
+ * there are, and moving the store copies no text. Entries are kept
+ * sorted by header_comparator, so iteration order matches the
+ * std::map-based header_map this replaces.
+ *
+ * Names and values are either copied into the text store or borrowed
+ * (static_text); every view handed out is NUL-terminated. Copied text is
+ * never moved while the container lives, so a view stays valid across
+ * inserts of other names -- it is invalidated by reassigning the same
+ * name, or by moving from or destroying the container. Iteration yields
+ * std::pair<std::string_view, std::string_view> by value, so
+ *
+ *     for (const auto& [name, value] : r.get_headers()) ...
+ *
+ * works as it did on header_map.
+**/
+template <std::size_t Fields, std::size_t ChunkBytes>
+class basic_header_fields {
+ private:
+     struct field {
+         std::string_view name;
+         std::string_view value;
+     };
+
+ public:
+     using value_type = std::pair<std::string_view, std::string_view>;
+     using size_type = std::size_t;
+
+     static constexpr size_type inline_capacity = Fields;
+
+     class const_iterator {
+      public:
+         using iterator_category = std::input_iterator_tag;
+         using iterator_concept = std::forward_iterator_tag;
+         using value_type = basic_header_fields::value_type;
+         using difference_type = std::ptrdiff_t;
+         using reference = value_type;
+
+         struct pointer {
+             value_type pair;
+             const value_type* operator->() const noexcept { return &pair; }
+         };
+
+         const_iterator() noexcept = default;
+
+         value_type operator*() const noexcept { return {f_->name, f_->value}; }
+         pointer operator->() const noexcept { return pointer{**this}; }
+
+         const_iterator& operator++() noexcept {
+             ++f_;
+             return *this;
+         }
+         const_iterator operator++(int) noexcept {
+             const_iterator old = *this;
+             ++f_;
+             return old;
+         }
+
+         friend bool operator==(const_iterator a, const_iterator b) noexcept {
+             return a.f_ == b.f_;
+         }
+
+      private:
+         explicit const_iterator(const field* f) noexcept : f_(f) {}
+
+         const field* f_ = nullptr;
+
+         friend class basic_header_fields;
+     };
+
+     basic_header_fields() noexcept = default;
+     ~basic_header_fields() { release_text(); }
+
+     // Copies re-copy every name and value into the new text store.
+     basic_header_fields(const basic_header_fields& other) {
+         for (const field& f : other.entries()) append(store(f.name), store(f.value));
+     }
+
+     basic_header_fields(basic_header_fields&& other) noexcept { take(other); }
+
+     basic_header_fields& operator=(const basic_header_fields& other) {
+         if (this != &other) {
+             basic_header_fields copy(other);
+             clear();
+             take(copy);
+         }
+         return *this;
+     }
+
+     basic_header_fields& operator=(basic_header_fields&& other) noexcept {
+         if (this != &other) {
+             clear();
+             take(other);
+         }
+         return *this;
+     }
+
+     [[nodiscard]] size_type size() const noexcept {
+         return spilled_ ? heap_.size() : inline_size_;
+     }
+     [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+     [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(data()); }
+     [[nodiscard]] const_iterator end() const noexcept {
+         return const_iterator(data() + size());
+     }
+
+     [[nodiscard]] const_iterator find(std::string_view name) const noexcept {
+         const field* f = lower_bound(name);
+         const field* last = data() + size();
+         return const_iterator(f != last && same_name(f->name, name) ? f : last);
+     }
+
+     [[nodiscard]] size_type count(std::string_view name) const noexcept {
+         return find(name) == end() ? 0 : 1;
+     }
+     [[nodiscard]] bool contains(std::string_view name) const noexcept {
+         return find(name) != end();
+     }
+
+     /// Value of field @p name; throws std::out_of_range if absent.
+     [[nodiscard]] std::string_view at(std::string_view name) const {
+         const const_iterator it = find(name);
+         if (it == end()) throw std::out_of_range("basic_header_fields::at");
+         return it->second;
+     }
+
+     // Set @p name to @p value, replacing any field whose name compares
+     // equal (the replaced field keeps its original name spelling).
+     void insert_or_assign(std::string_view name, std::string_view value) {
+         assign(name, value, false, false);
+     }
+     void insert_or_assign(static_text name, std::string_view value) {
+         assign(name.view(), value, true, false);
+     }
+     void insert_or_assign(static_text name, static_text value) {
+         assign(name.view(), value.view(), true, true);
+     }
+
+     void clear() noexcept {
+         heap_.clear();
+         spilled_ = false;
+         inline_size_ = 0;
+         release_text();
+     }
+
+ private:
+     // Header of a text chunk; its bytes follow it in the same allocation.
+     struct chunk {
+         chunk* prev;
+         size_type size;
+         char* text() noexcept { return reinterpret_cast<char*>(this + 1); }
+     };
+
+     field* data() noexcept { return spilled_ ? heap_.data() : inline_.data(); }
+     const field* data() const noexcept { return spilled_ ? heap_.data() : inline_.data(); }
+     std::span<field> entries() noexcept { return {data(), size()}; }
+     std::span<const field> entries() const noexcept { return {data(), size()}; }
+
+     static bool same_name(std::string_view a, std::string_view b) noexcept {
+         return !header_comparator()(a, b) && !header_comparator()(b, a);
+     }
+
+     const field* lower_bound(std::string_view name) const noexcept {
+         return std::lower_bound(data(), data() + size(), name,
+             [](const field& f, std::string_view key) {
+                 return header_comparator()(f.name, key);
+             });
+     }
+
+     void assign(std::string_view name, std::string_view value,
+                 bool name_static, bool value_static) {
+         const size_type index = static_cast<size_type>(lower_bound(name) - data());
+         if (index != size() && same_name(data()[index].name, name)) {
+             field& f = data()[index];
+             f.value = value_static ? value : replace(f.value, value);
+             return;
+         }
+         if (!spilled_ && inline_size_ == Fields) spill();
+         const std::string_view n = name_static ? name : store(name);
+         const std::string_view v = value_static ? value : store(value);
+         insert_at(index, field{n, v});
+     }
+
+     void append(std::string_view name, std::string_view value) {
+         if (!spilled_ && inline_size_ == Fields) spill();
+         insert_at(size(), field{name, value});
+     }
+
+     void insert_at(size_type index, const field& f) {
+         if (spilled_) {
+             heap_.insert(heap_.begin() + static_cast<std::ptrdiff_t>(index), f);
+             return;
+         }
+         std::copy_backward(inline_.begin() + index, inline_.begin() + inline_size_,
+                            inline_.begin() + inline_size_ + 1);
+         inline_[index] = f;
+         ++inline_size_;
+     }
+
+     // Move the inline entries to the heap; later inserts go there. The
+     // text they view does not move.
+     void spill() {
+         heap_.reserve(Fields == 0 ? 2 : 2 * Fields);
+         heap_.assign(inline_.begin(), inline_.begin() + inline_size_);
+         inline_size_ = 0;
+         spilled_ = true;
+     }
+
+     // Copy @p s, NUL-terminated, into the newest chunk, starting a new
+     // one when it does not fit. Earlier chunks are never reallocated.
+     std::string_view store(std::string_view s) {
+         const size_type need = s.size() + 1;
+         if (tail_ == nullptr || need > tail_->size - tail_used_) {
+             const size_type size = std::max<size_type>(
+                 need, tail_ == nullptr ? ChunkBytes : 2 * ChunkBytes);
+             tail_ = ::new (::operator new(sizeof(chunk) + size)) chunk{tail_, size};
+             tail_used_ = 0;
+         }
+         char* out = tail_->text() + tail_used_;
+         std::copy(s.begin(), s.end(), out);
+         out[s.size()] = '\0';
+         tail_used_ += need;
+         return {out, s.size()};
+     }
+
+     // store() for a value replacing @p old. When @p old is the newest
+     // copy and the new text fits in its place, it is overwritten, so
+     // reassigning one header in a loop does not grow the store.
+     std::string_view replace(std::string_view old, std::string_view s) {
+         if (tail_ != nullptr) {
+             const char* block = tail_->text();
+             const bool newest = std::less_equal<const char*>()(block, old.data())
+                 && old.data() + old.size() + 1 == block + tail_used_;
+             if (newest && s.size() <= tail_->size - tail_used_ + old.size()) {
+                 tail_used_ -= old.size() + 1;
+             }
+         }
+         return store(s);
+     }
+
+     void release_text() noexcept {
+         while (tail_ != nullptr) {
+             chunk* prev = tail_->prev;
+             ::operator delete(static_cast<void*>(tail_));
+             tail_ = prev;
+         }
+         tail_used_ = 0;
+     }
+
+     // Precondition: *this is empty. Leaves other empty. The text stays
+     // where it is, so every view remains valid in the new owner.
+     void take(basic_header_fields& other) noexcept {
+         tail_ = std::exchange(other.tail_, nullptr);
+         tail_used_ = std::exchange(other.tail_used_, 0);
+         spilled_ = other.spilled_;
+         if (spilled_) {
+             heap_ = std::move(other.heap_);
+         } else {
+             std::copy(other.inline_.begin(), other.inline_.begin() + other.inline_size_,
+                       inline_.begin());
+             inline_size_ = other.inline_size_;
+         }
+         other.clear();
+     }
+
+     std::array<field, Fields> inline_{};
+     size_type inline_size_ = 0;
+     bool spilled_ = false;
+     std::vector<field> heap_;
+
+     // Newest text chunk and the bytes written to it; older chunks hang
+     // off its prev chain.
+     chunk* tail_ = nullptr;
+     size_type tail_used_ = 0;
+};
+
+/// Response headers: four fields inline, text in 256-byte chunks.
+using header_fields = basic_header_fields<4, 256>;
+/// Response footers (trailers) are rare; kept entirely out of line.
+using footer_fields = basic_header_fields<0, 64>;
+
+}  // namespace http
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_HEADER_FIELDS_HPP_
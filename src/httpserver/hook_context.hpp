@@ -182,6 +182,9 @@ struct request_received_ctx {
  * @note `offset` is the number of body bytes already buffered before
  *   this chunk (first firing has `offset==0`, next has
  *   `offset==chunk0.size()`, etc.).
+ * @note With create_webserver::decode_request_body on, a compressed
+ *   body fires once per decoded window: `chunk` and `offset` refer to
+ *   decoded bytes, and `chunk` aliases the decoder's window instead.
  * @note Short-circuit: returning `hook_action::respond_with(r)` aborts
  *   the upload at the next MHD callback; the resource handler is never
  *   invoked. Any in-flight post-processor is destroyed and its buffer
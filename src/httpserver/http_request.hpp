@@ -680,6 +680,7 @@ class http_request {
      void set_arg_flat(const std::string& key, const std::string& value);
 
      void grow_last_arg(const std::string& key, const std::string& value);
+     void grow_last_arg(const char* key, const char* value, size_t size);
 
      /**
       * Method used to set the content of the request
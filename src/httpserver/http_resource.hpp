@@ -25,11 +25,15 @@
 #ifndef SRC_HTTPSERVER_HTTP_RESOURCE_HPP_
 #define SRC_HTTPSERVER_HTTP_RESOURCE_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <span>
 #include <string>
+#include <string_view>
 
 // render_* virtuals return http_response by value; the inline
 // defaults call render(req) and forward the prvalue, which
@@ -62,6 +66,21 @@ namespace httpserver {
 // v1-compatible sentinel for "handler did not produce a response"; the
 // dispatch path routes the sentinel through the internal-error handler.
 
+/**
+ * One piece of a file part delivered to http_resource::on_upload_chunk
+ * under FILE_UPLOAD_STREAM. The views are only valid for the duration of
+ * the call. Every part ends with a call carrying `is_last == true` and an
+ * empty `data`, issued once the next part starts or the body ends.
+**/
+struct upload_chunk {
+    std::string_view field;         // form field name
+    std::string_view filename;      // client-supplied file name
+    std::string_view content_type;  // part Content-Type; empty if absent
+    std::span<const std::byte> data;
+    std::uint64_t offset;           // position of data within the part
+    bool is_last;
+};
+
 /**
  * Class representing a callable http resource.
  *
@@ -175,6 +194,45 @@ class http_resource {
          return render(req);
      }
 
+     /**
+      * Receive file-upload bytes as they are parsed, when the webserver
+      * runs with `file_upload_target(FILE_UPLOAD_STREAM)`. Called on the
+      * connection's thread before the render_* method of the same request;
+      * the parts are not stored in the request. Returning false (or
+      * throwing) aborts the request with 500 Internal Server Error and the
+      * handler does not run; an aborted request delivers no is_last call
+      * for its open part. The default refuses every upload.
+      * @param req Request the upload belongs to (headers, query and route
+      *        args; form fields parsed so far)
+      * @param chunk Bytes of the current file part
+      * @return true to keep receiving the upload
+     **/
+     virtual bool on_upload_chunk(const http_request& req, const upload_chunk& chunk) {
+         (void)req;
+         (void)chunk;
+         return false;
+     }
+
+     /**
+      * Opt into request coalescing ("single flight"). Requests that get
+      * the same non-empty key while a render_* call for that key is
+      * running do not call the handler again: they wait for it and are
+      * answered with a frozen copy of its response, error responses
+      * included. Called on the connection's thread after before_handler
+      * hooks, for allowed methods only. A response that cannot be frozen
+      * (see http_response::freeze) is not shared; the waiting requests
+      * then run the handler themselves. Waiting requests are suspended
+      * when the webserver runs with `deferred()`, wait on their own
+      * thread under THREAD_PER_CONNECTION, and are not coalesced
+      * otherwise. The default returns an empty key: no coalescing.
+      * @param req Request about to be handled
+      * @return The key to coalesce on, or an empty string
+     **/
+     virtual std::string single_flight_key(const http_request& req) {
+         (void)req;
+         return {};
+     }
+
      /**
       * Toggle whether a specific http_method is allowed on this resource.
       * @param method enum identifying the method (no string lookup)
@@ -25,19 +25,21 @@
 #ifndef SRC_HTTPSERVER_HTTP_RESPONSE_HPP_
 #define SRC_HTTPSERVER_HTTP_RESPONSE_HPP_
 
-#include <sys/types.h>          // ssize_t — for the deferred() producer
-
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 #include "httpserver/body_kind.hpp"
 #include "httpserver/cookie.hpp"
+#include "httpserver/deferred_producer.hpp"
+#include "httpserver/header_fields.hpp"
 #include "httpserver/http_arg_value.hpp"
 #include "httpserver/http_utils.hpp"
 #include "httpserver/iovec_entry.hpp"
@@ -50,6 +52,13 @@ namespace httpserver {
 // destructor / move-op definition sites only; those live in the .cpp.
 namespace detail { class response_body; }
 
+// Shared state behind frozen_response (defined in detail/response_body.hpp).
+namespace detail { struct frozen_response_state; }
+class frozen_response;
+
+// Producer handle of http_response::stream() (httpserver/stream_writer.hpp).
+class stream_writer;
+
 // Forward declarations needed for the friend grants in http_response.
 // body_/kind_/status_code_ are private; detail::webserver_impl dispatch
 // helpers need direct access to materialise wire responses without
@@ -62,6 +71,12 @@ class webserver_impl;
 // same body_ access the god-object had.
 class response_materializer;
 class hook_dispatcher;
+// Swap a compressed / ranged / 304 body in for the one the handler returned.
+class response_compressor;
+class range_responder;
+class etag_responder;
+// Sizes and freezes the responses it stores.
+class response_cache;
 }  // namespace detail
 
 /**
@@ -102,6 +117,35 @@ struct digest_challenge {
     std::string response_body = {};       // "access denied" body
 };
 
+/**
+ * Options for http_response::file().
+ *
+ * `precompressed`: also look for "<path>.br" and "<path>.gz" next to the
+ * file and, when the request's Accept-Encoding allows it, serve the
+ * preferred one that exists (br first on a tie) with the matching
+ * Content-Encoding. The response gains `Vary: Accept-Encoding`. Selection
+ * happens when the response is queued, so the siblings are only opened
+ * for clients that can use them. Works without zlib.
+ */
+struct file_options {
+    bool precompressed = false;
+};
+
+/**
+ * Options for http_response::pipe().
+ *
+ * `block_size`: bytes read from the fd per call, and so handed to the
+ * socket per send. 0 keeps libmicrohttpd's own pipe reader, which reads
+ * small fixed blocks (4 KiB in libmicrohttpd 1.0); large outputs from a
+ * child process or a local upstream socket want far larger ones, which
+ * cut the number of read/send pairs. The bytes are still copied through
+ * libmicrohttpd's buffers either way. Chunked (HTTP/1.1) replies are
+ * also capped by the connection's write buffer (memory_limit).
+ */
+struct pipe_options {
+    std::size_t block_size = 0;
+};
+
 /**
  * Class representing an abstraction for an Http Response. It is used from classes using these apis to send information through http protocol.
 **/
@@ -182,11 +226,33 @@ class http_response final {
          std::string response_body,
          std::string content_type = "text/plain");
 
-     // Construct a response that streams a file from disk. Does NOT
-     // throw on a missing or unreadable path — failure is observable at
-     // dispatch time (the materialized MHD_Response is null and the
+     // Construct a response that serves *body in place: nothing is
+     // copied, and the response (and the libmicrohttpd response built
+     // from it) keeps body alive until the bytes are sent. Use for
+     // large cached documents shared across requests.
+     // Throws std::invalid_argument if body is null or content_type
+     // contains CR, LF, or NUL.
+     [[nodiscard]] static http_response shared(
+         std::shared_ptr<const std::string> body,
+         std::string content_type = "text/plain");
+
+     // As above for an arbitrary byte range kept alive by `owner`: the
+     // bytes must stay valid while owner lives. A null owner declares
+     // the bytes static.
+     [[nodiscard]] static http_response shared(
+         std::span<const std::byte> data,
+         std::shared_ptr<const void> owner,
+         std::string content_type = "application/octet-stream");
+
+     // Construct a response that streams a file from disk. The path is
+     // opened when the response is queued (through
+     // create_webserver::file_descriptor_cache when set), not here. Does
+     // NOT throw on a missing or unreadable path — failure is observable
+     // at dispatch time (the materialized MHD_Response is null and the
      // dispatch path renders a 500). Mirrors v1 file_response semantics.
-     [[nodiscard]] static http_response file(std::string path);
+     // See file_options for serving precompressed siblings.
+     [[nodiscard]] static http_response file(std::string path,
+                                             file_options options = {});
 
      // Construct a response from a span of scatter/gather buffers. The
      // entries array is deep-copied into the body so the span need not
@@ -196,12 +262,20 @@ class http_response final {
      [[nodiscard]] static http_response iovec(
          std::span<const iovec_entry> entries);
 
+     // As above, but every segment carries the owner of its bytes: the
+     // response, and the libmicrohttpd response built from it, keep the
+     // owners alive until the last byte is written, so nothing is
+     // borrowed. Segments without an owner are static.
+     [[nodiscard]] static http_response iovec(
+         std::vector<iovec_segment> segments);
+
      // Construct a response that streams from a pipe read-end. The
      // factory takes ownership of `fd` immediately. The fd is closed
      // when the materialized MHD_Response is destroyed; if the response
      // is never materialized, the http_response's destructor closes
-     // it. Callers MUST NOT close `fd` after handing it off.
-     [[nodiscard]] static http_response pipe(int fd);
+     // it. Callers MUST NOT close `fd` after handing it off. Any fd
+     // read(2) works, including a connected socket; see pipe_options.
+     [[nodiscard]] static http_response pipe(int fd, pipe_options options = {});
 
      // Construct an empty (no-payload) response. Defaults to 204
      // No Content, matching v1 empty_response. The optional `mhd_flags`
@@ -214,11 +288,22 @@ class http_response final {
      // libmicrohttpd invokes `producer(pos, buf, max)` whenever it
      // needs more bytes; the producer should return the number of
      // bytes written, MHD_CONTENT_READER_END_OF_STREAM, or
-     // MHD_CONTENT_READER_END_WITH_ERROR. The producer is stored by
-     // move; large captures may force std::function to heap-allocate
-     // internally (independent of http_response's own SBO).
+     // MHD_CONTENT_READER_END_WITH_ERROR. Any such callable converts to
+     // deferred_producer, which keeps captures of up to 40 bytes inline
+     // (see there). `block_size` is the buffer libmicrohttpd reads each
+     // block into, and so the largest `max` a call sees; raise it for
+     // high-bandwidth producers. Chunked (HTTP/1.1) replies are also
+     // capped by the connection's write buffer (memory_limit). A producer
+     // taking a fourth deferred_trailers& argument can add trailers while
+     // it streams.
      [[nodiscard]] static http_response deferred(
-         std::function<ssize_t(std::uint64_t, char*, std::size_t)> producer);
+         deferred_producer producer,
+         std::size_t block_size = deferred_producer::default_block_size);
+
+     // Construct a response whose body is pushed through `writer` from
+     // any thread (see stream_writer). The connection is suspended while
+     // the writer has nothing queued. Hand a writer to one response only.
+     [[nodiscard]] static http_response stream(const stream_writer& writer);
 
      /// Construct a 401 Unauthorized response with a WWW-Authenticate
      /// header of the form `<scheme> realm="<realm>"`. Replaces v1's
@@ -290,19 +375,21 @@ class http_response final {
      //      (with_header(key, ...) replacing an existing value
      //      invalidates a view obtained from a prior get_header(key)).
      //
-     // std::map's node-stability guarantee means that adding or removing
-     // OTHER keys does NOT invalidate views of unrelated keys; only
-     // same-key re-assignment, erase, or whole-response destruction
-     // does. Multi-value headers are not modelled in v2.0 — header_map
-     // is single-valued per key.
+     // Headers and footers live in an http::header_fields, which shifts
+     // fields as others are inserted: adding ANY header invalidates
+     // get_headers() iterators. Its text is never moved, so views from
+     // get_header(key) survive other inserts unless the field is
+     // reassigned. Multi-value headers are not modelled in v2.0 —
+     // fields are single-valued per key.
      //
      // Callers MUST NOT keep the view past the next non-const operation
      // on the response, and MUST NOT keep it past the response's
      // destruction. If a longer lifetime is required, copy into a
      // std::string.
      //
-     // No noexcept on the single-key accessors: std::map::find can in
-     // principle propagate a comparator exception. The map-returning
+     // No noexcept on the single-key accessors: the cookie mirror is a
+     // std::map whose find can in principle propagate a comparator
+     // exception. The map-returning
      // accessors and the trivial scalar accessors (get_status, kind) are
      // noexcept (they only return a reference / scalar member).
      // -----------------------------------------------------------------
@@ -327,17 +414,18 @@ class http_response final {
 
      /**
       * Method used to get all response headers.
-      * @return a map<string,string> containing all headers.
+      * @return a read-only, map-like view (find / count / at / iteration
+      *         over name -> value string_view pairs) of all headers.
      **/
-     [[nodiscard]] const http::header_map& get_headers() const noexcept {
+     [[nodiscard]] const http::header_fields& get_headers() const noexcept {
          return headers_;
      }
 
      /**
       * Method used to get all response footers.
-      * @return a map<string,string> containing all footers.
+      * @return a read-only, map-like view of all footers.
      **/
-     [[nodiscard]] const http::header_map& get_footers() const noexcept {
+     [[nodiscard]] const http::footer_fields& get_footers() const noexcept {
          return footers_;
      }
 
@@ -399,10 +487,11 @@ class http_response final {
      //     successive `&&` overloads on the same SBO-inline body without
      //     any intermediate move-construction or heap relocation.
      //
-     // String parameters are taken by value: the body internally moves
-     // them into the underlying header/footer/cookie maps via
-     // insert_or_assign, so callers can either copy or move into the
-     // setter without an extra allocation.
+     // String parameters are taken by value for source compatibility.
+     // Header and footer text is copied into the response's text store
+     // (see http::basic_header_fields), so a typical set of headers
+     // costs one allocation; the static_text overloads skip even the
+     // copy.
      //
      // Backward compatibility (constraint): v1 callers wrote
      //         r.with_header(k, v);
@@ -427,6 +516,14 @@ class http_response final {
      http_response& with_header(std::string key, std::string value) &;
      http_response&& with_header(std::string key, std::string value) &&;
 
+     // Static-text overloads: the name (and value) are stored by pointer,
+     // never copied. Pass string_view literals ("Cache-Control"sv); see
+     // http::static_text.
+     http_response& with_header(http::static_text key, std::string value) &;
+     http_response&& with_header(http::static_text key, std::string value) &&;
+     http_response& with_header(http::static_text key, http::static_text value) &;
+     http_response&& with_header(http::static_text key, http::static_text value) &&;
+
      http_response& with_footer(std::string key, std::string value) &;
      http_response&& with_footer(std::string key, std::string value) &&;
 
@@ -456,11 +553,23 @@ class http_response final {
 
      void shoutCAST();
 
+     /**
+      * Turn this response into a reusable frozen_response. The body is
+      * materialized into a libmicrohttpd response and decorated with the
+      * headers, footers and cookies exactly once, here; every request
+      * that later returns the frozen_response queues that same object.
+      * Only string, shared, empty and iovec bodies can be replayed, so freezing
+      * any other kind throws std::invalid_argument (borrowed iovec buffers
+      * must outlive the frozen_response; iovec_segment owners are kept). Throws
+      * std::runtime_error if libmicrohttpd cannot build the response.
+     **/
+     [[nodiscard]] frozen_response freeze() &&;
+
  private:
      int status_code_ = -1;
 
-     http::header_map headers_;
-     http::header_map footers_;
+     http::header_fields headers_;
+     http::footer_fields footers_;
      // Legacy name->value mirror backing the deprecated get_cookies() /
      // get_cookie() accessors. Rebuilt lazily from structured_cookies_ by
      // ensure_cookie_mirror_() (gated by cookies_mirror_valid_) on first
@@ -492,14 +601,26 @@ class http_response final {
      // the inline-vs-heap discriminator details.
      void destroy_body() noexcept;
      void adopt_body_from(http_response& other) noexcept;
+     // Swap in @p donor's body (and kind) for ours, leaving donor empty.
+     // Used by the stages that re-encode or narrow a handler's body.
+     void replace_body(http_response& donor) noexcept;
 
      // Shared mutation helpers for the fluent setters.
      // Each helper validates its inputs, then performs the
      // map mutation or scalar assignment.  Centralising the logic here
      // means the & and && overloads only differ in their return
      // statement; the mutation + validation is in exactly one place.
-     void do_set_header(std::string key, std::string value);
-     void do_set_footer(std::string key, std::string value);
+     void do_set_header(std::string_view key, std::string_view value);
+     // Static names are validated at compile time; only the value is
+     // checked here. Also used by the factories with the library's own
+     // http_utils header-name constants.
+     void do_set_header(http::static_text key, std::string_view value);
+     // Wraps one of the library's http_utils::http_header_* names, which
+     // are static C strings known only at run time.
+     static http::static_text library_header(const char* name) noexcept {
+         return http::static_text(name, http::static_text::unchecked_t{});
+     }
+     void do_set_footer(std::string_view key, std::string_view value);
      // Legacy entry point: forwards through the structured path so
      // wire rendering goes through a single code path. Preserves v1
      // overwrite semantics: a cookie with the same name (compared with
@@ -551,9 +672,50 @@ class http_response final {
      friend class detail::webserver_impl;
      friend class detail::response_materializer;
      friend class detail::hook_dispatcher;
+     friend class detail::response_compressor;
+     friend class detail::range_responder;
+     friend class detail::etag_responder;
+     friend class detail::response_cache;
+     // Converting a frozen_response back into an http_response emplaces
+     // the frozen body.
+     friend class frozen_response;
 };
 
 std::ostream &operator<<(std::ostream &os, const http_response &r);
 
+/**
+ * A response whose libmicrohttpd object is built once, by
+ * http_response::freeze(), and shared by every request that returns it --
+ * for constant endpoints such as health checks, robots.txt or static JSON.
+ *
+ * Copies are cheap (they share one immutable state) and may be used from
+ * any thread. Converting to http_response, e.g. returning one from a
+ * render_* method, skips body materialization and header decoration. The
+ * converted response starts with the frozen status and no headers of its
+ * own; a status change is free, while headers, footers or cookies added to
+ * it (say by an after_handler hook) are honoured by building a fresh
+ * libmicrohttpd response for that request.
+**/
+class frozen_response {
+ public:
+     // Implicit so a handler can `return frozen_;`.
+     operator http_response() const;  // NOLINT(runtime/explicit)
+
+     /// The status every converted response starts with.
+     [[nodiscard]] int get_status() const noexcept;
+
+     /// The response that was frozen, for inspecting its headers.
+     [[nodiscard]] const http_response& source() const noexcept;
+
+ private:
+     explicit frozen_response(
+         std::shared_ptr<const detail::frozen_response_state> state) noexcept
+         : state_(std::move(state)) {}
+
+     std::shared_ptr<const detail::frozen_response_state> state_;
+
+     friend class http_response;
+};
+
 }  // namespace httpserver
 #endif  // SRC_HTTPSERVER_HTTP_RESPONSE_HPP_
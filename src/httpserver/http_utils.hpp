@@ -72,6 +72,9 @@ enum file_upload_target_T {
      FILE_UPLOAD_MEMORY_ONLY,
      FILE_UPLOAD_DISK_ONLY,
      FILE_UPLOAD_MEMORY_AND_DISK,
+     // File parts go straight to http_resource::on_upload_chunk; nothing
+     // is stored in the request or on disk.
+     FILE_UPLOAD_STREAM,
 };
 
 typedef void(*unescaper_ptr)(std::string&);
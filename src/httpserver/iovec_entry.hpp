@@ -26,6 +26,9 @@
 #define SRC_HTTPSERVER_IOVEC_ENTRY_HPP_
 
 #include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
 
 namespace httpserver {
 
@@ -53,5 +56,28 @@ struct iovec_entry {
     std::size_t len;
 };
 
+// A scatter/gather buffer together with the owner that keeps it alive,
+// for http_response::iovec(std::vector<iovec_segment>). The response, and
+// the libmicrohttpd response built from it, hold every owner until the
+// last byte is written, so segments may come from shared caches,
+// templates and per-request strings without copies or lifetime rules.
+// A null owner declares the bytes static.
+struct iovec_segment {
+    iovec_segment(const void* b, std::size_t n, std::shared_ptr<const void> o = nullptr) noexcept
+        : base(b), len(n), owner(std::move(o)) {}
+
+    // The whole of *s, kept alive by s.
+    iovec_segment(std::shared_ptr<const std::string> s) noexcept  // NOLINT(runtime/explicit)
+        : base(s->data()), len(s->size()), owner(std::move(s)) {}
+
+    // Takes s over (its bytes are moved, not copied).
+    iovec_segment(std::string s)  // NOLINT(runtime/explicit)
+        : iovec_segment(std::make_shared<const std::string>(std::move(s))) {}
+
+    const void* base;
+    std::size_t len;
+    std::shared_ptr<const void> owner;
+};
+
 }  // namespace httpserver
 #endif  // SRC_HTTPSERVER_IOVEC_ENTRY_HPP_
@@ -0,0 +1,105 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#if !defined (_HTTPSERVER_HPP_INSIDE_) && !defined (HTTPSERVER_COMPILATION)
+#error "Only <httpserver.hpp> or <httpserverpp> can be included directly."
+#endif
+
+#ifndef SRC_HTTPSERVER_SSE_CHANNEL_HPP_
+#define SRC_HTTPSERVER_SSE_CHANNEL_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include "httpserver/http_response.hpp"
+
+namespace httpserver {
+
+class http_request;
+
+namespace detail { class sse_hub; }
+
+/**
+ * Options for sse_channel.
+**/
+struct sse_channel_options {
+    // Events kept for Last-Event-ID replay; 0 disables replay.
+    std::size_t replay_events = 256;
+    // A ":" comment goes to every subscriber when nothing was published for
+    // this long, so proxies keep idle streams open; 0 disables it.
+    std::chrono::milliseconds keep_alive{15000};
+    // Bytes queued per subscriber before it is dropped as too slow.
+    std::size_t subscriber_buffer = 64 * 1024;
+};
+
+/**
+ * A Server-Sent Events topic. Handlers answer with subscribe(); publish()
+ * then reaches every subscribed connection:
+ *
+ *     auto prices = std::make_shared<sse_channel>();
+ *     ws.on_get("/prices", [prices](const http_request& req) {
+ *         return prices->subscribe(req);
+ *     });
+ *     prices->publish(R"({"EUR":1.08})", "tick", std::to_string(seq));
+ *
+ * Each event is encoded once ("event:", "id:" and one "data:" line per
+ * line of data) into a refcounted buffer that every subscriber's queue
+ * shares; nothing is copied per subscriber until it reaches the socket.
+ * Subscriptions are http_response::stream() bodies, so with
+ * create_webserver::deferred() an idle subscriber is a suspended
+ * connection, not a thread.
+ *
+ * A subscriber whose queue would exceed subscriber_buffer is dropped; its
+ * client reconnects with Last-Event-ID, and the events after that id
+ * still in the replay ring are sent before live ones. Keep-alive comments
+ * come from a single timer thread per channel. Destroying the channel
+ * ends every subscription.
+**/
+class sse_channel {
+ public:
+     // Throws std::invalid_argument when subscriber_buffer is 0.
+     explicit sse_channel(sse_channel_options options = {});
+     ~sse_channel();
+
+     sse_channel(const sse_channel&) = delete;
+     sse_channel& operator=(const sse_channel&) = delete;
+
+     // A text/event-stream response subscribed to this channel, replaying
+     // what followed the request's Last-Event-ID header.
+     [[nodiscard]] http_response subscribe(const http_request& req);
+
+     // Sends one event to every subscriber. Throws std::invalid_argument
+     // when @p event or @p id contains CR, LF or NUL.
+     void publish(std::string_view data, std::string_view event = {},
+                  std::string_view id = {});
+
+     // Subscribers still connected.
+     [[nodiscard]] std::size_t subscribers() const;
+
+ private:
+     std::size_t subscriber_buffer_;
+     std::unique_ptr<detail::sse_hub> hub_;
+};
+
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_SSE_CHANNEL_HPP_
@@ -0,0 +1,105 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#if !defined (_HTTPSERVER_HPP_INSIDE_) && !defined (HTTPSERVER_COMPILATION)
+#error "Only <httpserver.hpp> or <httpserverpp> can be included directly."
+#endif
+
+#ifndef SRC_HTTPSERVER_STATIC_DIRECTORY_RESOURCE_HPP_
+#define SRC_HTTPSERVER_STATIC_DIRECTORY_RESOURCE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "httpserver/http_resource.hpp"
+#include "httpserver/http_response.hpp"
+
+namespace httpserver {
+
+class http_request;
+
+namespace detail { class static_directory_index; }
+
+/**
+ * Options for static_directory_resource.
+**/
+struct static_directory_options {
+    // Tried in order when a URL names a directory.
+    std::vector<std::string> index_files = {"index.html"};
+    // Sent as Cache-Control on every file response; empty sends none.
+    std::string cache_control{};
+    // Paths whose metadata is kept; 0 runs lstat() on every request.
+    std::size_t max_index_entries = 4096;
+    // How long a path's metadata is trusted before it is looked up again.
+    std::chrono::milliseconds revalidate_after{1000};
+    // Serve ".br" / ".gz" siblings (http_response::file_options).
+    bool precompressed = false;
+};
+
+/**
+ * Serves the files under a directory, registered with
+ * webserver::register_prefix at @p url_prefix:
+ *
+ *     ws.register_prefix("/static",
+ *         std::make_unique<static_directory_resource>("/static", "/var/www"));
+ *
+ * The request path is normalized (dot-segments resolved, never above the
+ * root) and mapped below the root; a directory serves its first existing
+ * index file. Only regular files are served -- a symlink as the last
+ * component is a 404, though symlinked directories along the way are
+ * followed. Anything not found is a plain 404 (the webserver's
+ * not_found_handler is not consulted); methods other than GET and HEAD
+ * are 405.
+ *
+ * Responses carry a Content-Type from a compiled extension table, a
+ * strong ETag and Last-Modified, and the configured Cache-Control. The
+ * ETag matches the one create_webserver::file_range_requests derives, so
+ * that stage answers conditional and range requests without an fstat().
+ * Metadata is kept in an in-memory index built as paths are requested,
+ * so a repeated request touches the filesystem only to open the file --
+ * and not even that with create_webserver::file_descriptor_cache.
+ *
+ * Throws std::invalid_argument when @p root is not a directory or
+ * cache_control contains CR, LF or NUL.
+**/
+class static_directory_resource final : public http_resource {
+ public:
+     static_directory_resource(std::string url_prefix, std::string root,
+                               static_directory_options options = {});
+     ~static_directory_resource() override;
+
+     static_directory_resource(const static_directory_resource&) = delete;
+     static_directory_resource& operator=(const static_directory_resource&) = delete;
+
+     http_response render_get(const http_request& req) override;
+     http_response render_head(const http_request& req) override;
+
+ private:
+     std::string prefix_;
+     static_directory_options options_;
+     std::unique_ptr<detail::static_directory_index> index_;
+};
+
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_STATIC_DIRECTORY_RESOURCE_HPP_
@@ -0,0 +1,84 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#if !defined (_HTTPSERVER_HPP_INSIDE_) && !defined (HTTPSERVER_COMPILATION)
+#error "Only <httpserver.hpp> or <httpserverpp> can be included directly."
+#endif
+
+#ifndef SRC_HTTPSERVER_STREAM_WRITER_HPP_
+#define SRC_HTTPSERVER_STREAM_WRITER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace httpserver {
+
+class http_response;
+
+namespace detail { class stream_channel; }
+
+/**
+ * The producer end of a response built by http_response::stream(): any
+ * thread may write() the body into it, as the data becomes available, and
+ * finish() it.
+ *
+ *     stream_writer out;
+ *     events.subscribe([out](std::string_view e) mutable { out.write(e); });
+ *     return http_response::stream(out);
+ *
+ * Bytes go through a bounded ring of @p buffer_bytes. While it is empty
+ * the connection is suspended rather than holding a worker thread, so
+ * idle streams cost only their buffer; this needs create_webserver::
+ * deferred() (otherwise, and under THREAD_PER_CONNECTION, the
+ * connection's thread waits). write() blocks while the ring is full;
+ * try_write() never blocks.
+ *
+ * Copies share one stream. Once the response is gone -- sent after
+ * finish(), the client disconnected, or the webserver stopped -- closed()
+ * turns true and writes are dropped. A stream never finished stays open
+ * until the client goes away or the webserver stops.
+**/
+class stream_writer {
+ public:
+     // Throws std::invalid_argument when @p buffer_bytes is 0.
+     explicit stream_writer(std::size_t buffer_bytes = 64 * 1024);
+
+     // Queues all of @p data, waiting while the buffer is full. False when
+     // the stream is closed or finished (part of @p data may be lost).
+     bool write(std::string_view data);
+     // Queues as much of @p data as fits without waiting; returns the
+     // bytes taken.
+     std::size_t try_write(std::string_view data);
+     // Ends the body once the queued bytes are sent.
+     void finish() noexcept;
+     // True once nothing written can reach the client any more.
+     [[nodiscard]] bool closed() const noexcept;
+
+ private:
+     std::shared_ptr<detail::stream_channel> channel_;
+
+     friend class http_response;
+     friend class sse_channel;
+};
+
+}  // namespace httpserver
+
+#endif  // SRC_HTTPSERVER_STREAM_WRITER_HPP_
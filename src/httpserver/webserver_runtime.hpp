@@ -148,11 +148,43 @@
      **/
      uint16_t get_bound_port() const;
 
+     /**
+      * Request-body bytes currently held by in-progress requests, with
+      * the caps set through create_webserver::upload_memory_budget and
+      * upload_disk_budget (0 = uncapped). Memory counts buffered content
+      * and form / in-memory upload args; disk counts bytes written under
+      * file_upload_dir. Bytes are returned as each request completes.
+      *
+      * Safe to call from any thread; the counters are read without a
+      * lock, so the four fields are not a single atomic snapshot.
+     **/
+     struct upload_usage {
+         size_t memory_bytes;
+         size_t memory_limit;
+         size_t disk_bytes;
+         size_t disk_limit;
+     };
+     upload_usage get_upload_usage() const noexcept;
+
+     /**
+      * Drop responses kept by create_webserver::response_cache: every
+      * one, or those stored for @p path (every method, query string and
+      * variant of it). @p path is normalized the way request paths are.
+      * Requests already answered from an entry are unaffected.
+      *
+      * Safe to call from any thread, handlers included.
+      * @return the number of entries dropped (the no-argument form
+      *         returns nothing).
+     **/
+     void purge_cached_responses();
+     size_t purge_cached_responses(std::string_view path);
+
      /**
       * Reports build-time feature availability.
       *
-      * The four boolean fields of the returned struct reflect the
-      * HAVE_BAUTH / HAVE_DAUTH / HAVE_GNUTLS / HAVE_WEBSOCKET macros at
+      * The five boolean fields of the returned struct reflect the
+      * HAVE_BAUTH / HAVE_DAUTH / HAVE_GNUTLS / HAVE_WEBSOCKET / HAVE_ZLIB
+      * macros at
       * the time libhttpserver was compiled. Use this at runtime to
       * decide whether to register a feature-dependent handler or to
       * surface the configuration to the operator.
@@ -169,6 +201,7 @@
          bool digest_auth;
          bool tls;
          bool websocket;
+         bool compression;  // zlib: decode_request_body, compress_responses
      };
      static features features() noexcept;
 
@@ -0,0 +1,66 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/sse_channel.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "httpserver/detail/sse_hub.hpp"
+#include "httpserver/http_request.hpp"
+#include "httpserver/http_response.hpp"
+#include "httpserver/stream_writer.hpp"
+
+using std::string_view_literals::operator""sv;
+
+namespace httpserver {
+
+sse_channel::sse_channel(sse_channel_options options)
+    : subscriber_buffer_(options.subscriber_buffer),
+      hub_(std::make_unique<detail::sse_hub>(options.replay_events, options.keep_alive)) {
+    if (subscriber_buffer_ == 0) {
+        throw std::invalid_argument("sse_channel: subscriber_buffer must be > 0");
+    }
+}
+
+sse_channel::~sse_channel() = default;
+
+http_response sse_channel::subscribe(const http_request& req) {
+    stream_writer out(subscriber_buffer_);
+    hub_->subscribe(out.channel_, req.get_header("Last-Event-ID"));
+    return http_response::stream(out)
+        .with_header("Content-Type"sv, "text/event-stream"sv)
+        .with_header("Cache-Control"sv, "no-cache"sv);
+}
+
+void sse_channel::publish(std::string_view data, std::string_view event,
+                          std::string_view id) {
+    hub_->publish(std::make_shared<const std::string>(detail::sse_hub::encode(data, event, id)),
+                  std::string(id));
+}
+
+std::size_t sse_channel::subscribers() const {
+    return hub_->subscribers();
+}
+
+}  // namespace httpserver
@@ -0,0 +1,112 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/static_directory_resource.hpp"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "httpserver/constants.hpp"
+#include "httpserver/http_method.hpp"
+#include "httpserver/http_request.hpp"
+#include "httpserver/http_utils.hpp"
+#include "httpserver/detail/http_field_validation.hpp"
+#include "httpserver/detail/path_normalize.hpp"
+#include "httpserver/detail/static_directory_index.hpp"
+
+namespace httpserver {
+
+namespace {
+
+using namespace std::string_view_literals;
+
+// realpath() of @p root, which must be a directory.
+std::string resolve_root(const std::string& root) {
+    char* resolved = ::realpath(root.c_str(), nullptr);
+    if (resolved == nullptr) {
+        throw std::invalid_argument("static_directory_resource: cannot resolve root '" + root + "'");
+    }
+    std::string out(resolved);
+    ::free(resolved);
+    struct stat sb;
+    if (::stat(out.c_str(), &sb) != 0 || !S_ISDIR(sb.st_mode)) {
+        throw std::invalid_argument("static_directory_resource: root '" + root + "' is not a directory");
+    }
+    return out;
+}
+
+http_response not_found() {
+    return http_response::string(std::string{constants::NOT_FOUND_ERROR})
+        .with_status(http::http_utils::http_not_found);
+}
+
+}  // namespace
+
+static_directory_resource::static_directory_resource(std::string url_prefix, std::string root,
+                                                     static_directory_options options)
+    : prefix_(detail::normalize_path(url_prefix)), options_(std::move(options)) {
+    if (detail::has_forbidden_field_char(options_.cache_control)) {
+        throw std::invalid_argument(
+            "static_directory_resource: cache_control contains CR, LF or NUL");
+    }
+    index_ = std::make_unique<detail::static_directory_index>(
+        resolve_root(root), options_.index_files, options_.max_index_entries,
+        options_.revalidate_after);
+    disallow_all();
+    set_allowing(http_method::get, true);
+    set_allowing(http_method::head, true);
+}
+
+static_directory_resource::~static_directory_resource() = default;
+
+http_response static_directory_resource::render_get(const http_request& req) {
+    const std::string path = detail::normalize_path(req.get_path());
+    std::string_view rel = path;
+    if (prefix_ != "/") {
+        if (!rel.starts_with(prefix_)
+                || (rel.size() > prefix_.size() && rel[prefix_.size()] != '/')) {
+            return not_found();
+        }
+        rel.remove_prefix(prefix_.size());
+        if (rel.empty()) rel = "/"sv;
+    }
+    // An escaped %00 survives unescaping; no file name holds one.
+    if (rel.find('\0') != std::string_view::npos) return not_found();
+    const auto info = index_->lookup(std::string(rel));
+    if (info == nullptr) return not_found();
+    http_response r = http_response::file(info->path, {.precompressed = options_.precompressed});
+    r.with_header("Content-Type"sv, info->content_type)
+        .with_header("ETag"sv, info->etag)
+        .with_header("Last-Modified"sv, info->last_modified);
+    if (!options_.cache_control.empty()) r.with_header("Cache-Control"sv, options_.cache_control);
+    return r;
+}
+
+http_response static_directory_resource::render_head(const http_request& req) {
+    return render_get(req);
+}
+
+}  // namespace httpserver
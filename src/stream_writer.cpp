@@ -0,0 +1,51 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include "httpserver/stream_writer.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include "httpserver/detail/stream_channel.hpp"
+
+namespace httpserver {
+
+stream_writer::stream_writer(std::size_t buffer_bytes)
+    : channel_(std::make_shared<detail::stream_channel>(buffer_bytes)) {
+}
+
+bool stream_writer::write(std::string_view data) {
+    return channel_->write(data);
+}
+
+std::size_t stream_writer::try_write(std::string_view data) {
+    return channel_->try_write(data);
+}
+
+void stream_writer::finish() noexcept {
+    channel_->finish();
+}
+
+bool stream_writer::closed() const noexcept {
+    return channel_->closed();
+}
+
+}  // namespace httpserver
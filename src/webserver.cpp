@@ -212,6 +212,11 @@ webserver::webserver(const create_webserver& params):
         if (config.digest_auth_enabled) {
             throw feature_unavailable("digest_auth", "HAVE_DAUTH");
         }
+#endif
+#ifndef HAVE_ZLIB
+        if (config.decode_request_body || config.compress_responses) {
+            throw feature_unavailable("compression", "HAVE_ZLIB");
+        }
 #endif
         ignore_sigpipe();
         // Register the three v1 setter aliases as hooks
@@ -255,7 +260,12 @@ struct webserver::features webserver::features() noexcept {
 #else
     constexpr bool k_ws = false;
 #endif
-    return {k_bauth, k_dauth, k_tls, k_ws};
+#ifdef HAVE_ZLIB
+    constexpr bool k_zlib = true;
+#else
+    constexpr bool k_zlib = false;
+#endif
+    return {k_bauth, k_dauth, k_tls, k_ws, k_zlib};
 }
 
 webserver::~webserver() {
@@ -443,7 +453,12 @@ bool webserver::stop() {
     pthread_cond_signal(&impl_->daemon_.mutexcond);
     pthread_mutex_unlock(&impl_->daemon_.mutexwait);
 
+    // MHD cannot stop with suspended connections: end every stream
+    // response first (which resumes a parked one), and fail new ones
+    // until the daemon is gone.
+    impl_->response_mat_.streams().close();
     MHD_stop_daemon(impl_->daemon_.daemon.load(std::memory_order_acquire));
+    impl_->response_mat_.streams().reopen();
     // Reset so the daemon != nullptr guards treat it as absent after stop().
     impl_->daemon_.daemon.store(nullptr, std::memory_order_release);
 
@@ -493,6 +508,22 @@ uint16_t webserver::get_bound_port() const {
     return info->port;
 }
 
+webserver::upload_usage webserver::get_upload_usage() const noexcept {
+    using kind = detail::upload_budget::kind;
+    const detail::upload_budget& b = impl_->budget_;
+    return {b.in_use(kind::memory), b.limit(kind::memory),
+            b.in_use(kind::disk), b.limit(kind::disk)};
+}
+
+void webserver::purge_cached_responses() {
+    impl_->response_cache_.clear();
+}
+
+size_t webserver::purge_cached_responses(std::string_view path) {
+    return impl_->response_cache_.purge(
+        detail::normalize_path(http_utils::standardize_url(std::string(path))));
+}
+
 bool webserver::run() {
     struct MHD_Daemon* d = impl_->daemon_.handle();
     if (d == nullptr) return false;
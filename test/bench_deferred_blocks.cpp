@@ -0,0 +1,150 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+// Generated-stream throughput by http_response::deferred block size: one
+// libcurl client downloading a 64 MiB body produced by an inline lambda,
+// median of kOuter downloads, reported as MB/s and producer calls:
+//
+//   (a) block_4k: http_response::deferred(producer, 4 * 1024)
+//   (b) block_256k: http_response::deferred(producer, 256 * 1024)
+//
+// The client asks for HTTP/1.0, so the body goes out unchunked and
+// close-delimited straight from the block buffer -- the path block_size
+// governs. A chunked HTTP/1.1 reply is also capped by the connection's
+// write buffer (create_webserver::memory_limit).
+//
+// CI gate (relative, measured in-run so it tracks runner speed):
+//   * (b) must not be slower than (a) (10% margin for timer noise):
+//     larger blocks mean fewer producer calls and sends.
+//
+// Wired into `make bench` via bench_targets in test/Makefile.am; not
+// part of `make check`. Sanitizer builds skip with exit 0.
+
+#include <curl/curl.h>
+#include <microhttpd.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "./httpserver.hpp"
+#include "./bench_harness.hpp"
+
+using httpserver::create_webserver;
+using httpserver::http_request;
+using httpserver::http_resource;
+using httpserver::http_response;
+using httpserver::webserver;
+
+namespace {
+
+constexpr std::size_t kOuter = 7;
+constexpr std::uint64_t kBodyBytes = 64ull * 1024 * 1024;
+
+std::atomic<std::uint64_t> producer_calls{0};
+
+class generated_resource : public http_resource {
+ public:
+    explicit generated_resource(std::size_t block_size) : block_size_(block_size) {}
+
+    http_response render_get(const http_request&) override {
+        return http_response::deferred(
+            [](std::uint64_t pos, char* buf, std::size_t max) -> ssize_t {
+                producer_calls.fetch_add(1, std::memory_order_relaxed);
+                if (pos >= kBodyBytes) return MHD_CONTENT_READER_END_OF_STREAM;
+                const std::size_t n = static_cast<std::size_t>(
+                    std::min<std::uint64_t>(max, kBodyBytes - pos));
+                std::memset(buf, 'g', n);
+                return static_cast<ssize_t>(n);
+            }, block_size_);
+    }
+
+ private:
+    std::size_t block_size_;
+};
+
+std::size_t count_bytes(void*, std::size_t size, std::size_t nmemb, void* total) {
+    *static_cast<std::uint64_t*>(total) += size * nmemb;
+    return size * nmemb;
+}
+
+// Downloads the body from @p path kOuter times (after one untimed run)
+// and returns the median MB/s, or -1 when a download came up short.
+double measure(const char* label, std::uint16_t port, const char* path) {
+    const std::string url = "http://127.0.0.1:" + std::to_string(port) + path;
+    CURL* curl = curl_easy_init();
+    std::uint64_t received = 0;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, count_bytes);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &received);
+    long failures = 0;  // NOLINT(runtime/int)
+    const auto download = [&] {
+        received = 0;
+        if (curl_easy_perform(curl) != CURLE_OK || received != kBodyBytes) ++failures;
+    };
+    download();
+    producer_calls = 0;
+    const double median_ns = measure_median_ns(label, download, kOuter, 1, 0);
+    curl_easy_cleanup(curl);
+    if (failures != 0) {
+        std::printf("FAIL: %s: %ld downloads came up short\n", label, failures);
+        return -1;
+    }
+    const double mb_per_s = static_cast<double>(kBodyBytes) / median_ns * 1e3;
+    std::printf("    %.0f MB/s, %.0f producer calls per response\n", mb_per_s,
+                static_cast<double>(producer_calls.load()) / kOuter);
+    return mb_per_s;
+}
+
+}  // namespace
+
+int main() {
+    if constexpr (kSanitizerBuild) {
+        std::printf("bench_deferred_blocks: sanitizer build, skipping\n");
+        return 0;
+    }
+
+    curl_global_init(CURL_GLOBAL_ALL);
+    std::printf("bench_deferred_blocks (64 MiB generated body, HTTP/1.0, loopback):\n");
+
+    webserver ws{create_webserver(0)};
+    ws.register_path("/b4k", std::make_shared<generated_resource>(4 * 1024));
+    ws.register_path("/b256k", std::make_shared<generated_resource>(256 * 1024));
+    ws.start(false);
+    const double small = measure("block_4k", ws.get_bound_port(), "/b4k");
+    const double large = measure("block_256k", ws.get_bound_port(), "/b256k");
+    ws.stop();
+    curl_global_cleanup();
+
+    if (small < 0 || large < 0) return 1;
+    if (large < small * 0.90) {
+        std::printf("FAIL: block_256k %.0f MB/s is below 0.9x block_4k (%.0f MB/s)\n",
+                    large, small);
+        return 1;
+    }
+    std::printf("PASS: block_256k >= 0.9x block_4k\n");
+    return 0;
+}
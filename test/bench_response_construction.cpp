@@ -0,0 +1,141 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+// Response-construction microbench for the header_fields store.
+//
+// Five headers plus the factory's Content-Type, stored and then walked
+// once the way response_materializer::decorate_mhd_response does before
+// handing them to libmicrohttpd:
+//
+//   (a) map_baseline: six insert_or_assign calls into an http::header_map,
+//       the std::map store http_response kept headers in before
+//       header_fields. Six tree nodes, plus any name that outgrows SSO.
+//   (b) header_fields: the same six inserts into http::header_fields.
+//       Four entries inline, the rest in one vector, and all copied text
+//       in one chunk: two allocations.
+//   (c) response_owned: the whole response --
+//       http_response::string(...).with_header(std::string, ...) x5,
+//       including validation and the move out of the fluent chain.
+//   (d) response_static: (c) with "..."sv static_text names and values,
+//       which skip validation and are stored by pointer.
+//
+// CI gate (relative, measured in-run so it tracks runner speed):
+//   * (b) must not be slower than (a): the flat store has to beat the
+//     tree it replaced;
+//   * (d) must stay within 10% of (c): borrowing must never cost more
+//     than copying (the margin absorbs timer noise).
+//
+// Wired into `make bench` via bench_targets in test/Makefile.am; not
+// part of `make check`. Sanitizer builds skip with exit 0.
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "./httpserver.hpp"
+#include "./bench_harness.hpp"
+
+using httpserver::http_response;
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr std::size_t kOuter = 11;
+constexpr std::size_t kInner = 200'000;
+
+template <typename Map>
+std::size_t fill_and_walk(Map& m) {
+    m.insert_or_assign("Content-Type", "text/plain");
+    m.insert_or_assign("Cache-Control", "no-store");
+    m.insert_or_assign("X-Content-Type-Options", "nosniff");
+    m.insert_or_assign("X-Frame-Options", "DENY");
+    m.insert_or_assign("Vary", "Accept-Encoding");
+    m.insert_or_assign("X-Request-Id", "3f2a9c");
+    std::size_t n = 0;
+    for (const auto& [k, v] : m) n += k.size() + v.size();
+    return n;
+}
+
+std::size_t walk(const http_response& r) {
+    std::size_t n = 0;
+    for (const auto& [k, v] : r.get_headers()) n += k.size() + v.size();
+    return n;
+}
+
+}  // namespace
+
+int main() {
+    if constexpr (kSanitizerBuild) {
+        std::printf("bench_response_construction: sanitizer build, skipping\n");
+        return 0;
+    }
+
+    std::printf("bench_response_construction (5 headers + Content-Type):\n");
+    const double map_ns = measure_median_ns("map_baseline", [] {
+        httpserver::http::header_map m;
+        std::size_t n = fill_and_walk(m);
+        do_not_optimize(n);
+    }, kOuter, kInner);
+
+    const double fields_ns = measure_median_ns("header_fields", [] {
+        httpserver::http::header_fields f;
+        std::size_t n = fill_and_walk(f);
+        do_not_optimize(n);
+    }, kOuter, kInner);
+
+    const double owned_ns = measure_median_ns("response_owned", [] {
+        http_response r = http_response::string("ok")
+            .with_header("Cache-Control", "no-store")
+            .with_header("X-Content-Type-Options", "nosniff")
+            .with_header("X-Frame-Options", "DENY")
+            .with_header("Vary", "Accept-Encoding")
+            .with_header("X-Request-Id", "3f2a9c");
+        std::size_t n = walk(r);
+        do_not_optimize(n);
+    }, kOuter, kInner);
+
+    const double static_ns = measure_median_ns("response_static", [] {
+        http_response r = http_response::string("ok")
+            .with_header("Cache-Control"sv, "no-store"sv)
+            .with_header("X-Content-Type-Options"sv, "nosniff"sv)
+            .with_header("X-Frame-Options"sv, "DENY"sv)
+            .with_header("Vary"sv, "Accept-Encoding"sv)
+            .with_header("X-Request-Id"sv, "3f2a9c"sv);
+        std::size_t n = walk(r);
+        do_not_optimize(n);
+    }, kOuter, kInner);
+
+    int rc = 0;
+    if (fields_ns > map_ns) {
+        std::printf("FAIL: header_fields median %.3f ns exceeds map_baseline %.3f ns\n",
+                    fields_ns, map_ns);
+        rc = 1;
+    }
+    if (static_ns > owned_ns * 1.10) {
+        std::printf("FAIL: response_static median %.3f ns exceeds 1.1x "
+                    "response_owned (%.3f ns)\n", static_ns, owned_ns);
+        rc = 1;
+    }
+    if (rc == 0) {
+        std::printf("PASS: header_fields <= map_baseline, "
+                    "response_static <= 1.1x response_owned\n");
+    }
+    return rc;
+}
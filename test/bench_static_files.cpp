@@ -0,0 +1,209 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+// Small-file serving over loopback: one keep-alive libcurl client
+// fetching 16 x 1 KiB files in turn, median ns per request:
+//
+//   (a) handler_baseline: a register_prefix resource doing what a handler
+//       would without static_directory_resource -- realpath() + stat()
+//       per request, then http_response::file() with a Content-Type and
+//       an ETag.
+//   (b) static_directory: static_directory_resource; after the first
+//       round every request is a metadata-index hit, so the filesystem
+//       sees open() + sendfile() only.
+//   (c) static_directory_fd_cache: (b) plus
+//       create_webserver::file_descriptor_cache -- dup() + sendfile().
+//
+// CI gate (relative, measured in-run so it tracks runner speed):
+//   * (b) and (c) must stay within 10% of (a). The client and the
+//     loopback round-trip dominate, so this guards against the resource
+//     adding work; the absolute numbers are what to compare elsewhere.
+//
+// Comparing against nginx: serve the same tree (the bench prints its
+// path; BENCH_KEEP_TREE=1 keeps it after the run) from a
+// `location /static/ { alias <tree>/; }` block with sendfile on and
+// keepalive enabled, and drive both servers with the same client, e.g.
+// `wrk -t1 -c1 -d10s http://127.0.0.1:<port>/static/f0.html`.
+// That comparison needs an nginx install and is not part of this bench.
+//
+// Wired into `make bench` via bench_targets in test/Makefile.am; not
+// part of `make check`. Sanitizer builds skip with exit 0.
+
+#include <curl/curl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "./httpserver.hpp"
+#include "./bench_harness.hpp"
+
+using httpserver::create_webserver;
+using httpserver::http_request;
+using httpserver::http_resource;
+using httpserver::http_response;
+using httpserver::static_directory_resource;
+using httpserver::webserver;
+
+namespace {
+
+constexpr std::size_t kOuter = 11;
+constexpr std::size_t kInner = 2'000;
+constexpr std::size_t kWarmup = 500;
+constexpr int kFiles = 16;
+
+std::string make_tree() {
+    char tmpl[] = "/tmp/bench_static_filesXXXXXX";
+    if (::mkdtemp(tmpl) == nullptr) return "";
+    const std::string root(tmpl);
+    const std::string body(1024, 'x');
+    for (int i = 0; i < kFiles; ++i) {
+        std::ofstream(root + "/f" + std::to_string(i) + ".html") << body;
+    }
+    return root;
+}
+
+void remove_tree(const std::string& root) {
+    for (int i = 0; i < kFiles; ++i) {
+        ::unlink((root + "/f" + std::to_string(i) + ".html").c_str());
+    }
+    ::rmdir(root.c_str());
+}
+
+class handler_baseline : public http_resource {
+ public:
+    explicit handler_baseline(std::string root) : root_(std::move(root)) {}
+
+    http_response render_get(const http_request& req) override {
+        const std::string path = root_ + std::string(req.get_path().substr(sizeof("/static") - 1));
+        char* resolved = ::realpath(path.c_str(), nullptr);
+        if (resolved == nullptr) return http_response::string("").with_status(404);
+        const std::string real(resolved);
+        ::free(resolved);
+        struct stat sb;
+        if (!real.starts_with(root_) || ::stat(real.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode)) {
+            return http_response::string("").with_status(404);
+        }
+        char etag[48];
+        std::snprintf(etag, sizeof(etag), "\"%" PRIx64 "-%" PRIx64 "\"",
+                      static_cast<std::uint64_t>(sb.st_mtime),
+                      static_cast<std::uint64_t>(sb.st_size));
+        return http_response::file(real)
+            .with_header("Content-Type", "text/html")
+            .with_header("ETag", etag);
+    }
+
+ private:
+    std::string root_;
+};
+
+std::size_t discard(void*, std::size_t size, std::size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+// Serves the tree through @p ws and times requests from one keep-alive
+// client cycling over the files.
+double measure(const char* label, webserver* ws) {
+    ws->start(false);
+    const std::string base = "http://127.0.0.1:" + std::to_string(ws->get_bound_port()) + "/static/f";
+    std::string urls[kFiles];
+    for (int i = 0; i < kFiles; ++i) urls[i] = base + std::to_string(i) + ".html";
+
+    CURL* curl = curl_easy_init();
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+    int next = 0;
+    long failures = 0;  // NOLINT(runtime/int)
+    const double median = measure_median_ns(label, [&] {
+        curl_easy_setopt(curl, CURLOPT_URL, urls[next].c_str());
+        next = (next + 1) % kFiles;
+        long status = 0;  // NOLINT(runtime/int)
+        if (curl_easy_perform(curl) != CURLE_OK
+                || curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status) != CURLE_OK
+                || status != 200) {
+            ++failures;
+        }
+    }, kOuter, kInner, kWarmup);
+    curl_easy_cleanup(curl);
+    ws->stop();
+    if (failures != 0) {
+        std::printf("FAIL: %s: %ld requests did not return 200\n", label, failures);
+        return -1;
+    }
+    return median;
+}
+
+}  // namespace
+
+int main() {
+    if constexpr (kSanitizerBuild) {
+        std::printf("bench_static_files: sanitizer build, skipping\n");
+        return 0;
+    }
+
+    const std::string root = make_tree();
+    if (root.empty()) {
+        std::printf("FAIL: cannot create the file tree\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_ALL);
+    std::printf("bench_static_files (%d x 1 KiB files, %s, loopback keep-alive):\n",
+                kFiles, root.c_str());
+
+    webserver plain{create_webserver(0)};
+    plain.register_prefix("static", std::make_shared<handler_baseline>(root));
+    const double baseline_ns = measure("handler_baseline", &plain);
+
+    webserver indexed{create_webserver(0)};
+    indexed.register_prefix("static", std::make_shared<static_directory_resource>("/static", root));
+    const double index_ns = measure("static_directory", &indexed);
+
+    webserver cached{create_webserver(0).file_descriptor_cache(kFiles)};
+    cached.register_prefix("static", std::make_shared<static_directory_resource>("/static", root));
+    const double cached_ns = measure("static_directory_fd_cache", &cached);
+
+    curl_global_cleanup();
+    if (::getenv("BENCH_KEEP_TREE") == nullptr) remove_tree(root);
+
+    if (baseline_ns < 0 || index_ns < 0 || cached_ns < 0) return 1;
+    int rc = 0;
+    if (index_ns > baseline_ns * 1.10) {
+        std::printf("FAIL: static_directory median %.0f ns exceeds 1.1x "
+                    "handler_baseline (%.0f ns)\n", index_ns, baseline_ns);
+        rc = 1;
+    }
+    if (cached_ns > baseline_ns * 1.10) {
+        std::printf("FAIL: static_directory_fd_cache median %.0f ns exceeds 1.1x "
+                    "handler_baseline (%.0f ns)\n", cached_ns, baseline_ns);
+        rc = 1;
+    }
+    if (rc == 0) {
+        std::printf("PASS: static_directory and static_directory_fd_cache "
+                    "<= 1.1x handler_baseline\n");
+    }
+    return rc;
+}
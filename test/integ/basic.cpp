@@ -19,6 +19,9 @@
 */
 
 #include <curl/curl.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 #include <atomic>
 #include <cstdio>
 #include <cstring>
@@ -27,6 +30,7 @@
 #include <memory>
 #include <mutex>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -148,6 +152,62 @@ class header_set_test_resource : public http_resource {
      }
 };
 
+// Serves one frozen response. GET returns it untouched (the prebuilt MHD
+// response is queued); POST adds a header, which forces a per-request
+// materialization that must still carry the frozen headers.
+class frozen_resource : public http_resource {
+ public:
+     http_response render_get(const http_request&) override {
+         return frozen_;
+     }
+
+     http_response render_post(const http_request&) override {
+         http_response r = frozen_;
+         return std::move(r).with_header("X-Extra", "1");
+     }
+
+ private:
+     httpserver::frozen_response frozen_ = http_response::string("frozen")
+         .with_header("KEY", "VALUE").freeze();
+};
+
+// Serves one refcounted document to every request without copying it.
+class shared_body_resource : public http_resource {
+ public:
+     http_response render_get(const http_request&) override {
+         return http_response::shared(doc_);
+     }
+
+ private:
+     std::shared_ptr<const std::string> doc_ =
+         std::make_shared<const std::string>("shared document");
+};
+
+// Pushes a body through a small stream_writer from a producer thread,
+// slower than the client drains it, so the connection keeps parking.
+class stream_resource : public http_resource {
+ public:
+     ~stream_resource() override {
+         if (producer_.joinable()) producer_.join();
+     }
+
+     http_response render_get(const http_request&) override {
+         if (producer_.joinable()) producer_.join();
+         httpserver::stream_writer out(16);
+         producer_ = std::thread([out]() mutable {
+             for (int i = 0; i < 40; ++i) {
+                 if (!out.write("chunk " + std::to_string(i) + "\n")) return;
+                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
+             }
+             out.finish();
+         });
+         return http_response::stream(out);
+     }
+
+ private:
+     std::thread producer_;
+};
+
 class cookie_set_test_resource : public http_resource {
  public:
      http_response render_get(const http_request&) override {
@@ -398,6 +458,50 @@ class content_limit_resource : public http_resource {
      }
 };
 
+class content_echo_resource : public http_resource {
+ public:
+     http_response render_post(const http_request& req) {
+         return http_response::string(std::string(req.get_content()));
+     }
+};
+
+#ifdef HAVE_ZLIB
+std::string gzip_compress(const std::string& in) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&zs, static_cast<uLong>(in.size())), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+#endif
+
+// POST @p body with the given Content-Encoding; returns the status code
+// and stores the response body in @p s.
+long post_encoded(uint16_t port, const std::string& body, const char* coding, string* s) {
+    CURL *curl = curl_easy_init();
+    struct curl_slist* headers = curl_slist_append(nullptr, (std::string("Content-Encoding: ") + coding).c_str());
+    const std::string url = "localhost:" + std::to_string(port) + "/echo";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.data());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, s);
+    long http_code = 0;
+    if (curl_easy_perform(curl) == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    }
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return http_code;
+}
 
 LT_BEGIN_SUITE(basic_suite)
     std::unique_ptr<webserver> ws;
@@ -728,6 +832,176 @@ LT_BEGIN_AUTO_TEST(basic_suite, resource_setting_header)
     curl_easy_cleanup(curl);
 LT_END_AUTO_TEST(resource_setting_header)
 
+LT_BEGIN_AUTO_TEST(basic_suite, frozen_response_is_reused)
+    const uint16_t port = ws->get_bound_port();
+    ws->register_path("frozen", std::make_shared<frozen_resource>());
+    curl_global_init(CURL_GLOBAL_ALL);
+    const std::string url = "localhost:" + std::to_string(port) + "/frozen";
+    for (int i = 0; i < 3; ++i) {
+        string s;
+        map<string, string> ss;
+        CURL *curl = curl_easy_init();
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        if (i == 2) curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &ss);
+        LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+        LT_CHECK_EQ(s, "frozen");
+        LT_CHECK_EQ(ss["KEY"], "VALUE");
+        LT_CHECK_EQ(ss["X-Extra"], i == 2 ? "1" : "");
+        curl_easy_cleanup(curl);
+    }
+LT_END_AUTO_TEST(frozen_response_is_reused)
+
+// default_headers reach plain, frozen (shared and re-materialized) and
+// default error responses; a header the response sets itself wins.
+LT_BEGIN_AUTO_TEST(basic_suite, default_headers_are_added_to_every_response)
+    webserver ws2{create_webserver(0).default_headers(
+        {{"X-Content-Type-Options", "nosniff"}, {"key", "default"}})};
+    ws2.register_path("base", std::make_shared<header_set_test_resource>());
+    ws2.register_path("frozen", std::make_shared<frozen_resource>());
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+    const std::string base = "localhost:" + std::to_string(ws2.get_bound_port());
+    const auto fetch = [&base](const std::string& path, bool post) {
+        map<string, string> ss;
+        string s;
+        CURL *curl = curl_easy_init();
+        const std::string url = base + path;
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        if (post) curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &ss);
+        const CURLcode res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+        if (res != CURLE_OK) ss.clear();
+        return ss;
+    };
+    map<string, string> plain = fetch("/base", false);
+    LT_CHECK_EQ(plain["X-Content-Type-Options"], "nosniff");
+    LT_CHECK_EQ(plain["KEY"], "VALUE");
+    LT_CHECK_EQ(plain.count("key"), 0u);
+    for (int i = 0; i < 3; ++i) {
+        map<string, string> frozen = fetch("/frozen", i == 2);
+        LT_CHECK_EQ(frozen["X-Content-Type-Options"], "nosniff");
+        LT_CHECK_EQ(frozen["KEY"], "VALUE");
+        LT_CHECK_EQ(frozen.count("key"), 0u);
+    }
+    map<string, string> missing = fetch("/nowhere", false);
+    LT_CHECK_EQ(missing["X-Content-Type-Options"], "nosniff");
+    LT_CHECK_EQ(missing["key"], "default");
+    ws2.stop();
+LT_END_AUTO_TEST(default_headers_are_added_to_every_response)
+
+// One frozen response served by several webservers with different
+// default_headers: each gets its own defaults, including a webserver
+// created after the first owner was destroyed (possibly at its address).
+LT_BEGIN_AUTO_TEST(basic_suite, frozen_defaults_stay_per_webserver)
+    auto frozen = std::make_shared<frozen_resource>();
+    const auto make = [&frozen](const std::string& name) {
+        auto w = std::make_unique<webserver>(
+            create_webserver(0).default_headers({{"X-Server", name}}));
+        w->register_path("frozen", frozen);
+        w->start(false);
+        return w;
+    };
+    const auto server_header = [](webserver& w) {
+        map<string, string> ss;
+        string s;
+        CURL *curl = curl_easy_init();
+        const std::string url = "localhost:" + std::to_string(w.get_bound_port()) + "/frozen";
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &ss);
+        const CURLcode res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+        return res == CURLE_OK && s == "frozen" ? ss["X-Server"] : std::string("error");
+    };
+    curl_global_init(CURL_GLOBAL_ALL);
+    std::unique_ptr<webserver> a = make("a");
+    std::unique_ptr<webserver> b = make("b");
+    for (int i = 0; i < 2; ++i) {
+        LT_CHECK_EQ(server_header(*a), "a");
+        LT_CHECK_EQ(server_header(*b), "b");
+    }
+    a->stop();
+    a.reset();
+    std::unique_ptr<webserver> c = make("c");
+    LT_CHECK_EQ(server_header(*c), "c");
+    LT_CHECK_EQ(server_header(*b), "b");
+    c->stop();
+    b->stop();
+LT_END_AUTO_TEST(frozen_defaults_stay_per_webserver)
+
+LT_BEGIN_AUTO_TEST(basic_suite, shared_body_is_served)
+    const uint16_t port = ws->get_bound_port();
+    ws->register_path("shared", std::make_shared<shared_body_resource>());
+    curl_global_init(CURL_GLOBAL_ALL);
+    const std::string url = "localhost:" + std::to_string(port) + "/shared";
+    for (int i = 0; i < 2; ++i) {
+        string s;
+        CURL *curl = curl_easy_init();
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+        LT_CHECK_EQ(s, "shared document");
+        curl_easy_cleanup(curl);
+    }
+LT_END_AUTO_TEST(shared_body_is_served)
+
+LT_BEGIN_AUTO_TEST(basic_suite, generated_etag_answers_polling_with_304)
+    webserver ws2{create_webserver(0).generate_etags()};
+    ws2.register_path("base", std::make_shared<simple_resource>());
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+    const std::string url = "localhost:" + std::to_string(ws2.get_bound_port()) + "/base";
+    const auto fetch = [&url](const std::string& if_none_match, long* code, string* body) {  // NOLINT(runtime/int)
+        map<string, string> ss;
+        CURL *curl = curl_easy_init();
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, body);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &ss);
+        struct curl_slist* headers = nullptr;
+        if (!if_none_match.empty()) {
+            headers = curl_slist_append(headers, ("If-None-Match: " + if_none_match).c_str());
+        }
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        if (curl_easy_perform(curl) != CURLE_OK) ss.clear();
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, code);
+        curl_slist_free_all(headers);
+        curl_easy_cleanup(curl);
+        return ss;
+    };
+    long code = 0;  // NOLINT(runtime/int)
+    string s;
+    map<string, string> first = fetch("", &code, &s);
+    const string etag = first["ETag"];
+    LT_CHECK_EQ(code, 200);
+    LT_CHECK_EQ(s, "OK");
+    LT_CHECK_EQ(etag.size(), 18u);
+
+    s.clear();
+    map<string, string> again = fetch(etag, &code, &s);
+    LT_CHECK_EQ(code, 304);
+    LT_CHECK_EQ(s, "");
+    LT_CHECK_EQ(again["ETag"], etag);
+
+    s.clear();
+    fetch("\"stale\"", &code, &s);
+    LT_CHECK_EQ(code, 200);
+    LT_CHECK_EQ(s, "OK");
+    ws2.stop();
+LT_END_AUTO_TEST(generated_etag_answers_polling_with_304)
+
 LT_BEGIN_AUTO_TEST(basic_suite, resource_setting_cookie)
     const uint16_t port = ws->get_bound_port();
     auto resource = std::make_shared<cookie_set_test_resource>();
@@ -1456,6 +1730,216 @@ LT_BEGIN_AUTO_TEST(basic_suite, file_serving_resource)
     curl_easy_cleanup(curl);
 LT_END_AUTO_TEST(file_serving_resource)
 
+LT_BEGIN_AUTO_TEST(basic_suite, file_serving_resource_range)
+    const uint16_t port = ws->get_bound_port();
+    auto resource = std::make_shared<file_response_resource>();
+    ws->register_path("base", resource);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    string s;
+    CURL *curl = curl_easy_init();
+    const std::string url = "localhost:" + std::to_string(port) + "/base";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_RANGE, "5-11");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+    LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+    int64_t http_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    LT_CHECK_EQ(http_code, 206);
+    LT_CHECK_EQ(s, "content");
+    curl_easy_cleanup(curl);
+LT_END_AUTO_TEST(file_serving_resource_range)
+
+LT_BEGIN_AUTO_TEST(basic_suite, static_directory_serving)
+    const uint16_t port = ws->get_bound_port();
+    ws->register_prefix("static", std::make_shared<httpserver::static_directory_resource>(
+        "/static", ".", httpserver::static_directory_options{.cache_control = "max-age=60"}));
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    string s;
+    map<string, string> ss;
+    CURL *curl = curl_easy_init();
+    const std::string url = "localhost:" + std::to_string(port) + "/static/test_content";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &ss);
+    LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+    int64_t http_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    LT_CHECK_EQ(http_code, 200);
+    LT_CHECK_EQ(s, "test content of file\n");
+    LT_CHECK_EQ(ss["Cache-Control"], "max-age=60");
+    LT_CHECK_EQ(ss["ETag"].empty(), false);
+
+    s.clear();
+    const std::string escape = "localhost:" + std::to_string(port) + "/static/../../etc/passwd";
+    curl_easy_setopt(curl, CURLOPT_URL, escape.c_str());
+    curl_easy_setopt(curl, CURLOPT_PATH_AS_IS, 1L);
+    LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    LT_CHECK_NEQ(http_code, 200);
+    curl_easy_cleanup(curl);
+LT_END_AUTO_TEST(static_directory_serving)
+
+LT_BEGIN_AUTO_TEST(basic_suite, stream_response_is_pushed)
+    webserver ws2{create_webserver(0).deferred()};
+    ws2.register_path("stream", std::make_shared<stream_resource>());
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    string expected;
+    for (int i = 0; i < 40; ++i) expected += "chunk " + std::to_string(i) + "\n";
+    for (int round = 0; round < 2; ++round) {
+        string s;
+        CURL *curl = curl_easy_init();
+        const std::string url = "localhost:" + std::to_string(ws2.get_bound_port()) + "/stream";
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+        LT_CHECK_EQ(s == expected, true);
+        curl_easy_cleanup(curl);
+    }
+    ws2.stop();
+LT_END_AUTO_TEST(stream_response_is_pushed)
+
+// A stream that is never finished stays parked after the client gives up;
+// stop() must end it rather than leave MHD a suspended connection.
+LT_BEGIN_AUTO_TEST(basic_suite, stop_ends_unfinished_streams)
+    httpserver::stream_writer pending;
+    webserver ws2{create_webserver(0).deferred()};
+    ws2.on_get("/open", [pending](const http_request&) { return http_response::stream(pending); });
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    CURL *curl = curl_easy_init();
+    const std::string url = "localhost:" + std::to_string(ws2.get_bound_port()) + "/open";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 200L);
+    LT_CHECK_EQ(curl_easy_perform(curl), CURLE_OPERATION_TIMEDOUT);
+    curl_easy_cleanup(curl);
+    LT_CHECK_EQ(pending.closed(), false);
+    ws2.stop();
+    LT_CHECK_EQ(pending.closed(), true);
+LT_END_AUTO_TEST(stop_ends_unfinished_streams)
+
+LT_BEGIN_AUTO_TEST(basic_suite, response_cache_skips_the_handler)
+    std::atomic<int> calls{0};
+    webserver ws2{create_webserver(0).response_cache(1 << 20)};
+    ws2.on_get("/catalog", [&calls](const http_request&) {
+        return http_response::string("catalog " + std::to_string(++calls))
+            .with_header("Cache-Control", "max-age=60");
+    });
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    const std::string base = "localhost:" + std::to_string(ws2.get_bound_port());
+    auto get = [&base](const std::string& target) {
+        string s;
+        CURL *curl = curl_easy_init();
+        const std::string url = base + target;
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+        return s;
+    };
+    LT_CHECK_EQ(get("/catalog"), "catalog 1");
+    LT_CHECK_EQ(get("/catalog"), "catalog 1");
+    LT_CHECK_EQ(get("/catalog?page=2"), "catalog 2");
+    LT_CHECK_EQ(ws2.purge_cached_responses("/catalog"), 2u);
+    LT_CHECK_EQ(get("/catalog"), "catalog 3");
+    ws2.purge_cached_responses();
+    LT_CHECK_EQ(get("/catalog"), "catalog 4");
+    ws2.stop();
+LT_END_AUTO_TEST(response_cache_skips_the_handler)
+
+// A hit is served only after the auth_handler let the request through: a
+// client without the API key gets the 401, never the cached 200.
+LT_BEGIN_AUTO_TEST(basic_suite, response_cache_hit_still_runs_auth)
+    std::atomic<int> calls{0};
+    webserver ws2{create_webserver(0).response_cache(1 << 20)
+        .auth_handler([](const http_request& req) -> std::optional<http_response> {
+            if (req.get_header("X-Api-Key") == "k") return std::nullopt;
+            return http_response::string("denied").with_status(401);
+        })};
+    ws2.on_get("/private", [&calls](const http_request&) {
+        return http_response::string("private " + std::to_string(++calls))
+            .with_header("Cache-Control", "max-age=60");
+    });
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    const std::string url = "localhost:" + std::to_string(ws2.get_bound_port()) + "/private";
+    auto get = [&url](bool with_key, long* code) {  // NOLINT(runtime/int)
+        string s;
+        CURL *curl = curl_easy_init();
+        struct curl_slist* headers = nullptr;
+        if (with_key) headers = curl_slist_append(headers, "X-Api-Key: k");
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        curl_easy_perform(curl);
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, code);
+        curl_slist_free_all(headers);
+        curl_easy_cleanup(curl);
+        return s;
+    };
+    long code = 0;  // NOLINT(runtime/int)
+    LT_CHECK_EQ(get(true, &code), "private 1");
+    LT_CHECK_EQ(get(true, &code), "private 1");
+    LT_CHECK_EQ(code, 200);
+    LT_CHECK_EQ(get(false, &code), "denied");
+    LT_CHECK_EQ(code, 401);
+    LT_CHECK_EQ(calls.load(), 1);
+    ws2.stop();
+LT_END_AUTO_TEST(response_cache_hit_still_runs_auth)
+
+class coalesced_resource : public http_resource {
+ public:
+     std::string single_flight_key(const http_request& req) {
+         return std::string(req.get_path());
+     }
+
+     http_response render_get(const http_request&) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(500));
+         return http_response::string("report " + std::to_string(++calls));
+     }
+
+     std::atomic<int> calls{0};
+};
+
+LT_BEGIN_AUTO_TEST(basic_suite, single_flight_shares_one_handler_call)
+    webserver ws2{create_webserver(0).deferred().max_threads(4)};
+    auto res = std::make_shared<coalesced_resource>();
+    ws2.register_path("/report", res);
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    const std::string url = "localhost:" + std::to_string(ws2.get_bound_port()) + "/report";
+    std::string bodies[4];
+    std::vector<std::thread> clients;
+    for (auto& body : bodies) {
+        clients.emplace_back([&url, &body] {
+            CURL *curl = curl_easy_init();
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+            curl_easy_perform(curl);
+            curl_easy_cleanup(curl);
+        });
+    }
+    for (auto& c : clients) c.join();
+    LT_CHECK_EQ(res->calls.load(), 1);
+    for (const auto& body : bodies) LT_CHECK_EQ(body, "report 1");
+    ws2.stop();
+LT_END_AUTO_TEST(single_flight_shares_one_handler_call)
+
 LT_BEGIN_AUTO_TEST(basic_suite, file_serving_resource_empty)
     const uint16_t port = ws->get_bound_port();
     auto resource = std::make_shared<file_response_resource_empty>();
@@ -2083,6 +2567,144 @@ LT_BEGIN_AUTO_TEST(content_limit_suite, content_within_limit)
     curl_easy_cleanup(curl);
 LT_END_AUTO_TEST(content_within_limit)
 
+#ifdef HAVE_ZLIB
+LT_BEGIN_AUTO_TEST(content_limit_suite, gzip_request_body_is_decoded)
+    webserver ws2{create_webserver(0).decode_request_body().content_size_limit(1 << 20)};
+    ws2.register_path("echo", std::make_shared<content_echo_resource>());
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    std::string plain;
+    for (int i = 0; i < 2000; ++i) plain += "line " + std::to_string(i) + "\n";
+    string s;
+    LT_CHECK_EQ(post_encoded(ws2.get_bound_port(), gzip_compress(plain), "gzip", &s), 200);
+    LT_CHECK_EQ(s == plain, true);
+
+    // Decoded size, not wire size, is held against content_size_limit.
+    string bomb;
+    const std::string zeros(4 << 20, '\0');
+    LT_CHECK_EQ(post_encoded(ws2.get_bound_port(), gzip_compress(zeros), "gzip", &bomb), 413);
+
+    string bad;
+    LT_CHECK_EQ(post_encoded(ws2.get_bound_port(), "not gzip at all", "gzip", &bad), 400);
+
+    string unsupported;
+    LT_CHECK_EQ(post_encoded(ws2.get_bound_port(), "abc", "br", &unsupported), 415);
+    ws2.stop();
+LT_END_AUTO_TEST(gzip_request_body_is_decoded)
+
+// GET /long with @p accept_encoding (nullptr: no Accept-Encoding header);
+// libcurl decodes the body, the raw response headers land in @p hdrs.
+string get_long(uint16_t port, const char* accept_encoding, map<string, string>* hdrs) {
+    string s;
+    CURL *curl = curl_easy_init();
+    const std::string url = "localhost:" + std::to_string(port) + "/long";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (accept_encoding != nullptr) curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, accept_encoding);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, hdrs);
+    curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+    return s;
+}
+
+LT_BEGIN_AUTO_TEST(content_limit_suite, responses_are_compressed_when_accepted)
+    webserver ws2{create_webserver(0).compress_responses()};
+    ws2.register_path("long", std::make_shared<long_content_resource>());
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    for (const char* coding : {"gzip", "deflate"}) {
+        map<string, string> hdrs;
+        LT_CHECK_EQ(get_long(ws2.get_bound_port(), coding, &hdrs) == lorem_ipsum, true);
+        LT_CHECK_EQ(hdrs["Content-Encoding"], coding);
+        LT_CHECK_EQ(hdrs["Vary"], "Accept-Encoding");
+        LT_CHECK_EQ(std::stoul(hdrs["Content-Length"]) < lorem_ipsum.size(), true);
+    }
+
+    // No Accept-Encoding: sent as is, but still marked as varying.
+    map<string, string> hdrs;
+    LT_CHECK_EQ(get_long(ws2.get_bound_port(), nullptr, &hdrs) == lorem_ipsum, true);
+    LT_CHECK_EQ(hdrs.count("Content-Encoding"), 0u);
+    LT_CHECK_EQ(hdrs["Vary"], "Accept-Encoding");
+    ws2.stop();
+LT_END_AUTO_TEST(responses_are_compressed_when_accepted)
+
+// A cached response is stored after the ETag and compression stages:
+// the miss and every hit carry the encoding and the ETag, a matching
+// If-None-Match on a hit is a 304, and each Accept-Encoding value is its
+// own entry.
+LT_BEGIN_AUTO_TEST(content_limit_suite, response_cache_keeps_etag_and_encoding)
+    std::atomic<int> calls{0};
+    webserver ws2{create_webserver(0).compress_responses().generate_etags()
+        .response_cache(1 << 20).response_cache_vary({"Accept-Encoding"})};
+    ws2.on_get("/long", [&calls](const http_request&) {
+        ++calls;
+        return http_response::string(lorem_ipsum).with_header("Cache-Control", "max-age=60");
+    });
+    ws2.start(false);
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    const std::string url = "localhost:" + std::to_string(ws2.get_bound_port()) + "/long";
+    auto get = [&url](const char* accept_encoding, const std::string& if_none_match,
+                      map<string, string>* hdrs, long* code) {  // NOLINT(runtime/int)
+        string s;
+        CURL *curl = curl_easy_init();
+        struct curl_slist* headers = nullptr;
+        if (!if_none_match.empty()) {
+            headers = curl_slist_append(headers, ("If-None-Match: " + if_none_match).c_str());
+        }
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        if (accept_encoding != nullptr) curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, accept_encoding);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerfunc);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, hdrs);
+        curl_easy_perform(curl);
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, code);
+        curl_slist_free_all(headers);
+        curl_easy_cleanup(curl);
+        return s;
+    };
+    long code = 0;  // NOLINT(runtime/int)
+    map<string, string> miss;
+    LT_CHECK_EQ(get("gzip", "", &miss, &code) == lorem_ipsum, true);
+    map<string, string> hit;
+    LT_CHECK_EQ(get("gzip", "", &hit, &code) == lorem_ipsum, true);
+    LT_CHECK_EQ(calls.load(), 1);
+    for (map<string, string>* h : {&miss, &hit}) {
+        LT_CHECK_EQ((*h)["Content-Encoding"], "gzip");
+        LT_CHECK_EQ((*h)["ETag"].rfind("W/\"", 0), 0u);
+    }
+    LT_CHECK_EQ(hit["ETag"], miss["ETag"]);
+
+    map<string, string> revalidated;
+    LT_CHECK_EQ(get("gzip", miss["ETag"], &revalidated, &code), "");
+    LT_CHECK_EQ(code, 304);
+    LT_CHECK_EQ(revalidated["ETag"], miss["ETag"]);
+    LT_CHECK_EQ(calls.load(), 1);
+
+    map<string, string> identity;
+    LT_CHECK_EQ(get(nullptr, "", &identity, &code) == lorem_ipsum, true);
+    LT_CHECK_EQ(identity.count("Content-Encoding"), 0u);
+    LT_CHECK_EQ(identity["ETag"].empty(), false);
+    LT_CHECK_EQ(calls.load(), 2);
+    ws2.stop();
+LT_END_AUTO_TEST(response_cache_keeps_etag_and_encoding)
+#endif
+
+// Without decode_request_body the encoded bytes reach the handler as-is.
+LT_BEGIN_AUTO_TEST(content_limit_suite, encoded_body_passes_through_by_default)
+    ws->register_path("echo", std::make_shared<content_echo_resource>());
+    curl_global_init(CURL_GLOBAL_ALL);
+    string s;
+    LT_CHECK_EQ(post_encoded(content_limit_port, "opaque", "br", &s), 200);
+    LT_CHECK_EQ(s, "opaque");
+LT_END_AUTO_TEST(encoded_body_passes_through_by_default)
+
 LT_BEGIN_AUTO_TEST(basic_suite, get_args_flat)
     const uint16_t port = ws->get_bound_port();
     auto resource = std::make_shared<args_flat_resource>();
@@ -31,6 +31,7 @@
 #endif
 
 #include <curl/curl.h>
+#include <microhttpd.h>
 #include <signal.h>
 #include <unistd.h>
 
@@ -99,8 +100,8 @@ ssize_t test_callback_with_data(shared_ptr<test_data> closure_data, char* buf, s
 }
 
 // v1's deferred_response<T> had a typed callable + initial content
-// prefix. v2's http_response::deferred(producer) is type-erased through
-// std::function and has no initial-content parameter; the lambda below
+// prefix. v2's http_response::deferred(producer) takes any callable
+// through deferred_producer and has no initial-content parameter; the lambda below
 // reproduces the v1 prefix-then-callback semantics by emitting the prefix
 // once before delegating to the typed callback.
 class deferred_resource : public http_resource {
@@ -154,6 +155,40 @@ class deferred_resource_empty_content : public http_resource {
      }
 };
 
+// Streams three records and sends their count and a running checksum
+// (FNV-1a, standing in for a real digest) as trailers, plus one added
+// while the first record is produced.
+class deferred_resource_with_trailers : public http_resource {
+ public:
+     http_response render_get(const http_request&) {
+         return http_response::deferred(
+             [records = 0, hash = std::uint32_t{2166136261u}](
+                     std::uint64_t, char* buf, std::size_t max,
+                     httpserver::deferred_trailers& trailers) mutable -> ssize_t {
+                 if (records == 3) {
+                     char hex[9];
+                     snprintf(hex, sizeof(hex), "%08x", hash);
+                     trailers.add("X-Record-Count", std::to_string(records));
+                     trailers.add("X-Checksum", hex);
+                     return MHD_CONTENT_READER_END_OF_STREAM;
+                 }
+                 if (records == 0) trailers.add("X-First-Record", "rec");
+                 const std::size_t n = std::min<std::size_t>(4, max);
+                 memcpy(buf, "rec\n", n);
+                 for (std::size_t i = 0; i < n; ++i) {
+                     hash = (hash ^ static_cast<unsigned char>(buf[i])) * 16777619u;
+                 }
+                 ++records;
+                 return static_cast<ssize_t>(n);
+             });
+     }
+};
+
+size_t collect_headers(char* ptr, size_t size, size_t nmemb, string* s) {
+    s->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
 LT_BEGIN_SUITE(deferred_suite)
     std::unique_ptr<webserver> ws;
     uint16_t port = 0;
@@ -231,6 +266,40 @@ LT_BEGIN_AUTO_TEST(deferred_suite, deferred_response_empty_content)
     curl_easy_cleanup(curl);
 LT_END_AUTO_TEST(deferred_response_empty_content)
 
+LT_BEGIN_AUTO_TEST(deferred_suite, deferred_response_sends_trailers)
+    ws->register_path("base", std::make_shared<deferred_resource_with_trailers>());
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    std::string body;
+    std::string headers;
+    CURL *curl = curl_easy_init();
+    const std::string url = "localhost:" + std::to_string(port) + "/base";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, collect_headers);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headers);
+    LT_ASSERT_EQ(curl_easy_perform(curl), 0);
+    LT_CHECK_EQ(body, "rec\nrec\nrec\n");
+    // libcurl hands trailer lines to the header callback after the body,
+    // so they follow the blank line ending the header section; none may
+    // have reached the response's headers.
+    LT_CHECK(headers.find("Transfer-Encoding: chunked") != std::string::npos);
+    const std::size_t header_end = headers.find("\r\n\r\n");
+    LT_ASSERT_NEQ(header_end, std::string::npos);
+    const std::string trailer_lines = headers.substr(header_end + 4);
+    LT_CHECK_EQ(headers.substr(0, header_end).find("X-First-Record"), std::string::npos);
+    LT_CHECK(trailer_lines.find("X-First-Record: rec\r\n") != std::string::npos);
+    LT_CHECK(trailer_lines.find("X-Record-Count: 3\r\n") != std::string::npos);
+    std::uint32_t hash = 2166136261u;
+    for (const char c : body) hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    char hex[9];
+    snprintf(hex, sizeof(hex), "%08x", hash);
+    LT_CHECK(trailer_lines.find(std::string("X-Checksum: ") + hex + "\r\n") != std::string::npos);
+    curl_easy_cleanup(curl);
+LT_END_AUTO_TEST(deferred_response_sends_trailers)
+
 // ---------------------------------------------------------------------------
 // Acceptance tests: handler return-by-value dispatch cutover.
 //
@@ -295,6 +295,30 @@ class print_file_upload_resource : public http_resource {
      string content;
 };
 
+// Collects FILE_UPLOAD_STREAM parts: the bytes of each (field, filename)
+// part plus how many is_last calls closed a part.
+class streaming_upload_resource : public http_resource {
+ public:
+     bool on_upload_chunk(const http_request&, const httpserver::upload_chunk& chunk) override {
+         std::string& part = parts[string(chunk.field) + "/" + string(chunk.filename)];
+         if (chunk.offset != part.size()) return false;
+         part.append(reinterpret_cast<const char*>(chunk.data.data()), chunk.data.size());
+         if (chunk.is_last) ++finished_parts;
+         return true;
+     }
+
+     http_response render_post(const http_request& req) {
+         files_seen = req.get_files().size();
+         param = string(req.get_arg(TEST_PARAM_KEY));
+         return http_response::string("OK").with_status(201);
+     }
+
+     map<string, string> parts;
+     int finished_parts = 0;
+     size_t files_seen = 0;
+     string param;
+};
+
 LT_BEGIN_SUITE(file_upload_suite)
     void set_up() {
     }
@@ -450,6 +474,176 @@ LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_memory_and_disk_additional_par
     LT_CHECK_EQ(file_exists(file->second.get_file_system_file_name()), false);
 LT_END_AUTO_TEST(file_upload_memory_and_disk_additional_params)
 
+// Same upload as above, parsed by the native form_parser instead of
+// MHD_PostProcessor: args, file metadata and on-disk bytes must match.
+LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_native_form_parser)
+    string upload_directory = ".";
+
+    auto ws = std::make_unique<webserver>(create_webserver(0)
+                       .native_form_parser()
+                       .file_upload_target(httpserver::FILE_UPLOAD_MEMORY_AND_DISK)
+                       .file_upload_dir(upload_directory)
+                       .generate_random_filename_on_upload());
+    ws->start(false);
+    LT_CHECK_EQ(ws->is_running(), true);
+    const uint16_t port = ws->get_bound_port();
+
+    auto resource = std::make_shared<print_file_upload_resource>();
+    ws->register_path("upload", resource);
+
+    auto res = send_file_to_webserver(port, false, true);
+    LT_ASSERT_EQ(res.first, 0);
+    LT_ASSERT_EQ(res.second, 201);
+
+    ws->stop();
+
+    auto args = resource->get_args();
+    LT_CHECK_EQ(args.size(), 2);
+    auto arg = args.begin();
+    LT_CHECK_EQ(arg->first, TEST_KEY);
+    LT_CHECK_EQ(arg->second[0], TEST_CONTENT);
+    arg++;
+    LT_CHECK_EQ(arg->first, TEST_PARAM_KEY);
+    LT_CHECK_EQ(arg->second[0], TEST_PARAM_VALUE);
+
+    map<string, map<string, httpserver::http::file_info>> files = resource->get_files();
+    LT_CHECK_EQ(files.size(), 1);
+    auto file = files.begin()->second.begin();
+    LT_CHECK_EQ(file->first, TEST_CONTENT_FILENAME);
+    LT_CHECK_EQ(file->second.get_file_size(), TEST_CONTENT_SIZE);
+    LT_CHECK_EQ(file->second.get_content_type(), httpserver::http::http_utils::application_octet_stream);
+LT_END_AUTO_TEST(file_upload_native_form_parser)
+
+// Disk writes go through the background upload_writer. A 1-byte budget
+// forces every chunk through the suspend/resume backpressure path, and the
+// handler must still observe the complete file.
+LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_async_writes)
+    string upload_directory = ".";
+
+    auto ws = std::make_unique<webserver>(create_webserver(0)
+                       .async_upload_writes(1)
+                       .file_upload_target(httpserver::FILE_UPLOAD_DISK_ONLY)
+                       .file_upload_dir(upload_directory)
+                       .generate_random_filename_on_upload());
+    ws->start(false);
+    LT_CHECK_EQ(ws->is_running(), true);
+    const uint16_t port = ws->get_bound_port();
+
+    auto resource = std::make_shared<print_file_upload_resource>();
+    ws->register_path("upload", resource);
+
+    auto res = send_file_to_webserver(port, false, false);
+    LT_ASSERT_EQ(res.first, 0);
+    LT_ASSERT_EQ(res.second, 201);
+
+    ws->stop();
+
+    map<string, map<string, httpserver::http::file_info>> files = resource->get_files();
+    LT_CHECK_EQ(files.size(), 1);
+    auto file = files.begin()->second.begin();
+    LT_CHECK_EQ(file->first, TEST_CONTENT_FILENAME);
+    LT_CHECK_EQ(file->second.get_file_size(), TEST_CONTENT_SIZE);
+    LT_CHECK_EQ(file_exists(file->second.get_file_system_file_name()), false);
+LT_END_AUTO_TEST(file_upload_async_writes)
+
+// An upload that does not fit the process-wide memory budget is rejected
+// with 503 before the handler runs, and its reservation is returned once
+// the request completes.
+LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_memory_budget_exhausted)
+    auto ws = std::make_unique<webserver>(create_webserver(0)
+                       .upload_memory_budget(1)
+                       .file_upload_target(httpserver::FILE_UPLOAD_MEMORY_ONLY));
+    ws->start(false);
+    LT_CHECK_EQ(ws->is_running(), true);
+    const uint16_t port = ws->get_bound_port();
+
+    auto resource = std::make_shared<print_file_upload_resource>();
+    ws->register_path("upload", resource);
+
+    auto res = send_file_to_webserver(port, false, false);
+    LT_ASSERT_EQ(res.first, 0);
+    LT_CHECK_EQ(res.second, 503);
+    LT_CHECK_EQ(resource->get_files().size(), 0);
+
+    auto usage = ws->get_upload_usage();
+    LT_CHECK_EQ(usage.memory_bytes, 0);
+    LT_CHECK_EQ(usage.memory_limit, 1);
+    LT_CHECK_EQ(usage.disk_limit, 0);
+
+    ws->stop();
+LT_END_AUTO_TEST(file_upload_memory_budget_exhausted)
+
+// Same for the disk budget: 507 Insufficient Storage, nothing left held.
+LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_disk_budget_exhausted)
+    auto ws = std::make_unique<webserver>(create_webserver(0)
+                       .upload_disk_budget(1)
+                       .file_upload_target(httpserver::FILE_UPLOAD_DISK_ONLY)
+                       .file_upload_dir(".")
+                       .generate_random_filename_on_upload());
+    ws->start(false);
+    LT_CHECK_EQ(ws->is_running(), true);
+    const uint16_t port = ws->get_bound_port();
+
+    auto resource = std::make_shared<print_file_upload_resource>();
+    ws->register_path("upload", resource);
+
+    auto res = send_file_to_webserver(port, false, false);
+    LT_ASSERT_EQ(res.first, 0);
+    LT_CHECK_EQ(res.second, 507);
+
+    auto usage = ws->get_upload_usage();
+    LT_CHECK_EQ(usage.disk_bytes, 0);
+    LT_CHECK_EQ(usage.disk_limit, 1);
+
+    ws->stop();
+LT_END_AUTO_TEST(file_upload_disk_budget_exhausted)
+
+// FILE_UPLOAD_STREAM hands each file part to the resource as it is parsed
+// and stores nothing in the request; plain fields are still args.
+LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_stream_to_resource)
+    auto ws = std::make_unique<webserver>(create_webserver(0)
+                       .file_upload_target(httpserver::FILE_UPLOAD_STREAM));
+    ws->start(false);
+    LT_CHECK_EQ(ws->is_running(), true);
+    const uint16_t port = ws->get_bound_port();
+
+    auto resource = std::make_shared<streaming_upload_resource>();
+    ws->register_path("upload", resource);
+
+    auto res = send_file_to_webserver(port, true, true);
+    LT_ASSERT_EQ(res.first, 0);
+    LT_ASSERT_EQ(res.second, 201);
+
+    ws->stop();
+
+    LT_CHECK_EQ(resource->parts.size(), 2);
+    LT_CHECK_EQ(resource->parts[string(TEST_KEY) + "/" + TEST_CONTENT_FILENAME], TEST_CONTENT);
+    LT_CHECK_EQ(resource->parts[string(TEST_KEY_2) + "/" + TEST_CONTENT_FILENAME_2], TEST_CONTENT_2);
+    LT_CHECK_EQ(resource->finished_parts, 2);
+    LT_CHECK_EQ(resource->files_seen, 0);
+    LT_CHECK_EQ(resource->param, TEST_PARAM_VALUE);
+LT_END_AUTO_TEST(file_upload_stream_to_resource)
+
+// A resource that does not accept streamed uploads fails the request with
+// 500 before its handler runs.
+LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_stream_refused)
+    auto ws = std::make_unique<webserver>(create_webserver(0)
+                       .file_upload_target(httpserver::FILE_UPLOAD_STREAM));
+    ws->start(false);
+    LT_CHECK_EQ(ws->is_running(), true);
+    const uint16_t port = ws->get_bound_port();
+
+    auto resource = std::make_shared<print_file_upload_resource>();
+    ws->register_path("upload", resource);
+
+    auto res = send_file_to_webserver(port, false, false);
+    LT_ASSERT_EQ(res.first, 0);
+    LT_CHECK_EQ(res.second, 500);
+    LT_CHECK_EQ(resource->get_files().size(), 0);
+
+    ws->stop();
+LT_END_AUTO_TEST(file_upload_stream_refused)
+
 LT_BEGIN_AUTO_TEST(file_upload_suite, file_upload_memory_and_disk_two_files)
     string upload_directory = ".";
 
@@ -0,0 +1,190 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/body_decoder.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::body_decoder, the streaming Content-Encoding stage behind
+// create_webserver::decode_request_body. Bodies are compressed with zlib
+// in-process and fed whole and byte-by-byte; the sink records every
+// decoded window. Without HAVE_ZLIB only the coding classification is
+// checked.
+
+using httpserver::detail::body_decoder;
+
+namespace {
+
+constexpr std::size_t unlimited = std::numeric_limits<std::size_t>::max();
+
+struct collector {
+    std::string out;
+    std::size_t calls = 0;
+    std::size_t largest = 0;
+    std::size_t stop_after = 0;  // 0 = never stop
+
+    static bool sink(void* cls, const char* data, std::size_t size) {
+        auto* self = static_cast<collector*>(cls);
+        self->out.append(data, size);
+        ++self->calls;
+        if (size > self->largest) self->largest = size;
+        return self->stop_after == 0 || self->calls < self->stop_after;
+    }
+};
+
+std::unique_ptr<body_decoder> make(const char* coding, std::size_t limit = unlimited) {
+    std::unique_ptr<body_decoder> d;
+    body_decoder::create(coding, limit, &d);
+    return d;
+}
+
+#ifdef HAVE_ZLIB
+// window_bits: 16 + MAX_WBITS for gzip, MAX_WBITS for deflate (zlib).
+std::string compress(const std::string& in, int window_bits) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&zs, static_cast<uLong>(in.size())), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+std::string sample_text() {
+    std::string s;
+    for (int i = 0; i < 5000; ++i) s += "{\"id\":" + std::to_string(i) + ",\"v\":\"payload\"},";
+    return s;
+}
+#endif
+
+}  // namespace
+
+LT_BEGIN_SUITE(body_decoder_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(body_decoder_suite)
+
+LT_BEGIN_AUTO_TEST(body_decoder_suite, classifies_codings)
+    std::unique_ptr<body_decoder> d;
+    LT_CHECK_EQ(body_decoder::create(nullptr, unlimited, &d) == body_decoder::coding::identity, true);
+    LT_CHECK_EQ(body_decoder::create(" Identity ", unlimited, &d) == body_decoder::coding::identity, true);
+    LT_CHECK_EQ(body_decoder::create("br", unlimited, &d) == body_decoder::coding::unsupported, true);
+    LT_CHECK_EQ(body_decoder::create("gzip, gzip", unlimited, &d) == body_decoder::coding::unsupported, true);
+    LT_CHECK_EQ(d == nullptr, true);
+#ifdef HAVE_ZLIB
+    LT_CHECK_EQ(body_decoder::create("GZIP", unlimited, &d) == body_decoder::coding::supported, true);
+    LT_CHECK_EQ(body_decoder::create("x-gzip", unlimited, &d) == body_decoder::coding::supported, true);
+    LT_CHECK_EQ(body_decoder::create("deflate", unlimited, &d) == body_decoder::coding::supported, true);
+    LT_CHECK_EQ(d != nullptr, true);
+#else
+    LT_CHECK_EQ(body_decoder::create("gzip", unlimited, &d) == body_decoder::coding::unsupported, true);
+#endif
+LT_END_AUTO_TEST(classifies_codings)
+
+#ifdef HAVE_ZLIB
+LT_BEGIN_AUTO_TEST(body_decoder_suite, gzip_whole_body_in_bounded_windows)
+    const std::string text = sample_text();
+    const std::string wire = compress(text, 16 + MAX_WBITS);
+    collector c;
+    auto d = make("gzip");
+    LT_CHECK_EQ(d->feed(wire.data(), wire.size(), &collector::sink, &c) == body_decoder::status::ok, true);
+    LT_CHECK_EQ(d->finished(), true);
+    LT_CHECK_EQ(c.out == text, true);
+    LT_CHECK_EQ(c.largest <= body_decoder::window_bytes, true);
+    LT_CHECK_EQ(c.calls > 1, true);
+LT_END_AUTO_TEST(gzip_whole_body_in_bounded_windows)
+
+LT_BEGIN_AUTO_TEST(body_decoder_suite, deflate_byte_by_byte)
+    const std::string text = sample_text();
+    const std::string wire = compress(text, MAX_WBITS);
+    collector c;
+    auto d = make("deflate");
+    for (char b : wire) {
+        LT_ASSERT_EQ(d->feed(&b, 1, &collector::sink, &c) == body_decoder::status::ok, true);
+    }
+    LT_CHECK_EQ(d->finished(), true);
+    LT_CHECK_EQ(c.out == text, true);
+LT_END_AUTO_TEST(deflate_byte_by_byte)
+
+LT_BEGIN_AUTO_TEST(body_decoder_suite, concatenated_gzip_members)
+    const std::string wire = compress("hello ", 16 + MAX_WBITS) + compress("world", 16 + MAX_WBITS);
+    collector c;
+    auto d = make("gzip");
+    LT_CHECK_EQ(d->feed(wire.data(), wire.size(), &collector::sink, &c) == body_decoder::status::ok, true);
+    LT_CHECK_EQ(d->finished(), true);
+    LT_CHECK_EQ(c.out, std::string("hello world"));
+LT_END_AUTO_TEST(concatenated_gzip_members)
+
+LT_BEGIN_AUTO_TEST(body_decoder_suite, truncated_and_corrupt_streams)
+    const std::string wire = compress(sample_text(), 16 + MAX_WBITS);
+    collector c;
+    auto truncated = make("gzip");
+    LT_CHECK_EQ(truncated->feed(wire.data(), wire.size() / 2, &collector::sink, &c) == body_decoder::status::ok, true);
+    LT_CHECK_EQ(truncated->finished(), false);
+
+    auto corrupt = make("gzip");
+    const std::string garbage = "this is not gzip";
+    LT_CHECK_EQ(corrupt->feed(garbage.data(), garbage.size(), &collector::sink, &c) == body_decoder::status::corrupt, true);
+    LT_CHECK_EQ(corrupt->feed(wire.data(), wire.size(), &collector::sink, &c) == body_decoder::status::corrupt, true);
+
+    // deflate allows no second stream after the first.
+    const std::string twice = compress("a", MAX_WBITS) + compress("b", MAX_WBITS);
+    auto trailing = make("deflate");
+    LT_CHECK_EQ(trailing->feed(twice.data(), twice.size(), &collector::sink, &c) == body_decoder::status::corrupt, true);
+LT_END_AUTO_TEST(truncated_and_corrupt_streams)
+
+LT_BEGIN_AUTO_TEST(body_decoder_suite, decoded_limit_stops_zip_bomb)
+    const std::string bomb = compress(std::string(8 * 1024 * 1024, '\0'), 16 + MAX_WBITS);
+    collector c;
+    auto d = make("gzip", 64 * 1024);
+    LT_CHECK_EQ(d->feed(bomb.data(), bomb.size(), &collector::sink, &c) == body_decoder::status::too_large, true);
+    LT_CHECK_EQ(c.out.size() <= 64 * 1024, true);
+LT_END_AUTO_TEST(decoded_limit_stops_zip_bomb)
+
+LT_BEGIN_AUTO_TEST(body_decoder_suite, sink_can_stop_decoding)
+    const std::string wire = compress(sample_text(), 16 + MAX_WBITS);
+    collector c;
+    c.stop_after = 1;
+    auto d = make("gzip");
+    LT_CHECK_EQ(d->feed(wire.data(), wire.size(), &collector::sink, &c) == body_decoder::status::stopped, true);
+    LT_CHECK_EQ(c.calls, static_cast<std::size_t>(1));
+LT_END_AUTO_TEST(sink_can_stop_decoding)
+#endif
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
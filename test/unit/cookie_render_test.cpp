@@ -650,6 +650,50 @@ LT_BEGIN_AUTO_TEST(cookie_render_suite, same_site_none_with_explicit_secure_emit
     LT_CHECK_EQ(out, std::string("sid=x; Secure; SameSite=None"));
 LT_END_AUTO_TEST(same_site_none_with_explicit_secure_emits_single_secure_token)
 
+// ---------------- append_set_cookie_header / freeze ----------------
+
+LT_BEGIN_AUTO_TEST(cookie_render_suite, append_matches_to_set_cookie_header)
+    const cookie c = cookie{}.with_name("sid").with_value("abc")
+                         .with_path("/").with_http_only(true);
+    std::string out = "prefix|";
+    c.append_set_cookie_header(out);
+    LT_CHECK_EQ(out, "prefix|" + c.to_set_cookie_header());
+LT_END_AUTO_TEST(append_matches_to_set_cookie_header)
+
+LT_BEGIN_AUTO_TEST(cookie_render_suite, freeze_renders_once_and_copies_share_it)
+    cookie c = cookie{}.with_name("sid").with_value("abc")
+                   .with_max_age(60).with_secure(true).freeze();
+    LT_CHECK_EQ(c.is_frozen(), true);
+    LT_CHECK_EQ(c.to_set_cookie_header(), std::string("sid=abc; Max-Age=60; Secure"));
+    const cookie copy = c;
+    LT_CHECK_EQ(copy.is_frozen(), true);
+    std::string out;
+    copy.append_set_cookie_header(out);
+    LT_CHECK_EQ(out, std::string("sid=abc; Max-Age=60; Secure"));
+LT_END_AUTO_TEST(freeze_renders_once_and_copies_share_it)
+
+LT_BEGIN_AUTO_TEST(cookie_render_suite, setter_drops_frozen_rendering)
+    cookie c = cookie{}.with_name("sid").with_value("abc").freeze();
+    c.with_http_only(true);
+    LT_CHECK_EQ(c.is_frozen(), false);
+    LT_CHECK_EQ(c.to_set_cookie_header(), std::string("sid=abc; HttpOnly"));
+    c.freeze().with_value("xyz");
+    LT_CHECK_EQ(c.is_frozen(), false);
+    LT_CHECK_EQ(c.to_set_cookie_header(), std::string("sid=xyz; HttpOnly"));
+LT_END_AUTO_TEST(setter_drops_frozen_rendering)
+
+LT_BEGIN_AUTO_TEST(cookie_render_suite, freeze_without_name_throws)
+    bool threw = false;
+    cookie c;
+    try {
+        c.freeze();
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    LT_CHECK_EQ(threw, true);
+    LT_CHECK_EQ(c.is_frozen(), false);
+LT_END_AUTO_TEST(freeze_without_name_throws)
+
 LT_BEGIN_AUTO_TEST_ENV()
     AUTORUN_TESTS()
 LT_END_AUTO_TEST_ENV()
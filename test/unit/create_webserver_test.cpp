@@ -563,6 +563,15 @@ LT_BEGIN_AUTO_TEST(create_webserver_suite, listen_backlog_negative_throws)
         []{ create_webserver().listen_backlog(-1); }, "-1"));
 LT_END_AUTO_TEST(listen_backlog_negative_throws)
 
+LT_BEGIN_AUTO_TEST(create_webserver_suite, default_headers_rejects_bad_fields)
+    LT_CHECK(throws_invalid_argument_with(
+        []{ create_webserver().default_headers({{"", "x"}}); }, "default_headers"));
+    LT_CHECK(throws_invalid_argument_with(
+        []{ create_webserver().default_headers({{"X-A", "1\r\nX-B: 2"}}); },
+        "default_headers"));
+    LT_CHECK_NOTHROW(create_webserver().default_headers({{"Server", "test"}}));
+LT_END_AUTO_TEST(default_headers_rejects_bad_fields)
+
 LT_BEGIN_AUTO_TEST(create_webserver_suite, address_reuse_negative_throws)
     LT_CHECK(throws_invalid_argument_with(
         []{ create_webserver().address_reuse(-1); }, "address_reuse"));
@@ -0,0 +1,155 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <microhttpd.h>
+
+#include <string>
+
+#include "./httpserver.hpp"
+#include "httpserver/create_test_request.hpp"
+#include "httpserver/detail/connection_context.hpp"
+#include "httpserver/detail/error_pages.hpp"
+#include "httpserver/detail/response_body.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::error_pages: the default 404 / 405 / 500 pages are frozen
+// once and every call hands out the same MHD_Response, a default 405 is
+// frozen per allow mask with its Allow header, and user handlers still
+// run per call (the 405 one gaining the Allow header).
+
+using httpserver::body_kind;
+using httpserver::create_test_request;
+using httpserver::http_method;
+using httpserver::http_resource;
+using httpserver::http_response;
+using httpserver::webserver_config;
+using httpserver::detail::connection_context;
+using httpserver::detail::error_pages;
+
+namespace httpserver {
+
+// Same per-TU friend hook as http_response_sbo_test.cpp.
+struct http_response_sbo_test_access {
+    static detail::response_body* body_ptr(http_response& r) noexcept { return r.body_; }
+};
+
+}  // namespace httpserver
+
+namespace {
+
+using SBO = httpserver::http_response_sbo_test_access;
+
+// The frozen state behind a converted response.
+const httpserver::detail::frozen_response_state& frozen_state(http_response& r) {
+    return static_cast<httpserver::detail::frozen_response_body*>(SBO::body_ptr(r))->state();
+}
+
+class get_only : public http_resource {
+ public:
+    get_only() {
+        disallow_all();
+        set_allowing(http_method::get, true);
+    }
+};
+
+class any_method : public http_resource {
+};
+
+}  // namespace
+
+LT_BEGIN_SUITE(error_pages_suite)
+    webserver_config config;
+    httpserver::http_request req = create_test_request().build();
+    connection_context conn;
+
+    // req is suite-owned; detach it before conn would delete it.
+    void set_up() {
+        config = webserver_config{};
+        conn.request.reset(&req);
+    }
+
+    void tear_down() {
+        conn.request.release();
+    }
+LT_END_SUITE(error_pages_suite)
+
+LT_BEGIN_AUTO_TEST(error_pages_suite, default_pages_are_frozen_once)
+    error_pages pages(config);
+    http_response a = pages.not_found_page(&conn);
+    http_response b = pages.not_found_page(&conn);
+    LT_ASSERT_EQ(static_cast<int>(a.kind()), static_cast<int>(body_kind::frozen));
+    LT_CHECK_EQ(a.get_status(), 404);
+    LT_CHECK_EQ(frozen_state(a).mhd == frozen_state(b).mhd, true);
+
+    http_response e = pages.internal_error_page(&conn, "boom");
+    LT_ASSERT_EQ(static_cast<int>(e.kind()), static_cast<int>(body_kind::frozen));
+    LT_CHECK_EQ(e.get_status(), 500);
+    http_response f = pages.internal_error_page(&conn, "", /*force_our=*/true);
+    LT_ASSERT_EQ(static_cast<int>(f.kind()), static_cast<int>(body_kind::frozen));
+    LT_CHECK_EQ(f.get_status(), 500);
+    LT_CHECK_EQ(frozen_state(e).mhd == frozen_state(f).mhd, false);
+LT_END_AUTO_TEST(default_pages_are_frozen_once)
+
+LT_BEGIN_AUTO_TEST(error_pages_suite, method_not_allowed_is_frozen_per_allow_mask)
+    error_pages pages(config);
+    get_only get;
+    any_method all;
+    http_response a = pages.method_not_allowed_page(&conn, get);
+    http_response b = pages.method_not_allowed_page(&conn, get);
+    http_response c = pages.method_not_allowed_page(&conn, all);
+    LT_ASSERT_EQ(static_cast<int>(a.kind()), static_cast<int>(body_kind::frozen));
+    LT_CHECK_EQ(a.get_status(), 405);
+    LT_CHECK_EQ(frozen_state(a).mhd == frozen_state(b).mhd, true);
+    LT_CHECK_EQ(frozen_state(a).mhd == frozen_state(c).mhd, false);
+    LT_CHECK_EQ(std::string(frozen_state(a).source.get_headers().at("Allow")), "GET");
+    // Nothing was added after conversion, so the shared response is queued.
+    LT_CHECK_EQ(a.get_headers().empty(), true);
+LT_END_AUTO_TEST(method_not_allowed_is_frozen_per_allow_mask)
+
+LT_BEGIN_AUTO_TEST(error_pages_suite, user_handlers_run_per_call)
+    int calls = 0;
+    config.not_found_handler = [&calls](const httpserver::http_request&) {
+        ++calls;
+        return http_response::string("custom").with_status(404);
+    };
+    config.method_not_allowed_handler = [](const httpserver::http_request&) {
+        return http_response::string("nope").with_status(405);
+    };
+    config.expose_exception_messages = true;
+    error_pages pages(config);
+    http_response a = pages.not_found_page(&conn);
+    pages.not_found_page(&conn);
+    LT_CHECK_EQ(calls, 2);
+    LT_CHECK_EQ(static_cast<int>(a.kind()), static_cast<int>(body_kind::string));
+
+    get_only get;
+    http_response m = pages.method_not_allowed_page(&conn, get);
+    LT_CHECK_EQ(static_cast<int>(m.kind()), static_cast<int>(body_kind::string));
+    LT_CHECK_EQ(std::string(m.get_headers().at("Allow")), "GET");
+
+    // expose_exception_messages keeps the 500 body per call.
+    http_response e = pages.internal_error_page(&conn, "boom");
+    LT_CHECK_EQ(static_cast<int>(e.kind()), static_cast<int>(body_kind::string));
+LT_END_AUTO_TEST(user_handlers_run_per_call)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
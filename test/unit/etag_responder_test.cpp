@@ -0,0 +1,166 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./httpserver.hpp"
+#include "httpserver/create_test_request.hpp"
+#include "httpserver/detail/etag_responder.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::etag_responder, the create_webserver::generate_etags
+// stage: the XXH64 body hash against published test vectors, ETags that
+// depend on content only (string, iovec and shared bodies agree), 304
+// from If-None-Match (also for frozen responses), and the status /
+// method / body-kind filters.
+
+using httpserver::body_kind;
+using httpserver::create_test_request;
+using httpserver::http_response;
+using httpserver::iovec_entry;
+using httpserver::webserver_config;
+using httpserver::detail::etag_responder;
+
+namespace {
+
+// Longer than one 32-byte stripe, so both hash paths run.
+std::string payload() {
+    std::string s;
+    for (int i = 0; i < 1000; ++i) s.push_back(static_cast<char>(i * 31 + 7));
+    return s;
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(etag_responder_suite)
+    webserver_config config;
+
+    http_response serve(create_test_request req, http_response r) {
+        etag_responder etags(config);
+        etags.apply(req.build(), r);
+        return r;
+    }
+
+    void set_up() {
+        config = webserver_config{};
+        config.generate_etags = true;
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(etag_responder_suite)
+
+LT_BEGIN_AUTO_TEST(etag_responder_suite, hashes_with_xxh64)
+    auto etag = [](std::string s) {
+        return *etag_responder::body_etag(http_response::string(std::move(s)));
+    };
+    LT_CHECK_EQ(etag(""), "\"ef46db3751d8e999\"");
+    LT_CHECK_EQ(etag("a"), "\"d24ec4f1a98c6e5b\"");
+    LT_CHECK_EQ(etag("abc"), "\"44bc2cf5ad770999\"");
+    LT_CHECK_EQ(etag(payload()), "\"99594f4828043d35\"");
+    LT_CHECK_EQ(etag_responder::body_etag(http_response::empty()).has_value(), false);
+LT_END_AUTO_TEST(hashes_with_xxh64)
+
+LT_BEGIN_AUTO_TEST(etag_responder_suite, etag_depends_on_content_only)
+    const std::string body = payload();
+    const std::string expected = *etag_responder::body_etag(http_response::string(body));
+
+    // Segment boundaries inside and across stripes.
+    for (std::size_t cut : {1u, 7u, 31u, 32u, 33u, 500u}) {
+        const iovec_entry entries[] = {
+            {body.data(), cut},
+            {body.data() + cut, 0},
+            {body.data() + cut, body.size() - cut},
+        };
+        LT_CHECK_EQ(*etag_responder::body_etag(http_response::iovec(entries)), expected);
+    }
+    auto owned = std::make_shared<const std::string>(body);
+    LT_CHECK_EQ(*etag_responder::body_etag(http_response::shared(owned)), expected);
+    LT_CHECK_EQ(*etag_responder::body_etag(http_response::string(body + "!")) == expected, false);
+LT_END_AUTO_TEST(etag_depends_on_content_only)
+
+LT_BEGIN_AUTO_TEST(etag_responder_suite, adds_etag_and_answers_304)
+    http_response first = serve(create_test_request(), http_response::string("{\"n\":1}"));
+    const std::string etag(first.get_header("ETag"));
+    LT_CHECK_EQ(etag, *etag_responder::body_etag(http_response::string("{\"n\":1}")));
+    LT_CHECK_EQ(first.get_status(), 200);
+
+    http_response same = serve(create_test_request().header("If-None-Match", "\"x\", " + etag),
+                               http_response::string("{\"n\":1}"));
+    LT_CHECK_EQ(same.get_status(), 304);
+    LT_CHECK_EQ(same.kind() == body_kind::empty, true);
+    LT_CHECK_EQ(same.get_header("ETag"), etag);
+    LT_CHECK_EQ(serve(create_test_request().method("HEAD").header("If-None-Match", "W/" + etag),
+                      http_response::string("{\"n\":1}")).get_status(), 304);
+    LT_CHECK_EQ(serve(create_test_request().header("If-None-Match", "*"),
+                      http_response::string("{}")).get_status(), 304);
+
+    http_response changed = serve(create_test_request().header("If-None-Match", etag),
+                                  http_response::string("{\"n\":2}"));
+    LT_CHECK_EQ(changed.get_status(), 200);
+    LT_CHECK_EQ(changed.kind() == body_kind::string, true);
+LT_END_AUTO_TEST(adds_etag_and_answers_304)
+
+LT_BEGIN_AUTO_TEST(etag_responder_suite, keeps_handler_etag)
+    http_response own = serve(create_test_request().header("If-None-Match", "\"v7\""),
+                              http_response::string("body").with_header("ETag", "\"v7\""));
+    LT_CHECK_EQ(own.get_header("ETag"), "\"v7\"");
+    LT_CHECK_EQ(own.get_status(), 304);
+LT_END_AUTO_TEST(keeps_handler_etag)
+
+// A frozen response (a response_cache hit) is not hashed again; its own
+// ETag answers If-None-Match with a 304 carrying the validator fields.
+LT_BEGIN_AUTO_TEST(etag_responder_suite, answers_frozen_with_its_etag)
+    const httpserver::frozen_response frozen = http_response::string("cached")
+        .with_header("ETag", "W/\"c1\"").with_header("Cache-Control", "max-age=60")
+        .with_header("Content-Type", "text/plain").freeze();
+    http_response hit = serve(create_test_request().header("If-None-Match", "\"c1\""), frozen);
+    LT_CHECK_EQ(hit.get_status(), 304);
+    LT_CHECK_EQ(hit.kind() == body_kind::empty, true);
+    LT_CHECK_EQ(hit.get_header("ETag"), "W/\"c1\"");
+    LT_CHECK_EQ(hit.get_header("Cache-Control"), "max-age=60");
+    LT_CHECK_EQ(hit.get_header("Content-Type"), "");
+
+    http_response other = serve(create_test_request().header("If-None-Match", "\"c2\""), frozen);
+    LT_CHECK_EQ(other.kind() == body_kind::frozen, true);
+    LT_CHECK_EQ(serve(create_test_request(), frozen).kind() == body_kind::frozen, true);
+LT_END_AUTO_TEST(answers_frozen_with_its_etag)
+
+LT_BEGIN_AUTO_TEST(etag_responder_suite, filters)
+    const auto req = [] { return create_test_request().header("If-None-Match", "*"); };
+    LT_CHECK_EQ(serve(req().method("POST"), http_response::string("x")).get_header("ETag"), "");
+    http_response missing = serve(req(), http_response::string("x").with_status(404));
+    LT_CHECK_EQ(missing.get_status(), 404);
+    LT_CHECK_EQ(missing.get_header("ETag"), "");
+    LT_CHECK_EQ(serve(req(), http_response::empty()).get_status(), 200);
+
+    config.generate_etags = false;
+    http_response off = serve(req(), http_response::string("x"));
+    LT_CHECK_EQ(off.get_status(), 200);
+    LT_CHECK_EQ(off.get_header("ETag"), "");
+LT_END_AUTO_TEST(filters)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
@@ -0,0 +1,206 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <microhttpd.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/file_descriptor_cache.hpp"
+#include "httpserver/detail/response_body.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::file_descriptor_cache (create_webserver::
+// file_descriptor_cache) and the deferred open of http_response::file
+// bodies it is consulted from: dup'd descriptors on a hit, the entry bound
+// and TTL, uncached failures, and descriptors that outlive their entry.
+
+using httpserver::http_response;
+using httpserver::detail::file_descriptor_cache;
+using httpserver::detail::file_response_body;
+using std::chrono::hours;
+
+namespace httpserver {
+
+// Same per-TU friend hook as http_response_sbo_test.cpp: reaches the file
+// body behind a factory-built response.
+struct http_response_sbo_test_access {
+    static detail::response_body* body_ptr(http_response& r) noexcept { return r.body_; }
+};
+
+}  // namespace httpserver
+
+namespace {
+
+using SBO = httpserver::http_response_sbo_test_access;
+
+struct temp_file {
+    explicit temp_file(const std::string& content) {
+        char tmpl[] = "/tmp/file_descriptor_cache_testXXXXXX";
+        const int fd = ::mkstemp(tmpl);
+        (void) !::write(fd, content.data(), content.size());
+        ::close(fd);
+        path = tmpl;
+    }
+    ~temp_file() { ::unlink(path.c_str()); }
+    temp_file(const temp_file&) = delete;
+    temp_file& operator=(const temp_file&) = delete;
+
+    std::string path;
+};
+
+bool same_file(int a, int b) {
+    struct stat sa, sb;
+    return ::fstat(a, &sa) == 0 && ::fstat(b, &sb) == 0
+        && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+}
+
+// Renames a new file with @p content over @p path.
+void replace(const std::string& path, const std::string& content) {
+    temp_file next(content);
+    ::rename(next.path.c_str(), path.c_str());
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(file_descriptor_cache_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(file_descriptor_cache_suite)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, hit_hands_out_a_dup)
+    temp_file f("hello world");
+    file_descriptor_cache cache(4, hours(1));
+    std::size_t first_size = 0, second_size = 0;
+    const int first = cache.open(f.path, &first_size);
+    const int second = cache.open(f.path, &second_size);
+    LT_ASSERT_NEQ(first, -1);
+    LT_ASSERT_NEQ(second, -1);
+    LT_CHECK_NEQ(first, second);
+    LT_CHECK_EQ(same_file(first, second), true);
+    LT_CHECK_EQ(first_size, 11u);
+    LT_CHECK_EQ(second_size, 11u);
+    LT_CHECK_EQ(cache.entries(), 1u);
+    ::close(first);
+    ::close(second);
+LT_END_AUTO_TEST(hit_hands_out_a_dup)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, handed_out_fd_outlives_the_cache)
+    temp_file f("abc");
+    int fd = -1;
+    {
+        file_descriptor_cache cache(1, hours(1));
+        std::size_t size = 0;
+        fd = cache.open(f.path, &size);
+        temp_file other("defg");
+        // Evicts f's entry, closing the cache's own descriptor.
+        const int other_fd = cache.open(other.path, &size);
+        ::close(other_fd);
+        LT_CHECK_EQ(cache.entries(), 1u);
+    }
+    char buf[3];
+    LT_CHECK_EQ(::pread(fd, buf, sizeof(buf), 0), 3);
+    LT_CHECK_EQ(std::string(buf, 3), "abc");
+    ::close(fd);
+LT_END_AUTO_TEST(handed_out_fd_outlives_the_cache)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, bounded_by_entries)
+    temp_file a("a"), b("bb"), c("ccc");
+    file_descriptor_cache cache(2, hours(1));
+    std::size_t size = 0;
+    for (const temp_file* f : {&a, &b, &a, &c}) ::close(cache.open(f->path, &size));
+    LT_CHECK_EQ(cache.entries(), 2u);
+    // a was promoted by its second open, so b was the one evicted: a
+    // replaced a is still served from the old inode, a replaced b is not.
+    replace(a.path, "AAAA");
+    replace(b.path, "BBBBB");
+    ::close(cache.open(a.path, &size));
+    LT_CHECK_EQ(size, 1u);
+    ::close(cache.open(b.path, &size));
+    LT_CHECK_EQ(size, 5u);
+LT_END_AUTO_TEST(bounded_by_entries)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, expired_entries_reopen_the_path)
+    temp_file f("old");
+    file_descriptor_cache cache(4, std::chrono::milliseconds(0));
+    std::size_t size = 0;
+    ::close(cache.open(f.path, &size));
+    replace(f.path, "newer");
+    ::close(cache.open(f.path, &size));
+    LT_CHECK_EQ(size, 5u);
+    LT_CHECK_EQ(cache.entries(), 1u);
+LT_END_AUTO_TEST(expired_entries_reopen_the_path)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, failures_are_not_cached)
+    file_descriptor_cache cache(4, hours(1));
+    std::size_t size = 42;
+    LT_CHECK_EQ(cache.open("/no/such/path/should/exist", &size), -1);
+    LT_CHECK_EQ(cache.open("/tmp", &size), -1);
+    LT_CHECK_EQ(size, 42u);
+    LT_CHECK_EQ(cache.entries(), 0u);
+LT_END_AUTO_TEST(failures_are_not_cached)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, disabled_cache_keeps_nothing)
+    temp_file f("abc");
+    file_descriptor_cache cache(0, hours(1));
+    std::size_t size = 0;
+    const int fd = cache.open(f.path, &size);
+    LT_CHECK_NEQ(fd, -1);
+    LT_CHECK_EQ(size, 3u);
+    LT_CHECK_EQ(cache.entries(), 0u);
+    ::close(fd);
+LT_END_AUTO_TEST(disabled_cache_keeps_nothing)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, factory_defers_the_open)
+    temp_file f("deferred");
+    file_descriptor_cache cache(4, hours(1));
+    http_response r = http_response::file(f.path);
+    auto* body = static_cast<file_response_body*>(SBO::body_ptr(r));
+    LT_CHECK_EQ(body->fd(), -1);
+    LT_CHECK_EQ(body->size(), 0u);
+    const int fd = body->ensure_open(&cache);
+    LT_CHECK_NEQ(fd, -1);
+    LT_CHECK_EQ(body->size(), 8u);
+    LT_CHECK_EQ(cache.entries(), 1u);
+    // Later consumers see the same descriptor.
+    LT_CHECK_EQ(body->ensure_open(), fd);
+LT_END_AUTO_TEST(factory_defers_the_open)
+
+LT_BEGIN_AUTO_TEST(file_descriptor_cache_suite, deferred_open_of_missing_path)
+    http_response r = http_response::file("/no/such/path/should/exist");
+    auto* body = static_cast<file_response_body*>(SBO::body_ptr(r));
+    LT_CHECK_EQ(body->ensure_open(), -1);
+    LT_CHECK_EQ(body->size(), 0u);
+    LT_CHECK_EQ(body->materialize(), static_cast<MHD_Response*>(nullptr));
+LT_END_AUTO_TEST(deferred_open_of_missing_path)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
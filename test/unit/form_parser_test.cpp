@@ -0,0 +1,236 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/form_parser.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::form_parser, the native alternative to MHD_PostProcessor
+// (create_webserver::native_form_parser). The parser is driven directly
+// with a recording iterator of the MHD_PostDataIterator shape, so no
+// daemon is needed. Each multipart case is replayed at every two-chunk
+// split point and byte-by-byte: a boundary straddling chunks is the
+// parser's hardest path.
+
+using httpserver::detail::form_parser;
+
+namespace {
+
+struct recorded_field {
+    std::string value;
+    std::string filename;
+    std::string content_type;
+    bool has_filename = false;
+    int calls = 0;
+    bool offsets_contiguous = true;
+};
+
+struct recorder {
+    std::map<std::string, recorded_field> fields;
+    std::vector<const char*> data_ptrs;
+    int refuse_after = -1;
+    int total_calls = 0;
+
+    static MHD_Result iterate(void* cls, MHD_ValueKind, const char* key,
+                              const char* filename, const char* content_type,
+                              const char*, const char* data, uint64_t off,
+                              size_t size) {
+        auto* self = static_cast<recorder*>(cls);
+        auto& f = self->fields[key];
+        if (off != f.value.size()) f.offsets_contiguous = false;
+        f.value.append(data, size);
+        f.has_filename = (filename != nullptr);
+        if (filename != nullptr) f.filename = filename;
+        if (content_type != nullptr) f.content_type = content_type;
+        ++f.calls;
+        if (size > 0) self->data_ptrs.push_back(data);
+        ++self->total_calls;
+        if (self->refuse_after >= 0 && self->total_calls > self->refuse_after) {
+            return MHD_NO;
+        }
+        return MHD_YES;
+    }
+};
+
+const char multipart_type[] = "multipart/form-data; boundary=XyZ";
+
+// Values deliberately contain CR, LF, "--" and a near-miss "\r\n--Xy"
+// so the scanner has to reject partial delimiter matches.
+const std::string multipart_body =
+    "preamble to ignore\r\n"
+    "--XyZ\r\n"
+    "Content-Disposition: form-data; name=\"alpha\"\r\n"
+    "\r\n"
+    "one\r\n--Xy two\r\n"
+    "--XyZ\r\n"
+    "Content-Disposition: form-data; name=\"empty\"\r\n"
+    "\r\n"
+    "\r\n"
+    "--XyZ\r\n"
+    "content-disposition: form-data; name=\"upload\"; filename=\"a;b.txt\"\r\n"
+    "Content-Type: text/plain\r\n"
+    "\r\n"
+    "file\r\nbytes--\r\r\n"
+    "--XyZ--\r\n"
+    "epilogue";
+
+// One line per field: key, filename (or "-"), content type, value, and
+// whether the off arguments were contiguous. LT_* macros only work inside
+// a test body, so the multipart cases compare this rendering instead.
+std::string dump(const recorder& r) {
+    std::string out;
+    for (const auto& [key, f] : r.fields) {
+        out += key + "|" + (f.has_filename ? f.filename : "-") + "|"
+            + f.content_type + "|" + f.value + "|"
+            + (f.offsets_contiguous ? "ok" : "gap") + "\n";
+    }
+    return out;
+}
+
+const std::string multipart_expected =
+    "alpha|-||one\r\n--Xy two|ok\n"
+    "empty|-|||ok\n"
+    "upload|a;b.txt|text/plain|file\r\nbytes--\r|ok\n";
+
+std::unique_ptr<form_parser> make(const char* type, recorder* r) {
+    return form_parser::create(type, &recorder::iterate, r);
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(form_parser_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(form_parser_suite)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, rejects_non_form_and_boundaryless_types)
+    recorder r;
+    LT_CHECK_EQ(make(nullptr, &r) == nullptr, true);
+    LT_CHECK_EQ(make("text/plain", &r) == nullptr, true);
+    LT_CHECK_EQ(make("multipart/form-data", &r) == nullptr, true);
+    LT_CHECK_EQ(make("multipart/form-data; boundary=\"\"", &r) == nullptr, true);
+    LT_CHECK_EQ(make("Multipart/Form-Data; Boundary=\"q\"", &r) != nullptr, true);
+    LT_CHECK_EQ(make("application/x-www-form-urlencoded; charset=utf-8", &r) != nullptr, true);
+LT_END_AUTO_TEST(rejects_non_form_and_boundaryless_types)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, urlencoded_whole_body)
+    recorder r;
+    auto p = make("application/x-www-form-urlencoded", &r);
+    const std::string body = "a=1&b=x+y&c&d=%2F&e=";
+    LT_ASSERT_EQ(p->feed(body.data(), body.size()), true);
+    LT_ASSERT_EQ(p->finish(), true);
+    LT_CHECK_EQ(r.fields.size(), static_cast<size_t>(5));
+    LT_CHECK_EQ(r.fields["a"].value, std::string("1"));
+    LT_CHECK_EQ(r.fields["b"].value, std::string("x y"));
+    LT_CHECK_EQ(r.fields["c"].value, std::string(""));
+    // '%XX' stays raw, as MHD delivers it behind libhttpserver's no-op unescaper.
+    LT_CHECK_EQ(r.fields["d"].value, std::string("%2F"));
+    LT_CHECK_EQ(r.fields["e"].value, std::string(""));
+    LT_CHECK_EQ(r.fields["e"].calls, 1);
+LT_END_AUTO_TEST(urlencoded_whole_body)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, urlencoded_byte_by_byte)
+    recorder r;
+    auto p = make("application/x-www-form-urlencoded", &r);
+    const std::string body = "first+key=hello+world&second=abc&last";
+    for (char c : body) LT_ASSERT_EQ(p->feed(&c, 1), true);
+    LT_ASSERT_EQ(p->finish(), true);
+    LT_CHECK_EQ(r.fields["first key"].value, std::string("hello world"));
+    LT_CHECK_EQ(r.fields["first key"].offsets_contiguous, true);
+    LT_CHECK_EQ(r.fields["second"].value, std::string("abc"));
+    LT_CHECK_EQ(r.fields["last"].value, std::string(""));
+LT_END_AUTO_TEST(urlencoded_byte_by_byte)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, multipart_whole_body_is_zero_copy)
+    recorder r;
+    auto p = make(multipart_type, &r);
+    LT_ASSERT_EQ(p->feed(multipart_body.data(), multipart_body.size()), true);
+    LT_ASSERT_EQ(p->finish(), true);
+    LT_CHECK_EQ(dump(r), multipart_expected);
+    // Every non-empty value was handed out as a view into the input.
+    const char* lo = multipart_body.data();
+    const char* hi = lo + multipart_body.size();
+    for (const char* d : r.data_ptrs) {
+        LT_CHECK_EQ(d >= lo && d < hi, true);
+    }
+LT_END_AUTO_TEST(multipart_whole_body_is_zero_copy)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, multipart_every_split_point)
+    for (size_t cut = 0; cut <= multipart_body.size(); ++cut) {
+        recorder r;
+        auto p = make(multipart_type, &r);
+        LT_ASSERT_EQ(p->feed(multipart_body.data(), cut), true);
+        LT_ASSERT_EQ(p->feed(multipart_body.data() + cut,
+                             multipart_body.size() - cut), true);
+        LT_ASSERT_EQ(p->finish(), true);
+        LT_CHECK_EQ(dump(r), multipart_expected);
+    }
+LT_END_AUTO_TEST(multipart_every_split_point)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, multipart_byte_by_byte)
+    recorder r;
+    auto p = make(multipart_type, &r);
+    for (char c : multipart_body) LT_ASSERT_EQ(p->feed(&c, 1), true);
+    LT_ASSERT_EQ(p->finish(), true);
+    LT_CHECK_EQ(dump(r), multipart_expected);
+LT_END_AUTO_TEST(multipart_byte_by_byte)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, iterator_refusal_stops_parsing)
+    recorder r;
+    r.refuse_after = 1;
+    auto p = make("application/x-www-form-urlencoded", &r);
+    const std::string body = "a=1&b=2&c=3";
+    LT_CHECK_EQ(p->feed(body.data(), body.size()), false);
+    LT_CHECK_EQ(r.total_calls, 2);
+    LT_CHECK_EQ(p->feed(body.data(), body.size()), false);
+    LT_CHECK_EQ(p->finish(), false);
+    LT_CHECK_EQ(r.total_calls, 2);
+LT_END_AUTO_TEST(iterator_refusal_stops_parsing)
+
+LT_BEGIN_AUTO_TEST(form_parser_suite, malformed_and_oversized_input_fails)
+    recorder r;
+    auto bad_delim = make(multipart_type, &r);
+    const std::string garbage = "--XyZ!\r\n";
+    LT_CHECK_EQ(bad_delim->feed(garbage.data(), garbage.size()), false);
+
+    auto huge_headers = make(multipart_type, &r);
+    std::string body = "--XyZ\r\nX-Filler: ";
+    body.append(form_parser::max_buffered_bytes, 'h');
+    LT_CHECK_EQ(huge_headers->feed(body.data(), body.size()), false);
+
+    auto huge_key = make("application/x-www-form-urlencoded", &r);
+    const std::string key(form_parser::max_buffered_bytes + 1, 'k');
+    LT_CHECK_EQ(huge_key->feed(key.data(), key.size()), false);
+LT_END_AUTO_TEST(malformed_and_oversized_input_fails)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
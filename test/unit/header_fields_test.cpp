@@ -0,0 +1,155 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "./httpserver.hpp"
+
+#include "./littletest.hpp"
+
+// Pins http::basic_header_fields, the store behind
+// http_response::get_headers() / get_footers(): map-like lookup and
+// ordering, NUL-terminated views, view stability across inserts, spills
+// and moves, borrowed static_text, and moves that leave the source empty.
+
+using httpserver::http::basic_header_fields;
+using httpserver::http::static_text;
+using namespace std::string_view_literals;
+
+using small_fields = basic_header_fields<2, 16>;
+
+LT_BEGIN_SUITE(header_fields_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(header_fields_suite)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, lookup_is_case_insensitive)
+    small_fields f;
+    f.insert_or_assign("Content-Type", "text/plain");
+    LT_CHECK_EQ(f.size(), 1u);
+    LT_CHECK_EQ(f.at("content-type"), "text/plain");
+    LT_CHECK_EQ(f.count("CONTENT-TYPE"), 1u);
+    LT_CHECK_EQ(f.contains("X-Missing"), false);
+    LT_CHECK_THROW((void)f.at("X-Missing"));
+
+    // Same name, different case: replaced, original spelling kept.
+    f.insert_or_assign("content-type", "text/html");
+    LT_CHECK_EQ(f.size(), 1u);
+    LT_CHECK_EQ(f.begin()->first, "Content-Type");
+    LT_CHECK_EQ(f.begin()->second, "text/html");
+LT_END_AUTO_TEST(lookup_is_case_insensitive)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, iterates_in_header_map_order)
+    httpserver::http::header_fields f;
+    httpserver::http::header_map m;
+    for (const char* name : {"X-Long-Name", "B", "a", "Etag", "C"}) {
+        f.insert_or_assign(name, "v");
+        m.insert_or_assign(name, "v");
+    }
+    std::vector<std::string> got, want;
+    for (const auto& [name, value] : f) got.emplace_back(name);
+    for (const auto& [name, value] : m) want.push_back(name);
+    LT_CHECK_EQ(got == want, true);
+LT_END_AUTO_TEST(iterates_in_header_map_order)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, views_survive_inserts_and_spill)
+    small_fields f;
+    f.insert_or_assign("A", "alpha");
+    const std::string_view a = f.at("A");
+    // Overflows both the two inline entries and the 16-byte first chunk.
+    f.insert_or_assign("B", "a value longer than the first chunk");
+    f.insert_or_assign("C", "gamma");
+    f.insert_or_assign("D", "delta");
+    LT_CHECK_EQ(f.size(), 4u);
+    LT_CHECK_EQ(a, "alpha");
+    LT_CHECK_EQ(f.at("B"), "a value longer than the first chunk");
+    for (const auto& [name, value] : f) {
+        LT_CHECK_EQ(name.data()[name.size()], '\0');
+        LT_CHECK_EQ(value.data()[value.size()], '\0');
+    }
+LT_END_AUTO_TEST(views_survive_inserts_and_spill)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, static_text_is_borrowed)
+    static constexpr std::string_view name = "Cache-Control";
+    small_fields f;
+    f.insert_or_assign(static_text(name), static_text("no-store"sv));
+    LT_CHECK_EQ(f.begin()->first.data() == name.data(), true);
+    LT_CHECK_EQ(f.at("cache-control"), "no-store");
+
+    small_fields moved(std::move(f));
+    LT_CHECK_EQ(moved.begin()->first.data() == name.data(), true);
+LT_END_AUTO_TEST(static_text_is_borrowed)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, reassignment_reuses_text)
+    small_fields f;
+    f.insert_or_assign("K", "0123456789");
+    for (int i = 0; i < 1000; ++i) f.insert_or_assign("K", std::to_string(i));
+    LT_CHECK_EQ(f.at("K"), "999");
+    // Still room for another short field in the chunk: no text was leaked.
+    f.insert_or_assign("L", "x");
+    LT_CHECK_EQ(f.at("L"), "x");
+LT_END_AUTO_TEST(reassignment_reuses_text)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, move_and_copy)
+    small_fields f;
+    f.insert_or_assign("A", "1");
+    f.insert_or_assign("B", "2");
+
+    small_fields copy(f);
+    small_fields moved(std::move(f));
+    LT_CHECK_EQ(f.empty(), true);
+    LT_CHECK_EQ(moved.at("A"), "1");
+    LT_CHECK_EQ(moved.at("B"), "2");
+    LT_CHECK_EQ(copy.at("B"), "2");
+    // The copy owns its text; a move keeps the source's text in place.
+    LT_CHECK_EQ(moved.at("A").data() != copy.at("A").data(), true);
+    const std::string_view b = moved.at("B");
+    small_fields again(std::move(moved));
+    LT_CHECK_EQ(again.at("B").data() == b.data(), true);
+
+    f = copy;
+    f.insert_or_assign("C", "3");
+    LT_CHECK_EQ(f.size(), 3u);
+    LT_CHECK_EQ(copy.size(), 2u);
+LT_END_AUTO_TEST(move_and_copy)
+
+LT_BEGIN_AUTO_TEST(header_fields_suite, out_of_line_fields)
+    // No inline entries, as for footers: every field lives on the heap.
+    basic_header_fields<0, 16> f;
+    f.insert_or_assign("Trailer-B", "2");
+    f.insert_or_assign("Trailer-A", "1");
+    LT_CHECK_EQ(f.size(), 2u);
+    LT_CHECK_EQ(f.begin()->first, "Trailer-A");
+    LT_CHECK_EQ(f.at("trailer-b"), "2");
+    f.clear();
+    LT_CHECK_EQ(f.empty(), true);
+LT_END_AUTO_TEST(out_of_line_fields)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
@@ -27,12 +27,13 @@
 //     mirrors into BOTH the legacy map AND the structured vector;
 //   * the wire-render path -- which now reads structured_cookies_ via
 //     get_cookies_parsed() -- produces exactly one Set-Cookie header
-//     per structured entry, via cookie::to_set_cookie_header();
+//     per structured entry, rendered as cookie::to_set_cookie_header()
+//     renders it;
 //   * mixing both paths does NOT double-emit on the wire.
 //
 // Wire emission is asserted by walking the structured cookie vector and
-// invoking the renderer the dispatch path uses
-// (cookie::to_set_cookie_header). This is the only structured-cookie
+// invoking the renderer (cookie::to_set_cookie_header; the dispatch path
+// calls append_set_cookie_header, which produces the same bytes). This is the only structured-cookie
 // contract the dispatch path is allowed to depend on -- the actual
 // MHD_add_response_header invocation in decorate_mhd_response is a
 // trivial loop and is covered by the integration test
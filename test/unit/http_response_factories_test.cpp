@@ -51,6 +51,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -143,7 +144,7 @@ LT_BEGIN_AUTO_TEST(http_response_factories_suite,
 LT_END_AUTO_TEST(string_factory_overridden_content_type)
 
 // -----------------------------------------------------------------------
-// file() — opens at construction, missing path doesn't throw.
+// file() — opens when queued, missing path doesn't throw.
 // -----------------------------------------------------------------------
 LT_BEGIN_AUTO_TEST(http_response_factories_suite, file_factory_existing)
     // test_content lives in test/ — same fixture response_body_test uses.
@@ -227,20 +228,45 @@ LT_BEGIN_AUTO_TEST(http_response_factories_suite, iovec_factory_single_entry)
     LT_CHECK_EQ(SBO::body_inline(r), true);
 LT_END_AUTO_TEST(iovec_factory_single_entry)
 
-// Pin: pipe() must accept exactly one argument (the fd). Any future
-// reintroduction of a size_hint / chunk_size / Content-Length parameter
-// is a deliberate API change and must update this assertion.
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, iovec_segments_own_their_bytes)
+    // Owned segments: a shared fragment, a per-request string taken over
+    // by the response, and static bytes. The response keeps the owners
+    // alive after the caller dropped its references.
+    static const char crlf[] = "\r\n";
+    auto fragment = std::make_shared<const std::string>("<header>");
+    std::weak_ptr<const std::string> watch = fragment;
+    auto r = http_response::iovec({fragment, std::string("per-request body"), {crlf, 2}});
+    fragment.reset();
+    LT_CHECK_EQ(watch.expired(), false);
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::iovec));
+    LT_CHECK_EQ(r.get_status(), 200);
+    LT_CHECK_EQ(SBO::body_ptr(r)->size(), 8u + 16u + 2u);
+    LT_CHECK_EQ(SBO::body_inline(r), true);
+
+    // Moving the response moves the owners with it; destroying it
+    // releases them.
+    {
+        http_response moved = std::move(r);
+        LT_CHECK_EQ(watch.expired(), false);
+    }
+    LT_CHECK_EQ(watch.expired(), true);
+LT_END_AUTO_TEST(iovec_segments_own_their_bytes)
+
+// Pin: pipe() takes the fd and pipe_options, nothing else. Any future
+// reintroduction of a size_hint / Content-Length parameter is a
+// deliberate API change and must update this assertion.
 // Rationale: an accepted-but-ignored parameter teaches
 // callers a lie; honoring it would require synthesising Content-Length
-// without ground truth from the pipe fd.
+// without ground truth from the pipe fd. pipe_options::block_size is
+// honoured: it is the read size handed to libmicrohttpd.
 //
 // http_response::pipe is declared unconditionally (no platform guard), so
 // this compile-time signature check has no platform dependency and runs
 // on every CI lane, including Windows.
-using pipe_fn_t = http_response (*)(int);
+using pipe_fn_t = http_response (*)(int, httpserver::pipe_options);
 static_assert(std::is_same_v<decltype(&http_response::pipe), pipe_fn_t>,
-              "http_response::pipe must take exactly one parameter "
-              "(int fd); see TASK-063");
+              "http_response::pipe must take (int fd, pipe_options); "
+              "see TASK-063");
 
 LT_BEGIN_AUTO_TEST(http_response_factories_suite,
                    pipe_factory_signature_is_single_arg)
@@ -270,10 +296,28 @@ LT_BEGIN_AUTO_TEST(http_response_factories_suite, pipe_factory_kind)
     LT_CHECK_EQ(errno, EBADF);
     ::close(fds[1]);
 LT_END_AUTO_TEST(pipe_factory_kind)
+
+// A block-sized pipe response reads through its own callback; MHD still
+// owns the fd once materialized and closes it with the response.
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, pipe_factory_block_size)
+    int fds[2];
+    LT_ASSERT_EQ(::pipe(fds), 0);
+    {
+        auto r = http_response::pipe(fds[0], {.block_size = 256 * 1024});
+        auto* body = static_cast<httpserver::detail::pipe_response_body*>(SBO::body_ptr(r));
+        LT_CHECK_EQ(body->block_size(), static_cast<std::size_t>(256 * 1024));
+        MHD_Response* mhd = body->materialize();
+        LT_ASSERT_NEQ(mhd, static_cast<MHD_Response*>(nullptr));
+        MHD_destroy_response(mhd);
+    }
+    LT_CHECK_EQ(::close(fds[0]), -1);
+    LT_CHECK_EQ(errno, EBADF);
+    ::close(fds[1]);
+LT_END_AUTO_TEST(pipe_factory_block_size)
 #endif  // !_WIN32
 
 // -----------------------------------------------------------------------
-// deferred() — type-erased producer; sentinel test mirrors response_body_test.
+// deferred() — deferred_producer storage; sentinel test mirrors response_body_test.
 // -----------------------------------------------------------------------
 LT_BEGIN_AUTO_TEST(http_response_factories_suite, deferred_factory_kind)
     auto r = http_response::deferred(
@@ -302,6 +346,83 @@ LT_BEGIN_AUTO_TEST(http_response_factories_suite,
     LT_CHECK_EQ(w.expired(), true);
 LT_END_AUTO_TEST(deferred_factory_releases_capture_on_destruction)
 
+// A small lambda keeps its own type inside the body (no std::function, no
+// allocation); a large one is boxed once. Both honour block_size.
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, deferred_factory_block_size)
+    auto r = http_response::deferred(
+        [n = std::size_t{0}](std::uint64_t, char*, std::size_t) -> ssize_t {
+            (void)n;
+            return MHD_CONTENT_READER_END_OF_STREAM;
+        }, 256 * 1024);
+    auto* body = static_cast<httpserver::detail::deferred_response_body*>(SBO::body_ptr(r));
+    LT_CHECK_EQ(body->block_size(), static_cast<std::size_t>(256 * 1024));
+    auto d = http_response::deferred(
+        [](std::uint64_t, char*, std::size_t) -> ssize_t { return -1; });
+    auto* dbody = static_cast<httpserver::detail::deferred_response_body*>(SBO::body_ptr(d));
+    LT_CHECK_EQ(dbody->block_size(), httpserver::deferred_producer::default_block_size);
+    LT_CHECK_THROW((void)http_response::deferred(
+        [](std::uint64_t, char*, std::size_t) -> ssize_t { return -1; }, 0));
+LT_END_AUTO_TEST(deferred_factory_block_size)
+
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, deferred_producer_storage)
+    using httpserver::deferred_producer;
+    char out[4] = {};
+    deferred_producer small([tag = 'a'](std::uint64_t, char* buf, std::size_t) -> ssize_t {
+        buf[0] = tag;
+        return 1;
+    });
+    LT_CHECK_EQ(small.stored_inline(), true);
+    LT_CHECK_EQ(small(0, out, sizeof(out)), static_cast<ssize_t>(1));
+    LT_CHECK_EQ(out[0], 'a');
+
+    std::array<char, 64> big{};
+    big[0] = 'b';
+    deferred_producer large([big](std::uint64_t, char* buf, std::size_t) -> ssize_t {
+        buf[0] = big[0];
+        return 1;
+    });
+    LT_CHECK_EQ(large.stored_inline(), false);
+    deferred_producer moved(std::move(large));
+    LT_CHECK_EQ(static_cast<bool>(large), false);
+    LT_CHECK_EQ(moved(0, out, sizeof(out)), static_cast<ssize_t>(1));
+    LT_CHECK_EQ(out[0], 'b');
+
+    // Moving an inline callable relocates it and empties the source.
+    deferred_producer relocated(std::move(small));
+    LT_CHECK_EQ(static_cast<bool>(small), false);
+    LT_CHECK_EQ(relocated.stored_inline(), true);
+
+    std::function<ssize_t(std::uint64_t, char*, std::size_t)> none;
+    LT_CHECK_EQ(static_cast<bool>(deferred_producer(none)), false);
+    ssize_t (*null_fn)(std::uint64_t, char*, std::size_t) = nullptr;
+    LT_CHECK_EQ(static_cast<bool>(deferred_producer(null_fn)), false);
+LT_END_AUTO_TEST(deferred_producer_storage)
+
+// A producer taking deferred_trailers is recognised, materializes through
+// the trailer-binding path, and, called without libmicrohttpd, gets
+// trailers that refuse every field.
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, deferred_producer_with_trailers)
+    using httpserver::deferred_producer;
+    bool added = true;
+    deferred_producer p([&added](std::uint64_t, char*, std::size_t,
+                                 httpserver::deferred_trailers& t) -> ssize_t {
+        added = t.add("X-Count", "1");
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    });
+    LT_CHECK_EQ(p.takes_trailers(), true);
+    LT_CHECK_EQ(p.stored_inline(), true);
+    char out[4] = {};
+    LT_CHECK_EQ(p(0, out, sizeof(out)), static_cast<ssize_t>(MHD_CONTENT_READER_END_OF_STREAM));
+    LT_CHECK_EQ(added, false);
+    deferred_producer plain([](std::uint64_t, char*, std::size_t) -> ssize_t { return -1; });
+    LT_CHECK_EQ(plain.takes_trailers(), false);
+
+    auto r = http_response::deferred(std::move(p));
+    MHD_Response* mhd = SBO::body_ptr(r)->materialize();
+    LT_ASSERT_NEQ(mhd, static_cast<MHD_Response*>(nullptr));
+    MHD_destroy_response(mhd);
+LT_END_AUTO_TEST(deferred_producer_with_trailers)
+
 // -----------------------------------------------------------------------
 // unauthorized() — 401 status + WWW-Authenticate header.
 // -----------------------------------------------------------------------
@@ -500,6 +621,66 @@ LT_BEGIN_AUTO_TEST(http_response_factories_suite,
                 static_cast<int>(body_kind::string));
 LT_END_AUTO_TEST(factory_chain_keeps_body_inline_in_sbo)
 
+// -----------------------------------------------------------------------
+// freeze(): a frozen response converts back into a frozen-kind response
+// with the source status and body size; bodies that cannot be replayed
+// (one-shot pipes, producers) are refused.
+// -----------------------------------------------------------------------
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, freeze_round_trip)
+    httpserver::frozen_response f = http_response::string("frozen")
+        .with_header("X-Foo", "bar").with_status(202).freeze();
+    LT_CHECK_EQ(f.get_status(), 202);
+    LT_CHECK_EQ(std::string(f.source().get_header("X-Foo")), "bar");
+
+    http_response r = f;
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::frozen));
+    LT_CHECK_EQ(r.get_status(), 202);
+    LT_CHECK_EQ(r.get_headers().empty(), true);
+    LT_CHECK_EQ(SBO::body_inline(r), true);
+
+    // Conversions are independent: changing one does not touch the source.
+    http_response again = f;
+    again.with_status(203);
+    LT_CHECK_EQ(f.get_status(), 202);
+LT_END_AUTO_TEST(freeze_round_trip)
+
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, freeze_rejects_one_shot_bodies)
+    LT_CHECK_THROW((void)http_response::deferred(
+        [](std::uint64_t, char*, std::size_t) -> ssize_t { return -1; }).freeze());
+    LT_CHECK_THROW((void)http_response{}.freeze());
+LT_END_AUTO_TEST(freeze_rejects_one_shot_bodies)
+
+// -----------------------------------------------------------------------
+// shared(): the body borrows the caller's bytes (no copy) and holds a
+// reference on their owner for as long as the response lives.
+// -----------------------------------------------------------------------
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, shared_string_holds_owner)
+    auto doc = std::make_shared<const std::string>("shared body");
+    std::weak_ptr<const std::string> watch = doc;
+    {
+        auto r = http_response::shared(std::move(doc), "text/html");
+        LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::shared));
+        LT_CHECK_EQ(r.get_status(), 200);
+        LT_CHECK_EQ(std::string(r.get_header("Content-Type")), "text/html");
+        LT_CHECK_EQ(SBO::body_inline(r), true);
+        LT_CHECK_EQ(watch.expired(), false);
+    }
+    LT_CHECK_EQ(watch.expired(), true);
+LT_END_AUTO_TEST(shared_string_holds_owner)
+
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, shared_rejects_null_body)
+    LT_CHECK_THROW((void)http_response::shared(std::shared_ptr<const std::string>{}));
+LT_END_AUTO_TEST(shared_rejects_null_body)
+
+LT_BEGIN_AUTO_TEST(http_response_factories_suite, shared_span_can_be_frozen)
+    static const char bytes[] = "static";
+    auto r = http_response::shared(
+        std::as_bytes(std::span<const char>(bytes, 6)), nullptr);
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::shared));
+    httpserver::frozen_response f = std::move(r).freeze();
+    LT_CHECK_EQ(f.get_status(), 200);
+LT_END_AUTO_TEST(shared_span_can_be_frozen)
+
 LT_BEGIN_AUTO_TEST_ENV()
     AUTORUN_TESTS()
 LT_END_AUTO_TEST_ENV()
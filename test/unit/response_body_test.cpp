@@ -29,6 +29,7 @@
 #include <sys/types.h>      // ssize_t
 #include <unistd.h>         // pipe, close
 
+#include <array>
 #include <cerrno>
 #include <cstdint>
 #include <cstring>
@@ -355,23 +356,14 @@ LT_END_AUTO_TEST(deferred_body_trampoline_null_cls_returns_error)
 // `!self || !self->producer_` guard in deferred_response_body::trampoline
 // (src/detail/response_body.cpp). A move-constructed-from deferred_response_body has a
 // non-null `self` but an empty producer_, so trampoline must still return
-// MHD_CONTENT_READER_END_WITH_ERROR rather than invoking an empty
-// std::function (which would throw std::bad_function_call and terminate
-// in MHD's IO thread).
+// MHD_CONTENT_READER_END_WITH_ERROR rather than invoking nothing and
+// terminating in MHD's IO thread.
 //
-// The capture below is deliberately oversized (well past std::function's
-// small-object-optimization threshold on every mainstream stdlib) so the
-// lambda is heap-allocated by std::function. This is required for the
-// test to be meaningful: empirically (verified on libc++/Apple Clang),
-// std::function's move constructor for a *small*, SBO-eligible captureless
-// lambda may leave the source still holding a live (copied) target rather
-// than becoming empty, since the standard only guarantees the moved-from
-// std::function is left in a valid, unspecified state -- not that it is
-// empty. A heap-allocated target must have its owning pointer transferred
-// (and the source's pointer nulled) on move, so the source reliably
-// becomes empty in that case.
+// deferred_producer empties its source on move whether the callable is
+// stored inline or boxed; the oversized capture below takes the boxed
+// path, the small lambda the inline one.
 LT_BEGIN_AUTO_TEST(body_suite, deferred_body_trampoline_moved_from_producer_returns_error)
-    std::string oversized_capture(256, 'z');  // forces heap allocation in std::function
+    std::array<char, 256> oversized_capture{};  // boxed by deferred_producer
     httpserver::detail::deferred_response_body b(
         [oversized_capture](uint64_t, char*, std::size_t) -> ssize_t {
             (void)oversized_capture;
@@ -384,6 +376,16 @@ LT_BEGIN_AUTO_TEST(body_suite, deferred_body_trampoline_moved_from_producer_retu
     ssize_t n = httpserver::detail::deferred_response_body::trampoline(
         &b, 0, out, sizeof(out));
     LT_CHECK_EQ(n, static_cast<ssize_t>(MHD_CONTENT_READER_END_WITH_ERROR));
+
+    httpserver::detail::deferred_response_body small(
+        [](uint64_t, char*, std::size_t) -> ssize_t {
+            return MHD_CONTENT_READER_END_OF_STREAM;
+        });
+    httpserver::detail::deferred_response_body small_to(std::move(small));
+    (void)small_to;
+    n = httpserver::detail::deferred_response_body::trampoline(
+        &small, 0, out, sizeof(out));
+    LT_CHECK_EQ(n, static_cast<ssize_t>(MHD_CONTENT_READER_END_WITH_ERROR));
 LT_END_AUTO_TEST(deferred_body_trampoline_moved_from_producer_returns_error)
 
 LT_BEGIN_AUTO_TEST(body_suite, deferred_body_destructor_releases_callable)
@@ -0,0 +1,201 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "./httpserver.hpp"
+#include "httpserver/create_test_request.hpp"
+#include "httpserver/detail/response_cache.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::response_cache (create_webserver::response_cache): the
+// request key, which responses are stored and for how long, frozen
+// storage, the per-shard byte budget and purging.
+
+using httpserver::body_kind;
+using httpserver::create_test_request;
+using httpserver::http_method;
+using httpserver::http_response;
+using httpserver::detail::response_cache;
+using std::chrono::seconds;
+
+namespace {
+
+constexpr std::size_t kBudget = 16 * 4096;  // 4 KiB per shard
+
+std::string key_of(const response_cache& c, create_test_request req,
+                   http_method m = http_method::get) {
+    return c.key(req.build(), m, "/items");
+}
+
+http_response cacheable(std::string body, std::string cache_control = "max-age=60") {
+    return http_response::string(std::move(body)).with_header("Cache-Control", cache_control);
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(response_cache_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(response_cache_suite)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, lifetime_follows_cache_control)
+    LT_CHECK_EQ(response_cache::lifetime("max-age=60").value_or(seconds(-1)).count(), 60);
+    LT_CHECK_EQ(response_cache::lifetime("public, max-age=60, s-maxage=\"5\"")
+                    .value_or(seconds(-1)).count(), 5);
+    LT_CHECK_EQ(response_cache::lifetime("").has_value(), false);
+    LT_CHECK_EQ(response_cache::lifetime("max-age=0").has_value(), false);
+    LT_CHECK_EQ(response_cache::lifetime("max-age=ten").has_value(), false);
+    LT_CHECK_EQ(response_cache::lifetime("max-age=60, no-store").has_value(), false);
+    LT_CHECK_EQ(response_cache::lifetime("No-Cache, max-age=60").has_value(), false);
+    LT_CHECK_EQ(response_cache::lifetime("private, max-age=60").has_value(), false);
+LT_END_AUTO_TEST(lifetime_follows_cache_control)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, key_covers_method_query_vary_and_user_key)
+    response_cache c(kBudget, {"Accept-Language"},
+                     [](const httpserver::http_request& r) {
+                         return std::string(r.get_header("X-Tenant"));
+                     });
+    create_test_request base;
+    base.path("/items");
+    const std::string k = key_of(c, base);
+    LT_CHECK_EQ(k.empty(), false);
+    LT_CHECK_EQ(k == key_of(c, base), true);
+    LT_CHECK_EQ(k == key_of(c, base, http_method::head), false);
+
+    create_test_request q;
+    q.path("/items").querystring("?page=2");
+    LT_CHECK_EQ(k == key_of(c, q), false);
+    create_test_request lang;
+    lang.path("/items").header("Accept-Language", "fr");
+    LT_CHECK_EQ(k == key_of(c, lang), false);
+    create_test_request tenant;
+    tenant.path("/items").header("X-Tenant", "b");
+    LT_CHECK_EQ(k == key_of(c, tenant), false);
+    create_test_request other;
+    other.path("/items").header("User-Agent", "curl");
+    LT_CHECK_EQ(k == key_of(c, other), true);
+
+    // Not cacheable: other methods, credentials, a disabled cache.
+    LT_CHECK_EQ(key_of(c, base, http_method::post).empty(), true);
+    create_test_request auth;
+    auth.path("/items").header("Authorization", "Bearer x");
+    LT_CHECK_EQ(key_of(c, auth).empty(), true);
+    response_cache off(0, {}, nullptr);
+    LT_CHECK_EQ(off.enabled(), false);
+    LT_CHECK_EQ(key_of(off, base).empty(), true);
+LT_END_AUTO_TEST(key_covers_method_query_vary_and_user_key)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, stored_responses_are_frozen_and_served)
+    response_cache c(kBudget, {}, nullptr);
+    http_response r = cacheable("catalog").with_status(200);
+    c.store("k", "/items", r);
+    // The miss itself now sends the frozen response.
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::frozen));
+    auto hit = c.find("k", "/items");
+    LT_ASSERT_EQ(hit.has_value(), true);
+    LT_CHECK_EQ(hit->get_status(), 200);
+    LT_CHECK_EQ(hit->source().get_header("Cache-Control"), "max-age=60");
+    LT_CHECK_EQ(c.find("other", "/items").has_value(), false);
+    LT_CHECK_EQ(c.used() > 0, true);
+LT_END_AUTO_TEST(stored_responses_are_frozen_and_served)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, uncacheable_responses_pass_through)
+    response_cache c(kBudget, {"Accept-Language"}, nullptr);
+    std::vector<http_response> rejected;
+    rejected.push_back(http_response::string("no header"));
+    rejected.push_back(cacheable("no-store", "no-store"));
+    rejected.push_back(cacheable("error").with_status(500));
+    rejected.push_back(cacheable("cookie").with_cookie(
+        httpserver::cookie{}.with_name("session").with_value("1")));
+    rejected.push_back(cacheable("vary").with_header("Vary", "Accept-Encoding"));
+    rejected.push_back(cacheable("vary *").with_header("Vary", "*"));
+    rejected.push_back(http_response::deferred([](std::uint64_t, char*, std::size_t) -> ssize_t {
+        return -1;
+    }).with_header("Cache-Control", "max-age=60"));
+    for (std::size_t i = 0; i < rejected.size(); ++i) {
+        const body_kind before = rejected[i].kind();
+        c.store("k" + std::to_string(i), "/items", rejected[i]);
+        LT_CHECK_EQ(static_cast<int>(rejected[i].kind()), static_cast<int>(before));
+        LT_CHECK_EQ(c.find("k" + std::to_string(i), "/items").has_value(), false);
+    }
+    http_response varied = cacheable("fr").with_header("Vary", "accept-language");
+    c.store("varied", "/items", varied);
+    LT_CHECK_EQ(c.find("varied", "/items").has_value(), true);
+LT_END_AUTO_TEST(uncacheable_responses_pass_through)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, entries_expire)
+    response_cache c(kBudget, {}, nullptr);
+    http_response r = cacheable("brief", "max-age=1");
+    c.store("k", "/items", r);
+    LT_CHECK_EQ(c.find("k", "/items").has_value(), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    LT_CHECK_EQ(c.find("k", "/items").has_value(), false);
+    LT_CHECK_EQ(c.used(), 0u);
+LT_END_AUTO_TEST(entries_expire)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, shards_keep_their_budget)
+    response_cache c(kBudget, {}, nullptr);
+    // Same path, so same shard: the third 1.5 KiB body evicts the first.
+    for (int i = 0; i < 3; ++i) {
+        http_response r = cacheable(std::string(1536, 'x'));
+        c.store("k" + std::to_string(i), "/items", r);
+    }
+    LT_CHECK_EQ(c.find("k0", "/items").has_value(), false);
+    LT_CHECK_EQ(c.find("k1", "/items").has_value(), true);
+    LT_CHECK_EQ(c.find("k2", "/items").has_value(), true);
+    LT_CHECK_EQ(c.used() <= kBudget / response_cache::kShards, true);
+
+    // Larger than a shard's share: never stored, left unfrozen.
+    http_response big = cacheable(std::string(8192, 'y'));
+    c.store("big", "/items", big);
+    LT_CHECK_EQ(static_cast<int>(big.kind()), static_cast<int>(body_kind::string));
+    LT_CHECK_EQ(c.find("big", "/items").has_value(), false);
+LT_END_AUTO_TEST(shards_keep_their_budget)
+
+LT_BEGIN_AUTO_TEST(response_cache_suite, purge_drops_a_path_or_everything)
+    response_cache c(kBudget, {}, nullptr);
+    for (const char* key : {"a1", "a2"}) {
+        http_response r = cacheable("a");
+        c.store(key, "/a", r);
+    }
+    http_response b = cacheable("b");
+    c.store("b1", "/b", b);
+    LT_CHECK_EQ(c.purge("/a"), 2u);
+    LT_CHECK_EQ(c.purge("/a"), 0u);
+    LT_CHECK_EQ(c.find("a1", "/a").has_value(), false);
+    LT_CHECK_EQ(c.find("b1", "/b").has_value(), true);
+    c.clear();
+    LT_CHECK_EQ(c.find("b1", "/b").has_value(), false);
+    LT_CHECK_EQ(c.used(), 0u);
+LT_END_AUTO_TEST(purge_drops_a_path_or_everything)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
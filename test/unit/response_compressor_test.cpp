@@ -0,0 +1,443 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <microhttpd.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./httpserver.hpp"
+#include "httpserver/create_test_request.hpp"
+#include "httpserver/detail/compressed_file_cache.hpp"
+#include "httpserver/detail/response_body.hpp"
+#include "httpserver/detail/response_compressor.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::response_compressor, the create_webserver::
+// compress_responses stage: Accept-Encoding negotiation, the Content-Type
+// filter, Vary handling, precompressed file siblings, the compressed file
+// cache, and -- with zlib -- that string, iovec, deferred, pipe and cached
+// file bodies come out as streams that inflate back to the original.
+
+using httpserver::http_request;
+using httpserver::http_response;
+using httpserver::create_test_request;
+using httpserver::webserver_config;
+using httpserver::detail::response_compressor;
+
+namespace httpserver {
+
+// Same per-TU friend hook as http_response_sbo_test.cpp: reads the
+// encoded body back out of the response.
+struct http_response_sbo_test_access {
+    static detail::response_body* body_ptr(http_response& r) noexcept { return r.body_; }
+};
+
+}  // namespace httpserver
+
+namespace {
+
+using SBO = httpserver::http_response_sbo_test_access;
+using coding = response_compressor::coding;
+
+http_request request_accepting(const std::string& accept_encoding) {
+    return create_test_request().header("Accept-Encoding", accept_encoding).build();
+}
+
+// A scratch file under /tmp holding @p content; removed with the object.
+struct temp_file {
+    explicit temp_file(const std::string& content, std::string at = {}) {
+        if (at.empty()) {
+            char tmpl[] = "/tmp/response_compressor_testXXXXXX";
+            const int fd = ::mkstemp(tmpl);
+            ::close(fd);
+            at = tmpl;
+        }
+        path = std::move(at);
+        write(content);
+    }
+    ~temp_file() { ::unlink(path.c_str()); }
+    temp_file(const temp_file&) = delete;
+    temp_file& operator=(const temp_file&) = delete;
+
+    void write(const std::string& content) const {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        std::fwrite(content.data(), 1, content.size(), f);
+        std::fclose(f);
+    }
+
+    std::string path;
+};
+
+std::string file_path_of(http_response& r) {
+    return static_cast<httpserver::detail::file_response_body*>(SBO::body_ptr(r))->path();
+}
+
+std::string text_of(std::size_t bytes) {
+    std::string s;
+    for (int i = 0; s.size() < bytes; ++i) s += "line " + std::to_string(i) + "\n";
+    s.resize(bytes);
+    return s;
+}
+
+#ifdef HAVE_ZLIB
+// 32 + MAX_WBITS detects the gzip and zlib wrappers alike. With
+// @p partial, a stream cut short returns what inflated so far.
+std::string inflate_all(const std::string& in, bool partial = false) {
+    z_stream zs{};
+    inflateInit2(&zs, 32 + MAX_WBITS);
+    std::string out;
+    char buf[4096];
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        zs.next_out = reinterpret_cast<Bytef*>(buf);
+        zs.avail_out = sizeof(buf);
+        rc = inflate(&zs, Z_NO_FLUSH);
+        out.append(buf, sizeof(buf) - zs.avail_out);
+        if (rc == Z_BUF_ERROR && zs.avail_in == 0) break;
+    }
+    inflateEnd(&zs);
+    return rc == Z_STREAM_END || partial ? out : "<corrupt>";
+}
+
+std::string string_body(http_response& r) {
+    return static_cast<httpserver::detail::string_response_body*>(SBO::body_ptr(r))->get_data();
+}
+
+// Pulls a deferred body, @p max bytes per call, for at most @p calls
+// calls or to the end of the stream.
+std::string drain(http_response& r, std::size_t max, int calls = 100000) {
+    std::string out(max, '\0');
+    std::string all;
+    for (int i = 0; i < calls; ++i) {
+        const ssize_t n = httpserver::detail::deferred_response_body::trampoline(
+            SBO::body_ptr(r), all.size(), out.data(), max);
+        if (n == MHD_CONTENT_READER_END_OF_STREAM) break;
+        if (n < 0) return "<error>";
+        all.append(out.data(), static_cast<std::size_t>(n));
+    }
+    return all;
+}
+#endif  // HAVE_ZLIB
+
+}  // namespace
+
+LT_BEGIN_SUITE(response_compressor_suite)
+    webserver_config config;
+
+    void set_up() {
+        config = webserver_config{};
+        config.compress_responses = true;
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(response_compressor_suite)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, negotiates_codings)
+    LT_CHECK_EQ(response_compressor::negotiate("") == coding::identity, true);
+    LT_CHECK_EQ(response_compressor::negotiate("gzip") == coding::gzip, true);
+    LT_CHECK_EQ(response_compressor::negotiate("X-GZIP") == coding::gzip, true);
+    LT_CHECK_EQ(response_compressor::negotiate("deflate") == coding::deflate, true);
+    LT_CHECK_EQ(response_compressor::negotiate("br, deflate;q=0.8, gzip;q=0.5") == coding::deflate, true);
+    LT_CHECK_EQ(response_compressor::negotiate("gzip;q=0, deflate") == coding::deflate, true);
+    LT_CHECK_EQ(response_compressor::negotiate("deflate;q=0.5, gzip;q=0.5") == coding::gzip, true);
+    LT_CHECK_EQ(response_compressor::negotiate("*") == coding::gzip, true);
+    LT_CHECK_EQ(response_compressor::negotiate("*;q=0") == coding::identity, true);
+    LT_CHECK_EQ(response_compressor::negotiate("gzip;q=0, *;q=0.1") == coding::deflate, true);
+    LT_CHECK_EQ(response_compressor::negotiate("br, identity") == coding::identity, true);
+
+    // br only competes when a precompressed ".br" can be served.
+    LT_CHECK_EQ(response_compressor::negotiate("gzip, br", true) == coding::br, true);
+    LT_CHECK_EQ(response_compressor::negotiate("gzip, br;q=0.5", true) == coding::gzip, true);
+    LT_CHECK_EQ(response_compressor::negotiate("*", true) == coding::br, true);
+    LT_CHECK_EQ(response_compressor::negotiate("br;q=0, *", true) == coding::gzip, true);
+LT_END_AUTO_TEST(negotiates_codings)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, filters_content_type)
+    response_compressor c(config);
+    LT_CHECK_EQ(c.compressible_type("text/html; charset=utf-8"), true);
+    LT_CHECK_EQ(c.compressible_type("TEXT/PLAIN"), true);
+    LT_CHECK_EQ(c.compressible_type("application/json"), true);
+    LT_CHECK_EQ(c.compressible_type("image/png"), false);
+    LT_CHECK_EQ(c.compressible_type("text/"), false);
+    LT_CHECK_EQ(c.compressible_type(""), false);
+    config.compression_types = {"application/*"};
+    LT_CHECK_EQ(c.compressible_type("application/wasm"), true);
+    LT_CHECK_EQ(c.compressible_type("text/html"), false);
+LT_END_AUTO_TEST(filters_content_type)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, small_body_only_gains_vary)
+    response_compressor c(config);
+    http_response r = http_response::string("ok");
+    c.apply(request_accepting("gzip"), r);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "");
+    LT_CHECK_EQ(r.get_header("Vary"), "Accept-Encoding");
+
+    // A Vary that already lists the field (or "*") is left alone;
+    // otherwise the field is appended.
+    http_response listed = http_response::string("ok").with_header("Vary", "accept-encoding");
+    c.apply(request_accepting("gzip"), listed);
+    LT_CHECK_EQ(listed.get_header("Vary"), "accept-encoding");
+    http_response other = http_response::string("ok").with_header("Vary", "Origin");
+    c.apply(request_accepting("gzip"), other);
+    LT_CHECK_EQ(other.get_header("Vary"), "Origin, Accept-Encoding");
+LT_END_AUTO_TEST(small_body_only_gains_vary)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, ineligible_responses_are_untouched)
+    response_compressor c(config);
+    const std::string big = text_of(4096);
+    http_response png = http_response::string(big, "image/png");
+    http_response encoded = http_response::string(big).with_header("Content-Encoding", "br");
+    http_response no_transform = http_response::string(big)
+        .with_header("Cache-Control", "public, no-transform");
+    http_response not_modified = http_response::string(big).with_status(304);
+    for (http_response* r : {&png, &encoded, &no_transform, &not_modified}) {
+        c.apply(request_accepting("gzip"), *r);
+        LT_CHECK_EQ(r->get_header("Vary"), "");
+        LT_CHECK_EQ(r->get_header("Content-Encoding") == "gzip", false);
+    }
+LT_END_AUTO_TEST(ineligible_responses_are_untouched)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, precompressed_siblings_are_served)
+    // Siblings are picked whether or not compress_responses is on.
+    config.compress_responses = false;
+    response_compressor c(config);
+    temp_file original("original bytes");
+    temp_file gz("gzip bytes", original.path + ".gz");
+    auto serve = [&](const std::string& accept_encoding, bool precompressed = true) {
+        http_response r = http_response::file(original.path, {.precompressed = precompressed});
+        c.apply(request_accepting(accept_encoding), r);
+        return r;
+    };
+
+    http_response plain = serve("");
+    LT_CHECK_EQ(file_path_of(plain), original.path);
+    LT_CHECK_EQ(plain.get_header("Content-Encoding"), "");
+    LT_CHECK_EQ(plain.get_header("Vary"), "Accept-Encoding");
+
+    // No ".br" yet: a br-preferring client falls back to the ".gz".
+    http_response gzipped = serve("br, gzip;q=0.8");
+    LT_CHECK_EQ(file_path_of(gzipped), original.path + ".gz");
+    LT_CHECK_EQ(gzipped.get_header("Content-Encoding"), "gzip");
+    LT_CHECK_EQ(gzipped.kind() == httpserver::body_kind::file, true);
+
+    temp_file br("brotli bytes", original.path + ".br");
+    http_response brotli = serve("gzip, br");
+    LT_CHECK_EQ(file_path_of(brotli), original.path + ".br");
+    LT_CHECK_EQ(brotli.get_header("Content-Encoding"), "br");
+    http_response deflated = serve("deflate");
+    LT_CHECK_EQ(file_path_of(deflated), original.path);
+
+    // Without the opt-in the siblings are ignored, and Vary is not added.
+    http_response opted_out = serve("gzip, br", false);
+    LT_CHECK_EQ(file_path_of(opted_out), original.path);
+    LT_CHECK_EQ(opted_out.get_header("Vary"), "");
+
+    // A missing original is not papered over by its siblings.
+    http_response missing = http_response::file(original.path + ".none", {.precompressed = true});
+    c.apply(request_accepting("gzip"), missing);
+    LT_CHECK_EQ(missing.get_header("Content-Encoding"), "");
+LT_END_AUTO_TEST(precompressed_siblings_are_served)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, file_cache_is_bounded_and_stamped)
+    using cache = httpserver::detail::compressed_file_cache;
+    cache files(100);
+    auto bytes = [](std::size_t n) { return std::make_shared<const std::string>(n, 'x'); };
+    std::shared_ptr<const std::string> out;
+    files.insert("/a", 1, cache::stamp{1, 10}, bytes(40));
+    files.insert("/b", 1, cache::stamp{1, 10}, bytes(40));
+    LT_CHECK_EQ(files.used(), 84u);
+    LT_CHECK_EQ(files.find("/a", 1, cache::stamp{1, 10}, &out), true);
+    LT_CHECK_EQ(out->size(), 40u);
+    LT_CHECK_EQ(files.find("/a", 2, cache::stamp{1, 10}, &out), false);
+    LT_CHECK_EQ(files.find("/a", 1, cache::stamp{2, 10}, &out), false);
+
+    // "/b" is least recently used, so it makes room for "/c".
+    files.insert("/c", 1, cache::stamp{1, 10}, bytes(40));
+    LT_CHECK_EQ(files.find("/b", 1, cache::stamp{1, 10}, &out), false);
+    LT_CHECK_EQ(files.find("/a", 1, cache::stamp{1, 10}, &out), true);
+
+    // A newer stamp replaces the entry; an entry over budget is dropped.
+    files.insert("/a", 1, cache::stamp{2, 12}, nullptr);
+    LT_CHECK_EQ(files.find("/a", 1, cache::stamp{2, 12}, &out), true);
+    LT_CHECK_EQ(out == nullptr, true);
+    files.insert("/d", 1, cache::stamp{1, 10}, bytes(200));
+    LT_CHECK_EQ(files.find("/d", 1, cache::stamp{1, 10}, &out), false);
+    LT_CHECK_EQ(files.used(), 44u);
+LT_END_AUTO_TEST(file_cache_is_bounded_and_stamped)
+
+#ifdef HAVE_ZLIB
+LT_BEGIN_AUTO_TEST(response_compressor_suite, string_body_is_encoded)
+    response_compressor c(config);
+    const std::string big = text_of(8192);
+    http_response r = http_response::string(big).with_header("ETag", "\"v1\"");
+    c.apply(request_accepting("gzip, deflate"), r);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "gzip");
+    LT_CHECK_EQ(r.get_header("Vary"), "Accept-Encoding");
+    LT_CHECK_EQ(r.get_header("ETag"), "W/\"v1\"");
+    LT_CHECK_EQ(r.kind() == httpserver::body_kind::string, true);
+    LT_CHECK_EQ(string_body(r).size() < big.size(), true);
+    LT_CHECK_EQ(inflate_all(string_body(r)) == big, true);
+
+    // Without an acceptable coding the body stays as it was.
+    http_response plain = http_response::string(big);
+    c.apply(request_accepting("br"), plain);
+    LT_CHECK_EQ(plain.get_header("Content-Encoding"), "");
+    LT_CHECK_EQ(string_body(plain) == big, true);
+LT_END_AUTO_TEST(string_body_is_encoded)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, iovec_body_is_encoded)
+    response_compressor c(config);
+    const std::string a = text_of(3000), b = text_of(5000);
+    const std::vector<httpserver::iovec_entry> parts = {{a.data(), a.size()}, {b.data(), b.size()}};
+    http_response r = http_response::iovec(parts);
+    r.with_header("Content-Type", "text/plain");
+    c.apply(request_accepting("deflate"), r);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "deflate");
+    LT_CHECK_EQ(r.kind() == httpserver::body_kind::string, true);
+    LT_CHECK_EQ(inflate_all(string_body(r)) == a + b, true);
+LT_END_AUTO_TEST(iovec_body_is_encoded)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, deferred_body_streams_and_flushes_when_idle)
+    response_compressor c(config);
+    std::string expected;
+    for (int i = 0; i < 40; ++i) expected += text_of(997);
+    int calls = 0;
+    http_response r = http_response::deferred(
+        [&, sent = std::size_t{0}](std::uint64_t pos, char* buf, std::size_t max) mutable -> ssize_t {
+            if (pos != sent) return MHD_CONTENT_READER_END_WITH_ERROR;
+            if (++calls == 3) return 0;  // nothing ready yet
+            if (sent == expected.size()) return MHD_CONTENT_READER_END_OF_STREAM;
+            const std::size_t n = std::min<std::size_t>({max, 997, expected.size() - sent});
+            expected.copy(buf, n, sent);
+            sent += n;
+            return static_cast<ssize_t>(n);
+        });
+    r.with_header("Content-Type", "application/json");
+    c.apply(request_accepting("gzip"), r);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "gzip");
+    LT_CHECK_EQ(r.kind() == httpserver::body_kind::deferred, true);
+
+    // Pull until the source has stalled once: the two chunks it gave
+    // before that must already be on the wire, not held inside deflate.
+    std::string first;
+    while (calls < 3) first += drain(r, 64 * 1024, 1);
+    LT_CHECK_EQ(inflate_all(first, true) == expected.substr(0, 2 * 997), true);
+
+    const std::string wire = first + drain(r, 512);
+    LT_CHECK_EQ(wire.size() < expected.size(), true);
+    LT_CHECK_EQ(inflate_all(wire) == expected, true);
+LT_END_AUTO_TEST(deferred_body_streams_and_flushes_when_idle)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, pipe_body_streams)
+    response_compressor c(config);
+    int fds[2];
+    LT_ASSERT_EQ(::pipe(fds), 0);
+    const std::string body = text_of(20000);
+    LT_ASSERT_EQ(::write(fds[1], body.data(), body.size()), static_cast<ssize_t>(body.size()));
+    ::close(fds[1]);
+
+    http_response r = http_response::pipe(fds[0]);
+    r.with_header("Content-Type", "text/csv");
+    c.apply(request_accepting("gzip"), r);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "gzip");
+    LT_CHECK_EQ(inflate_all(drain(r, 4096)) == body, true);
+LT_END_AUTO_TEST(pipe_body_streams)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, stream_body_streams)
+    response_compressor c(config);
+    httpserver::stream_writer w(4096);
+    const std::string body = text_of(3000);
+    LT_CHECK_EQ(w.try_write(body), body.size());
+    w.finish();
+
+    http_response r = http_response::stream(w);
+    r.with_header("Content-Type", "text/event-stream");
+    c.apply(request_accepting("gzip"), r);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "gzip");
+    LT_CHECK_EQ(r.kind() == httpserver::body_kind::deferred, true);
+    LT_CHECK_EQ(inflate_all(drain(r, 512)) == body, true);
+    // The encoding stream owns the original body; dropping it closes the
+    // writer.
+    LT_CHECK_EQ(w.closed(), false);
+    r = http_response::empty();
+    LT_CHECK_EQ(w.closed(), true);
+LT_END_AUTO_TEST(stream_body_streams)
+
+LT_BEGIN_AUTO_TEST(response_compressor_suite, file_body_is_compressed_once)
+    config.compressed_file_cache_size = 1 << 20;
+    response_compressor c(config);
+    const std::string v1 = text_of(10000);
+    temp_file f(v1);
+    auto serve = [&] {
+        http_response r = http_response::file(f.path).with_header("Content-Type", "text/css");
+        c.apply(request_accepting("gzip"), r);
+        return r;
+    };
+    auto shared_bytes = [](http_response& r) {
+        auto* b = static_cast<httpserver::detail::shared_response_body*>(SBO::body_ptr(r));
+        return std::string_view(static_cast<const char*>(b->data()), b->size());
+    };
+
+    http_response first = serve();
+    LT_CHECK_EQ(first.get_header("Content-Encoding"), "gzip");
+    LT_CHECK_EQ(first.get_header("Vary"), "Accept-Encoding");
+    LT_ASSERT_EQ(first.kind() == httpserver::body_kind::shared, true);
+    LT_CHECK_EQ(inflate_all(std::string(shared_bytes(first))) == v1, true);
+
+    // A hit serves the same bytes, not a fresh compression.
+    http_response second = serve();
+    LT_ASSERT_EQ(second.kind() == httpserver::body_kind::shared, true);
+    LT_CHECK_EQ(shared_bytes(second).data() == shared_bytes(first).data(), true);
+
+    // A changed file (new size) is recompressed.
+    const std::string v2 = text_of(12000);
+    f.write(v2);
+    http_response third = serve();
+    LT_ASSERT_EQ(third.kind() == httpserver::body_kind::shared, true);
+    LT_CHECK_EQ(inflate_all(std::string(shared_bytes(third))) == v2, true);
+
+    // Off by default: the file keeps its zero-copy path.
+    config.compressed_file_cache_size = 0;
+    response_compressor off(config);
+    http_response r = http_response::file(f.path).with_header("Content-Type", "text/css");
+    off.apply(request_accepting("gzip"), r);
+    LT_CHECK_EQ(r.kind() == httpserver::body_kind::file, true);
+    LT_CHECK_EQ(r.get_header("Content-Encoding"), "");
+LT_END_AUTO_TEST(file_body_is_compressed_once)
+#endif  // HAVE_ZLIB
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
@@ -0,0 +1,172 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/single_flight.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::single_flight (http_resource::single_flight_key): one
+// leader per resource and key, followers sharing its frozen response, and
+// unshareable responses left to the followers. Followers block here (the
+// THREAD_PER_CONNECTION mode); parking needs a live daemon and is covered
+// by the integration suite.
+
+using httpserver::body_kind;
+using httpserver::frozen_response;
+using httpserver::http_resource;
+using httpserver::http_response;
+using httpserver::detail::single_flight;
+
+namespace {
+
+class keyed_resource : public http_resource {
+};
+
+// Spin until @p f has @p n blocked followers.
+void await_followers(single_flight::flight* f, std::size_t n) {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(f->mutex);
+            if (f->blocked == n) return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(single_flight_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(single_flight_suite)
+
+LT_BEGIN_AUTO_TEST(single_flight_suite, lone_leader_is_left_alone)
+    single_flight flights(single_flight::mode::block);
+    auto res = std::make_shared<keyed_resource>();
+    single_flight::ticket t;
+    LT_CHECK_EQ(flights.enabled(), true);
+    LT_CHECK_EQ(static_cast<int>(flights.join(res, "k", nullptr, &t)),
+                static_cast<int>(single_flight::role::lead));
+    LT_CHECK_EQ(flights.in_flight(), 1u);
+    http_response r = http_response::string("alone");
+    flights.land(&t, &r);
+    // Nobody followed, so nothing was frozen.
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::string));
+    LT_CHECK_EQ(t.joined == nullptr, true);
+    LT_CHECK_EQ(flights.in_flight(), 0u);
+    LT_CHECK_EQ(single_flight(single_flight::mode::off).enabled(), false);
+LT_END_AUTO_TEST(lone_leader_is_left_alone)
+
+LT_BEGIN_AUTO_TEST(single_flight_suite, followers_share_the_frozen_response)
+    single_flight flights(single_flight::mode::block);
+    auto res = std::make_shared<keyed_resource>();
+    single_flight::ticket lead;
+    LT_CHECK_EQ(static_cast<int>(flights.join(res, "k", nullptr, &lead)),
+                static_cast<int>(single_flight::role::lead));
+
+    std::optional<frozen_response> shared[2];
+    std::thread followers[2];
+    for (int i = 0; i < 2; ++i) {
+        followers[i] = std::thread([&flights, &res, &shared, i] {
+            single_flight::ticket t;
+            if (flights.join(res, "k", nullptr, &t) == single_flight::role::follow) {
+                shared[i] = single_flight::take(&t);
+            }
+        });
+    }
+    await_followers(lead.joined.get(), 2);
+
+    http_response r = http_response::string("expensive").with_status(203);
+    flights.land(&lead, &r);
+    for (auto& f : followers) f.join();
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::frozen));
+    for (const auto& s : shared) {
+        LT_ASSERT_EQ(s.has_value(), true);
+        LT_CHECK_EQ(s->get_status(), 203);
+    }
+
+    // The landed flight is gone; the next request leads a new one.
+    single_flight::ticket next;
+    LT_CHECK_EQ(static_cast<int>(flights.join(res, "k", nullptr, &next)),
+                static_cast<int>(single_flight::role::lead));
+    flights.land(&next, nullptr);
+LT_END_AUTO_TEST(followers_share_the_frozen_response)
+
+LT_BEGIN_AUTO_TEST(single_flight_suite, keys_are_per_resource)
+    single_flight flights(single_flight::mode::block);
+    auto a = std::make_shared<keyed_resource>();
+    auto b = std::make_shared<keyed_resource>();
+    single_flight::ticket ta;
+    single_flight::ticket tb;
+    single_flight::ticket tc;
+    LT_CHECK_EQ(static_cast<int>(flights.join(a, "k", nullptr, &ta)),
+                static_cast<int>(single_flight::role::lead));
+    LT_CHECK_EQ(static_cast<int>(flights.join(b, "k", nullptr, &tb)),
+                static_cast<int>(single_flight::role::lead));
+    LT_CHECK_EQ(static_cast<int>(flights.join(a, "other", nullptr, &tc)),
+                static_cast<int>(single_flight::role::lead));
+    LT_CHECK_EQ(flights.in_flight(), 3u);
+    flights.land(&ta, nullptr);
+    flights.land(&tb, nullptr);
+    flights.land(&tc, nullptr);
+    LT_CHECK_EQ(flights.in_flight(), 0u);
+LT_END_AUTO_TEST(keys_are_per_resource)
+
+LT_BEGIN_AUTO_TEST(single_flight_suite, unshareable_responses_stay_with_the_leader)
+    single_flight flights(single_flight::mode::block);
+    auto res = std::make_shared<keyed_resource>();
+    single_flight::ticket lead;
+    flights.join(res, "k", nullptr, &lead);
+
+    bool followed = false;
+    bool got_result = true;
+    std::thread follower([&] {
+        single_flight::ticket t;
+        followed = flights.join(res, "k", nullptr, &t) == single_flight::role::follow;
+        got_result = single_flight::take(&t).has_value();
+    });
+    await_followers(lead.joined.get(), 1);
+
+    http_response r = http_response::deferred([](std::uint64_t, char*, std::size_t) -> ssize_t {
+        return -1;
+    });
+    flights.land(&lead, &r);
+    follower.join();
+    LT_CHECK_EQ(followed, true);
+    // The follower runs the handler itself.
+    LT_CHECK_EQ(got_result, false);
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(body_kind::deferred));
+LT_END_AUTO_TEST(unshareable_responses_stay_with_the_leader)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
@@ -0,0 +1,214 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <microhttpd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+#include "./httpserver.hpp"
+#include "httpserver/create_test_request.hpp"
+#include "httpserver/detail/response_body.hpp"
+#include "httpserver/detail/sse_hub.hpp"
+#include "httpserver/detail/stream_channel.hpp"
+
+#include "./littletest.hpp"
+
+// Pins sse_channel: the event wire format, one encoded frame fanned out
+// to every subscriber, Last-Event-ID replay from the bounded ring,
+// dropping slow and disconnected subscribers, the keep-alive timer and
+// the end of every subscription when the channel goes away.
+
+using httpserver::create_test_request;
+using httpserver::http_response;
+using httpserver::sse_channel;
+using httpserver::sse_channel_options;
+using httpserver::detail::sse_hub;
+using httpserver::detail::stream_channel;
+using httpserver::detail::stream_response_body;
+
+namespace httpserver {
+
+// Same per-TU friend hook as http_response_sbo_test.cpp: reaches the
+// stream body behind a subscription.
+struct http_response_sbo_test_access {
+    static detail::response_body* body_ptr(http_response& r) noexcept { return r.body_; }
+};
+
+}  // namespace httpserver
+
+namespace {
+
+using SBO = httpserver::http_response_sbo_test_access;
+
+stream_channel& channel_of(http_response& r) {
+    return static_cast<stream_response_body*>(SBO::body_ptr(r))->channel();
+}
+
+// Everything queued on @p r right now; "<error>" once the stream failed,
+// "<end>" appended once it ended.
+std::string pending(http_response& r) {
+    std::string all;
+    char buf[7];
+    for (;;) {
+        const ssize_t n = channel_of(r).read(buf, sizeof(buf));
+        if (n == 0) return all;
+        if (n == MHD_CONTENT_READER_END_OF_STREAM) return all + "<end>";
+        if (n < 0) return "<error>";
+        all.append(buf, static_cast<std::size_t>(n));
+    }
+}
+
+http_response subscribe(sse_channel& ch, const std::string& last_event_id = {}) {
+    create_test_request req;
+    if (!last_event_id.empty()) req.header("Last-Event-ID", last_event_id);
+    return ch.subscribe(req.build());
+}
+
+sse_channel_options no_timer() {
+    sse_channel_options o;
+    o.keep_alive = std::chrono::milliseconds(0);
+    return o;
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(sse_channel_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(sse_channel_suite)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, events_are_encoded_per_the_wire_format)
+    LT_CHECK_EQ(sse_hub::encode("hi", "", ""), "data: hi\n\n");
+    LT_CHECK_EQ(sse_hub::encode("a\nb\r\nc\rd", "tick", "7"),
+                "event: tick\nid: 7\ndata: a\ndata: b\ndata: c\ndata: d\n\n");
+    LT_CHECK_EQ(sse_hub::encode("", "", ""), "data: \n\n");
+    LT_CHECK_THROW(sse_hub::encode("x", "bad\nevent", ""));
+    LT_CHECK_THROW(sse_hub::encode("x", "", std::string("i\0d", 3)));
+LT_END_AUTO_TEST(events_are_encoded_per_the_wire_format)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, subscription_is_an_event_stream)
+    sse_channel ch(no_timer());
+    http_response r = subscribe(ch);
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(httpserver::body_kind::stream));
+    LT_CHECK_EQ(r.get_header("Content-Type"), "text/event-stream");
+    LT_CHECK_EQ(r.get_header("Cache-Control"), "no-cache");
+    LT_CHECK_EQ(ch.subscribers(), 1u);
+    LT_CHECK_THROW(sse_channel(sse_channel_options{.subscriber_buffer = 0}));
+LT_END_AUTO_TEST(subscription_is_an_event_stream)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, publish_reaches_every_subscriber)
+    sse_channel ch(no_timer());
+    http_response a = subscribe(ch);
+    http_response b = subscribe(ch);
+    ch.publish("one");
+    ch.publish("two", "update", "2");
+    const std::string expected = "data: one\n\nevent: update\nid: 2\ndata: two\n\n";
+    LT_CHECK_EQ(pending(a), expected);
+    LT_CHECK_EQ(pending(b), expected);
+    LT_CHECK_EQ(pending(a), "");
+LT_END_AUTO_TEST(publish_reaches_every_subscriber)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, last_event_id_replays_what_followed)
+    sse_channel ch(no_timer());
+    ch.publish("first", "", "1");
+    ch.publish("second", "", "2");
+    ch.publish("untagged");
+    http_response resumed = subscribe(ch, "1");
+    LT_CHECK_EQ(pending(resumed), "id: 2\ndata: second\n\ndata: untagged\n\n");
+    ch.publish("live", "", "3");
+    LT_CHECK_EQ(pending(resumed), "id: 3\ndata: live\n\n");
+
+    // An id the ring no longer holds (or never did) replays nothing.
+    http_response unknown = subscribe(ch, "nope");
+    LT_CHECK_EQ(pending(unknown), "");
+    http_response latest = subscribe(ch, "3");
+    LT_CHECK_EQ(pending(latest), "");
+LT_END_AUTO_TEST(last_event_id_replays_what_followed)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, replay_ring_is_bounded)
+    sse_channel_options o = no_timer();
+    o.replay_events = 2;
+    sse_channel ch(o);
+    for (int i = 1; i <= 4; ++i) ch.publish("e", "", std::to_string(i));
+    http_response evicted = subscribe(ch, "1");
+    LT_CHECK_EQ(pending(evicted), "");
+    http_response kept = subscribe(ch, "3");
+    LT_CHECK_EQ(pending(kept), "id: 4\ndata: e\n\n");
+LT_END_AUTO_TEST(replay_ring_is_bounded)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, slow_subscribers_are_dropped)
+    sse_channel_options o = no_timer();
+    o.subscriber_buffer = 32;
+    sse_channel ch(o);
+    http_response slow = subscribe(ch);
+    http_response fast = subscribe(ch);
+    for (int i = 0; i < 4; ++i) {
+        ch.publish("0123456789");
+        pending(fast);
+    }
+    LT_CHECK_EQ(ch.subscribers(), 1u);
+    LT_CHECK_EQ(channel_of(slow).closed(), true);
+    LT_CHECK_EQ(pending(slow), "<error>");
+    ch.publish("still");
+    LT_CHECK_EQ(pending(fast), "data: still\n\n");
+LT_END_AUTO_TEST(slow_subscribers_are_dropped)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, dropped_responses_are_pruned)
+    sse_channel ch(no_timer());
+    {
+        http_response gone = subscribe(ch);
+        LT_CHECK_EQ(ch.subscribers(), 1u);
+    }
+    LT_CHECK_EQ(ch.subscribers(), 0u);
+    ch.publish("nobody listens");
+LT_END_AUTO_TEST(dropped_responses_are_pruned)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, idle_streams_get_keep_alive_comments)
+    sse_channel_options o;
+    o.keep_alive = std::chrono::milliseconds(10);
+    sse_channel ch(o);
+    http_response r = subscribe(ch);
+    std::string got;
+    for (int i = 0; i < 200 && got.empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        got = pending(r);
+    }
+    LT_CHECK_EQ(got.substr(0, 3), ":\n\n");
+LT_END_AUTO_TEST(idle_streams_get_keep_alive_comments)
+
+LT_BEGIN_AUTO_TEST(sse_channel_suite, destroying_the_channel_ends_subscriptions)
+    http_response r;
+    {
+        sse_channel ch(no_timer());
+        r = subscribe(ch);
+        ch.publish("bye");
+    }
+    LT_CHECK_EQ(pending(r), "data: bye\n\n<end>");
+LT_END_AUTO_TEST(destroying_the_channel_ends_subscriptions)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
@@ -0,0 +1,221 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "./httpserver.hpp"
+#include "httpserver/create_test_request.hpp"
+#include "httpserver/detail/http_date.hpp"
+#include "httpserver/detail/mime_types.hpp"
+#include "httpserver/detail/range_responder.hpp"
+#include "httpserver/detail/response_body.hpp"
+#include "httpserver/detail/static_directory_index.hpp"
+
+#include "./littletest.hpp"
+
+// Pins static_directory_resource: URL -> file mapping under the root
+// (prefix, dot-segments, index files, symlinks), the headers it sets, the
+// allowed methods, constructor validation, the metadata index behind it
+// and the compiled MIME table.
+
+using httpserver::create_test_request;
+using httpserver::http_response;
+using httpserver::static_directory_options;
+using httpserver::static_directory_resource;
+using httpserver::detail::mime_type_for;
+using httpserver::detail::static_directory_index;
+
+namespace httpserver {
+
+// Same per-TU friend hook as http_response_sbo_test.cpp: reads the file
+// body the resource built.
+struct http_response_sbo_test_access {
+    static detail::response_body* body_ptr(http_response& r) noexcept { return r.body_; }
+};
+
+}  // namespace httpserver
+
+namespace {
+
+using SBO = httpserver::http_response_sbo_test_access;
+
+void write_file(const std::string& path, const std::string& content) {
+    std::ofstream(path) << content;
+}
+
+// A root directory with a file, a subdirectory holding an index file,
+// an empty subdirectory, and a symlink; plus a file beside the root.
+struct temp_tree {
+    temp_tree() {
+        char tmpl[] = "/tmp/static_directory_testXXXXXX";
+        base = ::mkdtemp(tmpl);
+        root = base + "/root";
+        ::mkdir(root.c_str(), 0755);
+        ::mkdir((root + "/docs").c_str(), 0755);
+        ::mkdir((root + "/empty").c_str(), 0755);
+        write_file(root + "/app.css", "body{}");
+        write_file(root + "/docs/index.html", "<p>docs</p>");
+        write_file(base + "/secret.txt", "secret");
+        (void) !::symlink((base + "/secret.txt").c_str(), (root + "/link.txt").c_str());
+    }
+    ~temp_tree() {
+        for (const char* p : {"/root/app.css", "/root/docs/index.html", "/root/link.txt",
+                              "/secret.txt"}) {
+            ::unlink((base + p).c_str());
+        }
+        for (const char* d : {"/root/docs", "/root/empty", "/root", ""}) ::rmdir((base + d).c_str());
+    }
+    temp_tree(const temp_tree&) = delete;
+    temp_tree& operator=(const temp_tree&) = delete;
+
+    std::string base;
+    std::string root;
+};
+
+std::string served_path(http_response& r) {
+    if (r.kind() != httpserver::body_kind::file) return "";
+    return static_cast<httpserver::detail::file_response_body*>(SBO::body_ptr(r))->path();
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(static_directory_resource_suite)
+    temp_tree tree;
+
+    http_response get(static_directory_resource& res, const std::string& path) {
+        return res.render_get(create_test_request().path(path).build());
+    }
+
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(static_directory_resource_suite)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, serves_a_file_with_metadata)
+    static_directory_resource res("/static", tree.root, {.cache_control = "public, max-age=60"});
+    http_response r = get(res, "/static/app.css");
+    LT_CHECK_EQ(r.get_status(), 200);
+    LT_CHECK_EQ(served_path(r), tree.root + "/app.css");
+    LT_CHECK_EQ(r.get_header("Content-Type"), "text/css");
+    LT_CHECK_EQ(r.get_header("Cache-Control"), "public, max-age=60");
+    struct stat sb;
+    LT_ASSERT_EQ(::stat((tree.root + "/app.css").c_str(), &sb), 0);
+    LT_CHECK_EQ(r.get_header("ETag"), httpserver::detail::range_responder::file_etag(
+        httpserver::detail::file_mtime_ns(sb), static_cast<std::uint64_t>(sb.st_size)));
+    LT_CHECK_EQ(r.get_header("Last-Modified"), httpserver::detail::format_imf_fixdate(sb.st_mtime));
+LT_END_AUTO_TEST(serves_a_file_with_metadata)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, directories_serve_their_index_file)
+    static_directory_resource res("/static", tree.root);
+    http_response docs = get(res, "/static/docs");
+    LT_CHECK_EQ(served_path(docs), tree.root + "/docs/index.html");
+    LT_CHECK_EQ(docs.get_header("Content-Type"), "text/html");
+    LT_CHECK_EQ(get(res, "/static/empty").get_status(), 404);
+    // The prefix itself is the root, which has no index file.
+    LT_CHECK_EQ(get(res, "/static").get_status(), 404);
+    static_directory_resource css_index("/static", tree.root, {.index_files = {"app.css"}});
+    http_response root = get(css_index, "/static");
+    LT_CHECK_EQ(served_path(root), tree.root + "/app.css");
+LT_END_AUTO_TEST(directories_serve_their_index_file)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, stays_under_the_root)
+    static_directory_resource res("/static", tree.root);
+    LT_CHECK_EQ(get(res, "/static/../secret.txt").get_status(), 404);
+    LT_CHECK_EQ(get(res, "/static/docs/../../secret.txt").get_status(), 404);
+    http_response inside = get(res, "/static/docs/../app.css");
+    LT_CHECK_EQ(served_path(inside), tree.root + "/app.css");
+    LT_CHECK_EQ(get(res, "/static/link.txt").get_status(), 404);
+    LT_CHECK_EQ(get(res, "/staticx/app.css").get_status(), 404);
+    LT_CHECK_EQ(get(res, std::string("/static/app.css\0x", 17)).get_status(), 404);
+    LT_CHECK_EQ(get(res, "/static/missing.css").get_status(), 404);
+LT_END_AUTO_TEST(stays_under_the_root)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, root_prefix_maps_every_path)
+    static_directory_resource res("/", tree.root);
+    http_response r = get(res, "/app.css");
+    LT_CHECK_EQ(served_path(r), tree.root + "/app.css");
+LT_END_AUTO_TEST(root_prefix_maps_every_path)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, only_get_and_head)
+    static_directory_resource res("/static", tree.root);
+    LT_CHECK_EQ(res.is_allowed(httpserver::http_method::get), true);
+    LT_CHECK_EQ(res.is_allowed(httpserver::http_method::head), true);
+    LT_CHECK_EQ(res.is_allowed(httpserver::http_method::post), false);
+    LT_CHECK_EQ(res.is_allowed(httpserver::http_method::del), false);
+    http_response head = res.render_head(create_test_request().path("/static/app.css").build());
+    LT_CHECK_EQ(served_path(head), tree.root + "/app.css");
+LT_END_AUTO_TEST(only_get_and_head)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, constructor_validates)
+    LT_CHECK_THROW(static_directory_resource("/s", tree.root + "/app.css"));
+    LT_CHECK_THROW(static_directory_resource("/s", tree.base + "/nope"));
+    LT_CHECK_THROW(static_directory_resource("/s", tree.root, {.cache_control = "a\r\nX-Evil: 1"}));
+LT_END_AUTO_TEST(constructor_validates)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, index_caches_hits_only)
+    static_directory_index index(tree.root, {"index.html"}, 2, std::chrono::hours(1));
+    const auto first = index.lookup("/app.css");
+    LT_ASSERT_EQ(first != nullptr, true);
+    LT_CHECK_EQ(index.lookup("/app.css").get(), first.get());
+    LT_CHECK_EQ(index.lookup("/missing") == nullptr, true);
+    LT_CHECK_EQ(index.entries(), 1u);
+    index.lookup("/docs");
+    index.lookup("/");  // no index file at the root: not cached
+    LT_CHECK_EQ(index.entries(), 2u);
+    // Bounded: a third path evicts the least recently used (/app.css).
+    write_file(tree.root + "/extra.txt", "x");
+    index.lookup("/extra.txt");
+    LT_CHECK_EQ(index.entries(), 2u);
+    LT_CHECK_NEQ(index.lookup("/app.css").get(), first.get());
+    ::unlink((tree.root + "/extra.txt").c_str());
+LT_END_AUTO_TEST(index_caches_hits_only)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, index_entries_expire)
+    static_directory_index index(tree.root, {}, 8, std::chrono::milliseconds(0));
+    const auto first = index.lookup("/app.css");
+    LT_ASSERT_EQ(first != nullptr, true);
+    LT_CHECK_NEQ(index.lookup("/app.css").get(), first.get());
+    static_directory_index uncached(tree.root, {}, 0, std::chrono::hours(1));
+    LT_CHECK_EQ(uncached.lookup("/app.css") != nullptr, true);
+    LT_CHECK_EQ(uncached.entries(), 0u);
+LT_END_AUTO_TEST(index_entries_expire)
+
+LT_BEGIN_AUTO_TEST(static_directory_resource_suite, mime_table)
+    LT_CHECK_EQ(mime_type_for("/a/index.html").view(), "text/html");
+    LT_CHECK_EQ(mime_type_for("/a/APP.JS").view(), "application/javascript");
+    LT_CHECK_EQ(mime_type_for("/fonts/x.woff2").view(), "font/woff2");
+    LT_CHECK_EQ(mime_type_for("/a.b/README").view(), "application/octet-stream");
+    LT_CHECK_EQ(mime_type_for("/a/archive.unknown").view(), "application/octet-stream");
+    LT_CHECK_EQ(mime_type_for("/a/trailing.").view(), "application/octet-stream");
+LT_END_AUTO_TEST(mime_table)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
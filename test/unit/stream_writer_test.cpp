@@ -0,0 +1,203 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <microhttpd.h>
+
+#include <cstddef>
+#include <string>
+#include <thread>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/response_body.hpp"
+#include "httpserver/detail/stream_channel.hpp"
+
+#include "./littletest.hpp"
+
+// Pins stream_writer / http_response::stream: the bounded ring between
+// writer and content reader (wrap-around, partial and blocking writes,
+// finish), the reader waiting where it cannot suspend, the close paths
+// (body dropped, MHD response destroyed, server stop via
+// stream_registry) and what a closed stream does to writers.
+
+using httpserver::http_response;
+using httpserver::stream_writer;
+using httpserver::detail::stream_channel;
+using httpserver::detail::stream_registry;
+using httpserver::detail::stream_response_body;
+
+namespace httpserver {
+
+// Same per-TU friend hook as http_response_sbo_test.cpp: reaches the
+// stream body behind a factory-built response.
+struct http_response_sbo_test_access {
+    static detail::response_body* body_ptr(http_response& r) noexcept { return r.body_; }
+};
+
+}  // namespace httpserver
+
+namespace {
+
+using SBO = httpserver::http_response_sbo_test_access;
+
+stream_channel& channel_of(http_response& r) {
+    return static_cast<stream_response_body*>(SBO::body_ptr(r))->channel();
+}
+
+// Reads through the body's MHD content reader until the end of the
+// stream or an error; "<error>" for the latter.
+std::string drain(http_response& r, std::size_t max) {
+    std::shared_ptr<stream_channel> ref(std::shared_ptr<stream_channel>{}, &channel_of(r));
+    std::string out(max, '\0');
+    std::string all;
+    for (;;) {
+        const ssize_t n = stream_response_body::trampoline(&ref, all.size(), out.data(), max);
+        if (n == MHD_CONTENT_READER_END_OF_STREAM) return all;
+        if (n < 0) return "<error>";
+        all.append(out.data(), static_cast<std::size_t>(n));
+    }
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(stream_writer_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(stream_writer_suite)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, factory_builds_a_stream_body)
+    stream_writer w;
+    http_response r = http_response::stream(w);
+    LT_CHECK_EQ(r.get_status(), 200);
+    LT_CHECK_EQ(static_cast<int>(r.kind()), static_cast<int>(httpserver::body_kind::stream));
+    LT_CHECK_EQ(channel_of(r).capacity(), 64u * 1024u);
+    LT_CHECK_THROW(stream_writer(0));
+LT_END_AUTO_TEST(factory_builds_a_stream_body)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, ring_wraps_around)
+    stream_writer w(8);
+    http_response r = http_response::stream(w);
+    char buf[8];
+    LT_CHECK_EQ(w.try_write("abcdef"), 6u);
+    LT_CHECK_EQ(channel_of(r).read(buf, 4), 4);
+    LT_CHECK_EQ(std::string(buf, 4), "abcd");
+    // 2 bytes queued, 6 free: the write wraps past the end of the ring.
+    LT_CHECK_EQ(w.try_write("ghijklmn"), 6u);
+    LT_CHECK_EQ(w.try_write("x"), 0u);
+    LT_CHECK_EQ(channel_of(r).read(buf, 8), 8);
+    LT_CHECK_EQ(std::string(buf, 8), "efghijkl");
+    LT_CHECK_EQ(channel_of(r).read(buf, 8), 0);
+LT_END_AUTO_TEST(ring_wraps_around)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, finish_ends_the_body_once_drained)
+    stream_writer w(16);
+    http_response r = http_response::stream(w);
+    LT_CHECK_EQ(w.write("hello"), true);
+    w.finish();
+    LT_CHECK_EQ(w.write("late"), false);
+    LT_CHECK_EQ(w.try_write("late"), 0u);
+    LT_CHECK_EQ(drain(r, 3), "hello");
+LT_END_AUTO_TEST(finish_ends_the_body_once_drained)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, writes_block_while_full_and_arrive_in_order)
+    stream_writer w(7);
+    http_response r = http_response::stream(w);
+    std::string expected;
+    for (int i = 0; i < 500; ++i) expected += std::to_string(i) + ",";
+    std::thread producer([w, &expected]() mutable {
+        for (std::size_t i = 0; i < expected.size(); i += 13) {
+            if (!w.write(expected.substr(i, 13))) return;
+        }
+        w.finish();
+    });
+    // Unattached, the reader waits for the producer instead of suspending.
+    LT_CHECK_EQ(drain(r, 5) == expected, true);
+    producer.join();
+LT_END_AUTO_TEST(writes_block_while_full_and_arrive_in_order)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, dropping_the_response_closes_the_writer)
+    stream_writer w(4);
+    LT_CHECK_EQ(w.try_write("abcd"), 4u);
+    std::thread blocked;
+    bool blocked_result = true;
+    {
+        http_response r = http_response::stream(w);
+        LT_CHECK_EQ(w.closed(), false);
+        blocked = std::thread([w, &blocked_result]() mutable { blocked_result = w.write("e"); });
+        http_response moved = std::move(r);
+    }
+    blocked.join();
+    LT_CHECK_EQ(blocked_result, false);
+    LT_CHECK_EQ(w.closed(), true);
+    LT_CHECK_EQ(w.try_write("x"), 0u);
+LT_END_AUTO_TEST(dropping_the_response_closes_the_writer)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, destroying_the_mhd_response_closes_the_writer)
+    stream_writer w;
+    http_response r = http_response::stream(w);
+    MHD_Response* mhd = SBO::body_ptr(r)->materialize();
+    LT_ASSERT_NEQ(mhd, static_cast<MHD_Response*>(nullptr));
+    r = http_response::empty();
+    // MHD's reference keeps the stream open past the http_response.
+    LT_CHECK_EQ(w.closed(), false);
+    MHD_destroy_response(mhd);
+    LT_CHECK_EQ(w.closed(), true);
+LT_END_AUTO_TEST(destroying_the_mhd_response_closes_the_writer)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, registry_close_fails_streams)
+    stream_registry registry;
+    stream_writer w(16);
+    http_response r = http_response::stream(w);
+    channel_of(r).attach(nullptr, false, &registry);
+    LT_CHECK_EQ(w.write("partial"), true);
+    registry.close();
+    LT_CHECK_EQ(w.closed(), true);
+    LT_CHECK_EQ(w.write("more"), false);
+    LT_CHECK_EQ(drain(r, 16), "<error>");
+
+    // While closed, new streams are failed as they attach; reopen()
+    // tracks them again.
+    stream_writer late(16);
+    http_response late_r = http_response::stream(late);
+    channel_of(late_r).attach(nullptr, false, &registry);
+    LT_CHECK_EQ(late.closed(), true);
+    registry.reopen();
+    stream_writer next(16);
+    http_response next_r = http_response::stream(next);
+    channel_of(next_r).attach(nullptr, false, &registry);
+    LT_CHECK_EQ(next.closed(), false);
+LT_END_AUTO_TEST(registry_close_fails_streams)
+
+LT_BEGIN_AUTO_TEST(stream_writer_suite, park_waits_for_data_when_it_cannot_suspend)
+    stream_writer w(16);
+    http_response r = http_response::stream(w);
+    channel_of(r).attach(nullptr, false, nullptr);
+    std::thread producer([w]() mutable { w.write("late"); });
+    LT_CHECK_EQ(channel_of(r).park(), false);
+    char buf[16];
+    LT_CHECK_EQ(channel_of(r).read(buf, sizeof(buf)), 4);
+    producer.join();
+LT_END_AUTO_TEST(park_waits_for_data_when_it_cannot_suspend)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
@@ -0,0 +1,101 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/upload_budget.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::upload_budget, the process-wide request-body accounting
+// behind create_webserver::upload_memory_budget / upload_disk_budget:
+// limits are enforced per reservation, charges give their bytes back on
+// destruction and move, and concurrent reservers never overshoot.
+
+using httpserver::detail::upload_budget;
+using kind = upload_budget::kind;
+
+LT_BEGIN_SUITE(upload_budget_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(upload_budget_suite)
+
+LT_BEGIN_AUTO_TEST(upload_budget_suite, reservations_respect_limit)
+    upload_budget b(100, 0);
+    {
+        upload_budget::charge c(&b);
+        LT_CHECK_EQ(c.reserve(kind::memory, 60), true);
+        LT_CHECK_EQ(c.reserve(kind::memory, 41), false);
+        LT_CHECK_EQ(c.reserve(kind::memory, 40), true);
+        LT_CHECK_EQ(b.in_use(kind::memory), static_cast<size_t>(100));
+        // Disk is uncapped but still counted.
+        LT_CHECK_EQ(c.reserve(kind::disk, 1 << 20), true);
+        LT_CHECK_EQ(b.in_use(kind::disk), static_cast<size_t>(1 << 20));
+    }
+    LT_CHECK_EQ(b.in_use(kind::memory), static_cast<size_t>(0));
+    LT_CHECK_EQ(b.in_use(kind::disk), static_cast<size_t>(0));
+LT_END_AUTO_TEST(reservations_respect_limit)
+
+LT_BEGIN_AUTO_TEST(upload_budget_suite, move_transfers_ownership)
+    upload_budget b(0, 10);
+    upload_budget::charge outer;
+    LT_CHECK_EQ(outer.reserve(kind::disk, 1000), true);  // unbound: no-op
+    {
+        upload_budget::charge c(&b);
+        LT_CHECK_EQ(c.reserve(kind::disk, 10), true);
+        outer = std::move(c);
+    }
+    LT_CHECK_EQ(b.in_use(kind::disk), static_cast<size_t>(10));
+    outer = upload_budget::charge(&b);
+    LT_CHECK_EQ(b.in_use(kind::disk), static_cast<size_t>(0));
+LT_END_AUTO_TEST(move_transfers_ownership)
+
+LT_BEGIN_AUTO_TEST(upload_budget_suite, concurrent_reservers_never_overshoot)
+    upload_budget b(1000, 0);
+    std::vector<size_t> granted(8, 0);
+    std::vector<std::thread> threads;
+    std::vector<upload_budget::charge> charges;
+    for (int i = 0; i < 8; ++i) charges.emplace_back(&b);
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i] {
+            for (int n = 0; n < 1000; ++n) {
+                if (charges[i].reserve(kind::memory, 1)) ++granted[i];
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    size_t total = 0;
+    for (size_t g : granted) total += g;
+    LT_CHECK_EQ(total, static_cast<size_t>(1000));
+    LT_CHECK_EQ(b.in_use(kind::memory), static_cast<size_t>(1000));
+    charges.clear();
+    LT_CHECK_EQ(b.in_use(kind::memory), static_cast<size_t>(0));
+LT_END_AUTO_TEST(concurrent_reservers_never_overshoot)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
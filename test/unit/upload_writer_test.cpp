@@ -0,0 +1,138 @@
+/*
+     This file is part of libhttpserver
+     Copyright (C) 2011-2026 Sebastiano Merlino
+
+     This library is free software; you can redistribute it and/or
+     modify it under the terms of the GNU Lesser General Public
+     License as published by the Free Software Foundation; either
+     version 2.1 of the License, or (at your option) any later version.
+
+     This library is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     Lesser General Public License for more details.
+
+     You should have received a copy of the GNU Lesser General Public
+     License along with this library; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+     USA
+*/
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "./httpserver.hpp"
+#include "httpserver/detail/upload_writer.hpp"
+
+#include "./littletest.hpp"
+
+// Pins detail::upload_writer, the background pwrite() sink behind
+// create_webserver::async_upload_writes. The writer is built with
+// can_suspend == false (the THREAD_PER_CONNECTION mode), so throttle and
+// wait_for_flush block the calling thread and no daemon is needed.
+
+using httpserver::detail::upload_writer;
+
+namespace {
+
+std::string make_temp_path() {
+    char tmpl[] = "/tmp/upload_writer_testXXXXXX";
+    const int fd = mkstemp(tmpl);
+    if (fd >= 0) ::close(fd);
+    return tmpl;
+}
+
+std::shared_ptr<upload_writer::stream> open_stream(const std::string& path) {
+    auto s = std::make_shared<upload_writer::stream>();
+    s->file = std::make_shared<upload_writer::file_handle>(
+        ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666));
+    return s;
+}
+
+std::string slurp(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+}
+
+}  // namespace
+
+LT_BEGIN_SUITE(upload_writer_suite)
+    void set_up() {
+    }
+
+    void tear_down() {
+    }
+LT_END_SUITE(upload_writer_suite)
+
+LT_BEGIN_AUTO_TEST(upload_writer_suite, zero_budget_disables_writer)
+    upload_writer w(0, false);
+    LT_CHECK_EQ(w.enabled(), false);
+    LT_CHECK_EQ(w.in_flight_bytes(), static_cast<size_t>(0));
+LT_END_AUTO_TEST(zero_budget_disables_writer)
+
+LT_BEGIN_AUTO_TEST(upload_writer_suite, chunks_land_at_their_offsets)
+    const std::string path = make_temp_path();
+    upload_writer w(1024, false);
+    auto s = open_stream(path);
+    LT_ASSERT_EQ(s->file->fd >= 0, true);
+
+    std::string expected;
+    uint64_t offset = 0;
+    for (int i = 0; i < 200; ++i) {
+        const std::string chunk = "chunk-" + std::to_string(i) + ";";
+        LT_ASSERT_EQ(w.enqueue(s, offset, chunk.data(), chunk.size()), true);
+        // Over budget: blocks until this stream's writes drained enough.
+        LT_CHECK_EQ(w.throttle(*s, nullptr), false);
+        offset += chunk.size();
+        expected += chunk;
+    }
+    LT_CHECK_EQ(w.wait_for_flush(*s, nullptr), false);
+    LT_CHECK_EQ(s->pending, static_cast<size_t>(0));
+    LT_CHECK_EQ(s->failed, false);
+    LT_CHECK_EQ(w.in_flight_bytes(), static_cast<size_t>(0));
+    LT_CHECK_EQ(slurp(path), expected);
+    ::unlink(path.c_str());
+LT_END_AUTO_TEST(chunks_land_at_their_offsets)
+
+LT_BEGIN_AUTO_TEST(upload_writer_suite, destructor_drains_queue)
+    const std::string path = make_temp_path();
+    const std::string payload(64 * 1024, 'x');
+    {
+        upload_writer w(1, false);
+        auto s = open_stream(path);
+        for (uint64_t i = 0; i < 8; ++i) {
+            LT_ASSERT_EQ(w.enqueue(s, i * payload.size(), payload.data(), payload.size()), true);
+        }
+    }
+    LT_CHECK_EQ(slurp(path).size(), 8 * payload.size());
+    ::unlink(path.c_str());
+LT_END_AUTO_TEST(destructor_drains_queue)
+
+LT_BEGIN_AUTO_TEST(upload_writer_suite, failed_write_poisons_stream)
+    const std::string path = make_temp_path();
+    upload_writer w(1024, false);
+    auto s = std::make_shared<upload_writer::stream>();
+    // Read-only descriptor: pwrite() fails with EBADF.
+    s->file = std::make_shared<upload_writer::file_handle>(
+        ::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    LT_ASSERT_EQ(w.enqueue(s, 0, "abc", 3), true);
+    LT_CHECK_EQ(w.wait_for_flush(*s, nullptr), false);
+    LT_CHECK_EQ(s->failed, true);
+    LT_CHECK_EQ(w.enqueue(s, 3, "def", 3), false);
+    LT_CHECK_EQ(w.in_flight_bytes(), static_cast<size_t>(0));
+    ::unlink(path.c_str());
+LT_END_AUTO_TEST(failed_write_poisons_stream)
+
+LT_BEGIN_AUTO_TEST_ENV()
+    AUTORUN_TESTS()
+LT_END_AUTO_TEST_ENV()
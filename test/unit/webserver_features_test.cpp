@@ -19,8 +19,9 @@
 */
 
 // Pins the public contract of httpserver::webserver::features():
-//   - returns a struct with exactly four `bool` members in the
-//     documented order (basic_auth, digest_auth, tls, websocket);
+//   - returns a struct with exactly five `bool` members in the
+//     documented order (basic_auth, digest_auth, tls, websocket,
+//     compression);
 //   - the function is noexcept;
 //   - each field equals the corresponding HAVE_* state at build time.
 //
@@ -32,7 +33,7 @@
 #include "./httpserver.hpp"
 #include "./littletest.hpp"
 
-// Contract: features struct shape — exactly four bool fields in this order.
+// Contract: features struct shape — exactly five bool fields in this order.
 static_assert(
     std::is_same_v<decltype(httpserver::webserver::features().basic_auth), bool>,
     "features.basic_auth must be bool");
@@ -45,6 +46,9 @@ static_assert(
 static_assert(
     std::is_same_v<decltype(httpserver::webserver::features().websocket), bool>,
     "features.websocket must be bool");
+static_assert(
+    std::is_same_v<decltype(httpserver::webserver::features().compression), bool>,
+    "features.compression must be bool");
 
 // The struct-tag form disambiguates the type from the homonymous member
 // function (both spelled `features`).
@@ -88,9 +92,14 @@ constexpr bool k_expected_ws = true;
 #else
 constexpr bool k_expected_ws = false;
 #endif
+#ifdef HAVE_ZLIB
+constexpr bool k_expected_zlib = true;
+#else
+constexpr bool k_expected_zlib = false;
+#endif
 
 // Contract: each field reflects the HAVE_* that the library was built with.
-// The four assertions below are unconditional: each compares the runtime
+// The five assertions below are unconditional: each compares the runtime
 // value against its compile-time expected constant so the intent is clear
 // and both true and false branches are visible in every build.
 LT_BEGIN_AUTO_TEST(webserver_features_suite, fields_match_build_flags)
@@ -99,6 +108,7 @@ LT_BEGIN_AUTO_TEST(webserver_features_suite, fields_match_build_flags)
     LT_CHECK_EQ(f.digest_auth, k_expected_dauth);
     LT_CHECK_EQ(f.tls, k_expected_tls);
     LT_CHECK_EQ(f.websocket, k_expected_ws);
+    LT_CHECK_EQ(f.compression, k_expected_zlib);
 LT_END_AUTO_TEST(fields_match_build_flags)
 
 LT_BEGIN_AUTO_TEST_ENV()
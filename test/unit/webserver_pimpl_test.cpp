@@ -57,11 +57,11 @@ static_assert(!std::is_move_assignable_v<httpserver::webserver>,
 //
 //   | CI lane                                      | observed bytes |
 //   |----------------------------------------------|----------------|
-//   | macos-latest / Apple clang 21 / libc++       |            776 |  24-byte std::string SSO
-//   | ubuntu-latest / gcc 11..14 / libstdc++       |           ~848 |  32-byte std::string SSO dominates (inferred from libstdc++ ABI; not directly measured on this lane)
-//   | ubuntu-latest / clang 13..18 / libstdc++     |           ~848 |  same ABI as above (inferred, not directly measured on this lane)
-//   | windows-latest / MINGW64 gcc / libstdc++     |           ~848 |  inferred from libstdc++ ABI (32-byte std::string SSO); not directly measured on this lane
-//   | windows-latest / MSYS gcc / libstdc++        |           ~848 |  inferred from libstdc++ ABI (32-byte std::string SSO); not directly measured on this lane
+//   | macos-latest / Apple clang 21 / libc++       |          <1064 |  24-byte std::string SSO; 776 before the upload, compression, cache and default-header options (not re-measured since)
+//   | ubuntu-latest / gcc 11..14 / libstdc++       |           1064 |  32-byte std::string SSO dominates (measured with gcc 12)
+//   | ubuntu-latest / clang 13..18 / libstdc++     |          ~1064 |  same ABI as above (inferred, not directly measured on this lane)
+//   | windows-latest / MINGW64 gcc / libstdc++     |          ~1064 |  inferred from libstdc++ ABI (32-byte std::string SSO); not directly measured on this lane
+//   | windows-latest / MSYS gcc / libstdc++        |          ~1064 |  inferred from libstdc++ ABI (32-byte std::string SSO); not directly measured on this lane
 //
 // Slack: +16 bytes (one alignment-step worth of forgiveness for a
 // padding shift across an ABI bump).  Tight enough that any new field
@@ -73,12 +73,12 @@ static_assert(!std::is_move_assignable_v<httpserver::webserver>,
 //   2) bump the threshold to max(observed) + 16;
 //   3) update the table above.
 //
-// Threshold = max(observed) + 16 = 848 + 16 = 864.
+// Threshold = max(observed) + 16 = 1064 + 16 = 1080.
 //
 // The msan CI lane is excluded: it compiles against a from-source,
 // MemorySanitizer-instrumented libc++ (LLVM 18.1.8, rebuilt on cache miss)
 // whose container/string layout is NOT the canonical ABI this cap was
-// measured against (Apple libc++ 776 / libstdc++ 848), so it reports an
+// measured against (Apple libc++ / libstdc++ 1064), so it reports an
 // unrepresentative, larger sizeof. That lane's purpose is memory-safety, not
 // ABI-size stability, and the gate is fully enforced on every non-instrumented
 // lane above — so skip the upper-bound cap under MemorySanitizer rather than
@@ -93,7 +93,7 @@ static_assert(!std::is_move_assignable_v<httpserver::webserver>,
 #  endif
 #endif
 #ifndef LHS_UNDER_MSAN
-static_assert(sizeof(httpserver::webserver) <= 864,
+static_assert(sizeof(httpserver::webserver) <= 1080,
               "webserver size grew beyond the recorded per-lane "
               "max + 16-byte slack; see comment table above for the "
               "re-measurement procedure");